@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// Subset of Adafruit_GFX's GFXcanvas16 used by the UI. Shapes are drawn
+// into the RGB565 buffer. Printed text is drawn in the classic 6x8 cell
+// (times the text size) as a placeholder glyph derived from the character,
+// so frame diffs follow text changes, and is also captured as strings (one
+// per line) that the simulated display keeps with the next frame.
+class GFXcanvas16 : public Print {
+public:
+  GFXcanvas16(uint16_t w, uint16_t h);
+  uint16_t* getBuffer() { return _buffer.data(); }
+  int16_t width() const { return (int16_t)_width; }
+  int16_t height() const { return (int16_t)_height; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void fillScreen(uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+
+  void setCursor(int16_t x, int16_t y);
+  void setTextColor(uint16_t color) {
+    _textColor = color;
+    _textBackground = color; // same color = transparent background
+  }
+  void setTextColor(uint16_t color, uint16_t background) {
+    _textColor = color;
+    _textBackground = background;
+  }
+  void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+  void setTextWrap(bool wrap) { (void)wrap; }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  /**
+   * Description: Move the text printed since the last call out of the canvas.
+   * Inputs: None.
+   * Outputs: Returns one string per line; the canvas starts a new frame's text.
+   */
+  std::vector<std::string> takeText();
+
+private:
+  /**
+   * Description: Draw the placeholder glyph for a character at the cursor.
+   * Inputs:
+   * - c: character.
+   * Outputs: Fills the 6x8 cell (scaled) with a pattern unique to c.
+   */
+  void drawGlyph(uint8_t c);
+
+  uint16_t _width;
+  uint16_t _height;
+  std::vector<uint16_t> _buffer;
+  int16_t _cursorX = 0;
+  int16_t _cursorY = 0;
+  uint8_t _textSize = 1;
+  uint16_t _textColor = 0xFFFF;
+  uint16_t _textBackground = 0xFFFF;
+  std::vector<std::string> _lines;
+  std::string _line;
+};
@@ -0,0 +1,183 @@
+#pragma once
+// Linux stand-in for the Teensy 4.1 Arduino core, used by the native build
+// (CMakeLists.txt). It covers only the API subset the firmware calls:
+// clock, GPIO/ADC, USB and hardware serial ports. The peripherals behind it
+// are simulated in SimHal.cpp and driven through SimHal.h. ARDUINO is
+// deliberately not defined, so code with a host path (Profiler.h) takes it.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <deque>
+#include <vector>
+
+#define DMAMEM
+#define FASTRUN
+#define EXTMEM
+#define PROGMEM
+
+#define F_CPU 600000000u
+#define F_CPU_ACTUAL 600000000u
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define CHANGE 4
+#define FALLING 2
+#define RISING 3
+
+#define A16 40
+#define A17 41
+
+static constexpr uint8_t SIM_PIN_COUNT = 64;
+static constexpr uint8_t SIM_UART_COUNT = 8;
+
+// Clock.
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Cycle counter: 600 MHz cycles of host time, so cycle benchmarks still
+// measure real work (see SimHal.h for the simulated clock).
+uint32_t simCycleCount();
+#define ARM_DWT_CYCCNT (simCycleCount())
+
+// GPIO, ADC and interrupts. Interrupt numbers are pin numbers; handlers
+// run synchronously when the simulation changes a pin.
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+inline int digitalReadFast(uint8_t pin) { return digitalRead(pin); }
+inline void digitalWriteFast(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int irq, void (*handler)(), int mode);
+void detachInterrupt(int irq);
+int analogRead(uint8_t pin);
+void analogReadResolution(unsigned int bits);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// Periodic timer interrupt. The handler runs from the simulated clock
+// (clock reads and simAdvanceUs()), never nested inside another handler.
+class IntervalTimer {
+public:
+  ~IntervalTimer() { end(); }
+  bool begin(void (*handler)(), uint32_t periodUs);
+  void end();
+
+private:
+  int8_t _slot = -1;
+};
+
+// PSRAM allocation (plain heap on the host).
+inline void* extmem_malloc(size_t size) { return malloc(size); }
+inline void extmem_free(void* ptr) { free(ptr); }
+
+inline bool isPrintable(char c) { return c >= 32 && c < 127; }
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (n < len && write(buf[n])) n++;
+    return n;
+  }
+  size_t write(const char* buf, size_t len) { return write((const uint8_t*)buf, len); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t println() { return print("\r\n"); }
+  template <typename T>
+  size_t println(T v) { return print(v) + println(); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+// USB serial: output goes to stdout, input comes from simUsbInput().
+class usb_serial_class : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  using Print::write;
+  int availableForWrite() override;
+  void flush() override;
+  operator bool() const { return true; }
+};
+extern usb_serial_class Serial;
+
+// Hardware UART: TX bytes leave at the configured baud rate on the
+// simulated clock; see SimHal.h for RX injection and loopback.
+class HardwareSerial : public Stream {
+public:
+  explicit HardwareSerial(uint8_t index) : _index(index) {}
+  void begin(uint32_t baud, uint16_t format = 0);
+  void end();
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  using Print::write;
+  int availableForWrite() override;
+  void flush() override;
+  void clear();
+  void addMemoryForWrite(void* buffer, size_t size);
+  void addMemoryForRead(void* buffer, size_t size);
+  operator bool() const { return true; }
+
+private:
+  uint8_t _index;
+};
+extern HardwareSerial Serial1, Serial2, Serial3, Serial4, Serial5, Serial6, Serial7, Serial8;
+
+class elapsedMillis {
+public:
+  elapsedMillis() : _start(millis()) {}
+  operator uint32_t() const { return millis() - _start; }
+  elapsedMillis& operator=(uint32_t value) {
+    _start = millis() - value;
+    return *this;
+  }
+
+private:
+  uint32_t _start;
+};
+
+class elapsedMicros {
+public:
+  elapsedMicros() : _start(micros()) {}
+  operator uint32_t() const { return micros() - _start; }
+  elapsedMicros& operator=(uint32_t value) {
+    _start = micros() - value;
+    return *this;
+  }
+
+private:
+  uint32_t _start;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+#include "SimHal.h"
+
+// Emulated EEPROM backed by simEeprom().
+class EEPROMClass {
+public:
+  uint8_t read(int index) { return inRange(index, 1) ? simEeprom()[index] : 0xFF; }
+  void write(int index, uint8_t value) {
+    if (inRange(index, 1)) simEeprom()[index] = value;
+  }
+  void update(int index, uint8_t value) { write(index, value); }
+  int length() { return SIM_EEPROM_BYTES; }
+
+  template <typename T>
+  T& get(int index, T& value) {
+    if (inRange(index, (int)sizeof(T))) memcpy((void*)&value, simEeprom() + index, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  const T& put(int index, const T& value) {
+    if (inRange(index, (int)sizeof(T))) memcpy(simEeprom() + index, (const void*)&value, sizeof(T));
+    return value;
+  }
+
+private:
+  static bool inRange(int index, int bytes) { return index >= 0 && index + bytes <= SIM_EEPROM_BYTES; }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+
+// Simulated ILI9341_T4 driver: update() hands the frame (and the text the
+// canvas captured) to the simulated display; see simDisplayFrames().
+static constexpr uint16_t ILI9341_T4_COLOR_BLACK = 0x0000;
+static constexpr uint16_t ILI9341_T4_COLOR_WHITE = 0xFFFF;
+static constexpr uint16_t ILI9341_T4_COLOR_RED = 0xF800;
+static constexpr uint16_t ILI9341_T4_COLOR_GREEN = 0x07E0;
+static constexpr uint16_t ILI9341_T4_COLOR_YELLOW = 0xFFE0;
+static constexpr uint16_t ILI9341_T4_COLOR_NAVY = 0x000F;
+
+namespace ILI9341_T4 {
+
+class DiffBuffBase {};
+
+template <int SIZE>
+class DiffBuffStatic : public DiffBuffBase {};
+
+// Frame statistics; the simulation reports frames per simulated second.
+class StatsVar {
+public:
+  explicit StatsVar(double avg = 0.0) : _avg(avg) {}
+  double avg() const { return _avg; }
+
+private:
+  double _avg;
+};
+
+class ILI9341Driver {
+public:
+  ILI9341Driver(uint8_t cs, uint8_t dc, uint8_t sclk, uint8_t mosi, uint8_t miso,
+                uint8_t rst = 255, uint8_t touch_cs = 255, uint8_t touch_irq = 255) {
+    (void)cs; (void)dc; (void)sclk; (void)mosi; (void)miso; (void)rst; (void)touch_cs; (void)touch_irq;
+  }
+  bool begin(uint32_t spiClock = 30000000);
+  void output(Stream* stream) { (void)stream; }
+  void invertDisplay(bool invert) { (void)invert; }
+  void setRotation(int rotation) { _rotation = rotation; }
+  int width() const { return (_rotation & 1) ? 320 : 240; }
+  int height() const { return (_rotation & 1) ? 240 : 320; }
+  void setFramebuffer(uint16_t* fb) { (void)fb; }
+  void setDiffBuffers(DiffBuffBase* a, DiffBuffBase* b = nullptr) { (void)a; (void)b; }
+  void setDiffGap(int gap) { (void)gap; }
+  void setRefreshRate(int hz) { (void)hz; }
+  void setVSyncSpacing(int spacing) { (void)spacing; }
+  void update(const uint16_t* fb, bool force = false);
+  StatsVar statsFPS() const;
+
+private:
+  int _rotation = 0;
+};
+
+} // namespace ILI9341_T4
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// Simulated SD card: a host directory set with simSetSdRoot().
+#define BUILTIN_SDCARD 254
+#define FILE_READ 0
+#define FILE_WRITE 1
+
+class File {
+public:
+  File() = default;
+  explicit File(FILE* f) : _f(f) {}
+  operator bool() const { return _f != nullptr; }
+  uint64_t size();
+  int read(void* buf, size_t len);
+  size_t write(const void* buf, size_t len);
+  bool seek(uint64_t pos);
+  uint64_t position();
+  int available();
+  void flush();
+  void close();
+
+private:
+  FILE* _f = nullptr; // shared by copies, like the Teensy SD handle
+};
+
+class SDClass {
+public:
+  bool begin(uint8_t csPin);
+  File open(const char* path, uint8_t mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+};
+extern SDClass SD;
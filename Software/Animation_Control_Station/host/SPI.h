@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+
+// The display driver owns SPI on the target; nothing to simulate here.
+class SPIClass {
+public:
+  void begin() {}
+};
+extern SPIClass SPI;
@@ -0,0 +1,235 @@
+#include "SimHal.h"
+#include <Adafruit_GFX.h>
+#include <ILI9341_T4.h>
+
+#include <algorithm>
+
+// Simulated display sink: the driver's update() copies the frame and the
+// text its canvas captured since the previous frame, and counts the pixels
+// that changed (the ILI9341_T4 diff buffers send only those).
+struct SimDisplay {
+  uint32_t frames = 0;
+  uint64_t firstFrameNs = 0;
+  std::vector<std::string> text;
+  std::vector<uint16_t> pixels;
+  uint32_t changedPixels = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * Description: Get the display state (created on first use).
+ * Inputs: None.
+ * Outputs: Returns the process-wide display.
+ */
+static SimDisplay& display() {
+  static SimDisplay* state = new SimDisplay();
+  return *state;
+}
+
+/**
+ * Description: Get the live canvases, so update() can find the text drawn into a frame buffer.
+ * Inputs: None.
+ * Outputs: Returns the registry.
+ */
+static std::vector<GFXcanvas16*>& canvases() {
+  static std::vector<GFXcanvas16*>* list = new std::vector<GFXcanvas16*>();
+  return *list;
+}
+
+/**
+ * Description: Blank the simulated display (called by simReset()).
+ * Inputs: None.
+ * Outputs: No frames, no text, no pixels.
+ */
+void simDisplayReset() {
+  display() = SimDisplay();
+}
+
+// ---------------- GFXcanvas16 ----------------
+
+GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h)
+    : _width(w), _height(h), _buffer((size_t)w * h, 0) {
+  canvases().push_back(this);
+}
+
+void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= (int16_t)_width || y >= (int16_t)_height) return;
+  _buffer[(size_t)y * _width + x] = color;
+}
+
+void GFXcanvas16::fillScreen(uint16_t color) {
+  std::fill(_buffer.begin(), _buffer.end(), color);
+}
+
+void GFXcanvas16::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t j = y; j < y + h; j++) {
+    drawFastHLine(x, j, w, color);
+  }
+}
+
+void GFXcanvas16::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = x; i < x + w; i++) {
+    drawPixel(i, y, color);
+  }
+}
+
+void GFXcanvas16::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t j = y; j < y + h; j++) {
+    drawPixel(x, j, color);
+  }
+}
+
+void GFXcanvas16::setCursor(int16_t x, int16_t y) {
+  // A cursor move ends the text run in progress.
+  if (!_line.empty()) {
+    _lines.push_back(_line);
+    _line.clear();
+  }
+  _cursorX = x;
+  _cursorY = y;
+}
+
+/**
+ * Description: Draw the placeholder glyph for a character at the cursor.
+ * Inputs:
+ * - c: character.
+ * Outputs: Fills the 6x8 cell (scaled) with a pattern unique to c.
+ */
+void GFXcanvas16::drawGlyph(uint8_t c) {
+  const int16_t s = _textSize;
+  if (_textBackground != _textColor) {
+    fillRect(_cursorX, _cursorY, (int16_t)(6 * s), (int16_t)(8 * s), _textBackground);
+  }
+  if (c == ' ') {
+    return;
+  }
+  // 5x7 pattern from a hash of the code, so different characters differ.
+  uint64_t bits = (uint64_t)c * 0x9E3779B97F4A7C15ull;
+  bits ^= bits >> 29;
+  for (int16_t row = 0; row < 7; row++) {
+    for (int16_t col = 0; col < 5; col++) {
+      if ((bits >> (row * 5 + col)) & 1u) {
+        fillRect((int16_t)(_cursorX + col * s), (int16_t)(_cursorY + row * s), s, s, _textColor);
+      }
+    }
+  }
+}
+
+size_t GFXcanvas16::write(uint8_t c) {
+  if (c == '\n') {
+    _lines.push_back(_line);
+    _line.clear();
+    _cursorX = 0;
+    _cursorY = (int16_t)(_cursorY + 8 * _textSize);
+  } else if (c != '\r') {
+    drawGlyph(c);
+    _line += (char)c;
+    _cursorX = (int16_t)(_cursorX + 6 * _textSize);
+  }
+  return 1;
+}
+
+/**
+ * Description: Move the text printed since the last call out of the canvas.
+ * Inputs: None.
+ * Outputs: Returns one string per line; the canvas starts a new frame's text.
+ */
+std::vector<std::string> GFXcanvas16::takeText() {
+  if (!_line.empty()) {
+    _lines.push_back(_line);
+    _line.clear();
+  }
+  std::vector<std::string> out;
+  out.swap(_lines);
+  return out;
+}
+
+// ---------------- ILI9341_T4 driver ----------------
+
+namespace ILI9341_T4 {
+
+bool ILI9341Driver::begin(uint32_t spiClock) {
+  (void)spiClock;
+  return true;
+}
+
+void ILI9341Driver::update(const uint16_t* fb, bool force) {
+  SimDisplay& d = display();
+  if (d.frames == 0) d.firstFrameNs = simNowNs();
+  d.frames++;
+  GFXcanvas16* source = nullptr;
+  for (GFXcanvas16* canvas : canvases()) {
+    if (canvas->getBuffer() == fb) source = canvas;
+  }
+  // Without a canvas the frame is at the panel size.
+  const int w = source ? source->width() : width();
+  const int h = source ? source->height() : height();
+  const size_t count = (size_t)w * h;
+  uint32_t changed = 0;
+  if (force || w != d.width || h != d.height || d.pixels.size() != count) {
+    changed = (uint32_t)count;
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      if (d.pixels[i] != fb[i]) changed++;
+    }
+  }
+  d.width = w;
+  d.height = h;
+  d.changedPixels = changed;
+  d.pixels.assign(fb, fb + count);
+  if (source) {
+    d.text = source->takeText();
+  } else {
+    d.text.clear();
+  }
+}
+
+StatsVar ILI9341Driver::statsFPS() const {
+  const SimDisplay& d = display();
+  const uint64_t spanNs = simNowNs() - d.firstFrameNs;
+  return StatsVar(spanNs ? (double)d.frames * 1e9 / (double)spanNs : 0.0);
+}
+
+} // namespace ILI9341_T4
+
+// ---------------- SimHal.h display access ----------------
+
+/**
+ * Description: Get the number of frames sent to the display.
+ * Inputs: None.
+ * Outputs: Returns the update() count since simReset().
+ */
+uint32_t simDisplayFrames() {
+  return display().frames;
+}
+
+/**
+ * Description: Get the text drawn into the last frame.
+ * Inputs: None.
+ * Outputs: Returns one string per printed line.
+ */
+const std::vector<std::string>& simDisplayText() {
+  return display().text;
+}
+
+/**
+ * Description: Get how much of the last frame changed.
+ * Inputs: None.
+ * Outputs: Returns the pixels that differ from the previous frame (what a diff-updating driver sends).
+ */
+uint32_t simDisplayChangedPixels() {
+  return display().changedPixels;
+}
+
+/**
+ * Description: Get the last frame's pixels.
+ * Inputs:
+ * - width, height: receive the frame size.
+ * Outputs: Returns RGB565 pixels (text is drawn as placeholder glyphs, not a real font).
+ */
+const uint16_t* simDisplayPixels(int& width, int& height) {
+  width = display().width;
+  height = display().height;
+  return display().pixels.data();
+}
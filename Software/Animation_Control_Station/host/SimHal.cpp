@@ -0,0 +1,794 @@
+#include "SimHal.h"
+#include <EEPROM.h>
+#include <SD.h>
+#include <SPI.h>
+#include <SparkFunSX1509.h>
+#include <Wire.h>
+
+#include <stdarg.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Display state lives with the canvas and driver in SimDisplay.cpp.
+void simDisplayReset();
+
+static constexpr uint8_t SIM_TIMER_COUNT = 4;
+static constexpr uint8_t SIM_SX1509_ADDRESS = 0x3E;
+static constexpr uint32_t UART_BITS_PER_BYTE = 10; // 8N1
+
+struct SimPin {
+  uint8_t level = LOW;
+  uint8_t mode = INPUT;
+  bool driven = false;      // level set by the simulation, not by a pull resistor
+  void (*isr)() = nullptr;
+  int isrMode = 0;
+  float analog = 0.0f;
+};
+
+struct SimTimer {
+  void (*handler)() = nullptr;
+  uint64_t periodNs = 0;
+  uint64_t nextNs = 0;
+};
+
+struct SimUart {
+  uint32_t baud = 0;
+  size_t extraTx = 0;          // addMemoryForWrite() bytes
+  std::deque<uint8_t> rx;
+  std::deque<uint8_t> tx;      // written, not yet on the wire
+  std::vector<uint8_t> wire;   // on the wire, not yet taken by the simulation
+  uint64_t drainedNs = 0;      // time the wire accounting has reached
+  bool loopback = false;
+};
+
+struct SimState {
+  SimClockMode clockMode = SimClockMode::Virtual;
+  uint64_t virtualNs = 0;
+  uint32_t clockReadNs = SIM_CLOCK_READ_NS;
+  std::chrono::steady_clock::time_point realStart = std::chrono::steady_clock::now();
+  bool inIsr = false;
+  SimPin pins[SIM_PIN_COUNT];
+  unsigned adcBits = 10;
+  SimTimer timers[SIM_TIMER_COUNT];
+  SimUart uarts[SIM_UART_COUNT];
+  std::deque<uint8_t> usbRx;
+  bool usbEcho = true;
+  uint64_t usbTxBytes = 0;
+  bool i2cPresent[128] = {};
+  uint8_t sxLevel[SIM_SX1509_PINS] = {};
+  uint8_t sxPwm[SIM_SX1509_PINS] = {};
+  std::string sdRoot;
+  bool sdPresent = false;
+  uint8_t eeprom[SIM_EEPROM_BYTES] = {};
+};
+
+/**
+ * Description: Get the simulation state (created on first use, so firmware globals may touch it).
+ * Inputs: None.
+ * Outputs: Returns the process-wide state.
+ */
+static SimState& sim() {
+  static SimState* state = new SimState();
+  return *state;
+}
+
+usb_serial_class Serial;
+HardwareSerial Serial1(1), Serial2(2), Serial3(3), Serial4(4), Serial5(5), Serial6(6), Serial7(7), Serial8(8);
+TwoWire Wire;
+SPIClass SPI;
+EEPROMClass EEPROM;
+SDClass SD;
+
+// ---------------- Clock ----------------
+
+/**
+ * Description: Read the simulated clock without advancing it.
+ * Inputs: None.
+ * Outputs: Returns nanoseconds since simReset().
+ */
+uint64_t simNowNs() {
+  SimState& s = sim();
+  if (s.clockMode == SimClockMode::RealTime) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - s.realStart).count();
+  }
+  return s.virtualNs;
+}
+
+/**
+ * Description: Run interval timer handlers that are due.
+ * Inputs: None.
+ * Outputs: Calls each due handler once per elapsed period, outside any other handler.
+ */
+static void serviceTimers() {
+  SimState& s = sim();
+  if (s.inIsr) {
+    return;
+  }
+  for (uint8_t i = 0; i < SIM_TIMER_COUNT; i++) {
+    SimTimer& t = s.timers[i];
+    while (t.handler && simNowNs() >= t.nextNs) {
+      t.nextNs += t.periodNs;
+      s.inIsr = true;
+      t.handler();
+      s.inIsr = false;
+    }
+  }
+}
+
+/**
+ * Description: Move virtual time forward (no effect in real-time mode).
+ * Inputs:
+ * - us: microseconds to advance.
+ * Outputs: UART transmitters drain for the elapsed time on their next use.
+ */
+void simAdvanceUs(uint32_t us) {
+  SimState& s = sim();
+  if (s.clockMode == SimClockMode::Virtual) {
+    s.virtualNs += (uint64_t)us * 1000u;
+  }
+  serviceTimers();
+}
+
+/**
+ * Description: Move virtual time forward to an absolute time (no effect in real-time mode).
+ * Inputs:
+ * - ns: target time in nanoseconds since simReset().
+ * Outputs: The clock is at ns, or unchanged if it is already later.
+ */
+void simAdvanceToNs(uint64_t ns) {
+  SimState& s = sim();
+  if (s.clockMode == SimClockMode::Virtual && ns > s.virtualNs) {
+    s.virtualNs = ns;
+  }
+  serviceTimers();
+}
+
+/**
+ * Description: Set how much virtual time each clock read costs.
+ * Inputs:
+ * - ns: nanoseconds per micros()/millis() call (SIM_CLOCK_READ_NS after simReset()).
+ * Outputs: Later reads advance the virtual clock by ns.
+ */
+void simSetClockReadNs(uint32_t ns) {
+  sim().clockReadNs = ns;
+}
+
+/**
+ * Description: Select how the clock advances.
+ * Inputs:
+ * - mode: virtual (deterministic) or host real time.
+ * Outputs: Later clock reads use the mode; virtual time continues from its current value.
+ */
+void simSetClockMode(SimClockMode mode) {
+  SimState& s = sim();
+  if (mode == s.clockMode) {
+    return;
+  }
+  const uint64_t nowNs = simNowNs();
+  s.clockMode = mode;
+  if (mode == SimClockMode::RealTime) {
+    s.realStart = std::chrono::steady_clock::now() - std::chrono::nanoseconds(nowNs);
+  } else {
+    s.virtualNs = nowNs;
+  }
+}
+
+/**
+ * Description: Advance virtual time by one clock read and run due timers.
+ * Inputs: None.
+ * Outputs: Returns the clock after the read.
+ */
+static uint64_t clockRead() {
+  SimState& s = sim();
+  if (s.clockMode == SimClockMode::Virtual) {
+    s.virtualNs += s.clockReadNs;
+  }
+  serviceTimers();
+  return simNowNs();
+}
+
+uint32_t micros() { return (uint32_t)(clockRead() / 1000u); }
+uint32_t millis() { return (uint32_t)(clockRead() / 1000000u); }
+
+void delayMicroseconds(uint32_t us) {
+  if (sim().clockMode == SimClockMode::RealTime) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    serviceTimers();
+    return;
+  }
+  simAdvanceUs(us);
+}
+
+void delay(uint32_t ms) {
+  delayMicroseconds(ms * 1000u);
+}
+
+void yield() {
+  serviceTimers();
+}
+
+uint32_t simCycleCount() {
+  const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)(ns * (F_CPU_ACTUAL / 1000000u) / 1000u);
+}
+
+bool IntervalTimer::begin(void (*handler)(), uint32_t periodUs) {
+  SimState& s = sim();
+  end();
+  for (uint8_t i = 0; i < SIM_TIMER_COUNT; i++) {
+    if (!s.timers[i].handler) {
+      s.timers[i].handler = handler;
+      s.timers[i].periodNs = (uint64_t)(periodUs ? periodUs : 1) * 1000u;
+      s.timers[i].nextNs = simNowNs() + s.timers[i].periodNs;
+      _slot = (int8_t)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void IntervalTimer::end() {
+  if (_slot >= 0) {
+    sim().timers[_slot].handler = nullptr;
+    _slot = -1;
+  }
+}
+
+// ---------------- GPIO and ADC ----------------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= SIM_PIN_COUNT) return;
+  SimPin& p = sim().pins[pin];
+  p.mode = mode;
+  if (!p.driven && mode == INPUT_PULLUP) p.level = HIGH;
+  if (!p.driven && mode == INPUT_PULLDOWN) p.level = LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < SIM_PIN_COUNT ? sim().pins[pin].level : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_PIN_COUNT) return;
+  sim().pins[pin].level = level ? HIGH : LOW;
+}
+
+void attachInterrupt(int irq, void (*handler)(), int mode) {
+  if (irq < 0 || irq >= SIM_PIN_COUNT) return;
+  sim().pins[irq].isr = handler;
+  sim().pins[irq].isrMode = mode;
+}
+
+void detachInterrupt(int irq) {
+  if (irq < 0 || irq >= SIM_PIN_COUNT) return;
+  sim().pins[irq].isr = nullptr;
+}
+
+int analogRead(uint8_t pin) {
+  if (pin >= SIM_PIN_COUNT) return 0;
+  const float fullScale = (float)((1u << sim().adcBits) - 1u);
+  return (int)lroundf(sim().pins[pin].analog * fullScale);
+}
+
+void analogReadResolution(unsigned int bits) {
+  sim().adcBits = (bits >= 1 && bits <= 16) ? bits : 10;
+}
+
+/**
+ * Description: Drive a GPIO pin from outside (button, encoder, e-stop input).
+ * Inputs:
+ * - pin: Teensy pin number.
+ * - level: LOW or HIGH.
+ * Outputs: Runs the attached ISR when the change matches its edge.
+ */
+void simSetPin(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_PIN_COUNT) return;
+  SimState& s = sim();
+  SimPin& p = s.pins[pin];
+  const uint8_t old = p.level;
+  p.level = level ? HIGH : LOW;
+  p.driven = true;
+  if (!p.isr || old == p.level) {
+    return;
+  }
+  const bool fire = p.isrMode == CHANGE ||
+                    (p.isrMode == RISING && p.level == HIGH) ||
+                    (p.isrMode == FALLING && p.level == LOW);
+  if (fire) {
+    const bool nested = s.inIsr;
+    s.inIsr = true;
+    p.isr();
+    s.inIsr = nested;
+  }
+}
+
+/**
+ * Description: Read a GPIO pin level.
+ * Inputs:
+ * - pin: Teensy pin number.
+ * Outputs: Returns the level the firmware would read (or last wrote).
+ */
+uint8_t simPinLevel(uint8_t pin) {
+  return pin < SIM_PIN_COUNT ? sim().pins[pin].level : LOW;
+}
+
+/**
+ * Description: Set an analog input.
+ * Inputs:
+ * - pin: analog pin (A16/A17 for the pots).
+ * - norm: 0.0..1.0 of full scale.
+ * Outputs: analogRead() returns it at the configured resolution.
+ */
+void simSetAnalog(uint8_t pin, float norm) {
+  if (pin >= SIM_PIN_COUNT) return;
+  sim().pins[pin].analog = norm < 0.0f ? 0.0f : (norm > 1.0f ? 1.0f : norm);
+}
+
+/**
+ * Description: Turn a quadrature encoder by a number of transitions.
+ * Inputs:
+ * - pinA, pinB: encoder pins.
+ * - steps: transitions; positive is the direction the firmware counts up.
+ * Outputs: Drives the pins through the Gray sequence, one ISR per transition.
+ */
+void simStepEncoder(uint8_t pinA, uint8_t pinB, int32_t steps) {
+  // A:B states in counting-up order.
+  static constexpr uint8_t GRAY[4] = {0, 1, 3, 2};
+  uint8_t state = (uint8_t)((simPinLevel(pinA) ? 2 : 0) | (simPinLevel(pinB) ? 1 : 0));
+  uint8_t at = 0;
+  while (GRAY[at] != state) at++;
+  const int8_t dir = steps >= 0 ? 1 : -1;
+  for (int32_t i = 0; i != steps; i += dir) {
+    at = (uint8_t)((at + 4 + dir) & 3);
+    const uint8_t next = GRAY[at];
+    if ((next ^ state) & 2) simSetPin(pinA, (next & 2) ? HIGH : LOW);
+    if ((next ^ state) & 1) simSetPin(pinB, (next & 1) ? HIGH : LOW);
+    state = next;
+  }
+}
+
+// ---------------- USB serial ----------------
+
+int usb_serial_class::available() { return (int)sim().usbRx.size(); }
+
+int usb_serial_class::read() {
+  std::deque<uint8_t>& rx = sim().usbRx;
+  if (rx.empty()) return -1;
+  const uint8_t b = rx.front();
+  rx.pop_front();
+  return b;
+}
+
+int usb_serial_class::peek() {
+  const std::deque<uint8_t>& rx = sim().usbRx;
+  return rx.empty() ? -1 : rx.front();
+}
+
+size_t usb_serial_class::write(uint8_t b) {
+  return write(&b, 1);
+}
+
+size_t usb_serial_class::write(const uint8_t* buf, size_t len) {
+  sim().usbTxBytes += len;
+  return sim().usbEcho ? fwrite(buf, 1, len, stdout) : len;
+}
+
+int usb_serial_class::availableForWrite() { return 4096; }
+
+void usb_serial_class::flush() { fflush(stdout); }
+
+/**
+ * Description: Queue bytes as if typed into the USB serial monitor.
+ * Inputs:
+ * - text: characters (include '\n' to end a console line).
+ * Outputs: Serial.read() returns them in order.
+ */
+void simUsbInput(const char* text) {
+  while (*text) {
+    sim().usbRx.push_back((uint8_t)*text++);
+  }
+}
+
+/**
+ * Description: Choose whether USB serial output is echoed to stdout.
+ * Inputs:
+ * - on: false to count and discard the output (benchmarks).
+ * Outputs: Later Serial writes go to stdout or are only counted.
+ */
+void simUsbSetEcho(bool on) {
+  sim().usbEcho = on;
+}
+
+/**
+ * Description: Get the number of bytes written to USB serial.
+ * Inputs: None.
+ * Outputs: Returns bytes since simReset(), echoed or not.
+ */
+uint64_t simUsbTxBytes() {
+  return sim().usbTxBytes;
+}
+
+int Print::printf(const char* fmt, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, fmt);
+  const int n = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (n <= 0) return n;
+  const size_t len = (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1;
+  return (int)write((const uint8_t*)buf, len);
+}
+
+// ---------------- Hardware UARTs ----------------
+
+/**
+ * Description: Get a UART by port number.
+ * Inputs:
+ * - port: 1..8.
+ * Outputs: Returns the UART state (port 1 for out-of-range numbers).
+ */
+static SimUart& uart(uint8_t port) {
+  return sim().uarts[(port >= 1 && port <= SIM_UART_COUNT) ? port - 1 : 0];
+}
+
+/**
+ * Description: Get the time one byte takes on the wire.
+ * Inputs:
+ * - u: UART.
+ * Outputs: Returns nanoseconds per byte (0 before begin()).
+ */
+static uint64_t byteNs(const SimUart& u) {
+  return u.baud ? (uint64_t)UART_BITS_PER_BYTE * 1000000000ull / u.baud : 0;
+}
+
+/**
+ * Description: Move the bytes that finished transmitting onto the wire.
+ * Inputs:
+ * - u: UART.
+ * Outputs: Drains tx by elapsed time; looped-back bytes reach rx.
+ */
+static void drain(SimUart& u) {
+  const uint64_t nowNs = simNowNs();
+  const uint64_t perByte = byteNs(u);
+  while (!u.tx.empty() && (perByte == 0 || u.drainedNs + perByte <= nowNs)) {
+    const uint8_t b = u.tx.front();
+    u.tx.pop_front();
+    u.wire.push_back(b);
+    if (u.loopback) u.rx.push_back(b);
+    u.drainedNs += perByte;
+  }
+  if (u.tx.empty()) {
+    u.drainedNs = nowNs;
+  }
+}
+
+void HardwareSerial::begin(uint32_t baud, uint16_t format) {
+  (void)format;
+  SimUart& u = uart(_index);
+  drain(u);
+  u.baud = baud;
+}
+
+void HardwareSerial::end() {
+  SimUart& u = uart(_index);
+  u.baud = 0;
+  u.tx.clear();
+}
+
+int HardwareSerial::available() {
+  SimUart& u = uart(_index);
+  drain(u);
+  return (int)u.rx.size();
+}
+
+int HardwareSerial::read() {
+  SimUart& u = uart(_index);
+  drain(u);
+  if (u.rx.empty()) return -1;
+  const uint8_t b = u.rx.front();
+  u.rx.pop_front();
+  return b;
+}
+
+int HardwareSerial::peek() {
+  SimUart& u = uart(_index);
+  drain(u);
+  return u.rx.empty() ? -1 : u.rx.front();
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+  return write(&b, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len) {
+  SimUart& u = uart(_index);
+  const size_t capacity = SIM_UART_FIFO_BYTES + u.extraTx;
+  for (size_t i = 0; i < len; i++) {
+    drain(u);
+    // A full buffer blocks the writer, as on the Teensy, until a byte leaves.
+    while (u.tx.size() >= capacity) {
+      if (sim().clockMode == SimClockMode::Virtual) {
+        sim().virtualNs = u.drainedNs + byteNs(u);
+      }
+      drain(u);
+    }
+    if (u.tx.empty()) u.drainedNs = simNowNs();
+    u.tx.push_back(buf[i]);
+  }
+  drain(u);
+  return len;
+}
+
+int HardwareSerial::availableForWrite() {
+  SimUart& u = uart(_index);
+  drain(u);
+  const size_t capacity = SIM_UART_FIFO_BYTES + u.extraTx;
+  return (int)(capacity - u.tx.size());
+}
+
+void HardwareSerial::flush() {
+  SimUart& u = uart(_index);
+  drain(u);
+  if (u.tx.empty()) return;
+  if (sim().clockMode == SimClockMode::Virtual) {
+    sim().virtualNs = u.drainedNs + byteNs(u) * u.tx.size();
+  }
+  while (!u.tx.empty()) drain(u);
+}
+
+void HardwareSerial::clear() {
+  uart(_index).rx.clear();
+}
+
+void HardwareSerial::addMemoryForWrite(void* buffer, size_t size) {
+  (void)buffer;
+  uart(_index).extraTx = size;
+}
+
+void HardwareSerial::addMemoryForRead(void* buffer, size_t size) {
+  (void)buffer;
+  (void)size;
+}
+
+/**
+ * Description: Deliver bytes to a UART's receiver.
+ * Inputs:
+ * - port: 1..8 (Serial1..Serial8).
+ * - data, len: received bytes.
+ * Outputs: Serial<port>.read() returns them in order.
+ */
+void simUartInject(uint8_t port, const uint8_t* data, size_t len) {
+  SimUart& u = uart(port);
+  u.rx.insert(u.rx.end(), data, data + len);
+}
+
+/**
+ * Description: Take the bytes a UART has finished transmitting.
+ * Inputs:
+ * - port: 1..8.
+ * Outputs: Returns bytes that left the TX pin since the last call (at the port's baud rate).
+ */
+std::vector<uint8_t> simUartTakeTx(uint8_t port) {
+  SimUart& u = uart(port);
+  drain(u);
+  std::vector<uint8_t> out;
+  out.swap(u.wire);
+  return out;
+}
+
+/**
+ * Description: Wire a UART's TX back to its RX (a loopback jumper).
+ * Inputs:
+ * - port: 1..8.
+ * - on: true to loop transmitted bytes back.
+ * Outputs: Later transmitted bytes also arrive on the receiver.
+ */
+void simUartSetLoopback(uint8_t port, bool on) {
+  SimUart& u = uart(port);
+  drain(u);
+  u.loopback = on;
+}
+
+/**
+ * Description: Get a UART's configured baud rate.
+ * Inputs:
+ * - port: 1..8.
+ * Outputs: Returns the rate from the last begin() (0 if never started).
+ */
+uint32_t simUartBaud(uint8_t port) {
+  return uart(port).baud;
+}
+
+// ---------------- I2C and the SX1509 ----------------
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  return sim().i2cPresent[_address & 0x7F] ? 0 : 2; // 2 = address NACK
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t count) {
+  return sim().i2cPresent[address & 0x7F] ? count : 0;
+}
+
+/**
+ * Description: Connect or remove an I2C device.
+ * Inputs:
+ * - address: 7-bit address.
+ * - present: true if the device answers.
+ * Outputs: Wire transactions to the address succeed or fail (the SX1509 is at 0x3E).
+ */
+void simI2cSetPresent(uint8_t address, bool present) {
+  sim().i2cPresent[address & 0x7F] = present;
+}
+
+uint8_t SX1509::begin(uint8_t address, TwoWire& wire, uint8_t resetPin) {
+  (void)resetPin;
+  wire.beginTransmission(address);
+  return wire.endTransmission() == 0 ? 1 : 0;
+}
+
+void SX1509::pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void SX1509::digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < SIM_SX1509_PINS) sim().sxLevel[pin] = level ? HIGH : LOW;
+}
+
+uint8_t SX1509::digitalRead(uint8_t pin) {
+  return pin < SIM_SX1509_PINS ? sim().sxLevel[pin] : HIGH;
+}
+
+void SX1509::ledDriverInit(uint8_t pin, uint8_t freq, bool log) {
+  (void)freq;
+  (void)log;
+  if (pin < SIM_SX1509_PINS) sim().sxPwm[pin] = 0;
+}
+
+void SX1509::analogWrite(uint8_t pin, uint8_t iOn) {
+  if (pin < SIM_SX1509_PINS) sim().sxPwm[pin] = iOn;
+}
+
+/**
+ * Description: Drive an SX1509 expander pin (buttons pull to LOW when pressed).
+ * Inputs:
+ * - pin: expander pin 0..15.
+ * - level: LOW or HIGH.
+ * Outputs: SX1509::digitalRead() returns it.
+ */
+void simSx1509SetPin(uint8_t pin, uint8_t level) {
+  if (pin < SIM_SX1509_PINS) sim().sxLevel[pin] = level ? HIGH : LOW;
+}
+
+/**
+ * Description: Read an SX1509 LED driver output.
+ * Inputs:
+ * - pin: expander pin 0..15.
+ * Outputs: Returns the last analogWrite() value (255 = off with the inverting driver).
+ */
+uint8_t simSx1509Pwm(uint8_t pin) {
+  return pin < SIM_SX1509_PINS ? sim().sxPwm[pin] : 0;
+}
+
+// ---------------- EEPROM and SD ----------------
+
+/**
+ * Description: Access the emulated EEPROM contents.
+ * Inputs: None.
+ * Outputs: Returns SIM_EEPROM_BYTES bytes (0xFF after simReset(), like an erased part).
+ */
+uint8_t* simEeprom() {
+  return sim().eeprom;
+}
+
+/**
+ * Description: Point the simulated SD card at a host directory.
+ * Inputs:
+ * - dir: directory that stands in for the card root (nullptr = no card).
+ * Outputs: SD.begin() fails without a card; paths are resolved under dir.
+ */
+void simSetSdRoot(const char* dir) {
+  sim().sdPresent = dir != nullptr;
+  sim().sdRoot = dir ? dir : "";
+}
+
+/**
+ * Description: Map a card path to a host path.
+ * Inputs:
+ * - path: card path ("/shows/a.shw" or "a.shw").
+ * Outputs: Returns the path under the SD root.
+ */
+static std::string sdPath(const char* path) {
+  std::string out = sim().sdRoot;
+  if (path[0] != '/') out += '/';
+  return out + path;
+}
+
+bool SDClass::begin(uint8_t csPin) {
+  (void)csPin;
+  return sim().sdPresent;
+}
+
+File SDClass::open(const char* path, uint8_t mode) {
+  if (!sim().sdPresent) return File();
+  const std::string host = sdPath(path);
+  if (mode == FILE_READ) {
+    return File(fopen(host.c_str(), "rb"));
+  }
+  // FILE_WRITE creates the file and appends, like O_CREAT | O_AT_END.
+  FILE* f = fopen(host.c_str(), "r+b");
+  if (!f) f = fopen(host.c_str(), "w+b");
+  if (f) fseek(f, 0, SEEK_END);
+  return File(f);
+}
+
+bool SDClass::exists(const char* path) {
+  if (!sim().sdPresent) return false;
+  FILE* f = fopen(sdPath(path).c_str(), "rb");
+  if (f) fclose(f);
+  return f != nullptr;
+}
+
+bool SDClass::remove(const char* path) {
+  if (!sim().sdPresent) return false;
+  return ::remove(sdPath(path).c_str()) == 0;
+}
+
+uint64_t File::size() {
+  if (!_f) return 0;
+  const long at = ftell(_f);
+  fseek(_f, 0, SEEK_END);
+  const long end = ftell(_f);
+  fseek(_f, at, SEEK_SET);
+  return end < 0 ? 0 : (uint64_t)end;
+}
+
+int File::read(void* buf, size_t len) {
+  return _f ? (int)fread(buf, 1, len, _f) : -1;
+}
+
+size_t File::write(const void* buf, size_t len) {
+  return _f ? fwrite(buf, 1, len, _f) : 0;
+}
+
+bool File::seek(uint64_t pos) {
+  return _f && fseek(_f, (long)pos, SEEK_SET) == 0;
+}
+
+uint64_t File::position() {
+  return _f ? (uint64_t)ftell(_f) : 0;
+}
+
+int File::available() {
+  return _f ? (int)(size() - position()) : 0;
+}
+
+void File::flush() {
+  if (_f) fflush(_f);
+}
+
+void File::close() {
+  if (_f) fclose(_f);
+  _f = nullptr;
+}
+
+// ---------------- Reset ----------------
+
+/**
+ * Description: Return every simulated peripheral to its power-on state.
+ * Inputs: None.
+ * Outputs: Clock at 0 (virtual), pins low and undriven, UARTs empty, SX1509 present at 0x3E, display blank.
+ */
+void simReset() {
+  SimState& s = sim();
+  s = SimState();
+  s.i2cPresent[SIM_SX1509_ADDRESS] = true;
+  memset(s.sxLevel, HIGH, sizeof(s.sxLevel));
+  memset(s.sxPwm, 255, sizeof(s.sxPwm));
+  memset(s.eeprom, 0xFF, sizeof(s.eeprom));
+  simDisplayReset();
+}
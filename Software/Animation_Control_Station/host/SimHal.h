@@ -0,0 +1,229 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// Simulated peripherals behind the host Arduino core (host/Arduino.h,
+// Wire.h, SparkFunSX1509.h, ILI9341_T4.h, Adafruit_GFX.h, EEPROM.h, SD.h).
+// The firmware sees the same calls it makes on the Teensy; a simulation
+// (host/sim_main.cpp, benchmarks) drives the other side through these
+// functions. Everything is single threaded: pin changes run attached ISRs
+// synchronously on the caller's stack.
+
+enum class SimClockMode : uint8_t {
+  Virtual = 0, // time moves only by simAdvanceUs()/delay() and a small step per clock read
+  RealTime     // host steady clock since simReset()
+};
+
+static constexpr uint32_t SIM_CLOCK_READ_NS = 100; // virtual time per micros()/millis() call
+static constexpr uint32_t SIM_UART_FIFO_BYTES = 64; // TX space before addMemoryForWrite()
+static constexpr uint8_t SIM_SX1509_PINS = 16;
+static constexpr int SIM_EEPROM_BYTES = 4284;       // Teensy 4.1 emulated EEPROM
+
+/**
+ * Description: Return every simulated peripheral to its power-on state.
+ * Inputs: None.
+ * Outputs: Clock at 0 (virtual), pins low and undriven, UARTs empty, SX1509 present at 0x3E, display blank.
+ */
+void simReset();
+
+/**
+ * Description: Select how the clock advances.
+ * Inputs:
+ * - mode: virtual (deterministic) or host real time.
+ * Outputs: Later clock reads use the mode; virtual time continues from its current value.
+ */
+void simSetClockMode(SimClockMode mode);
+
+/**
+ * Description: Read the simulated clock without advancing it.
+ * Inputs: None.
+ * Outputs: Returns nanoseconds since simReset().
+ */
+uint64_t simNowNs();
+
+/**
+ * Description: Move virtual time forward (no effect in real-time mode).
+ * Inputs:
+ * - us: microseconds to advance.
+ * Outputs: UART transmitters drain for the elapsed time on their next use.
+ */
+void simAdvanceUs(uint32_t us);
+
+/**
+ * Description: Move virtual time forward to an absolute time (no effect in real-time mode).
+ * Inputs:
+ * - ns: target time in nanoseconds since simReset().
+ * Outputs: The clock is at ns, or unchanged if it is already later.
+ */
+void simAdvanceToNs(uint64_t ns);
+
+/**
+ * Description: Set how much virtual time each clock read costs.
+ * Inputs:
+ * - ns: nanoseconds per micros()/millis() call (SIM_CLOCK_READ_NS after simReset()).
+ * Outputs: Later reads advance the virtual clock by ns.
+ */
+void simSetClockReadNs(uint32_t ns);
+
+/**
+ * Description: Drive a GPIO pin from outside (button, encoder, e-stop input).
+ * Inputs:
+ * - pin: Teensy pin number.
+ * - level: LOW or HIGH.
+ * Outputs: Runs the attached ISR when the change matches its edge.
+ */
+void simSetPin(uint8_t pin, uint8_t level);
+
+/**
+ * Description: Read a GPIO pin level.
+ * Inputs:
+ * - pin: Teensy pin number.
+ * Outputs: Returns the level the firmware would read (or last wrote).
+ */
+uint8_t simPinLevel(uint8_t pin);
+
+/**
+ * Description: Set an analog input.
+ * Inputs:
+ * - pin: analog pin (A16/A17 for the pots).
+ * - norm: 0.0..1.0 of full scale.
+ * Outputs: analogRead() returns it at the configured resolution.
+ */
+void simSetAnalog(uint8_t pin, float norm);
+
+/**
+ * Description: Turn a quadrature encoder by a number of transitions.
+ * Inputs:
+ * - pinA, pinB: encoder pins.
+ * - steps: transitions; positive is the direction the firmware counts up.
+ * Outputs: Drives the pins through the Gray sequence, one ISR per transition.
+ */
+void simStepEncoder(uint8_t pinA, uint8_t pinB, int32_t steps);
+
+/**
+ * Description: Queue bytes as if typed into the USB serial monitor.
+ * Inputs:
+ * - text: characters (include '\n' to end a console line).
+ * Outputs: Serial.read() returns them in order.
+ */
+void simUsbInput(const char* text);
+
+/**
+ * Description: Choose whether USB serial output is echoed to stdout.
+ * Inputs:
+ * - on: false to count and discard the output (benchmarks).
+ * Outputs: Later Serial writes go to stdout or are only counted.
+ */
+void simUsbSetEcho(bool on);
+
+/**
+ * Description: Get the number of bytes written to USB serial.
+ * Inputs: None.
+ * Outputs: Returns bytes since simReset(), echoed or not.
+ */
+uint64_t simUsbTxBytes();
+
+/**
+ * Description: Deliver bytes to a UART's receiver.
+ * Inputs:
+ * - port: 1..8 (Serial1..Serial8).
+ * - data, len: received bytes.
+ * Outputs: Serial<port>.read() returns them in order.
+ */
+void simUartInject(uint8_t port, const uint8_t* data, size_t len);
+
+/**
+ * Description: Take the bytes a UART has finished transmitting.
+ * Inputs:
+ * - port: 1..8.
+ * Outputs: Returns bytes that left the TX pin since the last call (at the port's baud rate).
+ */
+std::vector<uint8_t> simUartTakeTx(uint8_t port);
+
+/**
+ * Description: Wire a UART's TX back to its RX (a loopback jumper).
+ * Inputs:
+ * - port: 1..8.
+ * - on: true to loop transmitted bytes back.
+ * Outputs: Later transmitted bytes also arrive on the receiver.
+ */
+void simUartSetLoopback(uint8_t port, bool on);
+
+/**
+ * Description: Get a UART's configured baud rate.
+ * Inputs:
+ * - port: 1..8.
+ * Outputs: Returns the rate from the last begin() (0 if never started).
+ */
+uint32_t simUartBaud(uint8_t port);
+
+/**
+ * Description: Connect or remove an I2C device.
+ * Inputs:
+ * - address: 7-bit address.
+ * - present: true if the device answers.
+ * Outputs: Wire transactions to the address succeed or fail (the SX1509 is at 0x3E).
+ */
+void simI2cSetPresent(uint8_t address, bool present);
+
+/**
+ * Description: Drive an SX1509 expander pin (buttons pull to LOW when pressed).
+ * Inputs:
+ * - pin: expander pin 0..15.
+ * - level: LOW or HIGH.
+ * Outputs: SX1509::digitalRead() returns it.
+ */
+void simSx1509SetPin(uint8_t pin, uint8_t level);
+
+/**
+ * Description: Read an SX1509 LED driver output.
+ * Inputs:
+ * - pin: expander pin 0..15.
+ * Outputs: Returns the last analogWrite() value (255 = off with the inverting driver).
+ */
+uint8_t simSx1509Pwm(uint8_t pin);
+
+/**
+ * Description: Get the number of frames sent to the display.
+ * Inputs: None.
+ * Outputs: Returns the update() count since simReset().
+ */
+uint32_t simDisplayFrames();
+
+/**
+ * Description: Get the text drawn into the last frame.
+ * Inputs: None.
+ * Outputs: Returns one string per printed line.
+ */
+const std::vector<std::string>& simDisplayText();
+
+/**
+ * Description: Get how much of the last frame changed.
+ * Inputs: None.
+ * Outputs: Returns the pixels that differ from the previous frame (what a diff-updating driver sends).
+ */
+uint32_t simDisplayChangedPixels();
+
+/**
+ * Description: Get the last frame's pixels.
+ * Inputs:
+ * - width, height: receive the frame size.
+ * Outputs: Returns RGB565 pixels (text is drawn as placeholder glyphs, not a real font).
+ */
+const uint16_t* simDisplayPixels(int& width, int& height);
+
+/**
+ * Description: Point the simulated SD card at a host directory.
+ * Inputs:
+ * - dir: directory that stands in for the card root (nullptr = no card).
+ * Outputs: SD.begin() fails without a card; paths are resolved under dir.
+ */
+void simSetSdRoot(const char* dir);
+
+/**
+ * Description: Access the emulated EEPROM contents.
+ * Inputs: None.
+ * Outputs: Returns SIM_EEPROM_BYTES bytes (0xFF after simReset(), like an erased part).
+ */
+uint8_t* simEeprom();
@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// Simulated SX1509 I/O expander (one device). Pin levels come from
+// simSx1509SetPin(); LED driver outputs are read back with simSx1509Pwm().
+class SX1509 {
+public:
+  uint8_t begin(uint8_t address = 0x3E, TwoWire& wire = Wire, uint8_t resetPin = 0xFF);
+  void pinMode(uint8_t pin, uint8_t mode);
+  void digitalWrite(uint8_t pin, uint8_t level);
+  uint8_t digitalRead(uint8_t pin);
+  void ledDriverInit(uint8_t pin, uint8_t freq = 1, bool log = false);
+  void analogWrite(uint8_t pin, uint8_t iOn);
+  void debounceTime(uint8_t ms) { (void)ms; }
+  void debouncePin(uint8_t pin) { (void)pin; }
+};
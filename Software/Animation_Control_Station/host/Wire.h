@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+// Simulated I2C bus: a transaction succeeds when a device is present at the
+// address (simI2cSetPresent()); data bytes are not modeled.
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t hz) { (void)hz; }
+  void beginTransmission(uint8_t address) { _address = address; }
+  size_t write(uint8_t b) {
+    (void)b;
+    return 1;
+  }
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t count);
+  int available() { return 0; }
+  int read() { return -1; }
+
+private:
+  uint8_t _address = 0;
+};
+extern TwoWire Wire;
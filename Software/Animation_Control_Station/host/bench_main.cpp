@@ -0,0 +1,456 @@
+// acs_bench: host benchmarks for the controller's hot paths, built from the
+// same sources as the firmware (CMakeLists.txt). Prints one CSV row per
+// metric; with --baseline it also compares each metric to the stored
+// baseline and exits 1 if any is worse by more than its threshold, which
+// is what the "bench" build target runs.
+//
+//   acs_bench [--baseline FILE] [--update FILE] [--batches N]
+//
+// Every metric is "lower is better". Times are the best batch of N (the
+// least disturbed by the host), in nanoseconds per operation; byte counts
+// are deterministic.
+#include "SimHal.h"
+#include "BoardPins.h"
+#include "Console.h"
+#include "ConsoleTx.h"
+#include "EncoderJog.h"
+#include "Log.h"
+#include "RoboClaw.h"
+#include "Show.h"
+#include "ShowEngine.h"
+#include "ShowWriter.h"
+#include "TrackBuilder.h"
+#include "Ui.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t DEFAULT_BATCHES = 15;
+static constexpr uint32_t TOKENIZE_OPS = 20000;
+static constexpr uint32_t ENCODER_OPS = 200000;
+static constexpr uint32_t EVALUATE_TICKS = 2000;
+static constexpr uint32_t EVALUATE_TICK_US = 500;          // control task period
+static constexpr uint32_t SHOW_LENGTH_MS = 600000;         // 10 minutes
+static constexpr uint32_t SHOW_KEY_SPACING_MS = 250;
+static constexpr uint32_t CRC_OPS = 20000;
+static constexpr uint32_t UI_FRAMES = 50;
+static constexpr uint32_t LOG_CALLS = 128;                 // per batch; under LOG_RING_RECORDS
+static constexpr float DEFAULT_THRESHOLD_PCT = 25.0f;
+
+struct BenchResult {
+  std::string name;
+  double value = 0.0;
+  const char* unit = "";
+};
+
+struct BenchBaseline {
+  std::string name;
+  double value = 0.0;
+  float thresholdPct = DEFAULT_THRESHOLD_PCT;
+};
+
+/**
+ * Description: Read the host clock.
+ * Inputs: None.
+ * Outputs: Returns steady-clock nanoseconds.
+ */
+static uint64_t hostNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Description: Time a batch function several times and keep the best batch.
+ * Inputs:
+ * - batches: number of batches.
+ * - ops: operations per batch.
+ * - batch: runs ops operations.
+ * - between: optional untimed work after each batch (nullptr for none).
+ * Outputs: Returns nanoseconds per operation of the fastest batch.
+ */
+template <typename Batch, typename Between>
+static double bestNsPerOp(uint32_t batches, uint32_t ops, Batch batch, Between between) {
+  uint64_t best = UINT64_MAX;
+  for (uint32_t b = 0; b < batches; b++) {
+    const uint64_t t0 = hostNs();
+    batch();
+    const uint64_t ns = hostNs() - t0;
+    if (ns < best) best = ns;
+    between();
+  }
+  return (double)best / (double)ops;
+}
+
+template <typename Batch>
+static double bestNsPerOp(uint32_t batches, uint32_t ops, Batch batch) {
+  return bestNsPerOp(batches, ops, batch, [] {});
+}
+
+/**
+ * Description: Console tokenizer on typical command lines.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the result.
+ * Outputs: Appends console.tokenize_ns.
+ */
+static void benchConsole(uint32_t batches, std::vector<BenchResult>& out) {
+  static const char* const LINES[] = {
+    "tasks",
+    "xform 3 clamp -120.5 840.25",
+    "limits 2 -1000 1000 4000 20000 80000",
+    "rec 5 jog 2.5",
+  };
+  static constexpr uint32_t LINE_COUNT = sizeof(LINES) / sizeof(LINES[0]);
+  Console console;
+  CommandMsg msg;
+  volatile uint32_t sink = 0;
+  const double ns = bestNsPerOp(batches, TOKENIZE_OPS, [&] {
+    for (uint32_t i = 0; i < TOKENIZE_OPS; i++) {
+      console.tokenizeLine(LINES[i % LINE_COUNT], msg);
+      sink = sink + msg.argc;
+    }
+  });
+  out.push_back({"console.tokenize_ns", ns, "ns/line"});
+}
+
+/**
+ * Description: Quadrature decode, driven through the encoder pin interrupts.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the result.
+ * Outputs: Appends encoder.decode_ns (includes the simulated pin change).
+ */
+static void benchEncoder(uint32_t batches, std::vector<BenchResult>& out) {
+  EncoderJog encoder;
+  encoder.begin(PIN_ENC_A, PIN_ENC_B);
+  encoder.consumeDelta();
+  const double ns = bestNsPerOp(batches, ENCODER_OPS, [&] {
+    simStepEncoder(PIN_ENC_A, PIN_ENC_B, (int32_t)ENCODER_OPS);
+  });
+  if (encoder.consumeDelta() != (int32_t)(ENCODER_OPS * batches)) {
+    fprintf(stderr, "bench: encoder decode lost transitions\n");
+  }
+  out.push_back({"encoder.decode_ns", ns, "ns/transition"});
+}
+
+/**
+ * Description: Show evaluation for a 16-channel, 10-minute show at the control tick rate.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the result.
+ * Outputs: Appends show.evaluate_ns (per channel per tick).
+ */
+static void benchShow(uint32_t batches, std::vector<BenchResult>& out) {
+  static constexpr uint32_t KEYS = SHOW_LENGTH_MS / SHOW_KEY_SPACING_MS + 1;
+  std::vector<TrackKey> keys[SHOW_MAX_CHANNELS];
+  std::vector<TrackCheckpoint> checkpoints[SHOW_MAX_CHANNELS];
+  ShowWriterTrack tracks[SHOW_MAX_CHANNELS];
+  uint32_t rng = 12345u;
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    keys[ch].resize(KEYS);
+    checkpoints[ch].resize(Track::checkpointsFor(KEYS));
+    TrackBuilder builder;
+    builder.begin(keys[ch].data(), KEYS, checkpoints[ch].data(), (uint32_t)checkpoints[ch].size());
+    int32_t value = 0;
+    for (uint32_t k = 0; k < KEYS; k++) {
+      rng = rng * 1664525u + 1013904223u;
+      value += (int32_t)(rng >> 22) - 512;
+      builder.append(k * SHOW_KEY_SPACING_MS, value, (k & 1) ? Ease::Smooth : Ease::Linear);
+    }
+    tracks[ch].keys = keys[ch].data();
+    tracks[ch].keyCount = builder.keyCount();
+    tracks[ch].checkpoints = checkpoints[ch].data();
+    tracks[ch].checkpointCount = builder.checkpointCount();
+  }
+  const size_t size = ShowWriter::imageSize(tracks, SHOW_MAX_CHANNELS, 0);
+  std::vector<uint32_t> image((size + 3) / 4);
+  const size_t written = ShowWriter::write((uint8_t*)image.data(), image.size() * 4, tracks,
+                                           SHOW_MAX_CHANNELS, SHOW_LENGTH_MS, nullptr, 0);
+  Show show;
+  if (written == 0 || !show.load((const uint8_t*)image.data(), written)) {
+    fprintf(stderr, "bench: synthetic show did not load\n");
+    return;
+  }
+
+  static ChannelLimits limits[SHOW_MAX_CHANNELS];
+  ShowEngine engine;
+  engine.begin();
+  engine.setChannelLimits(limits);
+  engine.setShow(&show);
+  engine.setPlaying(true);
+  volatile float sink = 0.0f;
+  const double ns = bestNsPerOp(batches, EVALUATE_TICKS * SHOW_MAX_CHANNELS, [&] {
+    for (uint32_t i = 0; i < EVALUATE_TICKS; i++) {
+      simAdvanceUs(EVALUATE_TICK_US);
+      engine.update();
+      engine.evaluate();
+      sink = sink + engine.setpoint(0).pos;
+    }
+  });
+  out.push_back({"show.evaluate_ns", ns, "ns/channel"});
+}
+
+/**
+ * Description: RoboClaw CRC16 and frame building/checking.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the results.
+ * Outputs: Appends roboclaw.crc16_ns, roboclaw.frame_ns and roboclaw.reply_ns.
+ */
+static void benchRoboClaw(uint32_t batches, std::vector<BenchResult>& out) {
+  uint8_t frame[RoboClaw::MAX_FRAME_BYTES];
+  RoboClawMove m1, m2;
+  m1.accel = m2.accel = 20000;
+  m1.speed = m2.speed = 4000;
+  m1.deccel = m2.deccel = 20000;
+  volatile uint32_t sink = 0;
+
+  const double frameNs = bestNsPerOp(batches, CRC_OPS, [&] {
+    for (uint32_t i = 0; i < CRC_OPS; i++) {
+      m1.position = (int32_t)i;
+      m2.position = -(int32_t)i;
+      sink = sink + (uint32_t)RoboClaw::buildMixedPosition(frame, ROBOCLAW_DEFAULT_ADDRESS, m1, m2, true);
+    }
+  });
+  const double crcNs = bestNsPerOp(batches, CRC_OPS * RoboClaw::MIXED_POSITION_FRAME_BYTES, [&] {
+    for (uint32_t i = 0; i < CRC_OPS; i++) {
+      frame[2] = (uint8_t)i;
+      sink = sink + RoboClaw::crc16(frame, RoboClaw::MIXED_POSITION_FRAME_BYTES);
+    }
+  });
+
+  // A ReadEncoders reply with a valid CRC.
+  const RoboClawCmd cmd = RoboClawCmd::ReadEncoders;
+  const size_t replyBytes = RoboClaw::replyBytes(cmd);
+  uint8_t reply[RoboClaw::MAX_REPLY_BYTES] = {0x00, 0x00, 0x12, 0x34, 0xFF, 0xFF, 0xED, 0xCB};
+  const uint8_t header[2] = {ROBOCLAW_DEFAULT_ADDRESS, (uint8_t)cmd};
+  const uint16_t crc = RoboClaw::crc16(reply, replyBytes - 2, RoboClaw::crc16(header, 2));
+  reply[replyBytes - 2] = (uint8_t)(crc >> 8);
+  reply[replyBytes - 1] = (uint8_t)crc;
+  const double replyNs = bestNsPerOp(batches, CRC_OPS, [&] {
+    for (uint32_t i = 0; i < CRC_OPS; i++) {
+      sink = sink + RoboClaw::checkReply(ROBOCLAW_DEFAULT_ADDRESS, cmd, reply);
+    }
+  });
+  if (!RoboClaw::checkReply(ROBOCLAW_DEFAULT_ADDRESS, cmd, reply)) {
+    fprintf(stderr, "bench: reply CRC mismatch\n");
+  }
+  out.push_back({"roboclaw.crc16_ns", crcNs, "ns/byte"});
+  out.push_back({"roboclaw.frame_ns", frameNs, "ns/frame"});
+  out.push_back({"roboclaw.reply_ns", replyNs, "ns/reply"});
+}
+
+/**
+ * Description: Build the UI model for frame i of the benchmark sequence (a show playing).
+ * Inputs:
+ * - i: frame number.
+ * Outputs: Returns the model.
+ */
+static UiModel uiFrame(uint32_t i) {
+  UiModel model;
+  model.playing = true;
+  model.showTimeMs = i * (uint32_t)Ui::RENDER_PERIOD_MSEC;
+  model.speedNorm = 0.5f;
+  model.accelNorm = 0.5f;
+  model.jogPos = (int32_t)(i / 10);
+  model.motionPos = 1000.0f * sinf((float)i * 0.1f);
+  model.motionVel = 100.0f * cosf((float)i * 0.1f);
+  model.channel.target = (int32_t)model.motionPos;
+  model.channel.position = (int32_t)model.motionPos - 3;
+  model.channel.currentCa = (int16_t)(120 + i % 7);
+  return model;
+}
+
+/**
+ * Description: UI render cost and display bytes per frame while a show plays.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the results.
+ * Outputs: Appends ui.render_ns and ui.flush_bytes.
+ */
+static void benchUi(uint32_t batches, std::vector<BenchResult>& out) {
+  Ui ui;
+  ui.begin();
+  if (simDisplayFrames() == 0) {
+    fprintf(stderr, "bench: display did not start\n");
+    return;
+  }
+  // Bytes a diff-updating driver sends: 2 per changed RGB565 pixel.
+  uint64_t changed = 0;
+  for (uint32_t i = 0; i < UI_FRAMES; i++) {
+    ui.render(uiFrame(i));
+    changed += simDisplayChangedPixels();
+  }
+  const double ns = bestNsPerOp(batches, UI_FRAMES, [&] {
+    for (uint32_t i = 0; i < UI_FRAMES; i++) {
+      ui.render(uiFrame(i));
+    }
+  });
+  out.push_back({"ui.render_ns", ns, "ns/frame"});
+  out.push_back({"ui.flush_bytes", (double)(changed * 2u) / UI_FRAMES, "bytes/frame"});
+}
+
+/**
+ * Description: Deferred log call cost at the call site and per record when drained.
+ * Inputs:
+ * - batches: timing batches.
+ * - out: receives the results.
+ * Outputs: Appends log.call_ns and log.drain_ns (format and queue to the console lane).
+ */
+static void benchLog(uint32_t batches, std::vector<BenchResult>& out) {
+  logInit(115200);
+  logDrain();
+  const double callNs = bestNsPerOp(batches, LOG_CALLS, [&] {
+    for (uint32_t i = 0; i < LOG_CALLS; i++) {
+      LOGI("bench %lu pos=%ld %s %.2f", (unsigned long)i, (long)(i * 37), "deferred", (double)i * 0.5);
+    }
+  }, [] { logDrain(); });
+
+  // Untimed: send what the last drain queued, then queue new records.
+  auto fill = [] {
+    while (consoleTxPending()) {
+      consoleTxPoll();
+    }
+    for (uint32_t i = 0; i < LOG_CALLS; i++) {
+      LOGI("bench %lu pos=%ld %s %.2f", (unsigned long)i, (long)(i * 37), "drain", (double)i * 0.5);
+    }
+  };
+  fill();
+  const uint64_t usbBefore = simUsbTxBytes();
+  const double drainNs = bestNsPerOp(batches, LOG_CALLS, [&] {
+    logDrain();
+  }, fill);
+  while (consoleTxPending()) {
+    consoleTxPoll();
+  }
+  if (simUsbTxBytes() == usbBefore) {
+    fprintf(stderr, "bench: log drain wrote nothing\n");
+  }
+  logDrain();
+  out.push_back({"log.call_ns", callNs, "ns/call"});
+  out.push_back({"log.drain_ns", drainNs, "ns/record"});
+}
+
+/**
+ * Description: Read a baseline file ("name,value,threshold_pct" rows, '#' comments).
+ * Inputs:
+ * - path: file to read.
+ * - out: receives the rows.
+ * Outputs: Returns false if the file cannot be opened.
+ */
+static bool loadBaseline(const char* path, std::vector<BenchBaseline>& out) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n') {
+      continue;
+    }
+    char name[96] = {};
+    double value = 0.0;
+    float pct = DEFAULT_THRESHOLD_PCT;
+    if (sscanf(line, "%95[^,],%lf,%f", name, &value, &pct) >= 2) {
+      out.push_back({name, value, pct});
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * Description: Write results as a baseline file, keeping existing thresholds.
+ * Inputs:
+ * - path: file to write.
+ * - results: current metrics.
+ * - previous: old baseline rows (for thresholds).
+ * Outputs: Returns false if the file cannot be written.
+ */
+static bool writeBaseline(const char* path, const std::vector<BenchResult>& results,
+                          const std::vector<BenchBaseline>& previous) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "# acs_bench baseline: benchmark,value,threshold_pct (worse by more than pct fails)\n");
+  fprintf(f, "# Times depend on the host; refresh with the bench_update target on the machine\n");
+  fprintf(f, "# that runs the bench target, after reviewing the change that moved them.\n");
+  for (const BenchResult& r : results) {
+    float pct = (r.unit && strstr(r.unit, "bytes")) ? 0.0f : DEFAULT_THRESHOLD_PCT;
+    for (const BenchBaseline& b : previous) {
+      if (b.name == r.name) pct = b.thresholdPct;
+    }
+    fprintf(f, "%s,%.3f,%.0f\n", r.name.c_str(), r.value, pct);
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * Description: Run the suite, print CSV, and check or update the baseline.
+ * Inputs:
+ * - argc, argv: command line (see the top of this file).
+ * Outputs: Returns 0, 1 if a metric regressed past its threshold, 2 on usage or file errors.
+ */
+int main(int argc, char** argv) {
+  const char* baselinePath = nullptr;
+  const char* updatePath = nullptr;
+  uint32_t batches = DEFAULT_BATCHES;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--update") == 0 && i + 1 < argc) {
+      updatePath = argv[++i];
+    } else if (strcmp(argv[i], "--batches") == 0 && i + 1 < argc) {
+      batches = (uint32_t)strtoul(argv[++i], nullptr, 10);
+      if (batches == 0) batches = 1;
+    } else {
+      fprintf(stderr, "usage: %s [--baseline FILE] [--update FILE] [--batches N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  simReset();
+  simUsbSetEcho(false);
+
+  std::vector<BenchResult> results;
+  benchConsole(batches, results);
+  benchEncoder(batches, results);
+  benchShow(batches, results);
+  benchRoboClaw(batches, results);
+  benchUi(batches, results);
+  benchLog(batches, results);
+
+  std::vector<BenchBaseline> baseline;
+  const char* readPath = baselinePath ? baselinePath : updatePath;
+  if (readPath && !loadBaseline(readPath, baseline) && baselinePath) {
+    fprintf(stderr, "bench: cannot read %s\n", baselinePath);
+    return 2;
+  }
+
+  int status = 0;
+  printf("benchmark,value,unit,baseline,limit,result\n");
+  for (const BenchResult& r : results) {
+    const BenchBaseline* b = nullptr;
+    for (const BenchBaseline& row : baseline) {
+      if (row.name == r.name) b = &row;
+    }
+    if (!b) {
+      printf("%s,%.3f,%s,,,new\n", r.name.c_str(), r.value, r.unit);
+      continue;
+    }
+    const double limit = b->value * (1.0 + b->thresholdPct / 100.0);
+    const bool regressed = baselinePath && r.value > limit;
+    if (regressed) status = 1;
+    printf("%s,%.3f,%s,%.3f,%.3f,%s\n", r.name.c_str(), r.value, r.unit, b->value, limit,
+           regressed ? "REGRESSED" : "ok");
+  }
+
+  if (updatePath && !writeBaseline(updatePath, results, baseline)) {
+    fprintf(stderr, "bench: cannot write %s\n", updatePath);
+    return 2;
+  }
+  return status;
+}
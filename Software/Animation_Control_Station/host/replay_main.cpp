@@ -0,0 +1,487 @@
+// acs_replay: replays a trace captured with "trace arm" (TraceFormat.h)
+// through the unmodified firmware on the simulated peripherals, as fast as
+// the host runs it. The settings image from the trace header goes into the
+// emulated EEPROM, so setup() boots as the recorded controller did; the
+// firmware's own trace calls then go to a sink here instead of SD:
+//   - each Run/Job the firmware is about to start is matched against the
+//     next recorded one; the virtual clock jumps to the recorded start and
+//     the inputs that run observed (buttons, pots, jog counts, console
+//     line, RS422 bytes) are put on the simulated pins and ports first;
+//   - background jobs that were not recorded at that point are held back;
+//   - every frame the firmware writes to an RS422 port is compared with
+//     the recorded length and hash.
+// Idle time between runs is skipped, so replay speed is bound by the work
+// the tasks do. Any difference is reported as a divergence (exit code 1).
+//
+//   acs_replay [--sd DIR] [--read-ns N] [--echo] [--report N] TRACE
+//
+// --sd must hold the show files the recorded session loaded. --read-ns sets
+// the virtual time per clock read (default SIM_CLOCK_READ_NS, as in acs_sim).
+#include "SimHal.h"
+#include "BoardPins.h"
+#include "Config.h"
+#include "Input.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+
+static constexpr uint32_t DEFAULT_REPORT = 10;       // divergences printed in full
+static constexpr uint32_t MAX_NUDGE_US = 1000;       // clock steps to wait for a recorded run
+static constexpr uint32_t UART_DRAIN_PASSES = 4096;  // loop passes between discarding sent bytes
+
+// A frame the recorded firmware wrote.
+struct ExpectedTx {
+  uint64_t timeUs = 0;
+  uint8_t len = 0;
+  uint32_t hash = 0;
+};
+
+// A decoded record with its time on the 64-bit replay timeline.
+struct ReplayRecord {
+  TraceRecord type = TraceRecord::End;
+  uint8_t arg = 0;
+  uint64_t timeUs = 0;
+  const uint8_t* data = nullptr;
+  uint8_t len = 0;
+  uint32_t value = 0;
+};
+
+struct Replay {
+  std::vector<uint8_t> file;
+  const uint8_t* cursor = nullptr;
+  const uint8_t* end = nullptr;
+  uint32_t recordUs = 0;      // last decoded record time (micros() wraps)
+  uint64_t recordUs64 = 0;    // the same, unwrapped
+  uint32_t startUs = 0;
+  uint64_t offsetUs = 0;      // replay clock minus recorded time
+
+  bool started = false;
+  bool haveNext = false;      // next Run/Job record is in 'next'
+  bool ended = false;         // End record or end of file reached
+  bool sawEnd = false;        // the capture was closed, not cut short
+  ReplayRecord next;
+  std::vector<ReplayRecord> preRun; // e-stop edges to apply before 'next'
+  std::deque<ExpectedTx> expected[RS422_PORT_COUNT];
+  uint32_t nudges = 0;
+
+  // Counters for the summary.
+  uint64_t runs = 0;
+  uint64_t jobsHeld = 0;
+  uint64_t inputs = 0;
+  uint64_t txCompared = 0;
+  uint64_t scheduleDiverged = 0;
+  uint64_t txMismatched = 0;
+  uint64_t txMissing = 0;
+  uint64_t txUnexpected = 0;
+  uint64_t maxLagUs = 0;
+  uint32_t droppedAtCapture = 0;
+  uint32_t report = DEFAULT_REPORT;
+  uint64_t reported = 0;
+};
+
+/**
+ * Description: Convert a recorded time to seconds into the capture.
+ * Inputs:
+ * - r: replay state.
+ * - timeUs: time on the unwrapped recorded timeline.
+ * Outputs: Returns seconds since the capture started.
+ */
+static double replaySeconds(const Replay& r, uint64_t timeUs) {
+  return (double)(timeUs - r.startUs) / 1e6;
+}
+
+/**
+ * Description: Print one divergence, up to the report limit.
+ * Inputs:
+ * - r: replay state.
+ * - timeUs: recorded time the divergence belongs to.
+ * - text: description.
+ * Outputs: Writes a "replay: DIVERGE" line.
+ */
+static void diverge(Replay& r, uint64_t timeUs, const std::string& text) {
+  if (r.reported++ < r.report) {
+    printf("replay: DIVERGE at %.6f s: %s\n", replaySeconds(r, timeUs), text.c_str());
+  }
+}
+
+/**
+ * Description: Decode the next record of the trace.
+ * Inputs:
+ * - r: replay state.
+ * - out: receives the record.
+ * Outputs: Returns false at the end of the trace or a truncated record (a capture cut by power loss).
+ */
+static bool readRecord(Replay& r, ReplayRecord& out) {
+  if (r.ended) {
+    return false;
+  }
+  const uint32_t before = r.recordUs;
+  uint32_t timeUs = r.recordUs;
+  if (!traceGetRecord(r.cursor, r.end, timeUs, out.type, out.arg, out.data, out.len, out.value)) {
+    r.ended = true;
+    return false;
+  }
+  r.recordUs = timeUs;
+  r.recordUs64 += (uint64_t)(int64_t)(int32_t)(timeUs - before);
+  out.timeUs = r.recordUs64;
+  if (out.type == TraceRecord::End) {
+    r.droppedAtCapture = out.value;
+    r.sawEnd = true;
+    r.ended = true;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Description: Move the virtual clock to a recorded time.
+ * Inputs:
+ * - r: replay state.
+ * - timeUs: recorded time.
+ * Outputs: Clock at the time (never backwards); a later clock counts as lag.
+ */
+static void clockTo(Replay& r, uint64_t timeUs) {
+  const uint64_t targetNs = (timeUs + r.offsetUs) * 1000u;
+  const uint64_t nowNs = simNowNs();
+  if (nowNs > targetNs) {
+    const uint64_t lagUs = (nowNs - targetNs) / 1000u;
+    if (lagUs > r.maxLagUs) r.maxLagUs = lagUs;
+    return;
+  }
+  simAdvanceToNs(targetNs);
+}
+
+/**
+ * Description: Put one recorded input on the simulated hardware.
+ * Inputs:
+ * - rec: Buttons, Pot, Encoder, Console or Rx record.
+ * Outputs: Drives the expander pins, analog inputs, encoder, USB console or a UART receiver.
+ */
+static void applyInput(const ReplayRecord& rec) {
+  switch (rec.type) {
+    case TraceRecord::Buttons:
+      for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        // Buttons short to ground.
+        simSx1509SetPin((uint8_t)BUTTON_SX_PINS[i], (rec.value & (1u << i)) ? LOW : HIGH);
+      }
+      break;
+    case TraceRecord::Pot:
+      simSetAnalog(rec.arg == (uint8_t)TracePot::Accel ? PIN_POT_ACCEL : PIN_POT_SPEED, (float)rec.value / 4095.0f);
+      break;
+    case TraceRecord::Encoder:
+      simStepEncoder(PIN_ENC_A, PIN_ENC_B, (int32_t)rec.value);
+      break;
+    case TraceRecord::Console: {
+      const std::string line(reinterpret_cast<const char*>(rec.data), rec.len);
+      simUsbInput((line + "\n").c_str());
+      break;
+    }
+    case TraceRecord::Rx:
+      simUartInject((uint8_t)(rec.arg + 1), rec.data, rec.len);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * Description: Find the next Run/Job record, collecting e-stop edges on the way.
+ * Inputs:
+ * - r: replay state.
+ * Outputs: Sets r.next/r.haveNext; inputs before it were applied to the current run.
+ */
+static void loadSegment(Replay& r) {
+  r.haveNext = false;
+  ReplayRecord rec;
+  while (readRecord(r, rec)) {
+    switch (rec.type) {
+      case TraceRecord::Run:
+      case TraceRecord::Job:
+        r.next = rec;
+        r.haveNext = true;
+        return;
+      case TraceRecord::Estop:
+        r.preRun.push_back(rec);
+        break;
+      case TraceRecord::Tx:
+        if (rec.arg < RS422_PORT_COUNT) {
+          r.expected[rec.arg].push_back(ExpectedTx{rec.timeUs, rec.len, rec.value});
+        }
+        break;
+      case TraceRecord::Start:
+        break;
+      default:
+        r.inputs++;
+        applyInput(rec);
+        break;
+    }
+  }
+}
+
+/**
+ * Description: Report recorded frames the replayed firmware never wrote.
+ * Inputs:
+ * - r: replay state.
+ * Outputs: Empties the expectation queues.
+ */
+static void flushExpected(Replay& r) {
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    while (!r.expected[p].empty()) {
+      const ExpectedTx& e = r.expected[p].front();
+      char text[96];
+      snprintf(text, sizeof(text), "port %u: recorded %u-byte frame was not sent", (unsigned)p, (unsigned)e.len);
+      diverge(r, e.timeUs, text);
+      r.txMissing++;
+      r.expected[p].pop_front();
+    }
+  }
+}
+
+/**
+ * Description: Start the recorded run the firmware is about to start.
+ * Inputs:
+ * - r: replay state.
+ * Outputs: Clock at the recorded start; that run's inputs applied and its frames expected.
+ */
+static void consumeNext(Replay& r) {
+  flushExpected(r);
+  for (const ReplayRecord& edge : r.preRun) {
+    // The level is read in the run hook, just after the run's start time.
+    clockTo(r, std::min(edge.timeUs, r.next.timeUs));
+    // The e-stop loop is active low: its level is what the pin reads.
+    simSetPin(PIN_ESTOP, edge.arg ? HIGH : LOW);
+  }
+  r.preRun.clear();
+  clockTo(r, r.next.timeUs);
+  r.runs++;
+  r.nudges = 0;
+  loadSegment(r);
+}
+
+/**
+ * Description: Trace sink: the firmware's trace calls during the replay.
+ * Inputs:
+ * - event: record the firmware would have written; a matched Run/Job gets its start time.
+ * - context: replay state.
+ * Outputs: Returns false to hold back a background job the recording did not run here.
+ */
+static bool replaySink(TraceEvent& event, void* context) {
+  Replay& r = *static_cast<Replay*>(context);
+  switch (event.type) {
+    case TraceRecord::Start: {
+      // Line the clock up with the recorded micros() so periodic releases keep their phase.
+      r.started = true;
+      const uint64_t nowUs = simNowNs() / 1000u;
+      uint64_t startUs = (nowUs & ~0xFFFFFFFFull) | r.startUs;
+      if (startUs < nowUs) startUs += 0x100000000ull;
+      r.offsetUs = startUs - r.startUs;
+      simAdvanceToNs(startUs * 1000u);
+      loadSegment(r);
+      return true;
+    }
+    case TraceRecord::Run:
+    case TraceRecord::Job: {
+      if (r.haveNext && r.next.type == event.type && r.next.arg == event.arg) {
+        consumeNext(r);
+        // Start at the recorded time (or later when the clock already passed it).
+        event.timeUs = (uint32_t)(simNowNs() / 1000u);
+        return true;
+      }
+      if (event.type == TraceRecord::Job) {
+        r.jobsHeld++;
+        return false;
+      }
+      if (r.haveNext) {
+        char text[96];
+        snprintf(text, sizeof(text), "task %u ran, recorded next is %s %u", (unsigned)event.arg,
+                 r.next.type == TraceRecord::Job ? "job" : "task", (unsigned)r.next.arg);
+        diverge(r, r.next.timeUs, text);
+        r.scheduleDiverged++;
+      }
+      return true;
+    }
+    case TraceRecord::Tx: {
+      if (event.arg >= RS422_PORT_COUNT) {
+        return true;
+      }
+      std::deque<ExpectedTx>& queue = r.expected[event.arg];
+      const uint64_t nowUs = simNowNs() / 1000u - r.offsetUs;
+      char text[128];
+      if (queue.empty()) {
+        snprintf(text, sizeof(text), "port %u: unexpected %u-byte frame", (unsigned)event.arg, (unsigned)event.len);
+        diverge(r, nowUs, text);
+        r.txUnexpected++;
+        return true;
+      }
+      const ExpectedTx e = queue.front();
+      queue.pop_front();
+      r.txCompared++;
+      if (e.len != event.len || e.hash != event.value) {
+        snprintf(text, sizeof(text), "port %u: sent %u bytes #%08X, recorded %u bytes #%08X", (unsigned)event.arg,
+                 (unsigned)event.len, (unsigned)event.value, (unsigned)e.len, (unsigned)e.hash);
+        diverge(r, e.timeUs, text);
+        r.txMismatched++;
+      }
+      return true;
+    }
+    default:
+      // Inputs the firmware read back are the ones this replay put there.
+      return true;
+  }
+}
+
+/**
+ * Description: Read the trace file and put its settings image into the EEPROM.
+ * Inputs:
+ * - path: trace file.
+ * - r: replay state, receives the file.
+ * Outputs: Returns false if the file is missing or not a trace.
+ */
+static bool loadTrace(const char* path, Replay& r) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "replay: cannot open %s\n", path);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  const long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  r.file.resize(size > 0 ? (size_t)size : 0);
+  const size_t got = fread(r.file.data(), 1, r.file.size(), f);
+  fclose(f);
+  TraceFileHeader header = {};
+  if (got != r.file.size() || got < sizeof(header)) {
+    fprintf(stderr, "replay: %s is too short\n", path);
+    return false;
+  }
+  memcpy(&header, r.file.data(), sizeof(header));
+  if (header.magic != TRACE_MAGIC || header.version != TRACE_FORMAT_VERSION ||
+      sizeof(header) + header.configBytes > got) {
+    fprintf(stderr, "replay: %s is not a version %u trace\n", path, (unsigned)TRACE_FORMAT_VERSION);
+    return false;
+  }
+  // Config::save() writes the image the way the recorded controller held it.
+  Config config;
+  const size_t copy = header.configBytes < sizeof(ConfigData) ? header.configBytes : sizeof(ConfigData);
+  memcpy(&config.data(), r.file.data() + sizeof(header), copy);
+  config.data().traceAtBoot = 1;
+  if (!config.save()) {
+    fprintf(stderr, "replay: settings image does not fit the EEPROM\n");
+    return false;
+  }
+  r.startUs = header.startUs;
+  r.recordUs = header.startUs;
+  r.recordUs64 = header.startUs;
+  r.cursor = r.file.data() + sizeof(header) + header.configBytes;
+  r.end = r.file.data() + got;
+  return true;
+}
+
+/**
+ * Description: Parse options, replay the trace, print the comparison.
+ * Inputs:
+ * - argc, argv: command line (see the top of this file).
+ * Outputs: Returns 0 when the replay matched, 1 on a divergence, 2 on errors.
+ */
+int main(int argc, char** argv) {
+  const char* sdRoot = nullptr;
+  const char* tracePath = nullptr;
+  uint32_t readNs = SIM_CLOCK_READ_NS;
+  bool echo = false;
+  static Replay r;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--sd") == 0 && hasValue) {
+      sdRoot = argv[++i];
+    } else if (strcmp(arg, "--read-ns") == 0 && hasValue) {
+      readNs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--report") == 0 && hasValue) {
+      r.report = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--echo") == 0) {
+      echo = true;
+    } else if (arg[0] != '-' && !tracePath) {
+      tracePath = arg;
+    } else {
+      tracePath = nullptr;
+      break;
+    }
+  }
+  if (!tracePath) {
+    fprintf(stderr, "usage: %s [--sd DIR] [--read-ns N] [--echo] [--report N] TRACE\n", argv[0]);
+    return 2;
+  }
+
+  simReset();
+  simSetSdRoot(sdRoot);
+  simSetClockReadNs(readNs);
+  simUsbSetEcho(echo);
+  simSetPin(PIN_ESTOP, HIGH); // loop closed until the trace says otherwise
+  simSetAnalog(PIN_POT_SPEED, 0.5f);
+  simSetAnalog(PIN_POT_ACCEL, 0.5f);
+  if (!loadTrace(tracePath, r)) {
+    return 2;
+  }
+  traceSetSink(replaySink, &r);
+
+  const auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  if (!r.started) {
+    fprintf(stderr, "replay: the firmware did not start a trace at boot\n");
+    return 2;
+  }
+
+  uint64_t passes = 0;
+  while (r.haveNext) {
+    const uint64_t runsBefore = r.runs;
+    clockTo(r, r.next.timeUs);
+    loop();
+    if (++passes % UART_DRAIN_PASSES == 0) {
+      for (uint8_t port = 1; port <= SIM_UART_COUNT; port++) {
+        simUartTakeTx(port);
+      }
+    }
+    if (r.runs != runsBefore) {
+      continue;
+    }
+    // Nothing recorded ran: the release phase differs slightly, so step
+    // the clock; give up on the record after MAX_NUDGE_US.
+    if (++r.nudges <= MAX_NUDGE_US) {
+      simAdvanceUs(1);
+      continue;
+    }
+    char text[96];
+    snprintf(text, sizeof(text), "recorded %s %u never became due", r.next.type == TraceRecord::Job ? "job" : "task",
+             (unsigned)r.next.arg);
+    diverge(r, r.next.timeUs, text);
+    r.scheduleDiverged++;
+    consumeNext(r);
+  }
+  flushExpected(r);
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  const double tracedS = replaySeconds(r, r.recordUs64);
+
+  fflush(stdout);
+  const uint64_t divergences = r.scheduleDiverged + r.txMismatched + r.txMissing + r.txUnexpected;
+  printf("replay: %s, %.3f s recorded, %llu runs, %llu inputs, %llu frames compared\n", tracePath, tracedS,
+         (unsigned long long)r.runs, (unsigned long long)r.inputs, (unsigned long long)r.txCompared);
+  printf("replay: %llu divergences (schedule %llu, frame mismatch %llu, missing %llu, unexpected %llu), worst lag %llu us\n",
+         (unsigned long long)divergences, (unsigned long long)r.scheduleDiverged, (unsigned long long)r.txMismatched,
+         (unsigned long long)r.txMissing, (unsigned long long)r.txUnexpected, (unsigned long long)r.maxLagUs);
+  printf("replay: %.2f s wall, %.0fx real time\n", wallS, wallS > 0.0 ? tracedS / wallS : 0.0);
+  if (!r.sawEnd) {
+    printf("replay: warning: trace has no End record (capture cut short)\n");
+  }
+  if (r.droppedAtCapture) {
+    printf("replay: warning: the capture dropped %lu records; expect divergence\n", (unsigned long)r.droppedAtCapture);
+  }
+  return divergences ? 1 : 0;
+}
@@ -0,0 +1,280 @@
+// acs_sim: runs the unmodified firmware (setup()/loop()) on Linux against
+// the simulated peripherals in SimHal.cpp. Console output goes to stdout;
+// scripted events press buttons, turn the jog wheel, move the pots, feed
+// UART bytes and type console commands at given simulated times.
+//
+//   acs_sim [--ms N] [--realtime] [--loop-us N] [--sd DIR] [--eeprom FILE] [--script FILE] [-e "EVENT"]...
+//
+// --eeprom keeps the emulated EEPROM in a host file across runs, so a
+// setting saved in one run (e.g. "trace arm") is there at the next boot.
+//
+// Event lines (script files allow blank lines and '#' comments):
+//   <ms> cmd <console line>
+//   <ms> button <left|right|down|up|ok|red|yellow|green> <down|up>
+//   <ms> jog <steps>
+//   <ms> pot <speed|accel> <0..1>
+//   <ms> rx <port 1..8> <hex bytes>
+//   <ms> estop <0|1>
+#include "SimHal.h"
+#include "BoardPins.h"
+#include "Faults.h"
+#include "Input.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+
+struct SimEvent {
+  uint32_t atMs = 0;
+  std::string what;
+  std::string args;
+  uint32_t order = 0; // keeps same-time events in the order given
+};
+
+static constexpr uint32_t DEFAULT_RUN_MS = 2000;
+static constexpr uint32_t DEFAULT_LOOP_US = 5;
+
+static const char* const BUTTON_NAMES[BUTTON_COUNT] = {
+  "left", "right", "down", "up", "ok", "red", "yellow", "green"
+};
+
+/**
+ * Description: Parse one event line.
+ * Inputs:
+ * - line: "<ms> <what> <args...>".
+ * - order: sequence number for stable ordering.
+ * - out: receives the event.
+ * Outputs: Returns false for blank, comment or malformed lines.
+ */
+static bool parseEvent(const std::string& line, uint32_t order, SimEvent& out) {
+  const size_t start = line.find_first_not_of(" \t");
+  if (start == std::string::npos || line[start] == '#') {
+    return false;
+  }
+  char what[16] = {};
+  unsigned long atMs = 0;
+  int consumed = 0;
+  if (sscanf(line.c_str() + start, "%lu %15s %n", &atMs, what, &consumed) < 2) {
+    fprintf(stderr, "sim: bad event '%s'\n", line.c_str());
+    return false;
+  }
+  out.atMs = (uint32_t)atMs;
+  out.what = what;
+  out.args = line.substr(start + (size_t)consumed);
+  out.order = order;
+  return true;
+}
+
+/**
+ * Description: Apply an event to the simulated hardware.
+ * Inputs:
+ * - ev: event to apply.
+ * Outputs: Drives pins, expander inputs, analog inputs, UART RX or the USB console.
+ */
+static void applyEvent(const SimEvent& ev) {
+  const char* args = ev.args.c_str();
+  if (ev.what == "cmd") {
+    simUsbInput(args);
+    simUsbInput("\n");
+  } else if (ev.what == "button") {
+    char name[16] = {};
+    char state[8] = {};
+    if (sscanf(args, "%15s %7s", name, state) == 2) {
+      for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (strcmp(name, BUTTON_NAMES[i]) == 0) {
+          // Buttons short to ground.
+          simSx1509SetPin((uint8_t)BUTTON_SX_PINS[i], strcmp(state, "down") == 0 ? LOW : HIGH);
+        }
+      }
+    }
+  } else if (ev.what == "jog") {
+    simStepEncoder(PIN_ENC_A, PIN_ENC_B, (int32_t)strtol(args, nullptr, 10));
+  } else if (ev.what == "pot") {
+    char name[16] = {};
+    float norm = 0.0f;
+    if (sscanf(args, "%15s %f", name, &norm) == 2) {
+      simSetAnalog(strcmp(name, "accel") == 0 ? PIN_POT_ACCEL : PIN_POT_SPEED, norm);
+    }
+  } else if (ev.what == "rx") {
+    char* end = nullptr;
+    const uint8_t port = (uint8_t)strtoul(args, &end, 10);
+    std::vector<uint8_t> bytes;
+    unsigned int b = 0;
+    int used = 0;
+    while (end && sscanf(end, " %2x%n", &b, &used) == 1) {
+      bytes.push_back((uint8_t)b);
+      end += used;
+    }
+    simUartInject(port, bytes.data(), bytes.size());
+  } else if (ev.what == "estop") {
+    // The e-stop loop is active low: tripped opens the loop.
+    simSetPin(PIN_ESTOP, strtol(args, nullptr, 10) ? LOW : HIGH);
+  } else {
+    fprintf(stderr, "sim: unknown event '%s'\n", ev.what.c_str());
+  }
+}
+
+/**
+ * Description: Read events from a script file.
+ * Inputs:
+ * - path: script file.
+ * - events: receives the events.
+ * Outputs: Returns false if the file cannot be opened.
+ */
+static bool loadScript(const char* path, std::vector<SimEvent>& events) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "sim: cannot open %s\n", path);
+    return false;
+  }
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    std::string text(line);
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+    SimEvent ev;
+    if (parseEvent(text, (uint32_t)events.size(), ev)) {
+      events.push_back(ev);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * Description: Load or store the emulated EEPROM as a host file.
+ * Inputs:
+ * - path: image file.
+ * - store: true to write the EEPROM out, false to read it in (a missing file leaves it erased).
+ * Outputs: Returns false if the file cannot be written.
+ */
+static bool syncEeprom(const char* path, bool store) {
+  FILE* f = fopen(path, store ? "wb" : "rb");
+  if (!f) {
+    return !store;
+  }
+  bool ok = true;
+  if (store) {
+    ok = fwrite(simEeprom(), 1, SIM_EEPROM_BYTES, f) == (size_t)SIM_EEPROM_BYTES;
+  } else {
+    const size_t n = fread(simEeprom(), 1, SIM_EEPROM_BYTES, f);
+    (void)n;
+  }
+  fclose(f);
+  return ok;
+}
+
+/**
+ * Description: Print what the run left behind on the simulated hardware.
+ * Inputs:
+ * - passes: loop() calls made.
+ * Outputs: Writes a "sim:" summary to stdout.
+ */
+static void printSummary(uint64_t passes) {
+  fflush(stdout);
+  printf("\nsim: %.3f s simulated, %llu loop passes\n", (double)simNowNs() / 1e9,
+         (unsigned long long)passes);
+  printf("sim: display %u frames\n", (unsigned)simDisplayFrames());
+  for (const std::string& line : simDisplayText()) {
+    printf("sim:   | %s\n", line.c_str());
+  }
+  printf("sim: leds");
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    printf(" %u", 255u - simSx1509Pwm((uint8_t)(LED_SX_PIN_BASE + i)));
+  }
+  printf("\n");
+  for (uint8_t port = 1; port <= SIM_UART_COUNT; port++) {
+    const std::vector<uint8_t> tx = simUartTakeTx(port);
+    if (!tx.empty()) {
+      printf("sim: Serial%u %u baud, %zu bytes sent\n", port, (unsigned)simUartBaud(port), tx.size());
+    }
+  }
+  const uint32_t faults = faults_active();
+  printf("sim: faults 0x%08X", (unsigned)faults);
+  for (uint8_t f = 0; f < FAULT_MAX_INDEX; f++) {
+    if (faults & (1u << f)) printf(" %s", FAULT_STRING[f]);
+  }
+  printf("\n");
+}
+
+/**
+ * Description: Parse options, run the firmware for the requested time, print a summary.
+ * Inputs:
+ * - argc, argv: command line (see the top of this file).
+ * Outputs: Returns 0 on success, 2 on a usage error.
+ */
+int main(int argc, char** argv) {
+  uint32_t runMs = DEFAULT_RUN_MS;
+  uint32_t loopUs = DEFAULT_LOOP_US;
+  bool realTime = false;
+  const char* sdRoot = nullptr;
+  const char* eepromPath = nullptr;
+  std::vector<SimEvent> events;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--ms") == 0 && hasValue) {
+      runMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--loop-us") == 0 && hasValue) {
+      loopUs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--realtime") == 0) {
+      realTime = true;
+    } else if (strcmp(arg, "--sd") == 0 && hasValue) {
+      sdRoot = argv[++i];
+    } else if (strcmp(arg, "--eeprom") == 0 && hasValue) {
+      eepromPath = argv[++i];
+    } else if (strcmp(arg, "--script") == 0 && hasValue) {
+      if (!loadScript(argv[++i], events)) return 2;
+    } else if (strcmp(arg, "-e") == 0 && hasValue) {
+      SimEvent ev;
+      if (parseEvent(argv[++i], (uint32_t)events.size(), ev)) events.push_back(ev);
+    } else {
+      fprintf(stderr, "usage: %s [--ms N] [--realtime] [--loop-us N] [--sd DIR] [--eeprom FILE] [--script FILE] [-e \"EVENT\"]...\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const SimEvent& a, const SimEvent& b) { return a.atMs < b.atMs; });
+
+  simReset();
+  simSetSdRoot(sdRoot);
+  if (eepromPath) {
+    syncEeprom(eepromPath, false);
+  }
+  simSetPin(PIN_ESTOP, HIGH); // loop closed
+  simSetAnalog(PIN_POT_SPEED, 0.5f);
+  simSetAnalog(PIN_POT_ACCEL, 0.5f);
+  if (realTime) {
+    simSetClockMode(SimClockMode::RealTime);
+  }
+
+  setup();
+  size_t next = 0;
+  uint64_t passes = 0;
+  const uint64_t endNs = (uint64_t)runMs * 1000000u;
+  while (simNowNs() < endNs) {
+    const uint32_t nowMs = (uint32_t)(simNowNs() / 1000000u);
+    while (next < events.size() && events[next].atMs <= nowMs) {
+      applyEvent(events[next++]);
+    }
+    loop();
+    passes++;
+    simAdvanceUs(loopUs);
+  }
+  // Close a running capture as "trace stop" would, so the file is complete.
+  if (traceActive()) {
+    traceStop();
+    printf("sim: trace written to %s on the SD card\n", TRACE_FILE);
+  }
+  printSummary(passes);
+  if (eepromPath && !syncEeprom(eepromPath, true)) {
+    fprintf(stderr, "sim: cannot write %s\n", eepromPath);
+    return 2;
+  }
+  return 0;
+}
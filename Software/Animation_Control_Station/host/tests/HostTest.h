@@ -0,0 +1,41 @@
+#pragma once
+#include <math.h>
+#include <stdio.h>
+
+// Checks for the host test programs (host/tests/, run by ctest). Each
+// program calls its cases from main() and returns testExitCode(); a failed
+// check prints where it failed and the case keeps going.
+inline int g_testFailures = 0;
+inline int g_testChecks = 0;
+
+#define TEST_CHECK(cond)                                                   \
+  do {                                                                     \
+    g_testChecks++;                                                        \
+    if (!(cond)) {                                                         \
+      g_testFailures++;                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);      \
+    }                                                                      \
+  } while (0)
+
+#define TEST_CHECK_NEAR(actual, expected, tolerance)                                     \
+  do {                                                                                   \
+    g_testChecks++;                                                                      \
+    const double testActual_ = (double)(actual);                                         \
+    const double testExpected_ = (double)(expected);                                     \
+    if (!(fabs(testActual_ - testExpected_) <= (double)(tolerance))) {                  \
+      g_testFailures++;                                                                  \
+      printf("%s:%d: check failed: %s = %g, expected %g +/- %g\n", __FILE__, __LINE__, \
+             #actual, testActual_, testExpected_, (double)(tolerance));                  \
+    }                                                                                    \
+  } while (0)
+
+/**
+ * Description: Print the summary line and pick the exit code.
+ * Inputs:
+ * - name: test program name.
+ * Outputs: Returns 0 when every check passed, 1 otherwise.
+ */
+inline int testExitCode(const char* name) {
+  printf("%s: %d checks, %d failed\n", name, g_testChecks, g_testFailures);
+  return g_testFailures ? 1 : 0;
+}
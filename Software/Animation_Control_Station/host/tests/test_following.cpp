@@ -0,0 +1,167 @@
+// Following-error monitor against a simulated plant: a first-order lag
+// motor with encoder noise follows a show-like sine. Minutes of healthy
+// motion must never escalate; a stall or jam injected at different points
+// of the motion must escalate warning -> slow -> stop, and the test reports
+// the detection latency of each level.
+#include "HostTest.h"
+#include "FollowingError.h"
+
+#include <math.h>
+
+static constexpr uint32_t SAMPLE_US = 20000;       // telemetry rate of one channel
+static constexpr float AMPLITUDE = 2000.0f;         // counts
+static constexpr float FREQ_HZ = 0.5f;
+static constexpr float PLANT_LAG_S = 0.05f;         // healthy motor + drive response
+static constexpr int32_t NOISE_COUNTS = 20;
+static constexpr uint32_t HEALTHY_US = 600000000;   // 10 minutes
+static constexpr uint32_t STALL_RUN_US = 10000000;  // time allowed to reach Stop after the stall
+static constexpr uint32_t STOP_LATENCY_MAX_US = 1000000; // full stall at speed
+
+// Motor model: follows the command with a first-order lag; a jam scales
+// how far it can move per sample (0 = locked rotor).
+struct TestPlant {
+  float pos = 0.0f;
+  float freedom = 1.0f;
+  uint32_t rng = 99;
+
+  /**
+   * Description: Advance the plant one sample toward the command.
+   * Inputs:
+   * - commanded: position setpoint.
+   * Outputs: Returns the noisy encoder reading.
+   */
+  float step(float commanded) {
+    const float alpha = (float)SAMPLE_US * 1.0e-6f / PLANT_LAG_S;
+    pos += (commanded - pos) * alpha * freedom;
+    rng = rng * 1664525u + 1013904223u;
+    return pos + (float)((int32_t)((rng >> 8) % (2 * NOISE_COUNTS + 1)) - NOISE_COUNTS);
+  }
+};
+
+// When each level was first reached, relative to the stall (0 = never).
+struct Detection {
+  uint32_t latencyUs[4] = {};
+  FollowLevel worst = FollowLevel::Ok;
+};
+
+/**
+ * Description: Show-like command: a sine sweep.
+ * Inputs:
+ * - tUs: time.
+ * Outputs: Returns the commanded position.
+ */
+static float command(uint32_t tUs) {
+  return AMPLITUDE * sinf(2.0f * (float)M_PI * FREQ_HZ * (float)tUs * 1.0e-6f);
+}
+
+/**
+ * Description: Run the monitor on the plant, jamming it at a given time.
+ * Inputs:
+ * - stallAtUs: time of the jam (0 = never).
+ * - freedom: plant freedom after the jam (0 = full stall).
+ * - lengthUs: run length.
+ * Outputs: Returns when each level was first reached after the jam.
+ */
+static Detection run(uint32_t stallAtUs, float freedom, uint32_t lengthUs) {
+  static FollowingMonitor monitor;
+  monitor.reset();
+  TestPlant plant;
+  Detection d;
+  for (uint32_t tUs = SAMPLE_US; tUs <= lengthUs; tUs += SAMPLE_US) {
+    if (stallAtUs && tUs >= stallAtUs) {
+      plant.freedom = freedom;
+    }
+    const float commanded = command(tUs);
+    const FollowLevel level = monitor.sample(0, commanded, plant.step(commanded), tUs);
+    if (level > d.worst) {
+      d.worst = level;
+      d.latencyUs[(uint8_t)level] = (stallAtUs && tUs >= stallAtUs) ? tUs - stallAtUs : 1;
+    }
+    if (level == FollowLevel::Stop) {
+      break;
+    }
+  }
+  return d;
+}
+
+/**
+ * Description: Healthy motion never leaves Ok.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testNoFalseAlarm() {
+  const Detection d = run(0, 1.0f, HEALTHY_US);
+  TEST_CHECK(d.worst == FollowLevel::Ok);
+}
+
+/**
+ * Description: Full stalls at several points of the motion escalate in order within the latency bound.
+ * Inputs: None.
+ * Outputs: Records check results and prints the latencies.
+ */
+static void testStallLatency() {
+  // Peak speed, mid-sweep, and near a reversal (the hardest: the error grows slowly).
+  static const uint32_t STALL_AT_US[] = {3000000, 3250000, 3450000};
+  for (uint32_t stallAtUs : STALL_AT_US) {
+    const Detection d = run(stallAtUs, 0.0f, stallAtUs + STALL_RUN_US);
+    printf("follow: stall at %lu ms: warning +%lu ms, slow +%lu ms, stop +%lu ms\n",
+           (unsigned long)(stallAtUs / 1000), (unsigned long)(d.latencyUs[1] / 1000),
+           (unsigned long)(d.latencyUs[2] / 1000), (unsigned long)(d.latencyUs[3] / 1000));
+    TEST_CHECK(d.worst == FollowLevel::Stop);
+    TEST_CHECK(d.latencyUs[1] > 0 && d.latencyUs[1] <= d.latencyUs[2] && d.latencyUs[2] <= d.latencyUs[3]);
+    TEST_CHECK(d.latencyUs[3] <= STOP_LATENCY_MAX_US);
+  }
+}
+
+/**
+ * Description: A partial jam (motor still turning slowly) is caught too, only later.
+ * Inputs: None.
+ * Outputs: Records check results and prints the latencies.
+ */
+static void testPartialJam() {
+  const Detection full = run(3000000, 0.0f, 3000000 + STALL_RUN_US);
+  const Detection jam = run(3000000, 0.05f, 3000000 + STALL_RUN_US);
+  printf("follow: 5%% jam at 3000 ms: warning +%lu ms, slow +%lu ms, stop +%lu ms\n",
+         (unsigned long)(jam.latencyUs[1] / 1000), (unsigned long)(jam.latencyUs[2] / 1000),
+         (unsigned long)(jam.latencyUs[3] / 1000));
+  TEST_CHECK(jam.worst == FollowLevel::Stop);
+  TEST_CHECK(jam.latencyUs[3] >= full.latencyUs[3]);
+}
+
+/**
+ * Description: Stop stays latched when the error goes away, until reset().
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testStopLatches() {
+  static FollowingMonitor monitor;
+  monitor.reset();
+  uint32_t tUs = 0;
+  FollowLevel level = FollowLevel::Ok;
+  for (uint32_t i = 0; i < 200 && level != FollowLevel::Stop; i++) {
+    tUs += SAMPLE_US;
+    level = monitor.sample(1, 5000.0f, 0.0f, tUs);
+  }
+  TEST_CHECK(level == FollowLevel::Stop);
+  for (uint32_t i = 0; i < 200; i++) {
+    tUs += SAMPLE_US;
+    level = monitor.sample(1, 0.0f, 0.0f, tUs);
+  }
+  TEST_CHECK(level == FollowLevel::Stop);
+  TEST_CHECK(monitor.level() == FollowLevel::Stop);
+  monitor.reset();
+  TEST_CHECK(monitor.level() == FollowLevel::Ok);
+}
+
+/**
+ * Description: Run the following-error cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testNoFalseAlarm();
+  testStallLatency();
+  testPartialJam();
+  testStopLatches();
+  return testExitCode("test_following");
+}
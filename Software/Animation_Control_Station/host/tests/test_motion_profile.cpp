@@ -0,0 +1,210 @@
+// Motion profile planner: random moves retargeted and re-limited mid-move
+// (as the encoder and the speed/accel pots do) never exceed the velocity,
+// acceleration or (S-curve) jerk limits and always land on the target.
+// Also reports how many replans per second the planner sustains.
+#include "HostTest.h"
+#include "MotionProfile.h"
+
+#include <chrono>
+
+static constexpr uint32_t SAMPLE_US = 100;      // evaluation step
+// Jerk is measured as the change in acceleration over this window: plans
+// keep time as float seconds, which quantizes a long move to ~1 us, too
+// coarse for a difference over one 100 us step.
+static constexpr uint32_t JERK_WINDOW_US = 5000;
+static constexpr uint32_t RANDOM_MOVES = 400;
+static constexpr float LIMIT_SLACK = 1.0e-3f;   // relative float rounding allowance
+static constexpr uint32_t REPLAN_BENCH_COUNT = 200000;
+
+// Deterministic generator so a failure reproduces.
+struct TestRandom {
+  uint32_t state = 12345;
+
+  /**
+   * Description: Draw a value in [lo, hi).
+   * Inputs:
+   * - lo: lower bound.
+   * - hi: upper bound.
+   * Outputs: Returns the value.
+   */
+  float range(float lo, float hi) {
+    state = state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(state >> 8) / 16777216.0f;
+  }
+};
+
+// Worst kinematics seen while sampling, relative to the limits in force.
+struct LimitReport {
+  float velRatio = 0.0f;
+  float accRatio = 0.0f;
+  float jerkRatio = 0.0f;
+  float landError = 0.0f;
+};
+
+/**
+ * Description: Draw limits like the pots produce: 10%..100% of the full scale.
+ * Inputs:
+ * - rng: generator.
+ * Outputs: Returns the limits.
+ */
+static MotionLimits randomLimits(TestRandom& rng) {
+  MotionLimits limits;
+  limits.maxVel = 2000.0f * rng.range(0.1f, 1.0f);
+  limits.maxAccel = 8000.0f * rng.range(0.1f, 1.0f);
+  limits.maxJerk = 80000.0f * rng.range(0.1f, 1.0f);
+  return limits;
+}
+
+/**
+ * Description: Run random moves with mid-move retargets and limit changes.
+ * Inputs:
+ * - shape: ramp shape under test.
+ * Outputs: Returns the worst ratios to the limits and landing error.
+ */
+static LimitReport runRandomMoves(ProfileShape shape) {
+  TestRandom rng;
+  MotionProfile profile;
+  profile.setShape(shape);
+  uint32_t nowUs = 0xFFFF0000u; // crosses the 2^32 wrap early on
+  profile.reset(0.0f, nowUs);
+  LimitReport report;
+
+  MotionLimits limits = randomLimits(rng);
+  for (uint32_t move = 0; move < RANDOM_MOVES; move++) {
+    profile.moveTo(rng.range(-5000.0f, 5000.0f), limits, nowUs);
+    MotionSample jerkStart = profile.sample(nowUs);
+    uint32_t jerkElapsedUs = 0;
+    // Interrupt most moves: a retarget or a pot change at a random point.
+    const bool interrupt = move % 4 != 0;
+    const uint32_t interruptUs = (uint32_t)rng.range(1000.0f, 400000.0f);
+    uint32_t elapsedUs = 0;
+    while (!profile.isDone(nowUs) || elapsedUs == 0) {
+      nowUs += SAMPLE_US;
+      elapsedUs += SAMPLE_US;
+      const MotionSample s = profile.sample(nowUs);
+      // Limits only rise mid-move here, so the ones in force bound every sample.
+      const MotionLimits& in = profile.limits();
+      report.velRatio = fmaxf(report.velRatio, fabsf(s.vel) / in.maxVel);
+      report.accRatio = fmaxf(report.accRatio, fabsf(s.acc) / in.maxAccel);
+      jerkElapsedUs += SAMPLE_US;
+      if (shape == ProfileShape::SCurve && jerkElapsedUs >= JERK_WINDOW_US) {
+        const float jerk = fabsf(s.acc - jerkStart.acc) / ((float)jerkElapsedUs * 1.0e-6f);
+        report.jerkRatio = fmaxf(report.jerkRatio, jerk / in.maxJerk);
+        jerkStart = s;
+        jerkElapsedUs = 0;
+      }
+      if (interrupt && elapsedUs == interruptUs - interruptUs % SAMPLE_US) {
+        if (rng.range(0.0f, 1.0f) < 0.5f) {
+          profile.moveTo(rng.range(-5000.0f, 5000.0f), limits, nowUs);
+        } else {
+          // Raised only: lowering them mid-move ramps down (testLoweredLimits).
+          MotionLimits raised = limits;
+          raised.maxVel *= rng.range(1.0f, 1.5f);
+          raised.maxAccel *= rng.range(1.0f, 1.5f);
+          raised.maxJerk *= rng.range(1.0f, 1.5f);
+          limits = raised;
+          profile.setLimits(limits, nowUs);
+        }
+      }
+    }
+    report.landError = fmaxf(report.landError, fabsf(profile.sample(nowUs).pos - profile.target()));
+    if (move % 8 == 0) {
+      limits = randomLimits(rng); // next move starts at rest, so any limits apply
+    }
+  }
+  return report;
+}
+
+/**
+ * Description: Trapezoid and S-curve moves stay within their limits and land on target.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testLimitsNeverExceeded() {
+  const LimitReport trap = runRandomMoves(ProfileShape::Trapezoid);
+  TEST_CHECK(trap.velRatio <= 1.0f + LIMIT_SLACK);
+  TEST_CHECK(trap.accRatio <= 1.0f + LIMIT_SLACK);
+  TEST_CHECK(trap.landError < 1.0e-2f);
+
+  const LimitReport scurve = runRandomMoves(ProfileShape::SCurve);
+  TEST_CHECK(scurve.velRatio <= 1.0f + LIMIT_SLACK);
+  TEST_CHECK(scurve.accRatio <= 1.0f + LIMIT_SLACK);
+  TEST_CHECK(scurve.jerkRatio <= 1.0f + LIMIT_SLACK);
+  TEST_CHECK(scurve.landError < 1.0e-2f);
+  printf("limits: trapezoid vel %.4f acc %.4f, s-curve vel %.4f acc %.4f jerk %.4f (of limit)\n",
+         trap.velRatio, trap.accRatio, scurve.velRatio, scurve.accRatio, scurve.jerkRatio);
+}
+
+/**
+ * Description: Lowering the limits mid-move brings the motion down to them without a velocity step.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testLoweredLimits() {
+  MotionLimits fast;
+  fast.maxVel = 2000.0f;
+  fast.maxAccel = 8000.0f;
+  fast.maxJerk = 80000.0f;
+  MotionLimits slow = fast;
+  slow.maxVel = 500.0f;
+
+  MotionProfile profile;
+  uint32_t nowUs = 0;
+  profile.reset(0.0f, nowUs);
+  profile.moveTo(10000.0f, fast, nowUs);
+  nowUs += 1000000; // cruising at 2000
+  MotionSample prev = profile.sample(nowUs);
+  TEST_CHECK_NEAR(prev.vel, fast.maxVel, 1.0f);
+  profile.setLimits(slow, nowUs);
+  float maxStep = 0.0f;
+  float settledVel = 0.0f;
+  for (uint32_t i = 0; i < 5000; i++) {
+    nowUs += SAMPLE_US;
+    const MotionSample s = profile.sample(nowUs);
+    maxStep = fmaxf(maxStep, fabsf(s.vel - prev.vel));
+    if (i == 4000) settledVel = s.vel;
+    prev = s;
+  }
+  TEST_CHECK(maxStep <= fast.maxAccel * SAMPLE_US * 1.0e-6f * (1.0f + LIMIT_SLACK));
+  TEST_CHECK_NEAR(settledVel, slow.maxVel, 1.0f);
+  TEST_CHECK(profile.planCount() == 2);
+}
+
+/**
+ * Description: Measure replan throughput: a retarget every sample, as a live jog does.
+ * Inputs: None.
+ * Outputs: Records check results and prints replans per second.
+ */
+static void testReplansPerSecond() {
+  MotionLimits limits;
+  limits.maxVel = 2000.0f;
+  limits.maxAccel = 8000.0f;
+  limits.maxJerk = 80000.0f;
+  MotionProfile profile;
+  uint32_t nowUs = 0;
+  profile.reset(0.0f, nowUs);
+  float checksum = 0.0f;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < REPLAN_BENCH_COUNT; i++) {
+    nowUs += SAMPLE_US;
+    profile.moveTo((float)((i * 7919u) % 10000u) - 5000.0f, limits, nowUs);
+    checksum += profile.sample(nowUs + SAMPLE_US).pos;
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  TEST_CHECK(profile.planCount() == REPLAN_BENCH_COUNT);
+  TEST_CHECK(checksum == checksum); // no NaN from any plan
+  printf("replans: %u in %.3f s = %.0f replans/s (%.0f ns each)\n", REPLAN_BENCH_COUNT, seconds,
+         REPLAN_BENCH_COUNT / seconds, seconds * 1.0e9 / REPLAN_BENCH_COUNT);
+}
+
+/**
+ * Description: Run the motion profile cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testLimitsNeverExceeded();
+  testLoweredLimits();
+  testReplansPerSecond();
+  return testExitCode("test_motion_profile");
+}
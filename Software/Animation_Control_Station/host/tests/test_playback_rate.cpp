@@ -0,0 +1,125 @@
+// Variable-rate playback on the simulated clock: sweeping the rate keeps
+// show time continuous and slew-limited, and hours of playback at fixed
+// rates accumulate no drift against the ideal rate * real time, across
+// several 2^32 microsecond wraps of the real-time clock.
+#include "HostTest.h"
+#include "ShowEngine.h"
+#include "SimHal.h"
+
+static constexpr uint32_t SWEEP_TICK_US = 1000;
+static constexpr uint32_t SWEEP_HOLD_US = 150000;   // time at each swept rate
+static constexpr uint32_t DRIFT_TICK_US = 10000;
+static constexpr uint64_t DRIFT_PHASE_US = 3600ull * 1000000ull; // one hour per rate
+static constexpr uint32_t SETTLE_US = 2000000;      // longer than a full-range slew
+
+/**
+ * Description: Start an engine playing on an exact virtual clock.
+ * Inputs:
+ * - engine: engine to start.
+ * Outputs: Clock at 0 with free clock reads; engine playing at 1x.
+ */
+static void startEngine(ShowEngine& engine) {
+  simReset();
+  simSetClockReadNs(0); // real time moves only by the ticks below
+  engine.begin();
+  engine.setPlaying(true);
+}
+
+/**
+ * Description: Sweep the rate up and down with uneven ticks and check each tick's show-time step.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testRateSweep() {
+  ShowEngine engine;
+  startEngine(engine);
+  static const float RATES[] = {0.25f, 2.0f, 1.0f, 0.5f, 1.75f, 0.25f, 1.0f};
+
+  uint64_t prevShowUs = engine.currentTimeUs();
+  float prevRate = engine.playbackRate();
+  uint32_t worstStepErrorUs = 0;
+  float worstSlew = 0.0f;
+  uint32_t backwards = 0;
+  uint32_t tick = 0;
+  for (float rate : RATES) {
+    engine.setPlaybackRate(rate);
+    for (uint32_t heldUs = 0; heldUs < SWEEP_HOLD_US; tick++) {
+      // Loop passes are never exactly periodic.
+      const uint32_t dtUs = SWEEP_TICK_US / 2 + (tick * 7919u) % SWEEP_TICK_US;
+      simAdvanceUs(dtUs);
+      heldUs += dtUs;
+      engine.update();
+      const uint64_t showUs = engine.currentTimeUs();
+      const float applied = engine.playbackRate();
+      if (showUs < prevShowUs) {
+        backwards++;
+      }
+      // Trapezoidal integration of the rate over the tick, +-1 us of truncation.
+      const float expectedUs = 0.5f * (prevRate + applied) * (float)dtUs;
+      const float errorUs = fabsf((float)(showUs - prevShowUs) - expectedUs);
+      if (errorUs > (float)worstStepErrorUs) worstStepErrorUs = (uint32_t)ceilf(errorUs);
+      worstSlew = fmaxf(worstSlew, fabsf(applied - prevRate) / ((float)dtUs * 1.0e-6f));
+      prevShowUs = showUs;
+      prevRate = applied;
+    }
+  }
+  TEST_CHECK(backwards == 0);
+  TEST_CHECK(worstStepErrorUs <= 1);
+  // RATE_SLEW_Q16_PER_SEC is 1x per second; one Q16 step of carry-over allowed.
+  TEST_CHECK(worstSlew <= 1.0f + (1.0f / 65536.0f) / ((float)(SWEEP_TICK_US / 2) * 1.0e-6f));
+  // Holds are shorter than most slews; given time, the last target is met exactly.
+  for (uint32_t settledUs = 0; settledUs < SETTLE_US; settledUs += SWEEP_TICK_US) {
+    simAdvanceUs(SWEEP_TICK_US);
+    engine.update();
+  }
+  TEST_CHECK(engine.playbackRate() == 1.0f);
+}
+
+/**
+ * Description: Play an hour at each of several rates and compare show time with rate * real time.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testDriftOverHours() {
+  ShowEngine engine;
+  startEngine(engine);
+  static const float RATES[] = {1.0f, 0.25f, 2.0f, 0.7f};
+
+  for (float rate : RATES) {
+    engine.setPlaybackRate(rate);
+    for (uint32_t settledUs = 0; settledUs < SETTLE_US; settledUs += DRIFT_TICK_US) {
+      simAdvanceUs(DRIFT_TICK_US);
+      engine.update();
+    }
+    const uint32_t rateQ16 = (uint32_t)(rate * (float)ShowEngine::RATE_ONE_Q16);
+    TEST_CHECK_NEAR(engine.playbackRate(), (float)rateQ16 / (float)ShowEngine::RATE_ONE_Q16, 0.0f);
+
+    const uint64_t startShowUs = engine.currentTimeUs();
+    for (uint64_t elapsedUs = 0; elapsedUs < DRIFT_PHASE_US; elapsedUs += DRIFT_TICK_US) {
+      simAdvanceUs(DRIFT_TICK_US);
+      engine.update();
+    }
+    // Exact against the applied Q16 rate (only the final >> 16 truncates)...
+    const uint64_t expectedUs = (DRIFT_PHASE_US * rateQ16) >> 16;
+    const int64_t driftUs = (int64_t)(engine.currentTimeUs() - startShowUs) - (int64_t)expectedUs;
+    TEST_CHECK(driftUs >= -1 && driftUs <= 1);
+    // ...and within the Q16 quantization of the requested rate (< 16 ppm at 0.25x).
+    const double ideal = (double)DRIFT_PHASE_US * rate;
+    const double ppm = fabs((double)(engine.currentTimeUs() - startShowUs) - ideal) / ideal * 1.0e6;
+    TEST_CHECK(ppm < 16.0);
+    printf("drift: %.2fx for 1 h: %lld us against Q16 rate, %.2f ppm against requested\n",
+           rate, (long long)driftUs, ppm);
+  }
+  TEST_CHECK(simNowNs() / 1000u > 3ull * 0x100000000ull); // the 32-bit real-time clock wrapped 3 times
+}
+
+/**
+ * Description: Run the playback rate cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testRateSweep();
+  testDriftOverHours();
+  return testExitCode("test_playback_rate");
+}
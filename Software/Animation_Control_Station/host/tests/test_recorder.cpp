@@ -0,0 +1,191 @@
+// Live recording: synthetic input traces of the kinds a puppeteer produces
+// (jog sweeps, hold-and-move, a noisy pot, fast flicks) are recorded at the
+// control-tick rate. The take must stay within the tolerance of every
+// sample, and the report shows how far the swinging-door fit compresses
+// each trace. An overdub must keep the original keys outside the punch.
+#include "HostTest.h"
+#include "Recorder.h"
+
+#include <math.h>
+#include <vector>
+
+static constexpr uint32_t TRACE_MS = 60000;
+static constexpr float TOLERANCE = 2.0f; // RECORD_DEFAULT_TOLERANCE
+
+// A recorded input: one value per show millisecond from startMs.
+struct TestTrace {
+  const char* name;
+  uint32_t startMs;
+  std::vector<float> values;
+  float minRatio; // samples per key the fit must reach on this trace
+};
+
+/**
+ * Description: Deterministic noise in [-amplitude, amplitude].
+ * Inputs:
+ * - state: generator state.
+ * - amplitude: noise amplitude.
+ * Outputs: Returns the next noise value.
+ */
+static float noise(uint32_t& state, float amplitude) {
+  state = state * 1664525u + 1013904223u;
+  return amplitude * ((float)(state >> 8) / 8388608.0f - 1.0f);
+}
+
+/**
+ * Description: Build the input traces.
+ * Inputs: None.
+ * Outputs: Returns one trace per input style.
+ */
+static std::vector<TestTrace> buildTraces() {
+  std::vector<TestTrace> traces;
+  uint32_t rng = 99;
+
+  TestTrace sweep{"jog sweep", 0, {}, 20.0f};
+  for (uint32_t t = 0; t < TRACE_MS; t++) {
+    const float s = (float)t * 1.0e-3f;
+    sweep.values.push_back(1500.0f * sinf(0.4f * s) + 400.0f * sinf(1.3f * s + 1.0f));
+  }
+  traces.push_back(sweep);
+
+  // Moves of random size and speed between holds, like a head turn and look.
+  TestTrace holds{"hold and move", 0, {}, 100.0f};
+  float pos = 0.0f;
+  while (holds.values.size() < TRACE_MS) {
+    const float target = noise(rng, 2000.0f);
+    const uint32_t moveMs = 200 + (uint32_t)fabsf(noise(rng, 800.0f));
+    for (uint32_t i = 0; i < moveMs; i++) {
+      const float u = (float)i / (float)moveMs;
+      holds.values.push_back(pos + (target - pos) * u * u * (3.0f - 2.0f * u));
+    }
+    pos = target;
+    const uint32_t holdMs = 500 + (uint32_t)fabsf(noise(rng, 2500.0f));
+    holds.values.insert(holds.values.end(), holdMs, pos);
+  }
+  holds.values.resize(TRACE_MS);
+  traces.push_back(holds);
+
+  // A pot scaled to +-1000 units: slow sweep plus ADC noise near the tolerance.
+  TestTrace pot{"noisy pot", 0, {}, 3.0f};
+  for (uint32_t t = 0; t < TRACE_MS; t++) {
+    pot.values.push_back(1000.0f * sinf((float)t * 2.0e-4f) + noise(rng, 1.5f));
+  }
+  traces.push_back(pot);
+
+  // Fast flicks: full-range moves in 50 ms.
+  TestTrace flicks{"flicks", 5000, {}, 10.0f};
+  for (uint32_t t = 0; t < TRACE_MS; t++) {
+    const uint32_t phase = t % 1000;
+    const float u = (phase < 50) ? (float)phase / 50.0f : 1.0f;
+    const float from = ((t / 1000) % 2) ? 2000.0f : -2000.0f;
+    flicks.values.push_back(from + (-2.0f * from) * u * u * (3.0f - 2.0f * u));
+  }
+  traces.push_back(flicks);
+  return traces;
+}
+
+/**
+ * Description: Largest deviation of a track from a trace at every sample.
+ * Inputs:
+ * - track: recorded take.
+ * - trace: input trace.
+ * Outputs: Returns the worst |track - input|.
+ */
+static float measureError(const Track& track, const TestTrace& trace) {
+  TrackCursor cursor;
+  track.seek(cursor, trace.startMs);
+  float worst = 0.0f;
+  for (uint32_t i = 0; i < trace.values.size(); i++) {
+    const uint32_t tMs = trace.startMs + i;
+    track.advance(cursor, tMs);
+    const float pos = Track::sample(cursor, (uint64_t)tMs * 1000u).pos;
+    worst = fmaxf(worst, fabsf(pos - trace.values[i]));
+  }
+  return worst;
+}
+
+/**
+ * Description: Record each trace and report compression ratio and max error.
+ * Inputs: None.
+ * Outputs: Records check results and prints one line per trace.
+ */
+static void testCompressionAndError() {
+  static Recorder recorder;
+  for (const TestTrace& trace : buildTraces()) {
+    TEST_CHECK(recorder.start(0, nullptr, trace.startMs, TOLERANCE));
+    for (uint32_t i = 0; i < trace.values.size(); i++) {
+      recorder.sample(trace.startMs + i, trace.values[i]);
+    }
+    TEST_CHECK(recorder.stop());
+    const Track* take = recorder.take(0);
+    TEST_CHECK(take != nullptr);
+    if (!take) {
+      continue;
+    }
+    const RecordStats& st = recorder.stats();
+    const float error = measureError(*take, trace);
+    const float ratio = (float)st.samples / (float)take->keyCount();
+    printf("record: %-13s %6lu samples -> %5lu keys, ratio %6.1f, max error %.3f (tolerance %.1f)\n",
+           trace.name, (unsigned long)st.samples, (unsigned long)take->keyCount(), ratio, error, TOLERANCE);
+    TEST_CHECK(st.samples == trace.values.size());
+    TEST_CHECK(!st.overflow);
+    TEST_CHECK(error <= TOLERANCE);
+    TEST_CHECK(st.maxError <= TOLERANCE);
+    TEST_CHECK_NEAR(st.maxError, error, 0.01f); // the recorder's own report agrees
+    TEST_CHECK(ratio >= trace.minRatio);
+    recorder.discard(0);
+  }
+}
+
+/**
+ * Description: An overdub replaces only the punched span of the original track.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testOverdubKeepsOriginal() {
+  // Original: a key every second, alternating +-1000.
+  std::vector<TrackKey> keys(64);
+  std::vector<TrackCheckpoint> checkpoints(Track::checkpointsFor(64));
+  TrackBuilder builder;
+  builder.begin(keys.data(), (uint32_t)keys.size(), checkpoints.data(), (uint32_t)checkpoints.size());
+  for (uint32_t s = 0; s <= 30; s++) {
+    TEST_CHECK(builder.append(s * 1000, (s % 2) ? 1000 : -1000, Ease::Linear));
+  }
+  Track original;
+  TEST_CHECK(original.attach(builder.keys(), builder.keyCount(), builder.checkpoints(), builder.checkpointCount()));
+
+  static Recorder recorder;
+  TEST_CHECK(recorder.start(2, &original, 10000, TOLERANCE));
+  for (uint32_t t = 10000; t <= 20000; t++) {
+    recorder.sample(t, 0.0f);
+  }
+  TEST_CHECK(recorder.stop());
+  const Track* take = recorder.take(2);
+  TEST_CHECK(take != nullptr);
+  if (!take) {
+    return;
+  }
+  TrackCursor a;
+  TrackCursor b;
+  for (uint32_t t : {0u, 3500u, 9000u, 21000u, 25500u, 30000u}) {
+    original.seek(a, t);
+    take->seek(b, t);
+    TEST_CHECK_NEAR(Track::sample(b, (uint64_t)t * 1000u).pos, Track::sample(a, (uint64_t)t * 1000u).pos, 0.01f);
+  }
+  for (uint32_t t : {10000u, 15000u, 20000u}) {
+    take->seek(b, t);
+    TEST_CHECK_NEAR(Track::sample(b, (uint64_t)t * 1000u).pos, 0.0f, TOLERANCE);
+  }
+  recorder.discard(2);
+}
+
+/**
+ * Description: Run the recorder cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testCompressionAndError();
+  testOverdubKeepsOriginal();
+  return testExitCode("test_recorder");
+}
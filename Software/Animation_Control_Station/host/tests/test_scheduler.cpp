@@ -0,0 +1,198 @@
+// Loop scheduler on a virtual clock: tasks "run" by moving the clock
+// forward by their cost, so ordering, lateness, deadline misses, skipped
+// releases and forced background runs come out exact, including across the
+// 2^32 microsecond wrap.
+#include "HostTest.h"
+#include "Scheduler.h"
+
+#include <string>
+
+static constexpr uint32_t IDLE_STEP_US = 10; // clock step when a pass ran nothing
+
+static uint32_t g_nowUs = 0;
+
+// A task body: costs runUs of virtual time and logs its name.
+struct TestJob {
+  char name = '?';
+  uint32_t runUs = 0;
+  uint32_t nextRunUs = 0;   // cost of the next run only, if non-zero
+  uint32_t runs = 0;
+  std::string* log = nullptr;
+};
+
+/**
+ * Description: Virtual clock for the scheduler.
+ * Inputs: None.
+ * Outputs: Returns g_nowUs.
+ */
+static uint32_t testClock() { return g_nowUs; }
+
+/**
+ * Description: Task body that advances the virtual clock.
+ * Inputs:
+ * - context: the TestJob.
+ * Outputs: Moves the clock by the job's cost and records the run.
+ */
+static void testJobFn(void* context) {
+  TestJob& job = *static_cast<TestJob*>(context);
+  job.runs++;
+  if (job.log) {
+    *job.log += job.name;
+  }
+  g_nowUs += job.nextRunUs ? job.nextRunUs : job.runUs;
+  job.nextRunUs = 0;
+}
+
+/**
+ * Description: Run scheduler passes until the clock reaches a time.
+ * Inputs:
+ * - sched: scheduler to drive.
+ * - untilUs: clock value to stop at (wrap-safe).
+ * Outputs: Idle passes step the clock by IDLE_STEP_US.
+ */
+static void runUntil(Scheduler& sched, uint32_t untilUs) {
+  while ((int32_t)(g_nowUs - untilUs) < 0) {
+    const uint32_t before = g_nowUs;
+    sched.runOnce();
+    if (g_nowUs == before) {
+      g_nowUs += IDLE_STEP_US;
+    }
+  }
+}
+
+/**
+ * Description: Due tasks run by priority, and a higher one released during a lower one's run goes first next pass.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testPriorityOrder() {
+  g_nowUs = 1000;
+  std::string log;
+  TestJob low{'L', 10};
+  TestJob mid{'M', 10};
+  TestJob high{'H', 10};
+  low.log = mid.log = high.log = &log;
+  Scheduler sched;
+  sched.begin(testClock);
+  TEST_CHECK(sched.addTask("low", testJobFn, &low, 1000, 2, 100));
+  TEST_CHECK(sched.addTask("high", testJobFn, &high, 1000, 0, 100));
+  TEST_CHECK(sched.addTask("mid", testJobFn, &mid, 1000, 1, 100));
+  sched.runOnce();
+  TEST_CHECK(log == "HML");
+
+  // Low runs past the next release of all three: high leads again.
+  log.clear();
+  g_nowUs = 2000;
+  sched.runOnce(); // H M L at 2000..2030
+  low.nextRunUs = 1500;
+  g_nowUs = 3000;
+  sched.runOnce(); // H M L, L ends at 4520
+  sched.runOnce();
+  TEST_CHECK(log == "HMLHMLHML");
+  TEST_CHECK(sched.task(0).stats.maxLateUs == 4520 - 4000);
+  TEST_CHECK(sched.task(2).stats.misses == 1);
+  TEST_CHECK(sched.task(2).stats.overruns == 1);
+}
+
+/**
+ * Description: Releases keep their period across the 2^32 microsecond clock wrap.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testClockWrap() {
+  g_nowUs = 0xFFFFFFFFu - 2500u;
+  const uint32_t startUs = g_nowUs;
+  TestJob tick{'T', 0};
+  TestJob idle{'I', 0};
+  Scheduler sched;
+  sched.begin(testClock);
+  TEST_CHECK(sched.addTask("tick", testJobFn, &tick, 1000, 0, 100));
+  TEST_CHECK(sched.addBackground("idle", testJobFn, &idle, 20, 100000));
+  runUntil(sched, startUs + 10000u);
+  const TaskStats& s = sched.task(0).stats;
+  TEST_CHECK(tick.runs == 10);
+  TEST_CHECK(s.misses == 0);
+  TEST_CHECK(s.skipped == 0);
+  TEST_CHECK(s.maxLateUs == 0);
+  TEST_CHECK(sched.task(0).releaseUs == startUs + 10000u);
+  TEST_CHECK(idle.runs > 0);
+  TEST_CHECK(sched.task(1).stats.misses == 0);
+  TEST_CHECK(sched.statsElapsedUs() == 10000u);
+}
+
+/**
+ * Description: A run past the deadline counts one miss and drops the whole periods it fell behind.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testMissAndSkip() {
+  g_nowUs = 0;
+  TestJob task{'T', 10};
+  Scheduler sched;
+  sched.begin(testClock);
+  TEST_CHECK(sched.addTask("task", testJobFn, &task, 1000, 0, 100));
+  task.nextRunUs = 3500;
+  sched.runOnce(); // runs 0..3500: releases 1000 and 2000 dropped, next 3000
+  const TaskStats& s = sched.task(0).stats;
+  TEST_CHECK(s.misses == 1);
+  TEST_CHECK(s.skipped == 2);
+  TEST_CHECK(s.overruns == 1);
+  TEST_CHECK(sched.task(0).releaseUs == 3000);
+
+  sched.runOnce(); // phase kept: runs 500 late
+  TEST_CHECK(task.runs == 2);
+  TEST_CHECK(s.maxLateUs == 500);
+  TEST_CHECK(s.misses == 1);
+  runUntil(sched, 10000);
+  TEST_CHECK(task.runs == 8); // 0, 3500, then 4000..9000
+  TEST_CHECK(s.misses == 1 && s.skipped == 2);
+}
+
+/**
+ * Description: A background job that never fits the idle time is forced after maxWaitUs; one that fits is not.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testForcedBackground() {
+  static constexpr uint32_t MAX_WAIT_US = 5000;
+  g_nowUs = 0;
+  TestJob busy{'B', 950};  // leaves 50 us per 1 ms period
+  TestJob job{'J', 30};
+  Scheduler sched;
+  sched.begin(testClock);
+  TEST_CHECK(sched.addTask("busy", testJobFn, &busy, 1000, 0, 1000));
+  TEST_CHECK(sched.addBackground("job", testJobFn, &job, 200, MAX_WAIT_US));
+  runUntil(sched, MAX_WAIT_US - 1);
+  TEST_CHECK(job.runs == 0);
+  runUntil(sched, 4 * MAX_WAIT_US + 1000);
+  const TaskStats& s = sched.task(1).stats;
+  TEST_CHECK(job.runs >= 3);
+  TEST_CHECK(s.misses == job.runs);
+  TEST_CHECK(s.maxLateUs < 1000); // forced on the first pass after the wait
+  TEST_CHECK(sched.task(0).stats.misses == 0);
+
+  g_nowUs = 0;
+  TestJob light{'L', 100}; // leaves 900 us per period
+  TestJob fits{'F', 30};
+  Scheduler idle;
+  idle.begin(testClock);
+  TEST_CHECK(idle.addTask("light", testJobFn, &light, 1000, 0, 1000));
+  TEST_CHECK(idle.addBackground("fits", testJobFn, &fits, 200, MAX_WAIT_US));
+  runUntil(idle, 4 * MAX_WAIT_US);
+  TEST_CHECK(fits.runs > 4 * MAX_WAIT_US / 1000);
+  TEST_CHECK(idle.task(1).stats.misses == 0);
+  TEST_CHECK(idle.task(0).stats.misses == 0);
+}
+
+/**
+ * Description: Run the scheduler cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testPriorityOrder();
+  testClockWrap();
+  testMissAndSkip();
+  testForcedBackground();
+  return testExitCode("test_scheduler");
+}
@@ -0,0 +1,284 @@
+// Show engine: limits derived from the show and from track overrides
+// (recorded takes) reach the position clamp, in both evaluate() and
+// preview(), and the playback rate ceiling; a blended show switch reports
+// the velocity of the position it outputs and starts the new show at the
+// time played past the switch point; a seek during playback starts
+// its approach from the moving setpoint, and never targets a position
+// outside the limits.
+#include "HostTest.h"
+#include "ShowEngine.h"
+#include "SimHal.h"
+#include "ShowWriter.h"
+#include "TrackBuilder.h"
+
+#include <vector>
+
+static constexpr uint32_t TEST_LENGTH_MS = 10000;
+
+// One linear ramp, kept alive for the Track or Show that points into it.
+struct TestRamp {
+  std::vector<TrackKey> keys;
+  std::vector<TrackCheckpoint> checkpoints;
+  Track track;
+  uint32_t keyCount = 0;
+  uint32_t checkpointCount = 0;
+
+  /**
+   * Description: Build a ramp from one value to another over TEST_LENGTH_MS.
+   * Inputs:
+   * - from: value at time 0.
+   * - to: value at TEST_LENGTH_MS.
+   * Outputs: Returns false if the builder or the track rejected the keys.
+   */
+  bool build(int32_t from, int32_t to) {
+    keys.resize(16);
+    checkpoints.resize(Track::checkpointsFor(16));
+    TrackBuilder builder;
+    builder.begin(keys.data(), (uint32_t)keys.size(), checkpoints.data(), (uint32_t)checkpoints.size());
+    if (!builder.append(0, from, Ease::Linear) || !builder.append(TEST_LENGTH_MS, to, Ease::Linear)) {
+      return false;
+    }
+    keyCount = builder.keyCount();
+    checkpointCount = builder.checkpointCount();
+    return track.attach(keys.data(), keyCount, checkpoints.data(), checkpointCount);
+  }
+};
+
+// A one-channel show image, loaded and analyzed.
+struct TestShow {
+  TestRamp ramp;
+  std::vector<uint32_t> words; // 4-byte aligned image storage
+  std::vector<KinematicEnvelope> blocks;
+  Show show;
+
+  /**
+   * Description: Build, load and analyze a show with one ramp channel.
+   * Inputs:
+   * - from: value at time 0.
+   * - to: value at the end of the show.
+   * Outputs: Returns false if any step failed.
+   */
+  bool build(int32_t from, int32_t to) {
+    if (!ramp.build(from, to)) {
+      return false;
+    }
+    ShowWriterTrack track;
+    track.keys = ramp.keys.data();
+    track.keyCount = ramp.keyCount;
+    track.checkpoints = ramp.checkpoints.data();
+    track.checkpointCount = ramp.checkpointCount;
+    words.assign((ShowWriter::imageSize(&track, 1, 0) + 3) / 4, 0);
+    uint8_t* image = reinterpret_cast<uint8_t*>(words.data());
+    const size_t length = ShowWriter::write(image, words.size() * 4, &track, 1, TEST_LENGTH_MS, nullptr, 0);
+    if (length == 0 || !show.load(image, length)) {
+      return false;
+    }
+    blocks.resize(show.envelopeBlocksNeeded());
+    return show.analyze(blocks.data(), (uint32_t)blocks.size());
+  }
+};
+
+/**
+ * Description: A take outside the position limits is clamped, and a take faster
+ *              than the show lowers the rate ceiling until it is removed.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testOverrideLimits() {
+  TestShow show;
+  TEST_CHECK(show.build(0, 500)); // 50 units/s, inside the limits
+
+  ChannelLimits limits[SHOW_MAX_CHANNELS];
+  limits[0].minPos = -1000.0f;
+  limits[0].maxPos = 1000.0f;
+  limits[0].maxVel = 100.0f;
+
+  ShowEngine engine;
+  engine.begin();
+  engine.setChannelLimits(limits);
+  engine.setShow(&show.show);
+  TEST_CHECK_NEAR(engine.rateCeiling(), 2.0f, 0.01f);
+
+  TestRamp take;
+  TEST_CHECK(take.build(2000, 5000)); // 300 units/s, all above maxPos
+  engine.setTrackOverride(0, &take.track);
+  TEST_CHECK_NEAR(engine.rateCeiling(), 1.0f / 3.0f, 0.01f);
+  engine.evaluate();
+  TEST_CHECK(engine.setpoint(0).pos == 1000.0f);
+  TEST_CHECK(engine.preview(0, 0).pos == 1000.0f); // what armSyncStart() sends
+  TEST_CHECK(engine.preview(0, 5000000).pos == 1000.0f);
+
+  engine.setTrackOverride(0, nullptr);
+  TEST_CHECK_NEAR(engine.rateCeiling(), 2.0f, 0.01f);
+  engine.evaluate();
+  TEST_CHECK_NEAR(engine.setpoint(0).pos, 0.0f, 0.5f);
+}
+
+/**
+ * Description: The velocity during a switch blend is the derivative of the blended position.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testBlendVelocity() {
+  static constexpr uint32_t BLEND_MS = 1000;
+  static constexpr uint32_t STEP_US = 10000;
+  TestShow from;
+  TestShow to;
+  TEST_CHECK(from.build(0, 0));
+  TEST_CHECK(to.build(1000, 1000)); // both at rest: all motion comes from the fade
+
+  simReset();
+  ShowEngine engine;
+  engine.begin();
+  engine.setShow(&from.show);
+  engine.evaluate();
+  engine.queueSwitch(&to.show, 0, BLEND_MS);
+  engine.evaluate();
+  TEST_CHECK(engine.show() == &to.show);
+
+  ChannelSetpoint prev = engine.setpoint(0);
+  float peakVel = 0.0f;
+  for (uint32_t elapsedUs = STEP_US; elapsedUs < BLEND_MS * 1000u; elapsedUs += STEP_US) {
+    simAdvanceUs(STEP_US);
+    engine.evaluate();
+    const ChannelSetpoint sp = engine.setpoint(0);
+    const float slope = (sp.pos - prev.pos) / ((float)STEP_US * 1.0e-6f);
+    TEST_CHECK_NEAR(0.5f * (sp.vel + prev.vel), slope, 5.0f);
+    peakVel = fmaxf(peakVel, sp.vel);
+    prev = sp;
+  }
+  TEST_CHECK_NEAR(peakVel, 1500.0f, 5.0f); // 1000 units * 1.5 / 1 s at u = 0.5
+}
+
+/**
+ * Description: A switch reached mid-tick starts the new show at the time played past the switch point.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testSwitchCarriesOvershoot() {
+  static constexpr uint32_t STEP_US = 7000; // ticks never land on the switch point
+  TestShow from;
+  TestShow to;
+  TEST_CHECK(from.build(0, 0));
+  TEST_CHECK(to.build(0, 1000)); // 0.1 units per ms
+
+  for (uint32_t atMs : {5000u, ShowEngine::SWITCH_AT_END}) {
+    simReset();
+    simSetClockReadNs(0);
+    ShowEngine engine;
+    engine.begin();
+    engine.setShow(&from.show);
+    engine.setPlaying(true);
+    engine.queueSwitch(&to.show, atMs, 0);
+    const uint64_t switchUs = (uint64_t)((atMs == ShowEngine::SWITCH_AT_END) ? TEST_LENGTH_MS : atMs) * 1000u;
+    uint64_t playedUs = 0;
+    while (engine.show() != &to.show && playedUs < 2 * switchUs) {
+      simAdvanceUs(STEP_US);
+      playedUs += STEP_US;
+      engine.update();
+      engine.evaluate();
+    }
+    TEST_CHECK(engine.show() == &to.show);
+    TEST_CHECK(playedUs > switchUs);
+    TEST_CHECK(engine.currentTimeUs() == playedUs - switchUs);
+    TEST_CHECK_NEAR(engine.setpoint(0).pos, (float)(playedUs - switchUs) * 1.0e-4f, 0.5f);
+  }
+}
+
+/**
+ * Description: Seeking while playing keeps the setpoint velocity continuous.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testSeekWhilePlaying() {
+  static constexpr uint32_t STEP_US = 1000;
+  TestShow show;
+  TEST_CHECK(show.build(0, 1000)); // 100 units/s
+
+  simReset();
+  ShowEngine engine;
+  engine.begin();
+  engine.setShow(&show.show);
+  engine.setPlaying(true);
+  for (uint32_t i = 0; i < 5000; i++) {
+    simAdvanceUs(STEP_US);
+    engine.update();
+    engine.evaluate();
+  }
+  const ChannelSetpoint before = engine.setpoint(0);
+  TEST_CHECK_NEAR(before.vel, 100.0f, 0.5f);
+
+  MotionLimits approach;
+  approach.maxVel = 500.0f;
+  approach.maxAccel = 1000.0f;
+  approach.maxJerk = 10000.0f;
+  engine.seek(1000, approach);
+  TEST_CHECK(engine.isApproaching());
+  float prevVel = before.vel;
+  float maxVelStep = 0.0f;
+  uint32_t ticks = 0;
+  while (engine.isApproaching() && ticks < 10000) {
+    simAdvanceUs(STEP_US);
+    engine.update();
+    engine.evaluate();
+    maxVelStep = fmaxf(maxVelStep, fabsf(engine.setpoint(0).vel - prevVel));
+    prevVel = engine.setpoint(0).vel;
+    ticks++;
+  }
+  TEST_CHECK(!engine.isApproaching());
+  // Jerk-limited: at most 1000 units/s^2 * 1 ms per tick, never a step to 0.
+  TEST_CHECK(maxVelStep <= approach.maxAccel * STEP_US * 1.0e-6f + 0.01f);
+  TEST_CHECK_NEAR(engine.setpoint(0).pos, 100.0f, 1.0f);
+}
+
+/**
+ * Description: Seeking to a time whose sample is past the position limits approaches the limit, not the sample.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testSeekIntoClampedRegion() {
+  TestShow show;
+  TEST_CHECK(show.build(0, 3000)); // passes maxPos at 3.33 s
+
+  ChannelLimits limits[SHOW_MAX_CHANNELS];
+  limits[0].minPos = -1000.0f;
+  limits[0].maxPos = 1000.0f;
+
+  simReset();
+  ShowEngine engine;
+  engine.begin();
+  engine.setChannelLimits(limits);
+  engine.setShow(&show.show);
+  engine.evaluate();
+
+  MotionLimits approach;
+  approach.maxVel = 5000.0f;
+  approach.maxAccel = 20000.0f;
+  approach.maxJerk = 200000.0f;
+  engine.seek(8000, approach); // track value 2400
+  float highest = engine.setpoint(0).pos;
+  uint32_t ticks = 0;
+  while (engine.isApproaching() && ticks < 10000) {
+    simAdvanceUs(1000);
+    engine.evaluate();
+    highest = fmaxf(highest, engine.setpoint(0).pos);
+    ticks++;
+  }
+  TEST_CHECK(!engine.isApproaching());
+  TEST_CHECK(highest <= limits[0].maxPos);
+  TEST_CHECK_NEAR(engine.setpoint(0).pos, limits[0].maxPos, 0.01f);
+}
+
+/**
+ * Description: Run the engine cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testOverrideLimits();
+  testBlendVelocity();
+  testSwitchCarriesOvershoot();
+  testSeekWhilePlaying();
+  testSeekIntoClampedRegion();
+  return testExitCode("test_show_engine");
+}
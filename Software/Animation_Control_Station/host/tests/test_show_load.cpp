@@ -0,0 +1,177 @@
+// Show loader: images whose checkpoint index does not match the keys
+// (corrupt or hostile SD files) are rejected before any track is used,
+// and the stepped load/analysis gives the same result as the one-call path.
+#include "HostTest.h"
+#include "Show.h"
+#include "ShowWriter.h"
+#include "TrackBuilder.h"
+
+#include <vector>
+
+static constexpr uint32_t TEST_KEYS = 200;
+static constexpr uint32_t TEST_KEY_SPACING_MS = 100;
+
+// A two-channel show image built with the firmware's own writer.
+struct TestImage {
+  std::vector<TrackKey> keys[2];
+  std::vector<TrackCheckpoint> checkpoints[2];
+  std::vector<uint32_t> words; // 4-byte aligned image storage
+  size_t length = 0;
+
+  /**
+   * Description: Access the serialized image.
+   * Inputs: None.
+   * Outputs: Returns the first image byte.
+   */
+  uint8_t* bytes() { return reinterpret_cast<uint8_t*>(words.data()); }
+
+  /**
+   * Description: Find a checkpoint inside the serialized image.
+   * Inputs:
+   * - channel: channel index.
+   * - index: checkpoint index.
+   * Outputs: Returns the checkpoint as Show::load() will read it.
+   */
+  TrackCheckpoint* checkpoint(uint8_t channel, uint32_t index) {
+    const ShowTrackEntry* entries = reinterpret_cast<const ShowTrackEntry*>(bytes() + sizeof(ShowFileHeader));
+    return reinterpret_cast<TrackCheckpoint*>(bytes() + entries[channel].checkpointOffset) + index;
+  }
+};
+
+/**
+ * Description: Build a valid two-channel image.
+ * Inputs:
+ * - image: receives the tracks and the serialized image.
+ * Outputs: Returns false if the writer failed.
+ */
+static bool buildImage(TestImage& image) {
+  ShowWriterTrack tracks[2];
+  for (uint8_t ch = 0; ch < 2; ch++) {
+    image.keys[ch].resize(TEST_KEYS);
+    image.checkpoints[ch].resize(Track::checkpointsFor(TEST_KEYS));
+    TrackBuilder builder;
+    builder.begin(image.keys[ch].data(), TEST_KEYS, image.checkpoints[ch].data(),
+                  (uint32_t)image.checkpoints[ch].size());
+    for (uint32_t i = 0; i < TEST_KEYS; i++) {
+      const int32_t value = (int32_t)((i * 37u + ch * 11u) % 500u) - 250;
+      if (!builder.append(i * TEST_KEY_SPACING_MS, value, Ease::Smooth)) {
+        return false;
+      }
+    }
+    tracks[ch].keys = builder.keys();
+    tracks[ch].keyCount = builder.keyCount();
+    tracks[ch].checkpoints = builder.checkpoints();
+    tracks[ch].checkpointCount = builder.checkpointCount();
+  }
+  const uint32_t durationMs = (TEST_KEYS - 1) * TEST_KEY_SPACING_MS;
+  const size_t size = ShowWriter::imageSize(tracks, 2, 0);
+  image.words.assign((size + 3) / 4, 0);
+  image.length = ShowWriter::write(image.bytes(), image.words.size() * 4, tracks, 2, durationMs, nullptr, 0);
+  return image.length > 0;
+}
+
+/**
+ * Description: A well-formed image loads, analyzes and seeks.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testValidImage() {
+  TestImage image;
+  TEST_CHECK(buildImage(image));
+  Show show;
+  TEST_CHECK(show.load(image.bytes(), image.length));
+  std::vector<KinematicEnvelope> blocks(show.envelopeBlocksNeeded());
+  TEST_CHECK(show.analyze(blocks.data(), (uint32_t)blocks.size()));
+  TrackCursor cursor;
+  show.track(1).seek(cursor, 150 * TEST_KEY_SPACING_MS);
+  TEST_CHECK(cursor.index == 150);
+}
+
+/**
+ * Description: A load and analysis split into bounded steps matches the one-call result.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testSteppedLoad() {
+  TestImage image;
+  TEST_CHECK(buildImage(image));
+  Show whole;
+  TEST_CHECK(whole.load(image.bytes(), image.length));
+  std::vector<KinematicEnvelope> wholeBlocks(whole.envelopeBlocksNeeded());
+  TEST_CHECK(whole.analyze(wholeBlocks.data(), (uint32_t)wholeBlocks.size()));
+
+  Show stepped;
+  TEST_CHECK(stepped.beginLoad(image.bytes(), image.length));
+  uint32_t loadSteps = 1;
+  while (stepped.loadStep() == ShowStep::Busy) {
+    TEST_CHECK(!stepped.isLoaded());
+    loadSteps++;
+  }
+  TEST_CHECK(stepped.isLoaded());
+  TEST_CHECK(loadSteps == 3); // one per channel, then the events
+  std::vector<KinematicEnvelope> steppedBlocks(stepped.envelopeBlocksNeeded());
+  TEST_CHECK(stepped.beginAnalyze(steppedBlocks.data(), (uint32_t)steppedBlocks.size()));
+  uint32_t analyzeSteps = 1;
+  while (stepped.analyzeStep(7) == ShowStep::Busy) {
+    TEST_CHECK(!stepped.isAnalyzed());
+    analyzeSteps++;
+  }
+  TEST_CHECK(stepped.isAnalyzed());
+  TEST_CHECK(analyzeSteps >= 2 * TEST_KEYS / 7);
+  for (uint8_t ch = 0; ch < 2; ch++) {
+    const KinematicEnvelope& a = whole.envelope(ch);
+    const KinematicEnvelope& b = stepped.envelope(ch);
+    TEST_CHECK(a.minPos == b.minPos && a.maxPos == b.maxPos);
+    TEST_CHECK(a.maxVel == b.maxVel && a.maxAccel == b.maxAccel && a.maxJerk == b.maxJerk);
+  }
+  for (size_t i = 0; i < wholeBlocks.size(); i++) {
+    TEST_CHECK(wholeBlocks[i].maxJerk == steppedBlocks[i].maxJerk);
+  }
+}
+
+/**
+ * Description: Corrupt one checkpoint field and check the load fails.
+ * Inputs:
+ * - channel: channel to corrupt.
+ * - index: checkpoint to corrupt.
+ * - corrupt: changes the checkpoint.
+ * Outputs: Records check results.
+ */
+template <typename Corrupt>
+static void expectRejected(uint8_t channel, uint32_t index, Corrupt corrupt) {
+  TestImage image;
+  TEST_CHECK(buildImage(image));
+  corrupt(*image.checkpoint(channel, index));
+  Show show;
+  TEST_CHECK(!show.load(image.bytes(), image.length));
+  TEST_CHECK(!show.isLoaded());
+  TEST_CHECK(show.channelCount() == 0);
+}
+
+/**
+ * Description: Checkpoints pointing at the wrong key, or out of time order, are rejected.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testCorruptCheckpoints() {
+  // Past the end of the keys: seek() and the envelope blocks would read/write out of bounds.
+  expectRejected(1, 3, [](TrackCheckpoint& cp) { cp.keyIndex = 0x7FFFFFFFu; });
+  expectRejected(0, 2, [](TrackCheckpoint& cp) { cp.keyIndex = TEST_KEYS; });
+  // In range but not the key this checkpoint anchors.
+  expectRejected(0, 1, [](TrackCheckpoint& cp) { cp.keyIndex = 5; });
+  expectRejected(1, 0, [](TrackCheckpoint& cp) { cp.keyIndex = TRACK_CHECKPOINT_INTERVAL; });
+  // Time index not sorted: the binary search in seek() relies on it.
+  expectRejected(0, 4, [](TrackCheckpoint& cp) { cp.timeMs = 0; });
+}
+
+/**
+ * Description: Run the loader cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testValidImage();
+  testSteppedLoad();
+  testCorruptCheckpoints();
+  return testExitCode("test_show_load");
+}
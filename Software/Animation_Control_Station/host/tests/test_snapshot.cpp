@@ -0,0 +1,155 @@
+// Snapshot exchange under real threads: a writer publishes numbered
+// snapshots as fast as it can while readers spin on the other side. Every
+// snapshot a reader accepts must be whole (no field from another write) and
+// never older than the one it accepted before.
+#include "HostTest.h"
+#include "Snapshot.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t TORTURE_WRITES = 2000000;
+static constexpr uint8_t SEQLOCK_READERS = 3;
+static constexpr uint32_t SNAPSHOT_WORDS = 30; // wide enough that a torn copy is likely
+
+// A snapshot whose words all derive from its number, so a torn copy shows.
+struct TestSnapshot {
+  uint32_t number;
+  uint32_t words[SNAPSHOT_WORDS];
+};
+
+// What one reader saw.
+struct ReaderResult {
+  uint32_t reads = 0;
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t last = 0;
+};
+
+/**
+ * Description: Fill a snapshot for a given write number.
+ * Inputs:
+ * - snapshot: snapshot to fill.
+ * - number: write number.
+ * Outputs: Sets every field from number.
+ */
+static void fillSnapshot(TestSnapshot& snapshot, uint32_t number) {
+  snapshot.number = number;
+  for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++) {
+    snapshot.words[i] = number * 2654435761u + i;
+  }
+}
+
+/**
+ * Description: Check a snapshot a reader accepted.
+ * Inputs:
+ * - snapshot: accepted snapshot.
+ * - result: reader counters to update.
+ * Outputs: Counts torn and out-of-order snapshots.
+ */
+static void checkSnapshot(const TestSnapshot& snapshot, ReaderResult& result) {
+  result.reads++;
+  for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++) {
+    if (snapshot.words[i] != snapshot.number * 2654435761u + i) {
+      result.torn++;
+      break;
+    }
+  }
+  if (snapshot.number < result.last) {
+    result.backwards++;
+  }
+  result.last = snapshot.number;
+}
+
+/**
+ * Description: One writer and several readers on a Seqlock.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testSeqlockThreads() {
+  Seqlock<TestSnapshot> lock;
+  TestSnapshot first;
+  fillSnapshot(first, 0); // readers may start before the first write
+  lock.publish(first);
+  std::atomic<bool> done{false};
+  ReaderResult results[SEQLOCK_READERS];
+  std::vector<std::thread> readers;
+  for (uint8_t r = 0; r < SEQLOCK_READERS; r++) {
+    readers.emplace_back([&lock, &done, &result = results[r]]() {
+      TestSnapshot snapshot;
+      bool finished = false;
+      while (!finished) {
+        finished = done.load(std::memory_order_acquire); // one more read after the last write
+        lock.read(snapshot);
+        checkSnapshot(snapshot, result);
+      }
+    });
+  }
+
+  std::thread writer([&lock, &done]() {
+    for (uint32_t n = 1; n <= TORTURE_WRITES; n++) {
+      fillSnapshot(lock.beginWrite(), n);
+      lock.endWrite();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  writer.join();
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+
+  for (const ReaderResult& result : results) {
+    TEST_CHECK(result.reads > 0);
+    TEST_CHECK(result.torn == 0);
+    TEST_CHECK(result.backwards == 0);
+    TEST_CHECK(result.last == TORTURE_WRITES);
+  }
+  TEST_CHECK(lock.sequence() == 2 * (TORTURE_WRITES + 1));
+}
+
+/**
+ * Description: One writer and the reader on a TripleBuffer.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testTripleBufferThreads() {
+  TripleBuffer<TestSnapshot> buffer;
+  std::atomic<bool> done{false};
+  ReaderResult result;
+  std::thread reader([&buffer, &done, &result]() {
+    bool finished = false;
+    while (!finished) {
+      finished = done.load(std::memory_order_acquire);
+      if (buffer.update()) {
+        checkSnapshot(buffer.front(), result);
+      }
+    }
+  });
+
+  std::thread writer([&buffer, &done]() {
+    for (uint32_t n = 1; n <= TORTURE_WRITES; n++) {
+      fillSnapshot(buffer.back(), n);
+      buffer.publish();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  writer.join();
+  reader.join();
+
+  TEST_CHECK(result.reads > 0);
+  TEST_CHECK(result.torn == 0);
+  TEST_CHECK(result.backwards == 0);
+  TEST_CHECK(result.last == TORTURE_WRITES);
+}
+
+/**
+ * Description: Run the snapshot cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testSeqlockThreads();
+  testTripleBufferThreads();
+  return testExitCode("test_snapshot");
+}
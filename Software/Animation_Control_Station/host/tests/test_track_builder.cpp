@@ -0,0 +1,96 @@
+// TrackBuilder: gaps and jumps too large for the 16-bit key deltas are
+// split into keys that decode back to the values appended.
+#include "HostTest.h"
+#include "TrackBuilder.h"
+
+static constexpr uint32_t TEST_MAX_KEYS = 256;
+
+struct TestTrack {
+  TrackKey keys[TEST_MAX_KEYS];
+  TrackCheckpoint checkpoints[(TEST_MAX_KEYS + TRACK_CHECKPOINT_INTERVAL - 1) / TRACK_CHECKPOINT_INTERVAL];
+  TrackBuilder builder;
+  Track track;
+
+  /**
+   * Description: Start an empty track.
+   * Inputs: None.
+   * Outputs: The builder writes into this track's storage.
+   */
+  TestTrack() {
+    builder.begin(keys, TEST_MAX_KEYS, checkpoints, sizeof(checkpoints) / sizeof(checkpoints[0]));
+  }
+
+  /**
+   * Description: Evaluate the built track.
+   * Inputs:
+   * - tMs: show time in milliseconds.
+   * Outputs: Returns the position at that time.
+   */
+  float at(uint32_t tMs) {
+    TrackCursor cursor;
+    track.seek(cursor, tMs);
+    return Track::sample(cursor, (uint64_t)tMs * 1000u).pos;
+  }
+};
+
+/**
+ * Description: A Step key followed by a jump wider than int16 lands on the appended value.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testStepJump() {
+  TestTrack t;
+  TEST_CHECK(t.builder.append(0, 0, Ease::Step));
+  TEST_CHECK(t.builder.append(1000, 50000, Ease::Step));
+  TEST_CHECK(t.builder.append(2000, -70000, Ease::Linear));
+  TEST_CHECK(t.builder.append(3000, -70000, Ease::Step));
+  TEST_CHECK(t.builder.attach(t.track));
+  TEST_CHECK_NEAR(t.at(999), 0.0, 0.0);
+  TEST_CHECK_NEAR(t.at(1000), 50000.0, 0.0);
+  TEST_CHECK_NEAR(t.at(1999), 50000.0, 0.0);
+  TEST_CHECK_NEAR(t.at(2000), -70000.0, 0.0);
+  TEST_CHECK_NEAR(t.at(3000), -70000.0, 0.0);
+  TEST_CHECK(t.track.durationMs() == 3000);
+}
+
+/**
+ * Description: A Step key across a gap longer than one key holds, then jumps at the end.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testStepGapAndJump() {
+  TestTrack t;
+  TEST_CHECK(t.builder.append(0, 100, Ease::Step));
+  TEST_CHECK(t.builder.append(200000, -40000, Ease::Step));
+  TEST_CHECK(t.builder.attach(t.track));
+  TEST_CHECK_NEAR(t.at(70000), 100.0, 0.0);
+  TEST_CHECK_NEAR(t.at(199999), 100.0, 0.0);
+  TEST_CHECK_NEAR(t.at(200000), -40000.0, 0.0);
+}
+
+/**
+ * Description: A Linear jump wider than int16 stays on the straight line.
+ * Inputs: None.
+ * Outputs: Records check results.
+ */
+static void testLinearJump() {
+  TestTrack t;
+  TEST_CHECK(t.builder.append(0, 0, Ease::Linear));
+  TEST_CHECK(t.builder.append(1000, 100000, Ease::Linear));
+  TEST_CHECK(t.builder.attach(t.track));
+  TEST_CHECK_NEAR(t.at(250), 25000.0, 1.0);
+  TEST_CHECK_NEAR(t.at(500), 50000.0, 1.0);
+  TEST_CHECK_NEAR(t.at(1000), 100000.0, 0.0);
+}
+
+/**
+ * Description: Run the builder cases.
+ * Inputs: None.
+ * Outputs: Returns 0 when every check passed.
+ */
+int main() {
+  testStepJump();
+  testStepGapAndJump();
+  testLinearJump();
+  return testExitCode("test_track_builder");
+}
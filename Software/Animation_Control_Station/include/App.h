@@ -5,6 +5,16 @@
 #include "ShowEngine.h"
 #include "EncoderJog.h"
 #include "Rs422Ports.h"
+#include "MotionProfile.h"
+#include "ShowSlots.h"
+#include "Recorder.h"
+#include "Config.h"
+#include "MotorOutput.h"
+#include "FollowingError.h"
+#include "LinkTuner.h"
+#include "FlightRecorder.h"
+#include "Scheduler.h"
+#include "Snapshot.h"
 
 class App {
 public:
@@ -16,18 +26,474 @@ public:
   void begin();
 
   /**
-   * Description: Main application loop.
+   * Description: Main application loop: one scheduler pass.
    * Inputs: None.
-   * Outputs: Updates model state and renders UI each tick.
+   * Outputs: Runs due tasks in priority order, then background jobs in idle time.
    */
   void loop();
 
+  /**
+   * Description: Execute a console command.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Runs the matching command handler or reports an unknown command.
+   */
+  void handleCommand(const CommandMsg& msg);
+
 private:
+  /**
+   * Description: Register the loop tasks and background jobs with the scheduler.
+   * Inputs: None.
+   * Outputs: Fills the scheduler table; the first releases are due immediately.
+   */
+  void registerTasks();
+
+  /**
+   * Description: Console task: read USB serial and dispatch complete commands.
+   * Inputs: None.
+   * Outputs: Runs console command handlers.
+   */
+  void consoleTask();
+
+  /**
+   * Description: Input task: buttons, pots, LEDs, jog wheel and trim editing.
+   * Inputs: None.
+   * Outputs: Updates _inputState and the model; plans jog/scrub moves; trips the stop on RUN/HALT.
+   */
+  void inputTask();
+
+  /**
+   * Description: RS422 test traffic while motor output is off (the ports carry RoboClaw frames otherwise).
+   * Inputs: None.
+   * Outputs: Sends a hello line per port at 10 Hz and logs received bytes.
+   */
+  void rs422TestTask();
+
+  /**
+   * Description: Control task: show clock, motor output, flight recorder and live recording.
+   * Inputs: None.
+   * Outputs: Sends one set of setpoints per period and records a flight snapshot.
+   */
+  void controlTask();
+
+  /**
+   * Description: Publish this control tick's state for the UI.
+   * Inputs:
+   * - jog: jog profile sample of this tick.
+   * Outputs: Fills the status back buffer and swaps it in (never waits for the UI).
+   */
+  void publishStatus(const MotionSample& jog);
+
+  /**
+   * Description: UI task: refresh the model and render the display.
+   * Inputs: None.
+   * Outputs: Draws one frame per render period.
+   */
+  void uiTask();
+
+  /**
+   * Description: Cue task: perform discrete show events off the control path.
+   * Inputs: None.
+   * Outputs: Drains up to CUE_DRAIN_PER_PASS events.
+   */
+  void cuesTask();
+
+  /**
+   * Description: Background job: load shows into the inactive slot (SD prefetch).
+   * Inputs: None.
+   * Outputs: Advances a pending load by one step.
+   */
+  void slotsTask();
+
+  /**
+   * Description: Background job: deferred settings save after trim/limit edits.
+   * Inputs: None.
+   * Outputs: Writes the EEPROM image once edits have settled.
+   */
+  void configTask();
+
+  /**
+   * Description: Background job: log formatting and console/flight USB output.
+   * Inputs: None.
+   * Outputs: Formats queued log lines and sends only what USB accepts without blocking.
+   */
+  void logTask();
+
+  /**
+   * Description: Background job: write the trace capture to SD.
+   * Inputs: None.
+   * Outputs: Writes one chunk of queued trace records.
+   */
+  void traceTask();
+
+  /**
+   * Description: Scheduler run hook while a trace runs: e-stop level, then the Run record.
+   * Inputs:
+   * - task: task about to run.
+   * - index: its scheduler table index.
+   * - startUs: start time of the run (moved by a replay).
+   * - context: App instance.
+   * Outputs: Returns false when a replay holds a background job back.
+   */
+  static bool traceRunHook(const SchedulerTask& task, uint8_t index, uint32_t& startUs, void* context);
+
+  /**
+   * Description: Console "help": list available commands.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints the command list.
+   */
+  void cmdHelp(const CommandMsg& msg);
+
+  /**
+   * Description: Console "seek <ms>": jump the attached show to a time.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Seeks the show engine with a safe approach move.
+   */
+  void cmdSeek(const CommandMsg& msg);
+
+  /**
+   * Description: Console "play" / "pause": start or hold show playback.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Updates the show engine play state (synchronized start when motors are on).
+   */
+  void cmdPlay(const CommandMsg& msg);
+
+  /**
+   * Description: Start show playback as "play" does.
+   * Inputs:
+   * - name: command name for the log.
+   * Outputs: Returns false while the e-stop is latched; otherwise arms a
+   *   synchronized start or starts playback, and returns true.
+   */
+  bool startPlayback(const char* name);
+
+  /**
+   * Description: Console "load <slot> <file>": load a show image from SD in the background.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Starts loading unless the slot is in use by the engine.
+   */
+  void cmdLoad(const CommandMsg& msg);
+
+  /**
+   * Description: Console "switch <slot> [atMs|end] [blendMs]": queue a show switch.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Queues the switch (or approaches the first show directly).
+   */
+  void cmdSwitch(const CommandMsg& msg);
+
+  /**
+   * Description: Console "slots": show slot states and switch statistics.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints one line per slot plus switch latency.
+   */
+  void cmdSlots(const CommandMsg& msg);
+
+  /**
+   * Description: Console "rec ...": record a live input onto a channel during playback.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Starts, stops, cancels or clears a take, or prints take statistics.
+   */
+  void cmdRec(const CommandMsg& msg);
+
+  /**
+   * Description: Abandon a recording in progress (show time jumped or show changed).
+   * Inputs:
+   * - reason: text for the log.
+   * Outputs: Cancels the recorder; the channel keeps its previous track.
+   */
+  void cancelRecording(const char* reason);
+
+  /**
+   * Description: Drop every stored take once the show they were recorded against is no longer active.
+   * Inputs: None.
+   * Outputs: Frees the takes (the engine dropped their overrides when the show changed).
+   */
+  void discardStaleTakes();
+
+  /**
+   * Description: Console "limits [ch minPos maxPos maxVel maxAccel [maxJerk]]": show or set motor limits.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints the limits table or updates one channel and re-checks the show.
+   */
+  void cmdLimits(const CommandMsg& msg);
+
+  /**
+   * Description: Console "xform [ch [gain|offset|clamp|invert|shift|reset ...]]": show or edit channel transforms.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints transforms or updates one; takes effect on the next tick and is saved.
+   */
+  void cmdXform(const CommandMsg& msg);
+
+  /**
+   * Description: Console "save": write settings to EEPROM now.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Saves the config and reports the result.
+   */
+  void cmdSave(const CommandMsg& msg);
+
+  /**
+   * Description: Publish edited transforms/limits to the engine and schedule a save.
+   * Inputs: None.
+   * Outputs: Refreshes envelope-derived limits and marks the config dirty.
+   */
+  void settingsChanged();
+
+  /**
+   * Description: Handle the front-panel trim editor (OK toggles, arrows select, jog adjusts).
+   * Inputs:
+   * - inputState: latest input snapshot.
+   * Outputs: Returns true when the encoder was consumed by the editor.
+   */
+  bool handleTrimInput(const InputState& inputState);
+
+  /**
+   * Description: Check whether a slot holds the active or queued show.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns true if the slot must not be reloaded.
+   */
+  bool slotInUse(uint8_t slot) const;
+
+  /**
+   * Description: Check that a console benchmark may run; they block the console task for a long time.
+   * Inputs:
+   * - name: command name for the refusal message.
+   * Outputs: Returns false, and says why, while motors are on, a show is playing or a
+   *          flight dump is streaming (bench output would corrupt it).
+   */
+  bool benchAllowed(const char* name) const;
+
+  /**
+   * Description: Console "seekbench": measure seek latency for 1 min..2 h shows.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints seek latency per show length; refused while motors are on or playing.
+   */
+  void cmdSeekBench(const CommandMsg& msg);
+
+  /**
+   * Description: Console "cuebench": time the cue scheduler on a 20k-event show.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints per-tick dispatch cost and fired/expected counts; refused while motors are on or playing.
+   */
+  void cmdCueBench(const CommandMsg& msg);
+
+  /**
+   * Description: Console "logbench": cycles per log call, deferred vs Serial.printf.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints avg/max cycles for both paths and the logger counters; refused while motors are on or playing.
+   */
+  void cmdLogBench(const CommandMsg& msg);
+
+  /**
+   * Description: Console "stats [reset|policy <resp|log> <newest|oldest>]": console output counters.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints per-lane bytes, drops and fill plus logger counters, clears them, or sets a drop policy.
+   */
+  void cmdStats(const CommandMsg& msg);
+
+  /**
+   * Description: Console "perf [hist]": per-subsystem loop timing since the last perf.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints the probe table (and histograms with "hist"), then resets the probes.
+   */
+  void cmdPerf(const CommandMsg& msg);
+
+  /**
+   * Description: Console "flight [arm|freeze|dump]": flight recorder status and control.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints ring state and record cost, re-arms, freezes, or streams the ring over USB.
+   */
+  void cmdFlight(const CommandMsg& msg);
+
+  /**
+   * Description: Console "faults [reset]": active faults with raise counts and times.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints the fault table or clears the raise history.
+   */
+  void cmdFaults(const CommandMsg& msg);
+
+  /**
+   * Description: Console "tasks [reset]": per-task scheduler statistics.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints runs, CPU share, lateness, run time, misses and overruns, or clears them.
+   */
+  void cmdTasks(const CommandMsg& msg);
+
+  /**
+   * Description: Console "snapbench": publish and read cost of the snapshot exchanges by size.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints ns per call for Seqlock and TripleBuffer at several sizes and for ControlStatus;
+   *          refused while benchAllowed() says no.
+   */
+  void cmdSnapBench(const CommandMsg& msg);
+
+  /**
+   * Description: Console "trace [arm|stop]": input/serial trace capture for replay.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints capture counters, arms a capture from the next boot, or ends the capture.
+   */
+  void cmdTrace(const CommandMsg& msg);
+
+  /**
+   * Description: Take a flight recorder snapshot when one is due.
+   * Inputs:
+   * - inputState: latest input snapshot.
+   * Outputs: Records show time, faults, inputs, flags and per-channel target/position/current.
+   */
+  void recordFlight(const InputState& inputState);
+
+  /**
+   * Description: Console "motors on|off": start or stop streaming setpoints to the RoboClaws.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Enables/disables motor output and reports the state.
+   */
+  void cmdMotors(const CommandMsg& msg);
+
+  /**
+   * Description: Console "latency [reset]": per-port output latency and inter-channel skew.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints latency estimates, ack counters and skew with/without compensation.
+   */
+  void cmdLatency(const CommandMsg& msg);
+
+  /**
+   * Description: Console "telemetry [on|off|<ch>]": telemetry rates per port, or one channel's readings.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints achieved rates and budgets, a channel's latest values, or toggles polling.
+   */
+  void cmdTelemetry(const CommandMsg& msg);
+
+  /**
+   * Description: Feed fresh encoder readings to the following error monitor and act on its level.
+   * Inputs: None.
+   * Outputs: Sets/clears following faults; slows playback or trips the e-stop on escalation.
+   */
+  void updateFollowing();
+
+  /**
+   * Description: Apply the fault reaction table (once per control tick).
+   * Inputs: None.
+   * Outputs: Trips the e-stop, blinks the RUN/HALT LED and sets the UI fault text for active faults.
+   */
+  void applyFaultReactions();
+
+  /**
+   * Description: Console "follow [reset|sim]": following error statistics, reset, or the stall simulation.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints per-channel statistics, clears them, or reports modeled detection
+   *          latency (refused while benchAllowed() says no).
+   */
+  void cmdFollow(const CommandMsg& msg);
+
+  /**
+   * Description: Console "estop [trip|reset]": emergency stop status, manual trip or reset.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints stop latency statistics, trips the stop, or clears a latched stop.
+   */
+  void cmdEStop(const CommandMsg& msg);
+
+  /**
+   * Description: Console "baud [port rate]": show per-port baud rates or set one.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints the rates or reopens a port at a new rate and saves it.
+   */
+  void cmdBaud(const CommandMsg& msg);
+
+  /**
+   * Description: Console "tune [port|all]": find the fastest reliable baud rate per port.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints per-rate results and frames/s before and after; saves the chosen rates.
+   */
+  void cmdTune(const CommandMsg& msg);
+
+  /**
+   * Description: Console "loopback <port> [count]": time byte echoes through a TX->RX jumper.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints min/avg/max round trip for the port.
+   */
+  void cmdLoopback(const CommandMsg& msg);
+
+  /**
+   * Description: Console "skewsim": model unequal port loads and compare skew with and without lookahead.
+   * Inputs:
+   * - msg: parsed command message.
+   * Outputs: Prints average and worst skew for both cases; refused while motors are on or playing.
+   */
+  void cmdSkewSim(const CommandMsg& msg);
+
+  /**
+   * Description: Perform a discrete show event (runs from idle time).
+   * Inputs:
+   * - event: event drained from the cue scheduler.
+   * Outputs: Drives LEDs/outputs, logs audio cues, or applies mark actions.
+   */
+  void handleShowCue(const ShowEvent& event);
+
+  /**
+   * Description: Cue scheduler callback adapter.
+   * Inputs:
+   * - event: event drained from the cue scheduler.
+   * - context: App instance.
+   * Outputs: Forwards to handleShowCue().
+   */
+  static void showCueThunk(const ShowEvent& event, void* context);
+
+  Scheduler _sched;           // loop tasks and background jobs
   Console _console;
   Input _input;
+  InputState _inputState;     // latest poll; button edges are consumed by inputTask()
   Ui _ui;
   ShowEngine _show;
   EncoderJog _enc;
   Rs422Ports _rs422;
+  MotorOutput _motors;        // setpoint frames with per-port latency compensation
+  FollowingMonitor _follow;
+  FollowLevel _followLevel = FollowLevel::Ok;
+  FlightRecorder _flight;     // per-tick snapshots, frozen on a fault edge
+  uint32_t _faultsReacted = 0; // reaction-table faults acted on last tick
+  const char* _faultShown = nullptr; // degrade-UI fault text, published in the status
+  TripleBuffer<ControlStatus> _status; // control tick -> UI task
   UiModel _model;
+  ShowSlots _slots;
+  Config _config;             // channel transforms and motor limits (EEPROM)
+  bool _trimActive = false;   // UI trim mode: encoder edits the selected transform field
+  uint8_t _trimField = 0;     // TrimField being edited
+  Recorder _recorder;
+  RecordSource _recordSource = RecordSource::Jog;
+  const Show* _recordShow = nullptr; // show the take is being recorded against
+  const Show* _takesShow = nullptr;  // show the stored takes were recorded against
+  MotionProfile _jogProfile;
+  MotionLimits _jogLimits;     // pot-scaled limits, also used for seek approaches
+  float _jogSpeedScale = 0.0f; // pot values latched with hysteresis
+  float _jogAccelScale = 0.0f;
+  uint8_t _rs422TestPasses = 0; // rs422TestTask() passes since the last hello lines
+  uint8_t _slotsJob = 0xFF;     // scheduler index of the "slots" job (traced while loading)
 };
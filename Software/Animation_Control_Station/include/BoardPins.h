@@ -46,6 +46,10 @@ static constexpr uint8_t PIN_POT_ACCEL = A16;
 static constexpr uint8_t PIN_ENC_A = 5;
 static constexpr uint8_t PIN_ENC_B = 4;
 
+// ---------------- Emergency stop ----------------
+// Hardwired e-stop loop, active low (opening the loop pulls the pin low).
+static constexpr uint8_t PIN_ESTOP = 2;
+
 // ---------------- RS485 RoboClaw ports ----------------
 struct Rs422PortPins {
   uint8_t rx;
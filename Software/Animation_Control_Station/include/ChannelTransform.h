@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+
+static constexpr int32_t TRANSFORM_ONE_Q16 = 65536;       // gain 1.0
+static constexpr int32_t TRANSFORM_CLAMP_NONE = 0x3FFFFFFF; // default clamp bound (units)
+
+// On-site trim applied to a channel after the track engine, so a show can
+// be adjusted without re-encoding or reloading it. Evaluated in fixed point:
+//   out = clamp((invert ? -1 : 1) * track(t + timeOffsetMs) * gain + offset)
+struct ChannelTransform {
+  int32_t gainQ16 = TRANSFORM_ONE_Q16;
+  int32_t offset = 0;                       // units, added after gain/invert
+  int32_t clampMin = -TRANSFORM_CLAMP_NONE; // units
+  int32_t clampMax = TRANSFORM_CLAMP_NONE;
+  int16_t timeOffsetMs = 0;                 // > 0 leads the track, < 0 lags it
+  uint8_t invert = 0;                       // mirror around zero
+  uint8_t reserved = 0;
+
+  /**
+   * Description: Check whether the transform leaves the channel unchanged.
+   * Inputs: None.
+   * Outputs: Returns true for the default transform.
+   */
+  bool isIdentity() const {
+    return gainQ16 == TRANSFORM_ONE_Q16 && offset == 0 && timeOffsetMs == 0 && invert == 0 &&
+           clampMin == -TRANSFORM_CLAMP_NONE && clampMax == TRANSFORM_CLAMP_NONE;
+  }
+};
+
+static_assert(sizeof(ChannelTransform) == 20, "ChannelTransform layout (stored in config)");
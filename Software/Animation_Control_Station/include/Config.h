@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include "Show.h"
+#include "ChannelTransform.h"
+#include "Rs422Ports.h"
+
+// Persistent settings (EEPROM). Edit data() in place, then markDirty(); the
+// write is deferred so a burst of edits costs one EEPROM update. Fields are
+// only ever appended, so an older image restores as a prefix and the new
+// fields keep their defaults.
+struct ConfigData {
+  ChannelTransform transforms[SHOW_MAX_CHANNELS];
+  ChannelLimits limits[SHOW_MAX_CHANNELS];
+  uint32_t portBaud[RS422_PORT_COUNT]; // added in version 2
+  uint8_t traceAtBoot;                 // added in version 3: start a trace capture on boot
+};
+
+class Config {
+public:
+  static constexpr uint32_t MAGIC = 0x47464341u; // "ACFG"
+  static constexpr uint16_t VERSION = 3;
+  static constexpr uint32_t SAVE_DELAY_MS = 2000; // quiet time before a deferred save
+
+  /**
+   * Description: Restore settings from EEPROM.
+   * Inputs: None.
+   * Outputs: Returns true when a valid image was read. Otherwise data() keeps
+   *          its current (default) contents; a corrupt image sets
+   *          FAULT_CONFIG_RESTORE_FAULT.
+   */
+  bool load();
+
+  /**
+   * Description: Write settings to EEPROM now.
+   * Inputs: None.
+   * Outputs: Returns true when the image fits and was written.
+   */
+  bool save();
+
+  /**
+   * Description: Schedule a deferred save after an edit.
+   * Inputs: None.
+   * Outputs: Restarts the save delay.
+   */
+  void markDirty() {
+    _dirty = true;
+    _dirtyMs = millis();
+  }
+
+  /**
+   * Description: Perform a pending deferred save (call from idle time).
+   * Inputs: None.
+   * Outputs: Saves once SAVE_DELAY_MS has passed since the last edit.
+   */
+  void poll();
+
+  /**
+   * Description: Access the settings.
+   * Inputs: None.
+   * Outputs: Returns the live settings; storage stays valid for the program lifetime.
+   */
+  ConfigData& data() { return _data; }
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc;
+  };
+
+  ConfigData _data;
+  bool _dirty = false;
+  uint32_t _dirtyMs = 0;
+};
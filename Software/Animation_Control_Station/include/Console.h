@@ -51,15 +51,6 @@ public:
    */
   void setDispatchCommand(DispatchCommandFn handler);
 
-private:
-  /**
-   * Description: Check whether a character is whitespace.
-   * Inputs:
-   * - c: character to test.
-   * Outputs: Returns true if the character is space or tab.
-   */
-  bool isWhitespace(char c) const;
-
   /**
    * Description: Tokenize a line into a command message.
    * Inputs:
@@ -69,11 +60,20 @@ private:
    */
   void tokenizeLine(const char *line, CommandMsg &out) const;
 
+private:
+  /**
+   * Description: Check whether a character is whitespace.
+   * Inputs:
+   * - c: character to test.
+   * Outputs: Returns true if the character is space or tab.
+   */
+  bool isWhitespace(char c) const;
+
   /**
    * Description: Dispatch a parsed command message if a handler is registered.
    * Inputs:
    * - msg: parsed command message.
-   * Outputs: Calls the registered handler when available.
+   * Outputs: Calls the registered handler when available; its output uses the response lane.
    */
   void dispatchCommand(const CommandMsg &msg) const;
 
@@ -0,0 +1,99 @@
+#pragma once
+#include <Arduino.h>
+
+// Buffered USB console output. Writers copy into a RAM ring and return at
+// once; consoleTxPoll() moves bytes to USB only as far as the host has
+// room (Serial.availableForWrite()), so a closed serial monitor can never
+// stall the controller. Two lanes keep command responses ahead of log
+// traffic: the response lane is always sent first, and each lane drops
+// on overflow according to its own policy.
+static constexpr size_t CONSOLE_TX_RESPONSE_BYTES = 8192;
+static constexpr size_t CONSOLE_TX_LOG_BYTES = 8192;
+
+enum class ConsoleLane : uint8_t {
+  Response = 0, // output of console commands
+  Log,          // background log lines
+  Count
+};
+
+enum class TxDropPolicy : uint8_t {
+  DropNewest = 0, // keep what is queued; discard a write that does not fit
+  DropOldest      // discard the oldest whole lines to make room
+};
+
+// Per-lane counters for the "stats" command.
+struct ConsoleLaneStats {
+  uint32_t bytesIn = 0;      // accepted into the ring
+  uint32_t bytesOut = 0;     // handed to USB
+  uint32_t droppedBytes = 0;
+  uint32_t droppedWrites = 0; // writes (lines) lost in whole or part
+  uint16_t queued = 0;
+  uint16_t highWater = 0;
+  uint16_t capacity = 0;
+  TxDropPolicy policy = TxDropPolicy::DropNewest;
+};
+
+/**
+ * Description: Queue bytes for the console without blocking.
+ * Inputs:
+ * - lane: output lane.
+ * - data: bytes to send.
+ * - len: number of bytes.
+ * Outputs: Returns false if any bytes were dropped (counted per lane).
+ */
+bool consoleTxWrite(ConsoleLane lane, const char* data, size_t len);
+
+/**
+ * Description: Queue formatted text for the console without blocking.
+ * Inputs:
+ * - lane: output lane.
+ * - fmt: printf format string.
+ * - ...: format arguments.
+ * Outputs: Returns false if the text was truncated or dropped.
+ */
+bool consoleTxPrintf(ConsoleLane lane, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Description: Move queued bytes to USB as far as the host has room (call every loop pass).
+ * Inputs: None.
+ * Outputs: Writes response bytes first, then log bytes; never waits.
+ */
+void consoleTxPoll();
+
+/**
+ * Description: Check whether any console output is still queued.
+ * Inputs: None.
+ * Outputs: Returns true while either lane holds bytes.
+ */
+bool consoleTxPending();
+
+/**
+ * Description: Set a lane's overflow policy.
+ * Inputs:
+ * - lane: output lane.
+ * - policy: drop policy.
+ * Outputs: Applies to later writes.
+ */
+void consoleTxSetPolicy(ConsoleLane lane, TxDropPolicy policy);
+
+/**
+ * Description: Get a lane's counters.
+ * Inputs:
+ * - lane: output lane.
+ * Outputs: Returns byte, drop and fill counters.
+ */
+ConsoleLaneStats consoleTxStats(ConsoleLane lane);
+
+/**
+ * Description: Get how long USB has refused output while bytes were queued.
+ * Inputs: None.
+ * Outputs: Returns milliseconds since the last byte went out (0 when idle or flowing).
+ */
+uint32_t consoleTxStalledMs();
+
+/**
+ * Description: Clear the byte, drop and high-water counters.
+ * Inputs: None.
+ * Outputs: Leaves queued bytes and policies unchanged.
+ */
+void consoleTxResetStats();
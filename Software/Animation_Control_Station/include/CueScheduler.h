@@ -0,0 +1,154 @@
+#pragma once
+#include <Arduino.h>
+#include "ShowFormat.h"
+
+// Two-level hierarchical timing wheel for discrete show events.
+// Level 0: 256 slots of 1 ms (current 256 ms block).
+// Level 1: 256 slots of 256 ms (current ~65 s super block).
+// Events further out stay in the sorted event track and are inserted as the
+// horizon reaches them, so the wheel only ever holds near-term events.
+class CueScheduler {
+public:
+  using CueHandlerFn = void (*)(const ShowEvent& event, void* context);
+
+  static constexpr uint16_t WHEEL_SLOTS = 256;
+  static constexpr uint16_t NODE_POOL_SIZE = 512;   // events held in the wheel at once
+  static constexpr uint16_t DEFERRED_QUEUE_SIZE = 512; // power of two
+
+  /**
+   * Description: Attach a time-sorted event track (or nullptr to detach).
+   * Inputs:
+   * - events: sorted events; must stay valid while attached.
+   * - count: number of events.
+   * Outputs: Clears the wheel and rewinds to time 0.
+   */
+  void setEvents(const ShowEvent* events, uint32_t count);
+
+  /**
+   * Description: Reposition after a show time jump.
+   * Inputs:
+   * - tMs: new show time; events at or after it will fire.
+   * Outputs: Clears the wheel; nothing before tMs fires. Events already on
+   *          the deferred queue still run once.
+   */
+  void seek(uint32_t tMs);
+
+  /**
+   * Description: Dispatch every event due up to and including tMs.
+   * Inputs:
+   * - tMs: current show time (must not go backwards without seek()).
+   * Outputs: Queues due events on the deferred queue. Amortized O(1) per ms.
+   *          If the queue fills, the rest wait in the wheel for the next call.
+   */
+  void advance(uint32_t tMs);
+
+  /**
+   * Description: Run handlers for queued events (call from idle time).
+   * Inputs:
+   * - handler: callback for each event.
+   * - context: opaque pointer passed to the handler.
+   * - maxEvents: upper bound on events handled in this call.
+   * Outputs: Returns the number of events handled.
+   */
+  uint32_t drain(CueHandlerFn handler, void* context, uint32_t maxEvents = 0xFFFFFFFFu);
+
+  /**
+   * Description: Get the number of events queued for dispatch so far.
+   * Inputs: None.
+   * Outputs: Returns the dispatched event counter.
+   */
+  uint32_t dispatchedCount() const { return _dispatched; }
+
+  /**
+   * Description: Get the number of events queued after their due time.
+   * Inputs: None.
+   * Outputs: Returns the late event counter (node pool exhaustion).
+   */
+  uint32_t lateCount() const { return _late; }
+
+  /**
+   * Description: Get the number of times dispatch stalled on a full deferred queue.
+   * Inputs: None.
+   * Outputs: Returns the stall counter (stalled events fire on a later tick).
+   */
+  uint32_t stallCount() const { return _stalls; }
+
+private:
+  static constexpr uint16_t NIL = 0xFFFF;
+
+  // Singly linked FIFO of pool nodes.
+  struct SlotList {
+    uint16_t head = NIL;
+    uint16_t tail = NIL;
+  };
+
+  /**
+   * Description: Reset the wheel, node pool and bitmap.
+   * Inputs: None.
+   * Outputs: Returns every node to the free list.
+   */
+  void clearWheel();
+
+  /**
+   * Description: Insert events from the track that entered the horizon.
+   * Inputs:
+   * - nowMs: first unprocessed millisecond.
+   * Outputs: Moves events into the wheel until the horizon or pool is exhausted.
+   */
+  void refill(uint32_t nowMs);
+
+  /**
+   * Description: Place one event into the wheel slot for its time.
+   * Inputs:
+   * - eventIndex: index into the event track.
+   * - nowMs: first unprocessed millisecond.
+   * Outputs: Returns false when the node pool is empty.
+   */
+  bool insert(uint32_t eventIndex, uint32_t nowMs);
+
+  /**
+   * Description: Move the level 1 slot for a new block into level 0.
+   * Inputs:
+   * - blockStartMs: first millisecond of the block being entered.
+   * Outputs: Redistributes the slot's nodes by millisecond.
+   */
+  void cascade(uint32_t blockStartMs);
+
+  /**
+   * Description: Dispatch all occupied level 0 slots in a range.
+   * Inputs:
+   * - firstSlot: first slot (inclusive).
+   * - lastSlot: last slot (inclusive).
+   * - stalledSlot: receives the slot left pending when the queue fills.
+   * Outputs: Queues events and frees their nodes. Returns false on a stall.
+   */
+  bool dispatchSlots(uint16_t firstSlot, uint16_t lastSlot, uint16_t& stalledSlot);
+
+  /**
+   * Description: Push an event onto the deferred queue.
+   * Inputs:
+   * - event: event to queue (copied).
+   * Outputs: Returns false when the queue is full.
+   */
+  bool enqueue(const ShowEvent& event);
+
+  const ShowEvent* _events = nullptr;
+  uint32_t _eventCount = 0;
+  uint32_t _cursor = 0;   // next event not yet in the wheel
+  uint32_t _nextMs = 0;   // first millisecond not yet processed
+
+  SlotList _level0[WHEEL_SLOTS];
+  SlotList _level1[WHEEL_SLOTS];
+  uint32_t _level0Occupied[WHEEL_SLOTS / 32] = {};
+  uint32_t _nodeEvent[NODE_POOL_SIZE] = {};
+  uint16_t _nodeNext[NODE_POOL_SIZE] = {};
+  uint16_t _freeHead = NIL;
+
+  ShowEvent _deferred[DEFERRED_QUEUE_SIZE] = {}; // copies, so a show switch cannot invalidate them
+  volatile uint16_t _deferredHead = 0; // written by advance()
+  volatile uint16_t _deferredTail = 0; // written by drain()
+
+  uint32_t _dispatched = 0;
+  uint32_t _late = 0;
+  uint32_t _stalls = 0;
+};
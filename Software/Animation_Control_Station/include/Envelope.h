@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include "Track.h"
+
+// Kinematic bounds of a track span, in show-time units (1x playback).
+struct KinematicEnvelope {
+  float minPos = 3.0e38f;
+  float maxPos = -3.0e38f;
+  float maxVel = 0.0f;   // units/s
+  float maxAccel = 0.0f; // units/s^2
+  float maxJerk = 0.0f;  // units/s^3
+
+  /**
+   * Description: Widen this envelope to cover another.
+   * Inputs:
+   * - other: envelope to include.
+   * Outputs: Updates the bounds in place.
+   */
+  void merge(const KinematicEnvelope& other) {
+    if (other.minPos < minPos) minPos = other.minPos;
+    if (other.maxPos > maxPos) maxPos = other.maxPos;
+    if (other.maxVel > maxVel) maxVel = other.maxVel;
+    if (other.maxAccel > maxAccel) maxAccel = other.maxAccel;
+    if (other.maxJerk > maxJerk) maxJerk = other.maxJerk;
+  }
+};
+
+// Per-motor limits a channel's envelope is checked against (0 = unchecked).
+struct ChannelLimits {
+  float minPos = -1.0e6f;
+  float maxPos = 1.0e6f;
+  float maxVel = 0.0f;
+  float maxAccel = 0.0f;
+  float maxJerk = 0.0f;
+};
+
+// Violation flags returned by Envelope::check().
+static constexpr uint8_t ENVELOPE_POS = 0x01;
+static constexpr uint8_t ENVELOPE_VEL = 0x02;
+static constexpr uint8_t ENVELOPE_ACCEL = 0x04;
+static constexpr uint8_t ENVELOPE_JERK = 0x08;
+
+// Progress of an analysis split over several calls (Envelope::beginScan()/scan()).
+struct EnvelopeScan {
+  TrackCursor cursor;
+  float prevVel = 0.0f;
+  float prevAcc = 0.0f;
+  bool done = true;
+};
+
+// Load-time kinematic analysis. Bounds come from the closed-form easing
+// curves of each key segment; velocity/acceleration steps at keys are
+// spread over one control window, which is how the motors see them.
+class Envelope {
+public:
+  static constexpr float WINDOW_S = 0.01f; // control update window for key corners
+
+  /**
+   * Description: Analyze a track into per-block and whole-track envelopes.
+   * Inputs:
+   * - track: track to analyze.
+   * - blocks: one envelope per checkpoint block (Track::checkpointsFor(keys)),
+   *           or nullptr for the total only.
+   * - total: receives the whole-track envelope.
+   * Outputs: Fills blocks and total in one pass over the keys.
+   */
+  static void analyze(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total);
+
+  /**
+   * Description: Start an analysis that scan() carries out a few keys at a time.
+   * Inputs:
+   * - track: track to analyze.
+   * - blocks: one envelope per checkpoint block (Track::checkpointsFor(keys)),
+   *           or nullptr for the total only.
+   * - total: receives the whole-track envelope.
+   * - state: receives the scan position.
+   * Outputs: Clears blocks and total.
+   */
+  static void beginScan(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total,
+                        EnvelopeScan& state);
+
+  /**
+   * Description: Continue an analysis started by beginScan().
+   * Inputs:
+   * - track, blocks, total: as passed to beginScan().
+   * - state: scan position.
+   * - maxKeys: key segments to cover in this call.
+   * Outputs: Returns true once the whole track is covered and total is filled.
+   */
+  static bool scan(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total,
+                   EnvelopeScan& state, uint32_t maxKeys);
+
+  /**
+   * Description: Compare an envelope against motor limits at 1x playback.
+   * Inputs:
+   * - env: track envelope.
+   * - limits: motor limits.
+   * Outputs: Returns ENVELOPE_* flags for each exceeded limit (0 = safe).
+   */
+  static uint8_t check(const KinematicEnvelope& env, const ChannelLimits& limits);
+
+  /**
+   * Description: Highest playback rate at which an envelope stays within limits.
+   * Inputs:
+   * - env: track envelope.
+   * - limits: motor limits.
+   * Outputs: Returns the rate ceiling (velocity scales with rate, accel with
+   *          rate^2, jerk with rate^3); large when nothing is limited.
+   */
+  static float maxSafeRate(const KinematicEnvelope& env, const ChannelLimits& limits);
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
 
 typedef enum {
   FAULT_CONSOLE_TASK_FAULT = 0,
@@ -9,16 +10,126 @@ typedef enum {
   FAULT_CONFIG_RESTORE_FAULT = 3,
   FAULT_IO_EXPANDER_FAULT = 4,
   FAULT_LCD_DISPLAY_FAULT = 5,
-  FAULT_MAX_INDEX = 6
+  FAULT_ESTOP_FAULT = 6,
+  FAULT_FOLLOWING_WARNING = 7,
+  FAULT_FOLLOWING_SLOWDOWN = 8,
+  FAULT_FOLLOWING_STOP = 9,
+  FAULT_MAX_INDEX = 10
 } SYSTEM_FAULT_T;
 
-// Forward reference to master system fault bits in master .ini file.
-extern uint32_t system_faults;
+// Master fault bits. Set and cleared with atomic OR/AND (LDREX/STREX on
+// the M7), so a fault raised from an ISR can never be lost to a
+// read-modify-write in the loop.
+extern std::atomic<uint32_t> system_faults;
 extern const char *FAULT_STRING[];
 
+// History of one fault; updated on each rising edge of its bit.
+struct FaultRecord {
+  std::atomic<uint32_t> count{0};   // times raised
+  std::atomic<uint32_t> firstMs{0}; // millis() of the first raise (0 = never)
+  std::atomic<uint32_t> lastMs{0};  // millis() of the latest raise
+};
+extern FaultRecord fault_records[FAULT_MAX_INDEX];
+
+/**
+ * Description: Record a rising fault edge (count and timestamps).
+ * Inputs:
+ * - fault: fault index.
+ * Outputs: Updates the fault's history; ISR safe.
+ */
+void fault_record_edge(uint8_t fault);
+
+/**
+ * Description: Raise a fault (ISR safe).
+ * Inputs:
+ * - fault: fault index.
+ * Outputs: Sets the fault bit; a 0->1 edge is counted and timestamped.
+ */
+inline void fault_raise(uint8_t fault) {
+  const uint32_t bit = (uint32_t)1 << fault;
+  if ((system_faults.fetch_or(bit, std::memory_order_acq_rel) & bit) == 0) {
+    fault_record_edge(fault);
+  }
+}
+
+/**
+ * Description: Clear a fault (ISR safe).
+ * Inputs:
+ * - fault: fault index.
+ * Outputs: Clears the fault bit; history is kept.
+ */
+inline void fault_clear(uint8_t fault) {
+  system_faults.fetch_and(~((uint32_t)1 << fault), std::memory_order_acq_rel);
+}
+
+/**
+ * Description: Read all active fault bits.
+ * Inputs: None.
+ * Outputs: Returns the fault mask.
+ */
+inline uint32_t faults_active() {
+  return system_faults.load(std::memory_order_acquire);
+}
+
 // Fault macros.  Replace x with the fault enumeration name.
-#define FAULT_SET(x) system_faults = (system_faults | ((uint32_t)1 << x))
-#define FAULT_CLEAR(x) system_faults = (system_faults &= ~((uint32_t)1 << x))
-#define FAULT_ACTIVE(x) ((system_faults & (uint32_t)1 << x) != 0)
+#define FAULT_SET(x) fault_raise(x)
+#define FAULT_CLEAR(x) fault_clear(x)
+#define FAULT_ACTIVE(x) ((faults_active() & (uint32_t)1 << x) != 0)
+
+// Reactions applied by the control loop while a fault is active.
+enum FaultAction : uint8_t {
+  FAULT_ACTION_NONE = 0,
+  FAULT_ACTION_STOP_MOTORS = 1 << 0, // trip the emergency stop
+  FAULT_ACTION_BLINK_LED = 1 << 1,   // blink the RUN/HALT LED
+  FAULT_ACTION_DEGRADE_UI = 1 << 2   // show the fault on the display
+};
+
+struct FaultReaction {
+  SYSTEM_FAULT_T fault;
+  uint8_t actions; // FaultAction bits
+};
+
+// Reaction table. Faults not listed only set their bit.
+static constexpr FaultReaction FAULT_REACTIONS[] = {
+  {FAULT_CONFIG_RESTORE_FAULT, FAULT_ACTION_DEGRADE_UI},
+  {FAULT_IO_EXPANDER_FAULT, FAULT_ACTION_DEGRADE_UI},
+  {FAULT_LCD_DISPLAY_FAULT, FAULT_ACTION_BLINK_LED},
+  {FAULT_FOLLOWING_WARNING, FAULT_ACTION_BLINK_LED},
+  {FAULT_FOLLOWING_SLOWDOWN, FAULT_ACTION_BLINK_LED | FAULT_ACTION_DEGRADE_UI},
+  {FAULT_FOLLOWING_STOP, FAULT_ACTION_STOP_MOTORS | FAULT_ACTION_DEGRADE_UI},
+};
+
+/**
+ * Description: Collect the faults whose reaction includes an action.
+ * Inputs:
+ * - action: FaultAction bit(s).
+ * Outputs: Returns a fault mask (evaluated at compile time).
+ */
+constexpr uint32_t fault_action_mask(uint8_t action) {
+  uint32_t mask = 0;
+  for (const FaultReaction& r : FAULT_REACTIONS) {
+    if (r.actions & action) {
+      mask |= (uint32_t)1 << r.fault;
+    }
+  }
+  return mask;
+}
+
+static constexpr uint32_t FAULT_STOP_MASK = fault_action_mask(FAULT_ACTION_STOP_MOTORS);
+static constexpr uint32_t FAULT_BLINK_MASK = fault_action_mask(FAULT_ACTION_BLINK_LED);
+static constexpr uint32_t FAULT_DEGRADE_MASK = fault_action_mask(FAULT_ACTION_DEGRADE_UI);
+static constexpr uint32_t FAULT_REACTION_MASK = FAULT_STOP_MASK | FAULT_BLINK_MASK | FAULT_DEGRADE_MASK;
+
+/**
+ * Description: Print active faults and the raise history.
+ * Inputs: None.
+ * Outputs: Logs one line per fault that is active or has ever been raised.
+ */
+void print_faults();
 
-void print_faults();
\ No newline at end of file
+/**
+ * Description: Clear the raise history of every fault.
+ * Inputs: None.
+ * Outputs: Zeroes counts and timestamps; active bits are unchanged.
+ */
+void reset_fault_history();
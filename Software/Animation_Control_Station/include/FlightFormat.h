@@ -0,0 +1,129 @@
+#pragma once
+#include <Arduino.h>
+
+// Flight recorder dump layout (little-endian), as sent over USB:
+//   text line "FLIGHT BEGIN <bytes>\n" (<bytes> counts the binary part)
+//   FlightDumpHeader
+//   per block, oldest first: FlightBlockHeader, payload[payloadBytes]
+//   text line "\nFLIGHT END\n"
+// A payload is a run of frames. Each frame is FLIGHT_FIELD_COUNT values,
+// each stored as the zigzag varint of its difference from the previous
+// frame; the first frame of a block is relative to zero, so every block
+// decodes on its own after older blocks have been overwritten.
+
+static constexpr uint32_t FLIGHT_MAGIC = 0x31544C46u; // "FLT1"
+static constexpr uint16_t FLIGHT_FORMAT_VERSION = 1;
+static constexpr uint8_t FLIGHT_CHANNELS = 16;
+static constexpr uint32_t FLIGHT_NO_TRIGGER = 0xFFFFFFFFu;
+
+// Per-frame values, in stored order.
+enum class FlightField : uint8_t {
+  TimeUs = 0,  // micros() at the snapshot
+  ShowTimeMs,
+  Faults,      // system_faults bits
+  Buttons,     // bit per Button, 1 = pressed
+  PotSpeed,    // 0..1000
+  PotAccel,    // 0..1000
+  JogPos,      // jog wheel detents
+  Flags,       // FlightFlag bits, follow level in bits 5-6
+  Channels     // then FLIGHT_CHANNEL_FIELDS values per channel
+};
+
+// Per-channel values, in stored order after the frame fields.
+enum class FlightChannelField : uint8_t {
+  Target = 0, // position last sent to the motor
+  Position,   // latest encoder reading
+  CurrentCa,  // motor current, 10 mA units
+  Count
+};
+
+enum FlightFlag : uint32_t {
+  FLIGHT_FLAG_PLAYING = 1u << 0,
+  FLIGHT_FLAG_STOPPED = 1u << 1,    // e-stop latched
+  FLIGHT_FLAG_MOTORS_ON = 1u << 2,
+  FLIGHT_FLAG_APPROACHING = 1u << 3,
+  FLIGHT_FLAG_RECORDING = 1u << 4,
+  FLIGHT_FOLLOW_SHIFT = 5,
+};
+
+static constexpr uint8_t FLIGHT_CHANNEL_FIELDS = (uint8_t)FlightChannelField::Count;
+static constexpr uint8_t FLIGHT_FIELD_COUNT = (uint8_t)FlightField::Channels + FLIGHT_CHANNELS * FLIGHT_CHANNEL_FIELDS;
+static constexpr uint32_t FLIGHT_MAX_FRAME_BYTES = FLIGHT_FIELD_COUNT * 5u; // 5-byte varint per field
+
+struct FlightDumpHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t fieldCount;
+  uint32_t periodUs;      // snapshot period
+  uint32_t blockCount;    // blocks that follow
+  uint32_t triggerFrame;  // frame number of the fault edge, or FLIGHT_NO_TRIGGER
+  uint32_t triggerFaults; // fault bits that rose at the trigger
+  uint32_t checksum;      // FNV-1a over all block headers and payloads
+  uint32_t reserved;
+};
+
+struct FlightBlockHeader {
+  uint32_t firstFrame;  // frame number of the block's first frame
+  uint16_t frameCount;
+  uint16_t payloadBytes;
+};
+
+static_assert(sizeof(FlightDumpHeader) == 32, "FlightDumpHeader layout");
+static_assert(sizeof(FlightBlockHeader) == 8, "FlightBlockHeader layout");
+
+/**
+ * Description: Append a value delta as a zigzag varint.
+ * Inputs:
+ * - out: destination (at least 5 bytes free).
+ * - delta: signed difference from the previous value.
+ * Outputs: Returns the number of bytes written (1-5).
+ */
+inline uint8_t flightPutDelta(uint8_t* out, int32_t delta) {
+  uint32_t v = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+  uint8_t n = 0;
+  while (v >= 0x80u) {
+    out[n++] = (uint8_t)(v | 0x80u);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+/**
+ * Description: Read one zigzag varint delta.
+ * Inputs:
+ * - p: read cursor, advanced past the varint.
+ * - end: end of the payload.
+ * - delta: receives the signed difference.
+ * Outputs: Returns false on a truncated or overlong varint.
+ */
+inline bool flightGetDelta(const uint8_t*& p, const uint8_t* end, int32_t& delta) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (p >= end) {
+      return false;
+    }
+    const uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7Fu) << shift;
+    if ((b & 0x80u) == 0) {
+      delta = (int32_t)((v >> 1) ^ (0u - (v & 1u)));
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Description: Fold bytes into an FNV-1a hash.
+ * Inputs:
+ * - hash: running hash (start with 2166136261).
+ * - data: bytes to add.
+ * - len: number of bytes.
+ * Outputs: Returns the updated hash.
+ */
+inline uint32_t flightFnv1a(uint32_t hash, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include <Arduino.h>
+#include "FlightFormat.h"
+
+// Recorder counters for the "flight" command.
+struct FlightStats {
+  uint32_t frames = 0;        // recorded since arm
+  uint32_t blocksFilled = 0;  // blocks holding data (<= block count)
+  uint32_t maxFrameBytes = 0;
+  uint64_t encodedBytes = 0;  // payload written since arm
+  uint32_t maxTicks = 0;      // worst record() cost in profiler ticks
+  uint64_t totalTicks = 0;
+};
+
+// Flight recorder: a fixed ring of delta-encoded control-loop snapshots in
+// PSRAM (RAM when PSRAM is absent). The ring is split into blocks that each
+// start from an absolute frame, so overwriting the oldest block never
+// breaks decoding. A rising fault bit triggers it; it keeps recording for
+// POST_TRIGGER_FRAMES and then freezes until re-armed. A frozen ring can be
+// streamed over USB in the FlightFormat.h layout.
+class FlightRecorder {
+public:
+  static constexpr uint32_t PERIOD_US = 1000;          // snapshot period
+  static constexpr uint32_t BLOCK_BYTES = 4096;
+  static constexpr uint32_t PSRAM_BYTES = 1024u * 1024u; // ~17 s at 1 kHz (~58 bytes/frame)
+  static constexpr uint32_t RAM_BYTES = 64u * 1024u;    // fallback without PSRAM
+  static constexpr uint32_t POST_TRIGGER_FRAMES = 250;  // keep recording after the fault edge
+
+  /**
+   * Description: Allocate the ring and arm the recorder.
+   * Inputs: None.
+   * Outputs: Returns false if no memory could be allocated.
+   */
+  bool begin();
+
+  /**
+   * Description: Check whether the next snapshot is due.
+   * Inputs:
+   * - nowUs: current time in microseconds.
+   * Outputs: Returns true once per period while armed.
+   */
+  bool due(uint32_t nowUs) const { return _buf && !_frozen && !_dumping && (uint32_t)(nowUs - _lastUs) >= PERIOD_US; }
+
+  /**
+   * Description: Append one snapshot (bounded: FLIGHT_FIELD_COUNT varints).
+   * Inputs:
+   * - values: FLIGHT_FIELD_COUNT values in FlightField order.
+   * Outputs: Encodes the frame; triggers on a rising fault bit and freezes after the post-trigger window.
+   */
+  void record(const uint32_t* values);
+
+  /**
+   * Description: Freeze the ring now (manual trigger).
+   * Inputs: None.
+   * Outputs: Stops recording; contents stay until arm().
+   */
+  void freeze() { _frozen = true; }
+
+  /**
+   * Description: Clear the ring and resume recording.
+   * Inputs: None.
+   * Outputs: Drops all frames and statistics.
+   */
+  void arm();
+
+  /**
+   * Description: Start streaming the frozen ring to USB (freezes first if needed).
+   * Inputs: None.
+   * Outputs: Returns false if the ring is empty; call pollDump() until dumping() is false.
+   */
+  bool startDump();
+
+  /**
+   * Description: Continue a dump without blocking (call every loop pass while dumping).
+   * Inputs: None.
+   * Outputs: Writes as many bytes as USB accepts now.
+   */
+  void pollDump();
+
+  /**
+   * Description: Check whether a dump is in progress.
+   * Inputs: None.
+   * Outputs: Returns true until the END line has been written.
+   */
+  bool dumping() const { return _dumping; }
+
+  /**
+   * Description: Check whether a dump has written its first byte.
+   * Inputs: None.
+   * Outputs: Returns true once other USB output must wait for the END line.
+   */
+  bool dumpStarted() const { return _dumping && (_dumpStage > 0 || _dumpOffset > 0); }
+
+  /**
+   * Description: Check whether recording has stopped.
+   * Inputs: None.
+   * Outputs: Returns true after a trigger window ends, freeze() or a dump.
+   */
+  bool frozen() const { return _frozen; }
+
+  /**
+   * Description: Check whether a fault edge has triggered the recorder.
+   * Inputs: None.
+   * Outputs: Returns true until arm().
+   */
+  bool triggered() const { return _triggerFrame != FLIGHT_NO_TRIGGER; }
+
+  /**
+   * Description: Get the fault bits that rose at the trigger.
+   * Inputs: None.
+   * Outputs: Returns a system_faults mask (0 if not triggered).
+   */
+  uint32_t triggerFaults() const { return _triggerFaults; }
+
+  /**
+   * Description: Get the ring size.
+   * Inputs: None.
+   * Outputs: Returns the number of BLOCK_BYTES blocks (0 before begin()).
+   */
+  uint32_t blockCount() const { return _blockCount; }
+
+  /**
+   * Description: Check where the ring was allocated.
+   * Inputs: None.
+   * Outputs: Returns true for PSRAM, false for the RAM fallback.
+   */
+  bool inPsram() const { return _inPsram; }
+
+  /**
+   * Description: Get recorder counters.
+   * Inputs: None.
+   * Outputs: Returns frame counts and per-record cost.
+   */
+  const FlightStats& stats() const { return _stats; }
+
+  /**
+   * Description: Get the number of bytes a dump will send after the BEGIN line.
+   * Inputs: None.
+   * Outputs: Returns the binary size.
+   */
+  uint32_t dumpBytes() const;
+
+private:
+  /**
+   * Description: Get a block's header.
+   * Inputs:
+   * - index: block index.
+   * Outputs: Returns the header at the start of the block.
+   */
+  FlightBlockHeader* block(uint32_t index) const { return (FlightBlockHeader*)(_buf + index * BLOCK_BYTES); }
+
+  /**
+   * Description: Move to the next block, overwriting the oldest when full.
+   * Inputs: None.
+   * Outputs: Starts an empty block whose first frame is absolute.
+   */
+  void nextBlock();
+
+  /**
+   * Description: Get a block index in dump order.
+   * Inputs:
+   * - n: position from the oldest filled block.
+   * Outputs: Returns the ring index.
+   */
+  uint32_t dumpBlock(uint32_t n) const;
+
+  uint8_t* _buf = nullptr;
+  uint32_t _blockCount = 0;
+  uint32_t _head = 0;          // block being written
+  uint32_t _prev[FLIGHT_FIELD_COUNT] = {};
+  uint32_t _lastUs = 0;
+  uint32_t _lastFaults = 0;
+  uint32_t _triggerFrame = FLIGHT_NO_TRIGGER;
+  uint32_t _triggerFaults = 0;
+  uint32_t _postRemaining = 0;
+  bool _frozen = false;
+  bool _inPsram = false;
+  FlightStats _stats;
+
+  // Dump cursor: stage 0 = BEGIN line, 1 = header, 2 = blocks, 3 = END line.
+  bool _dumping = false;
+  uint8_t _dumpStage = 0;
+  uint32_t _dumpIndex = 0;    // block position within stage 2
+  uint32_t _dumpOffset = 0;   // bytes sent of the current piece
+  FlightDumpHeader _dumpHeader = {};
+  char _dumpText[32] = {};
+};
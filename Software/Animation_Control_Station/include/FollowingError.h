@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include "Show.h"
+
+// Escalation levels, in order of severity.
+enum class FollowLevel : uint8_t {
+  Ok = 0,
+  Warning,  // log and flag the fault
+  SlowDown, // playback rate reduced
+  Stop      // e-stop
+};
+
+// Streaming statistics of one channel's following error (counts).
+struct FollowStats {
+  float last = 0.0f;   // latest |commanded - measured|
+  float ewma = 0.0f;   // smoothed |error|
+  float trend = 0.0f;  // smoothed d|error|/dt, counts/s
+  float peak = 0.0f;   // largest |error| since reset
+  uint32_t samples = 0;
+  uint32_t lastSampleUs = 0;
+  FollowLevel level = FollowLevel::Ok;
+};
+
+// Watches commanded vs. measured position per channel. Each new encoder
+// reading updates an EWMA, a peak and a trend; the level is chosen from
+// the error projected HORIZON_S ahead along the trend, so a jam that is
+// still building up escalates before the error itself gets large. Stop
+// additionally needs the smoothed error past SLOW_COUNTS, so a noisy
+// trend alone cannot trip it. Levels drop back below CLEAR_RATIO of their
+// threshold; Stop stays latched until reset().
+class FollowingMonitor {
+public:
+  static constexpr float WARN_COUNTS = 500.0f;
+  static constexpr float SLOW_COUNTS = 1000.0f;
+  static constexpr float STOP_COUNTS = 2000.0f;
+  static constexpr float HORIZON_S = 0.25f;
+  static constexpr float CLEAR_RATIO = 0.5f;
+  static constexpr float EWMA_WEIGHT = 0.125f;
+
+  /**
+   * Description: Clear all channel statistics and levels.
+   * Inputs: None.
+   * Outputs: Every channel back to Ok.
+   */
+  void reset();
+
+  /**
+   * Description: Add a following error sample for a channel.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - commanded: position last sent to the motor.
+   * - measured: encoder position.
+   * - sampleUs: time of the encoder reading (repeats are ignored).
+   * Outputs: Returns the channel's level after the sample.
+   */
+  FollowLevel sample(uint8_t channel, float commanded, float measured, uint32_t sampleUs);
+
+  /**
+   * Description: Get the worst level over all channels.
+   * Inputs: None.
+   * Outputs: Returns the level.
+   */
+  FollowLevel level() const;
+
+  /**
+   * Description: Get a channel's statistics.
+   * Inputs:
+   * - channel: channel index.
+   * Outputs: Returns the statistics.
+   */
+  const FollowStats& stats(uint8_t channel) const { return _stats[channel]; }
+
+private:
+  FollowStats _stats[SHOW_MAX_CHANNELS];
+};
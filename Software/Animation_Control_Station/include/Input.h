@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <array>
+#include "BoardPins.h"
 
 // Enumerated SX1509-sourced button inputs
 enum class Button : uint8_t {
@@ -33,6 +34,19 @@ enum class LED : uint8_t
 };
 static constexpr uint8_t LED_COUNT = static_cast<uint8_t>(LED::COUNT);
 
+// SX1509 pin of each button, indexed by Button (buttons short to ground).
+static constexpr SXPin BUTTON_SX_PINS[BUTTON_COUNT] = {
+  SXPin::SX_BUTTON_5, // BUTTON_LEFT
+  SXPin::SX_BUTTON_3, // BUTTON_RIGHT
+  SXPin::SX_BUTTON_4, // BUTTON_DOWN
+  SXPin::SX_BUTTON_1, // BUTTON_UP
+  SXPin::SX_BUTTON_2, // BUTTON_OK
+  SXPin::SX_BUTTON_6, // BUTTON_RED
+  SXPin::SX_BUTTON_7, // BUTTON_YELLOW
+  SXPin::SX_BUTTON_8, // BUTTON_GREEN
+};
+static constexpr uint8_t LED_SX_PIN_BASE = (uint8_t)SXPin::SX_LED_1; // LED i is on SX1509 pin base + i
+
 
 struct InputState {
   // indexed by Button enum
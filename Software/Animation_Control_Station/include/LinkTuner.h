@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include "Rs422Ports.h"
+
+// Result of a CRC-checked read test on one port at one baud rate.
+struct LinkTestResult {
+  uint32_t baud = 0;
+  uint16_t requests = 0;
+  uint16_t good = 0;       // replies with a valid CRC
+  uint16_t crcErrors = 0;
+  uint16_t timeouts = 0;
+  uint32_t framesPerSec = 0; // good replies per second, back to back
+};
+
+// Finds the fastest reliable baud rate for a RoboClaw link. RoboClaw's
+// packet serial rate is set on the controller, so tuning steps through the
+// candidate rates, runs a burst of CRC-checked reads at each and keeps the
+// fastest one whose error rate is within MAX_ERROR_PERMILLE. A controller
+// set higher than its cable can carry shows up as errors at that rate.
+class LinkTuner {
+public:
+  static constexpr uint32_t CANDIDATE_BAUDS[] = {38400, 57600, 115200, 230400, 460800};
+  static constexpr uint8_t CANDIDATE_COUNT = sizeof(CANDIDATE_BAUDS) / sizeof(CANDIDATE_BAUDS[0]);
+  static constexpr uint16_t TEST_REQUESTS = 200;
+  static constexpr uint16_t PROBE_REQUESTS = 10;  // all time out: nothing answers, stop the test
+  static constexpr uint16_t MAX_ERROR_PERMILLE = 5;
+  static constexpr uint32_t REPLY_TIMEOUT_US = 10000;
+
+  /**
+   * Description: Run a read test on a port at its current baud rate.
+   * Inputs:
+   * - ports: RS422 ports.
+   * - port: port index.
+   * - requests: number of reads.
+   * Outputs: Returns counts and the achieved frame rate (blocks for the test; ends
+   *          after PROBE_REQUESTS when none of them was answered).
+   */
+  static LinkTestResult test(Rs422Ports& ports, uint8_t port, uint16_t requests = TEST_REQUESTS);
+
+  /**
+   * Description: Check whether a test result is good enough to use.
+   * Inputs:
+   * - result: test result.
+   * Outputs: Returns true when replies came back within the error budget.
+   */
+  static bool reliable(const LinkTestResult& result) {
+    const uint32_t errors = (uint32_t)result.crcErrors + result.timeouts;
+    return result.good > 0 && errors * 1000u <= (uint32_t)MAX_ERROR_PERMILLE * result.requests;
+  }
+
+  /**
+   * Description: Try every candidate rate on a port and keep the fastest reliable one.
+   * Inputs:
+   * - ports: RS422 ports.
+   * - port: port index.
+   * - results: CANDIDATE_COUNT entries, filled per candidate.
+   * Outputs: Returns the chosen baud (the port is left at it), or the original
+   *          rate when no candidate is reliable.
+   */
+  static uint32_t tune(Rs422Ports& ports, uint8_t port, LinkTestResult* results);
+};
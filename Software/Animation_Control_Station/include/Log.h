@@ -1,37 +1,201 @@
 #pragma once
 #include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+#include "ConsoleTx.h"
 
 #ifndef LOG_LEVEL
 #define LOG_LEVEL 2
 #endif
 
+// Deferred logging: a LOG call only copies its format pointer (the string
+// ID; host tools can map it back through the ELF), a timestamp and its raw
+// arguments into a ring buffer. Formatting and the USB write happen later
+// in logDrain(), from idle time. Records are reserved with a lock-free
+// compare-and-swap, so logging is safe from ISRs. String arguments are
+// copied into the record because their storage may not outlive the call.
+// Formatted lines go to the buffered console (ConsoleTx), on the response
+// lane while a console command runs and on the log lane otherwise.
+static constexpr uint8_t LOG_MAX_ARGS = 12;
+static constexpr uint8_t LOG_TEXT_BYTES = 48;  // copied string arguments per record
+static constexpr uint16_t LOG_RING_RECORDS = 256; // power of two
+
+enum class LogArgType : uint8_t {
+  Int = 0,
+  Uint,
+  Double,
+  Text, // offset into the record's text
+  Ptr
+};
+
+// One queued log call. Trivially constructible so the ring can sit in DMAMEM.
+struct LogRecord {
+  const char* fmt;
+  uint32_t timeUs;
+  std::atomic<uint8_t> ready;
+  uint8_t level;
+  uint8_t lane;     // ConsoleLane
+  uint8_t argCount;
+  uint8_t textUsed;
+  LogArgType types[LOG_MAX_ARGS];
+  uint64_t args[LOG_MAX_ARGS]; // integers widened, doubles by bits, text by offset
+  char text[LOG_TEXT_BYTES];
+};
+
+// Logger counters for diagnostics.
+struct LogStats {
+  uint32_t records = 0;  // formatted and written
+  uint32_t dropped = 0;  // ring full at the call
+  uint32_t maxLagUs = 0; // call to write, worst case
+  uint16_t pending = 0;  // records waiting now
+};
+
 /**
  * Description: Initialize the serial logger at the specified baud rate.
  * Inputs:
  * - baud: serial baud rate (default 115200).
- * Outputs: Opens the Serial port and waits briefly for USB.
+ * Outputs: Opens the Serial port, waits briefly for USB and empties the log ring.
  */
-inline void logInit(unsigned long baud = 115200) {
-  Serial.begin(baud);
-  // Don’t block forever if USB isn’t connected
-  const uint32_t t0 = millis();
-  while (!Serial && (millis() - t0) < 500) {}
+void logInit(unsigned long baud = 115200);
+
+/**
+ * Description: Reserve a ring record for a log call (ISR safe).
+ * Inputs:
+ * - level: log level (1 = I, 2 = D, 3 = V).
+ * - fmt: printf format string (must be a literal).
+ * Outputs: Returns the record to fill, or nullptr (counted as dropped) when the ring is full.
+ */
+LogRecord* logReserve(uint8_t level, const char* fmt);
+
+/**
+ * Description: Publish a filled record to the drain.
+ * Inputs:
+ * - record: record from logReserve().
+ * Outputs: Marks the record ready.
+ */
+inline void logCommit(LogRecord* record) { record->ready.store(1, std::memory_order_release); }
+
+/**
+ * Description: Format and write queued records (call from idle time).
+ * Inputs:
+ * - maxRecords: upper bound on records written in this call.
+ * Outputs: Returns the number of records queued to the console.
+ */
+uint32_t logDrain(uint32_t maxRecords = LOG_RING_RECORDS);
+
+/**
+ * Description: Format a log line immediately, bypassing the record ring.
+ * Inputs:
+ * - level: log level.
+ * - fmt: printf format string.
+ * - ...: format arguments.
+ * Outputs: Queues the formatted line on the current console lane.
+ */
+void logSync(uint8_t level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Description: Select the console lane for lines logged from now on.
+ * Inputs:
+ * - lane: ConsoleLane::Response while a command runs, ConsoleLane::Log otherwise.
+ * Outputs: Tags later records with the lane.
+ */
+void logSetLane(ConsoleLane lane);
+
+/**
+ * Description: Get logger counters.
+ * Inputs: None.
+ * Outputs: Returns records written, drops, worst lag and the current backlog.
+ */
+LogStats logStats();
+
+/**
+ * Description: Store one argument in a record.
+ * Inputs:
+ * - record: record being filled.
+ * - value: argument value.
+ * Outputs: Appends the argument (strings are copied, truncated to the text space).
+ */
+template <typename T>
+inline void logPut(LogRecord* record, T value) {
+  const uint8_t n = record->argCount++;
+  using V = typename std::decay<T>::type;
+  if constexpr (std::is_same<V, char*>::value || std::is_same<V, const char*>::value) {
+    const uint8_t start = record->textUsed;
+    uint8_t end = start;
+    if (value) {
+      while (end + 1 < LOG_TEXT_BYTES && value[end - start] != '\0') {
+        record->text[end] = value[end - start];
+        end++;
+      }
+    }
+    if (end < LOG_TEXT_BYTES) {
+      record->text[end++] = '\0';
+    }
+    record->textUsed = end;
+    record->types[n] = LogArgType::Text;
+    record->args[n] = start;
+  } else if constexpr (std::is_pointer<V>::value) {
+    record->types[n] = LogArgType::Ptr;
+    record->args[n] = (uint64_t)(uintptr_t)value;
+  } else if constexpr (std::is_floating_point<V>::value) {
+    const double d = (double)value;
+    record->types[n] = LogArgType::Double;
+    memcpy(&record->args[n], &d, sizeof(d));
+  } else if constexpr (std::is_signed<V>::value) {
+    record->types[n] = LogArgType::Int;
+    record->args[n] = (uint64_t)(int64_t)value;
+  } else {
+    record->types[n] = LogArgType::Uint;
+    record->args[n] = (uint64_t)value;
+  }
 }
 
+/**
+ * Description: Queue a log line for deferred formatting.
+ * Inputs:
+ * - level: log level.
+ * - fmt: printf format string (must be a literal).
+ * - args: format arguments.
+ * Outputs: Copies the call into the ring; nothing is formatted here.
+ */
+template <typename... Args>
+inline void logDeferred(uint8_t level, const char* fmt, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+  LogRecord* record = logReserve(level, fmt);
+  if (!record) {
+    return;
+  }
+  (logPut(record, args), ...);
+  logCommit(record);
+}
+
+/**
+ * Description: Never called; lets the compiler check LOG format strings against their arguments.
+ * Inputs:
+ * - fmt: printf format string.
+ * - ...: format arguments.
+ * Outputs: None.
+ */
+inline void logFormatCheck(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+inline void logFormatCheck(const char* fmt, ...) { (void)fmt; }
+
+#define LOG_DEFERRED(level, ...) \
+  do { if (0) logFormatCheck(__VA_ARGS__); logDeferred(level, __VA_ARGS__); } while(0)
+
 #if LOG_LEVEL >= 1
-  #define LOGI(...) do { Serial.printf("[I] " __VA_ARGS__); Serial.print("\n"); } while(0)
+  #define LOGI(...) LOG_DEFERRED(1, __VA_ARGS__)
 #else
   #define LOGI(...) do {} while(0)
 #endif
 
 #if LOG_LEVEL >= 2
-  #define LOGD(...) do { Serial.printf("[D] " __VA_ARGS__); Serial.print("\n"); } while(0)
+  #define LOGD(...) LOG_DEFERRED(2, __VA_ARGS__)
 #else
   #define LOGD(...) do {} while(0)
 #endif
 
 #if LOG_LEVEL >= 3
-  #define LOGV(...) do { Serial.printf("[V] " __VA_ARGS__); Serial.print("\n"); } while(0)
+  #define LOGV(...) LOG_DEFERRED(3, __VA_ARGS__)
 #else
   #define LOGV(...) do {} while(0)
 #endif
@@ -0,0 +1,173 @@
+#pragma once
+#include <Arduino.h>
+
+// Shape of the velocity ramps generated by the planner.
+enum class ProfileShape : uint8_t {
+  Trapezoid = 0, // constant acceleration ramps (infinite jerk)
+  SCurve         // jerk-limited ramps (continuous acceleration)
+};
+
+// Kinematic limits applied to a move (units per second, per second^2, per second^3).
+struct MotionLimits {
+  float maxVel = 0.0f;
+  float maxAccel = 0.0f;
+  float maxJerk = 0.0f; // ignored by ProfileShape::Trapezoid
+};
+
+// Kinematic state sampled from a profile at a point in time.
+struct MotionSample {
+  float pos = 0.0f;
+  float vel = 0.0f;
+  float acc = 0.0f;
+};
+
+class MotionProfile {
+public:
+  // Worst case: zero accel, brake (3), accel (3), cruise, decel (3), hold.
+  static constexpr uint8_t MAX_SEGMENTS = 12;
+
+  /**
+   * Description: Reset the profile to rest at a position.
+   * Inputs:
+   * - pos: resting position.
+   * - nowUs: current time in microseconds.
+   * Outputs: Clears the plan and holds at pos.
+   */
+  void reset(float pos, uint32_t nowUs) { reset(pos, 0.0f, nowUs); }
+
+  /**
+   * Description: Reset the profile to a state that may be moving (e.g. a setpoint taken over mid-motion).
+   * Inputs:
+   * - pos: current position.
+   * - vel: current velocity (units per second).
+   * - nowUs: current time in microseconds.
+   * Outputs: Clears the plan and coasts at vel from pos; the next moveTo()
+   *          starts from this state and bleeds the velocity off within its limits.
+   */
+  void reset(float pos, float vel, uint32_t nowUs);
+
+  /**
+   * Description: Select the ramp shape used by subsequent plans.
+   * Inputs:
+   * - shape: trapezoid or S-curve.
+   * Outputs: Stores the shape; the active plan is unchanged.
+   */
+  void setShape(ProfileShape shape) { _shape = shape; }
+
+  /**
+   * Description: Plan a move to a new target starting from the current state.
+   * Inputs:
+   * - target: destination position.
+   * - limits: kinematic limits for the move.
+   * - nowUs: current time in microseconds.
+   * Outputs: Replaces the active plan; motion stays continuous.
+   */
+  void moveTo(float target, const MotionLimits& limits, uint32_t nowUs);
+
+  /**
+   * Description: Change the limits of the active move without restarting it.
+   * Inputs:
+   * - limits: new kinematic limits.
+   * - nowUs: current time in microseconds.
+   * Outputs: Replans toward the existing target from the current state.
+   */
+  void setLimits(const MotionLimits& limits, uint32_t nowUs);
+
+  /**
+   * Description: Evaluate the profile at a point in time.
+   * Inputs:
+   * - nowUs: current time in microseconds (monotonic between calls).
+   * Outputs: Returns position, velocity and acceleration. Constant time per call.
+   */
+  MotionSample sample(uint32_t nowUs);
+
+  /**
+   * Description: Check whether the move has reached its target.
+   * Inputs:
+   * - nowUs: current time in microseconds.
+   * Outputs: Returns true once the final hold segment is active.
+   */
+  bool isDone(uint32_t nowUs) const;
+
+  /**
+   * Description: Get the active target position.
+   * Inputs: None.
+   * Outputs: Returns the destination of the current plan.
+   */
+  float target() const { return _target; }
+
+  /**
+   * Description: Get the active kinematic limits.
+   * Inputs: None.
+   * Outputs: Returns the limits used by the current plan.
+   */
+  const MotionLimits& limits() const { return _limits; }
+
+  /**
+   * Description: Get the number of plans computed since reset.
+   * Inputs: None.
+   * Outputs: Returns the plan counter.
+   */
+  uint32_t planCount() const { return _planCount; }
+
+private:
+  // One constant-jerk piece of the profile, starting at tStart seconds.
+  struct Segment {
+    float tStart;
+    float duration;
+    float p0, v0, a0, j;
+  };
+
+  /**
+   * Description: Build the segment table from a starting state.
+   * Inputs:
+   * - start: state at the plan origin.
+   * Outputs: Fills _segments and _segmentCount.
+   */
+  void plan(const MotionSample& start);
+
+  /**
+   * Description: Append a constant-jerk segment continuing from the running state.
+   * Inputs:
+   * - state: running state, advanced to the end of the segment.
+   * - duration: segment duration in seconds.
+   * - jerk: constant jerk over the segment.
+   * Outputs: Appends one segment when duration is positive.
+   */
+  void appendSegment(MotionSample& state, float duration, float jerk);
+
+  /**
+   * Description: Append the ramp that changes velocity from the running state to vEnd.
+   * Inputs:
+   * - state: running state with zero acceleration.
+   * - vEnd: velocity at the end of the ramp.
+   * Outputs: Appends one (trapezoid) or two/three (S-curve) segments.
+   */
+  void appendVelocityChange(MotionSample& state, float vEnd);
+
+  /**
+   * Description: Distance travelled while ramping between two velocities.
+   * Inputs:
+   * - vStart: starting velocity (>= 0).
+   * - vEnd: ending velocity (>= 0).
+   * Outputs: Returns the distance covered by the ramp.
+   */
+  float rampDistance(float vStart, float vEnd) const;
+
+  /**
+   * Description: Duration of a ramp between two velocities.
+   * Inputs:
+   * - deltaVel: absolute velocity change.
+   * Outputs: Returns the ramp duration in seconds.
+   */
+  float rampTime(float deltaVel) const;
+
+  Segment _segments[MAX_SEGMENTS] = {};
+  uint8_t _segmentCount = 0;
+  uint8_t _cursor = 0;
+  uint32_t _t0Us = 0;
+  float _target = 0.0f;
+  MotionLimits _limits;
+  ProfileShape _shape = ProfileShape::SCurve;
+  uint32_t _planCount = 0;
+};
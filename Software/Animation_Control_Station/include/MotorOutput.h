@@ -0,0 +1,449 @@
+#pragma once
+#include <Arduino.h>
+#include "Rs422Ports.h"
+#include "RoboClaw.h"
+#include "ShowEngine.h"
+#include "Telemetry.h"
+
+// Running one-way latency estimate for a port (EWMA, 1/8 weight).
+class LatencyEstimator {
+public:
+  /**
+   * Description: Forget all samples.
+   * Inputs: None.
+   * Outputs: Resets the estimate to 0.
+   */
+  void reset() { *this = LatencyEstimator{}; }
+
+  /**
+   * Description: Add a latency measurement.
+   * Inputs:
+   * - us: measured latency in microseconds.
+   * Outputs: Updates the estimate and min/max.
+   */
+  void addSample(uint32_t us) {
+    _avgQ3 = (_count == 0) ? (us << 3) : (_avgQ3 - (_avgQ3 >> 3) + us);
+    if (_count == 0 || us < _minUs) _minUs = us;
+    if (us > _maxUs) _maxUs = us;
+    _lastUs = us;
+    _count++;
+  }
+
+  /**
+   * Description: Get the smoothed latency.
+   * Inputs: None.
+   * Outputs: Returns microseconds (0 before the first sample).
+   */
+  uint32_t estimateUs() const { return _avgQ3 >> 3; }
+
+  uint32_t lastUs() const { return _lastUs; }
+  uint32_t minUs() const { return _minUs; }
+  uint32_t maxUs() const { return _maxUs; }
+  uint32_t count() const { return _count; }
+
+private:
+  uint32_t _avgQ3 = 0; // average * 8
+  uint32_t _lastUs = 0;
+  uint32_t _minUs = 0;
+  uint32_t _maxUs = 0;
+  uint32_t _count = 0;
+};
+
+// Inter-channel arrival skew. Each acknowledged frame contributes its
+// residual (actual latency - lead the frame was evaluated with); the skew
+// of a window is the spread of residuals across all ports. The spread of
+// raw latencies is what the skew would be without lookahead.
+class SkewTracker {
+public:
+  static constexpr uint32_t WINDOW_US = 1000000;
+
+  /**
+   * Description: Clear all skew statistics.
+   * Inputs: None.
+   * Outputs: Starts a new window at the next sample.
+   */
+  void reset() { *this = SkewTracker{}; }
+
+  /**
+   * Description: Add one acknowledged frame.
+   * Inputs:
+   * - residualUs: actual latency minus the lead used.
+   * - latencyUs: actual latency.
+   * - nowUs: current time.
+   * Outputs: Closes the window and updates the maxima once WINDOW_US has passed.
+   */
+  void add(int32_t residualUs, uint32_t latencyUs, uint32_t nowUs);
+
+  uint32_t lastSkewUs() const { return _lastSkewUs; }
+  uint32_t maxSkewUs() const { return _maxSkewUs; }
+  uint32_t lastUncompensatedUs() const { return _lastRawUs; }
+  uint32_t maxUncompensatedUs() const { return _maxRawUs; }
+
+private:
+  bool _open = false;
+  uint32_t _windowStartUs = 0;
+  int32_t _minResidual = 0, _maxResidual = 0;
+  uint32_t _minLatency = 0, _maxLatency = 0;
+  uint32_t _lastSkewUs = 0, _maxSkewUs = 0;
+  uint32_t _lastRawUs = 0, _maxRawUs = 0;
+};
+
+struct OutputPortStats {
+  uint32_t framesSent = 0;
+  uint32_t acks = 0;
+  uint32_t timeouts = 0;
+  uint32_t telemetryRequests = 0;
+  uint32_t telemetryTimeouts = 0;
+  uint32_t crcErrors = 0;
+  uint32_t lastQueueUs = 0; // TX queue ahead of the last frame
+  LatencyEstimator latency; // frame write -> received by the controller
+};
+
+// Synchronized start diagnostics (release = the held trigger bytes going out).
+struct SyncStartStats {
+  uint32_t releases = 0;
+  uint32_t lastSkewNs = 0; // first to last port trigger write
+  uint32_t maxSkewNs = 0;
+  uint32_t lastLateUs = 0; // timer release after the planned time
+  uint32_t maxLateUs = 0;
+  uint32_t lastHoldUs = 0; // prime to release (slowest port's primed bytes + margin)
+};
+
+enum class StopSource : uint8_t {
+  None = 0,
+  Input,   // hardwired e-stop pin
+  Button,  // front panel RUN/HALT
+  Console,
+  Following, // following error monitor
+  Fault      // fault reaction table
+};
+
+// Emergency stop diagnostics. Last byte times are predicted at trip time
+// from each port's queued bytes; the drained time is confirmed by the loop.
+struct EStopStats {
+  uint32_t trips = 0;
+  StopSource lastSource = StopSource::None;
+  uint32_t lastIsrNs = 0;      // time spent writing stop frames
+  uint32_t lastWorstUs = 0;    // trip -> last stop byte on the slowest port
+  uint32_t maxWorstUs = 0;
+  uint32_t lastDrainedUs = 0;  // trip -> all TX queues seen empty by the loop
+};
+
+// Streams show setpoints to RoboClaw controllers, one two-motor position
+// frame per port per FRAME_PERIOD_US, and fills the gaps between frames
+// with telemetry reads. Each port has one transaction in flight at a time. Each port's latency is measured from
+// its acknowledgements and fed back to the show engine as a per-channel
+// lead, so every channel is evaluated at now + latency and lands in sync.
+// Channel ch drives motor (ch % 2) on port (ch / 2).
+class MotorOutput {
+public:
+  static constexpr uint8_t MOTORS_PER_PORT = 2;
+  static constexpr uint32_t FRAME_PERIOD_US = 20000; // 50 Hz per port
+  static constexpr uint32_t ACK_TIMEOUT_US = 20000;
+  static constexpr uint32_t SYNC_MARGIN_US = 500; // after the slowest port's primed bytes drain
+  static constexpr uint8_t STOP_ADDRESS_COUNT = 1;
+  static constexpr uint8_t STOP_ADDRESSES[STOP_ADDRESS_COUNT] = {ROBOCLAW_DEFAULT_ADDRESS};
+  static constexpr size_t STOP_BYTES = RoboClaw::MIXED_SPEED_FRAME_BYTES * STOP_ADDRESS_COUNT;
+
+  /**
+   * Description: Attach the output stage to the serial ports.
+   * Inputs:
+   * - ports: RS422 ports (already started).
+   * - limits: per-channel motor limits (accel/speed for the frames).
+   * Outputs: Resets statistics; output starts disabled.
+   */
+  void begin(Rs422Ports* ports, const ChannelLimits* limits);
+
+  /**
+   * Description: Enable or disable motor frames.
+   * Inputs:
+   * - enabled: true to stream setpoints.
+   * Outputs: Updates the output state.
+   */
+  void setEnabled(bool enabled) {
+    _enabled = enabled;
+    _commandedMask = 0;
+  }
+
+  /**
+   * Description: Check whether motor frames are being sent.
+   * Inputs: None.
+   * Outputs: Returns true when enabled.
+   */
+  bool isEnabled() const { return _enabled; }
+
+  /**
+   * Description: Read acknowledgements and update latency (call every tick, before applyLeads()).
+   * Inputs:
+   * - nowUs: current time.
+   * Outputs: Updates per-port latency and skew statistics.
+   */
+  void poll(uint32_t nowUs);
+
+  /**
+   * Description: Push each port's measured latency into the show engine as channel leads.
+   * Inputs:
+   * - show: engine to update (before evaluate()).
+   * Outputs: Sets a lead per channel (0 while disabled).
+   */
+  void applyLeads(ShowEngine& show) const;
+
+  /**
+   * Description: Send frames for ports that are due (call after evaluate()).
+   * Inputs:
+   * - show: engine with fresh setpoints.
+   * - nowUs: current time.
+   * Outputs: Writes at most one frame per port.
+   */
+  void send(const ShowEngine& show, uint32_t nowUs);
+
+  /**
+   * Description: Prime every port with its first frame and schedule a common release.
+   * Inputs:
+   * - show: engine positioned at the start point (paused).
+   * - nowUs: current time.
+   * Outputs: Returns false if output is off, no show is attached or a start is already armed.
+   *          Each frame is written except its final CRC byte; a timer compare
+   *          writes the held bytes to all ports back to back, so every
+   *          controller completes its command within the same microsecond.
+   */
+  bool armSyncStart(const ShowEngine& show, uint32_t nowUs);
+
+  /**
+   * Description: Check whether a synchronized start is waiting for its release.
+   * Inputs: None.
+   * Outputs: Returns true between armSyncStart() and takeSyncRelease().
+   */
+  bool syncArmed() const { return _syncArmed; }
+
+  /**
+   * Description: Collect a synchronized start once released (call every tick).
+   * Inputs:
+   * - releaseUs: receives the release time.
+   * Outputs: Returns true once per release; resumes periodic frames in phase from it.
+   */
+  bool takeSyncRelease(uint32_t& releaseUs);
+
+  /**
+   * Description: Get the synchronized start diagnostics.
+   * Inputs: None.
+   * Outputs: Returns the statistics.
+   */
+  const SyncStartStats& syncStats() const { return _syncStats; }
+
+  /**
+   * Description: Attach the hardwired e-stop input (active low) to the stop interrupt.
+   * Inputs:
+   * - pin: GPIO pin.
+   * Outputs: A falling edge calls emergencyStop() from the pin interrupt.
+   */
+  void attachStopInput(uint8_t pin);
+
+  /**
+   * Description: Stop every motor now (ISR safe).
+   * Inputs:
+   * - source: what tripped the stop.
+   * Outputs: Drops any held sync frame, writes the precomputed stop frame for
+   *          every address on every port back to back, latches
+   *          FAULT_ESTOP_FAULT and blocks frames until resetStop(). Frames
+   *          already on the wire finish first; cutting one would make the
+   *          controller swallow the stop frame as the rest of that packet.
+   */
+  void emergencyStop(StopSource source);
+
+  /**
+   * Description: Check whether the stop is latched.
+   * Inputs: None.
+   * Outputs: Returns true until resetStop() succeeds.
+   */
+  bool isStopped() const { return _stopped; }
+
+  /**
+   * Description: Clear a latched stop.
+   * Inputs: None.
+   * Outputs: Returns false (still latched) while the e-stop input is asserted.
+   */
+  bool resetStop();
+
+  /**
+   * Description: Get the emergency stop diagnostics.
+   * Inputs: None.
+   * Outputs: Returns the statistics.
+   */
+  const EStopStats& stopStats() const { return _stopStats; }
+
+  /**
+   * Description: Model the worst-case trip-to-last-byte time at a baud rate.
+   * Inputs:
+   * - baud: line rate.
+   * Outputs: Returns microseconds for one full in-flight frame, the sync abort byte and the stop frames.
+   */
+  static uint32_t worstStopUs(uint32_t baud) {
+    return serialBytesUs(RoboClaw::MIXED_POSITION_FRAME_BYTES + 1 + STOP_BYTES, baud);
+  }
+
+  /**
+   * Description: Get the position last sent to a channel's motor.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - pos: receives the commanded position.
+   * Outputs: Returns false until a frame has been sent for the channel.
+   */
+  bool commandedPos(uint8_t channel, int32_t& pos) const {
+    if (channel >= SHOW_MAX_CHANNELS || !(_commandedMask & (1u << channel))) {
+      return false;
+    }
+    pos = _commanded[channel];
+    return true;
+  }
+
+  /**
+   * Description: Enable or disable telemetry polling (runs while output is enabled).
+   * Inputs:
+   * - enabled: true to poll.
+   * Outputs: Updates the telemetry state.
+   */
+  void setTelemetryEnabled(bool enabled) { _telemetryEnabled = enabled; }
+
+  /**
+   * Description: Check whether telemetry polling is on.
+   * Inputs: None.
+   * Outputs: Returns true when enabled.
+   */
+  bool telemetryEnabled() const { return _telemetryEnabled; }
+
+  /**
+   * Description: Access the per-channel telemetry readings.
+   * Inputs: None.
+   * Outputs: Returns the table (safe to read from any context).
+   */
+  const TelemetryTable& telemetry() const { return _telemetry; }
+
+  /**
+   * Description: Get a port's telemetry scheduler (rates and budget).
+   * Inputs:
+   * - port: port index.
+   * Outputs: Returns the scheduler.
+   */
+  const TelemetryScheduler& telemetryScheduler(uint8_t port) const { return _telemetrySched[port]; }
+
+  /**
+   * Description: Get a port's output statistics.
+   * Inputs:
+   * - port: port index [0..RS422_PORT_COUNT-1].
+   * Outputs: Returns the statistics.
+   */
+  const OutputPortStats& portStats(uint8_t port) const { return _stats[port]; }
+
+  /**
+   * Description: Get the arrival skew statistics.
+   * Inputs: None.
+   * Outputs: Returns the tracker.
+   */
+  const SkewTracker& skew() const { return _skew; }
+
+  /**
+   * Description: Clear latency and skew statistics.
+   * Inputs: None.
+   * Outputs: Resets all counters.
+   */
+  void resetStats();
+
+  /**
+   * Description: Map a channel to its RS422 port.
+   * Inputs:
+   * - channel: channel index.
+   * Outputs: Returns the port index.
+   */
+  static uint8_t portOf(uint8_t channel) { return channel / MOTORS_PER_PORT; }
+
+private:
+  enum class Pending : uint8_t {
+    None = 0,
+    Motion,    // waiting for a frame ack
+    Telemetry  // waiting for a read reply
+  };
+
+  struct PortState {
+    Pending pending = Pending::None;
+    uint32_t sentUs = 0;
+    uint32_t leadUs = 0;     // lead the pending frame was evaluated with
+    uint32_t lastFrameUs = 0;
+    TelemetryField field = TelemetryField::Position;
+    uint8_t rxCount = 0;
+    uint8_t rx[RoboClaw::MAX_REPLY_BYTES] = {};
+  };
+
+  /**
+   * Description: Send the next due telemetry request on an idle port.
+   * Inputs:
+   * - p: port index.
+   * - motionActive: true when the port carries motion frames.
+   * - nowUs: current time.
+   * Outputs: Writes at most one request.
+   */
+  void sendTelemetry(uint8_t p, bool motionActive, uint32_t nowUs);
+
+  /**
+   * Description: Consume a received byte of a telemetry reply.
+   * Inputs:
+   * - p: port index.
+   * - b: received byte.
+   * - nowUs: current time.
+   * Outputs: Stores the reading once the reply is complete and its CRC matches.
+   */
+  void receiveTelemetry(uint8_t p, uint8_t b, uint32_t nowUs);
+
+  /**
+   * Description: Convert a setpoint into a RoboClaw move.
+   * Inputs:
+   * - channel: channel index.
+   * - sp: setpoint.
+   * Outputs: Returns the move with speed/accel from the setpoint and limits.
+   */
+  RoboClawMove moveFor(uint8_t channel, const ChannelSetpoint& sp) const;
+
+  /**
+   * Description: Timer compare ISR: write the held trigger bytes to all primed ports.
+   * Inputs: None (ISR context).
+   * Outputs: Stops the timer and records per-port write cycle counts.
+   */
+  static void syncReleaseIsr();
+
+  /**
+   * Description: E-stop pin interrupt.
+   * Inputs: None (ISR context).
+   * Outputs: Trips the stop.
+   */
+  static void stopInputIsr();
+  static inline MotorOutput* _self = nullptr;
+
+  Rs422Ports* _ports = nullptr;
+  const ChannelLimits* _limits = nullptr;
+  IntervalTimer _syncTimer;
+  volatile bool _syncArmed = false;
+  volatile bool _syncFired = false;
+  uint8_t _syncMask = 0;                       // ports holding a trigger byte
+  uint8_t _syncTrigger[RS422_PORT_COUNT] = {}; // final CRC byte per port
+  uint32_t _syncPlannedUs = 0;
+  uint32_t _syncPrimeUs = 0;
+  volatile uint32_t _syncFiredUs = 0;
+  volatile uint32_t _syncFirstCycles = 0;
+  volatile uint32_t _syncLastCycles = 0;
+  SyncStartStats _syncStats;
+  int32_t _commanded[SHOW_MAX_CHANNELS] = {};
+  uint16_t _commandedMask = 0; // channels with a frame sent
+  bool _telemetryEnabled = true;
+  TelemetryTable _telemetry;
+  TelemetryScheduler _telemetrySched[RS422_PORT_COUNT];
+  uint8_t _stopFrame[STOP_BYTES] = {}; // built once in begin()
+  uint8_t _stopPin = 255;
+  volatile bool _stopped = false;
+  volatile bool _stopDraining = false;
+  volatile uint32_t _stopTripUs = 0;
+  EStopStats _stopStats;
+  bool _enabled = false;
+  PortState _state[RS422_PORT_COUNT];
+  OutputPortStats _stats[RS422_PORT_COUNT];
+  SkewTracker _skew;
+};
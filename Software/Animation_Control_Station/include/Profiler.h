@@ -0,0 +1,140 @@
+#pragma once
+#include <stdint.h>
+
+// Scoped loop profiler. PROFILE_SCOPE(Id) times the rest of the enclosing
+// block (PROFILE_BEGIN/PROFILE_END bracket a flat stretch of code instead)
+// and folds the result into that probe's min/avg/max and a log2
+// histogram. On the Teensy the clock is the DWT cycle counter (one read
+// per edge); host builds use std::chrono::steady_clock in nanoseconds.
+// Build with -DPROFILE_ENABLED=0 to compile every probe out.
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 1
+#endif
+
+#if defined(ARDUINO)
+  #include <Arduino.h>
+#else
+  #include <chrono>
+#endif
+
+enum class ProbeId : uint8_t {
+  Loop = 0,  // whole App::loop() pass
+  Console,   // console RX and command dispatch
+  Input,     // buttons, pots and LEDs (I2C expander)
+  Rs422Test, // test traffic and RX dumps while motors are off
+  Jog,       // jog/scrub planning
+  Show,      // sync release and show clock update
+  Motors,    // RoboClaw poll, following error and latency leads
+  Evaluate,  // track evaluation for all channels
+  Send,      // setpoint/telemetry frames to the RS422 ports
+  Flight,    // flight recorder snapshot
+  Ui,        // display render
+  Cues,      // show event drain
+  Slots,     // background show loading
+  Config,    // deferred settings save
+  Log,       // log formatting and console TX
+  Trace,     // trace capture SD writes
+  Count
+};
+
+static constexpr uint8_t PROFILE_BUCKETS = 32; // bucket b holds durations in [2^(b-1), 2^b) ticks
+
+struct ProbeStats {
+  uint32_t count = 0;
+  uint32_t minTicks = 0xFFFFFFFFu;
+  uint32_t maxTicks = 0;
+  uint64_t totalTicks = 0;
+  uint32_t histogram[PROFILE_BUCKETS] = {};
+};
+
+/**
+ * Description: Read the profiler clock.
+ * Inputs: None.
+ * Outputs: Returns CPU cycles on the Teensy, nanoseconds on the host.
+ */
+inline uint32_t profileNow() {
+#if defined(ARDUINO)
+  return ARM_DWT_CYCCNT;
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Description: Get the profiler clock rate.
+ * Inputs: None.
+ * Outputs: Returns ticks per microsecond.
+ */
+inline uint32_t profileTicksPerUs() {
+#if defined(ARDUINO)
+  return F_CPU_ACTUAL / 1000000u;
+#else
+  return 1000u;
+#endif
+}
+
+// Probe table, indexed by ProbeId.
+inline ProbeStats g_probes[(uint8_t)ProbeId::Count];
+
+/**
+ * Description: Fold one measured duration into a probe.
+ * Inputs:
+ * - id: probe.
+ * - ticks: duration in profiler ticks.
+ * Outputs: Updates count, min/max/total and the log2 histogram.
+ */
+inline void profileRecord(ProbeId id, uint32_t ticks) {
+  ProbeStats& p = g_probes[(uint8_t)id];
+  p.count++;
+  p.totalTicks += ticks;
+  if (ticks < p.minTicks) p.minTicks = ticks;
+  if (ticks > p.maxTicks) p.maxTicks = ticks;
+  const uint8_t bucket = ticks ? (uint8_t)(32 - __builtin_clz(ticks)) : 0;
+  p.histogram[bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1]++;
+}
+
+/**
+ * Description: Clear all probes.
+ * Inputs: None.
+ * Outputs: Resets every probe to empty.
+ */
+inline void profileReset() {
+  for (ProbeStats& p : g_probes) {
+    p = ProbeStats{};
+  }
+}
+
+/**
+ * Description: Get a probe's printable name.
+ * Inputs:
+ * - id: probe.
+ * Outputs: Returns a short lowercase name.
+ */
+const char* profileName(ProbeId id);
+
+// Times its enclosing scope.
+class ProfileScope {
+public:
+  explicit ProfileScope(ProbeId id) : _id(id), _start(profileNow()) {}
+  ~ProfileScope() { profileRecord(_id, profileNow() - _start); }
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  ProbeId _id;
+  uint32_t _start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILE_ENABLED
+  #define PROFILE_SCOPE(id) ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(ProbeId::id)
+  #define PROFILE_BEGIN(id) const uint32_t _profileStart##id = profileNow()
+  #define PROFILE_END(id) profileRecord(ProbeId::id, profileNow() - _profileStart##id)
+#else
+  #define PROFILE_SCOPE(id) do {} while(0)
+  #define PROFILE_BEGIN(id) do {} while(0)
+  #define PROFILE_END(id) do {} while(0)
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+#include <Arduino.h>
+#include "Show.h"
+#include "TrackBuilder.h"
+
+// Live input sources that can be recorded onto a channel.
+enum class RecordSource : uint8_t {
+  Jog = 0,  // smoothed jog position
+  SpeedPot,
+  AccelPot,
+
+  COUNT
+};
+
+struct RecordStats {
+  uint32_t samples = 0;   // raw samples taken (one per show millisecond)
+  uint32_t keys = 0;      // keys emitted for the recorded span
+  float maxError = 0.0f;  // largest |sample - track| over the recorded span
+  float tolerance = 0.0f;
+  bool overflow = false;  // scratch key storage ran out
+};
+
+// Records a live input onto one channel while the others play back.
+// Samples are simplified as they arrive with a swinging-door fit: each
+// linear segment is extended until no single line can stay within the
+// tolerance of every sample in it, so key count follows motion complexity
+// rather than duration. Keys outside the punch-in/out span are copied from
+// the original track.
+class Recorder {
+public:
+  static constexpr uint32_t SCRATCH_KEYS = 16384;
+  static constexpr uint16_t SEGMENT_MAX_SAMPLES = 512; // bounds error bookkeeping per segment
+
+  /**
+   * Description: Punch in on a channel.
+   * Inputs:
+   * - channel: channel to record [0..SHOW_MAX_CHANNELS-1].
+   * - original: current track for the channel (may be nullptr or empty).
+   * - startMs: show time of the punch-in.
+   * - tolerance: maximum deviation of the recorded track from the input (units).
+   * Outputs: Returns false for an invalid channel or if already recording.
+   */
+  bool start(uint8_t channel, const Track* original, uint32_t startMs, float tolerance);
+
+  /**
+   * Description: Feed one input sample (call every control tick).
+   * Inputs:
+   * - tMs: show time; repeated milliseconds are ignored.
+   * - value: live input value.
+   * Outputs: Extends the current segment or emits a key.
+   */
+  void sample(uint32_t tMs, float value);
+
+  /**
+   * Description: Punch out and publish the recorded take for the channel.
+   * Inputs: None.
+   * Outputs: Returns true when the take was stored (see take()).
+   */
+  bool stop();
+
+  /**
+   * Description: Abandon the recording in progress.
+   * Inputs: None.
+   * Outputs: Leaves any previous take for the channel untouched.
+   */
+  void cancel() { _recording = false; }
+
+  /**
+   * Description: Check whether a recording is in progress.
+   * Inputs: None.
+   * Outputs: Returns true between start() and stop()/cancel().
+   */
+  bool isRecording() const { return _recording; }
+
+  /**
+   * Description: Get the channel being recorded.
+   * Inputs: None.
+   * Outputs: Returns the channel index.
+   */
+  uint8_t channel() const { return _channel; }
+
+  /**
+   * Description: Get the finished take for a channel.
+   * Inputs:
+   * - channel: channel index.
+   * Outputs: Returns the track, or nullptr when there is no take.
+   */
+  const Track* take(uint8_t channel) const;
+
+  /**
+   * Description: Free a channel's take.
+   * Inputs:
+   * - channel: channel index; detach it from the engine first.
+   * Outputs: Releases the take's storage.
+   */
+  void discard(uint8_t channel);
+
+  /**
+   * Description: Get statistics for the current or last recording.
+   * Inputs: None.
+   * Outputs: Returns sample/key counts and measured error.
+   */
+  const RecordStats& stats() const { return _stats; }
+
+private:
+  struct Take {
+    TrackKey* keys = nullptr;
+    TrackCheckpoint* checkpoints = nullptr;
+    Track track;
+  };
+
+  /**
+   * Description: Close the current segment at the last sample.
+   * Inputs: None.
+   * Outputs: Emits one key and starts a new segment from it.
+   */
+  void closeSegment();
+
+  /**
+   * Description: Append a key to the scratch track.
+   * Inputs:
+   * - tMs: key time.
+   * - value: key value.
+   * - ease: interpolation toward the next key.
+   * Outputs: Flags overflow when scratch storage is full.
+   */
+  void emitKey(uint32_t tMs, int32_t value, Ease ease);
+
+  TrackBuilder _builder;
+  const Track* _original = nullptr;
+  bool _recording = false;
+  uint8_t _channel = 0;
+  float _door = 0.0f; // tolerance minus key rounding
+
+  // Swinging-door state: anchor key and the slope window still open.
+  bool _haveAnchor = false;
+  uint32_t _anchorT = 0;
+  int32_t _anchorV = 0;
+  float _slopeLo = 0.0f;
+  float _slopeHi = 0.0f;
+  uint32_t _lastT = 0;
+  float _lastV = 0.0f;
+  uint32_t _segT[SEGMENT_MAX_SAMPLES] = {};
+  float _segV[SEGMENT_MAX_SAMPLES] = {};
+  uint16_t _segCount = 0;
+
+  Take _takes[SHOW_MAX_CHANNELS];
+  RecordStats _stats;
+};
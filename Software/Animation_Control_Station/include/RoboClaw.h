@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+
+// RoboClaw packet serial protocol: [address, command, data..., crc16 hi, crc16 lo].
+// Write commands are acknowledged with a single ROBOCLAW_ACK byte. Read
+// commands are just [address, command]; the reply is [data..., crc16] with
+// the CRC taken over address, command and data.
+static constexpr uint8_t ROBOCLAW_DEFAULT_ADDRESS = 0x80;
+static constexpr uint8_t ROBOCLAW_ACK = 0xFF;
+
+// Command numbers used by the controller.
+enum class RoboClawCmd : uint8_t {
+  MixedSpeed = 37,                    // M1/M2 signed speed (qpps)
+  ReadCurrents = 49,                  // M1/M2 current, 10 mA units
+  MixedSpeedAccelDeccelPosition = 67, // M1/M2 accel, speed, deccel, position, buffer
+  ReadEncoders = 78,                  // M1/M2 encoder counts
+  ReadTemperature = 82,               // board temperature, 0.1 C units
+  ReadStatus = 90                     // error/warning bits
+};
+
+// One motor's part of a position command (encoder units).
+struct RoboClawMove {
+  uint32_t accel = 0;  // counts/s^2
+  uint32_t speed = 0;  // counts/s, max speed for the move
+  uint32_t deccel = 0; // counts/s^2
+  int32_t position = 0;
+};
+
+class RoboClaw {
+public:
+  static constexpr size_t MAX_FRAME_BYTES = 40;
+  static constexpr size_t MIXED_POSITION_FRAME_BYTES = 37;
+  static constexpr size_t MIXED_SPEED_FRAME_BYTES = 12;
+  static constexpr size_t READ_REQUEST_BYTES = 2;
+  static constexpr size_t MAX_REPLY_BYTES = 10;
+
+  /**
+   * Description: CRC16 (CCITT, polynomial 0x1021) used by packet serial.
+   * Inputs:
+   * - data: bytes to check.
+   * - length: number of bytes.
+   * - crc: running CRC (0 to start).
+   * Outputs: Returns the updated CRC.
+   */
+  static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0);
+
+  /**
+   * Description: Build a two-motor position command (command 67).
+   * Inputs:
+   * - out: frame buffer (MIXED_POSITION_FRAME_BYTES).
+   * - address: controller address (0x80..0x87).
+   * - m1: motor 1 move.
+   * - m2: motor 2 move.
+   * - immediate: true to replace any running move, false to queue behind it.
+   * Outputs: Returns the frame length.
+   */
+  static size_t buildMixedPosition(uint8_t* out, uint8_t address,
+                                   const RoboClawMove& m1, const RoboClawMove& m2, bool immediate);
+
+  /**
+   * Description: Build a two-motor speed command (command 37).
+   * Inputs:
+   * - out: frame buffer (MIXED_SPEED_FRAME_BYTES).
+   * - address: controller address.
+   * - speed1: motor 1 signed speed (counts/s).
+   * - speed2: motor 2 signed speed (counts/s).
+   * Outputs: Returns the frame length.
+   */
+  static size_t buildMixedSpeed(uint8_t* out, uint8_t address, int32_t speed1, int32_t speed2);
+
+  /**
+   * Description: Build a read request.
+   * Inputs:
+   * - out: frame buffer (READ_REQUEST_BYTES).
+   * - address: controller address.
+   * - command: one of the Read* commands.
+   * Outputs: Returns the request length.
+   */
+  static size_t buildRead(uint8_t* out, uint8_t address, RoboClawCmd command);
+
+  /**
+   * Description: Get the reply length of a read command.
+   * Inputs:
+   * - command: one of the Read* commands.
+   * Outputs: Returns data plus CRC bytes (0 for non-read commands).
+   */
+  static size_t replyBytes(RoboClawCmd command);
+
+  /**
+   * Description: Check a read reply's CRC.
+   * Inputs:
+   * - address: controller address the request went to.
+   * - command: read command.
+   * - reply: received bytes (replyBytes(command) long).
+   * Outputs: Returns true when the CRC matches.
+   */
+  static bool checkReply(uint8_t address, RoboClawCmd command, const uint8_t* reply);
+
+  /**
+   * Description: Read a big-endian 32-bit field from a reply.
+   * Inputs:
+   * - in: first byte.
+   * Outputs: Returns the value.
+   */
+  static uint32_t get32(const uint8_t* in) {
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+  }
+
+  /**
+   * Description: Read a big-endian 16-bit field from a reply.
+   * Inputs:
+   * - in: first byte.
+   * Outputs: Returns the value.
+   */
+  static uint16_t get16(const uint8_t* in) { return (uint16_t)(((uint16_t)in[0] << 8) | in[1]); }
+};
@@ -4,8 +4,24 @@
 
 struct Rs422Port {
   HardwareSerial* serial = nullptr;
+  uint32_t baud = 0;
+  int idleWriteSpace = 0; // availableForWrite() with an empty TX queue
 };
 
+static constexpr uint8_t RS422_PORT_COUNT = 8;
+static constexpr size_t RS422_TX_EXTRA_BYTES = 256; // added TX buffer so a frame never blocks
+
+/**
+ * Description: Time to transmit bytes on an 8N1 serial line.
+ * Inputs:
+ * - bytes: number of bytes.
+ * - baud: line rate.
+ * Outputs: Returns microseconds (10 bit times per byte).
+ */
+inline uint32_t serialBytesUs(uint32_t bytes, uint32_t baud) {
+  return (baud > 0) ? (uint32_t)((uint64_t)bytes * 10000000u / baud) : 0;
+}
+
 class Rs422Ports {
 public:
   /**
@@ -16,6 +32,23 @@ public:
    */
   void begin(unsigned long baud);
 
+  /**
+   * Description: Initialize all RS422 serial ports, each at its own baud rate.
+   * Inputs:
+   * - bauds: RS422_PORT_COUNT baud rates.
+   * Outputs: Opens serial ports and stores handles.
+   */
+  void begin(const uint32_t* bauds);
+
+  /**
+   * Description: Change one port's baud rate.
+   * Inputs:
+   * - portIndex: port index [0..7].
+   * - baud: new baud rate.
+   * Outputs: Waits for queued TX to finish, then reopens the port at the new rate.
+   */
+  void setBaud(uint8_t portIndex, uint32_t baud);
+
   /**
    * Description: Access a specific RS422 port by index.
    * Inputs:
@@ -24,6 +57,18 @@ public:
    */
   Rs422Port& port(uint8_t portIndex) { return _ports[portIndex]; }
 
+  /**
+   * Description: Get the number of bytes waiting in a port's TX queue.
+   * Inputs:
+   * - portIndex: port index [0..7].
+   * Outputs: Returns queued bytes (0 when idle).
+   */
+  uint32_t txQueued(uint8_t portIndex) {
+    const Rs422Port& p = _ports[portIndex];
+    const int free = p.serial ? p.serial->availableForWrite() : p.idleWriteSpace;
+    return (free < p.idleWriteSpace) ? (uint32_t)(p.idleWriteSpace - free) : 0;
+  }
+
 private:
-  Rs422Port _ports[8];
+  Rs422Port _ports[RS422_PORT_COUNT];
 };
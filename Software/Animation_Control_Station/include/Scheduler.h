@@ -0,0 +1,171 @@
+#pragma once
+#include <Arduino.h>
+
+// Cooperative loop scheduler. Periodic tasks are released every periodUs
+// and run to completion in priority order (0 first); a task that is still
+// waiting when its next release comes has missed its deadline, and one
+// that runs longer than its budget has overrun. Background jobs fill the
+// idle time between releases: each runs only when the next release is at
+// least its budget away, or when it has waited longer than its maxWaitUs.
+// The clock is injected so host builds can drive it with a virtual clock.
+// An optional run hook sees every start before it happens (trace capture
+// and replay); it may hold a background job back, never a periodic task.
+// Tasks that make timing decisions read runStartUs() rather than micros(),
+// so one run sees one instant and a replay can reproduce it exactly.
+using TaskFn = void (*)(void* context);
+using SchedulerClock = uint32_t (*)();
+
+struct SchedulerTask;
+using SchedulerRunHook = bool (*)(const SchedulerTask& task, uint8_t index, uint32_t& startUs, void* context);
+
+// Per-task counters for the "tasks" command.
+struct TaskStats {
+  uint32_t runs = 0;
+  uint32_t misses = 0;     // finished after the deadline (release + period); background: forced by maxWaitUs
+  uint32_t skipped = 0;    // releases dropped because the task fell a whole period behind
+  uint32_t overruns = 0;   // runs longer than the budget
+  uint32_t maxLateUs = 0;  // worst start delay after release (background: after maxWaitUs)
+  uint32_t maxRunUs = 0;
+  uint64_t totalRunUs = 0;
+};
+
+struct SchedulerTask {
+  const char* name = nullptr;
+  TaskFn fn = nullptr;
+  void* context = nullptr;
+  uint32_t periodUs = 0;    // 0 = background job
+  uint32_t budgetUs = 0;
+  uint32_t maxWaitUs = 0;   // background: run even without idle time after this long
+  uint32_t releaseUs = 0;   // next release (background: last run)
+  uint8_t priority = 0;     // 0 runs first
+  TaskStats stats;
+};
+
+class Scheduler {
+public:
+  static constexpr uint8_t MAX_TASKS = 16;
+
+  /**
+   * Description: Set the clock and drop all tasks.
+   * Inputs:
+   * - clock: microsecond clock (micros() on the Teensy, a virtual clock on the host).
+   * Outputs: Scheduler is empty and ready for addTask()/addBackground().
+   */
+  void begin(SchedulerClock clock);
+
+  /**
+   * Description: Register a periodic task.
+   * Inputs:
+   * - name: label for the "tasks" command (not copied).
+   * - fn: task body.
+   * - context: passed to fn.
+   * - periodUs: release period (> 0); the first release is now.
+   * - priority: 0 runs first; equal priorities run in registration order.
+   * - budgetUs: expected worst run time.
+   * Outputs: Returns false if the table is full or the period is 0.
+   */
+  bool addTask(const char* name, TaskFn fn, void* context, uint32_t periodUs, uint8_t priority, uint32_t budgetUs);
+
+  /**
+   * Description: Register a background job that runs in idle time.
+   * Inputs:
+   * - name: label for the "tasks" command (not copied).
+   * - fn: job body (should do a bounded slice of work per call).
+   * - context: passed to fn.
+   * - budgetUs: idle time the job needs before it is started.
+   * - maxWaitUs: run regardless of idle time after waiting this long.
+   * Outputs: Returns false if the table is full.
+   */
+  bool addBackground(const char* name, TaskFn fn, void* context, uint32_t budgetUs, uint32_t maxWaitUs);
+
+  /**
+   * Description: Run every due task in priority order, then background jobs that fit (call from loop()).
+   * Inputs: None.
+   * Outputs: Updates per-task statistics and releases.
+   */
+  void runOnce();
+
+  /**
+   * Description: Call a function before every task or job runs.
+   * Inputs:
+   * - hook: called with the task, its table index and the start time it
+   *         may move (nullptr = none); returning false skips a background
+   *         job for this pass.
+   * - context: passed to the hook.
+   * Outputs: The run starts at the time the hook leaves in startUs.
+   */
+  void setRunHook(SchedulerRunHook hook, void* context) {
+    _runHook = hook;
+    _runHookContext = context;
+  }
+
+  /**
+   * Description: Get the number of registered tasks and jobs.
+   * Inputs: None.
+   * Outputs: Returns the table size.
+   */
+  uint8_t taskCount() const { return _count; }
+
+  /**
+   * Description: Get the start time of the task or job now running.
+   * Inputs: None.
+   * Outputs: Returns the clock the run started at (the last start outside a run).
+   */
+  uint32_t runStartUs() const { return _runStartUs; }
+
+  /**
+   * Description: Get a task by table index (priority order, background jobs last).
+   * Inputs:
+   * - index: table index (< taskCount()).
+   * Outputs: Returns the task with its statistics.
+   */
+  const SchedulerTask& task(uint8_t index) const { return _tasks[index]; }
+
+  /**
+   * Description: Get the time covered by the statistics.
+   * Inputs: None.
+   * Outputs: Returns microseconds since begin() or resetStats().
+   */
+  uint32_t statsElapsedUs() const { return _clock() - _statsStartUs; }
+
+  /**
+   * Description: Clear every task's statistics.
+   * Inputs: None.
+   * Outputs: Counters restart; releases are unchanged.
+   */
+  void resetStats();
+
+private:
+  /**
+   * Description: Insert a task keeping the table in priority order.
+   * Inputs:
+   * - task: filled-in task.
+   * Outputs: Returns false if the table is full.
+   */
+  bool insert(const SchedulerTask& task);
+
+  /**
+   * Description: Run one task and fold the run into its statistics.
+   * Inputs:
+   * - task: task to run.
+   * - startUs: clock at the start of the run.
+   * Outputs: Returns the clock at the end of the run.
+   */
+  uint32_t run(SchedulerTask& task, uint32_t startUs);
+
+  /**
+   * Description: Get the time until the next periodic release.
+   * Inputs:
+   * - nowUs: current clock.
+   * Outputs: Returns microseconds of idle time (0 if a task is due).
+   */
+  uint32_t slackUs(uint32_t nowUs) const;
+
+  SchedulerClock _clock = nullptr;
+  SchedulerRunHook _runHook = nullptr;
+  void* _runHookContext = nullptr;
+  SchedulerTask _tasks[MAX_TASKS];
+  uint8_t _count = 0;
+  uint32_t _statsStartUs = 0;
+  uint32_t _runStartUs = 0;
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <Arduino.h>
+#include "Track.h"
+#include "ShowFormat.h"
+#include "Envelope.h"
+
+static constexpr uint8_t SHOW_MAX_CHANNELS = 16;
+
+// Result of one bounded step of an incremental load or analysis.
+enum class ShowStep : uint8_t {
+  Busy = 0, // more work left; call again
+  Done,
+  Failed
+};
+
+class Show {
+public:
+  static constexpr uint32_t LOAD_EVENTS_PER_STEP = 1024; // event order checks per loadStep()
+
+  /**
+   * Description: Parse a binary show image in place (the image is not copied).
+   * Inputs:
+   * - image: show image bytes, 4-byte aligned, kept alive while loaded.
+   * - length: image size in bytes.
+   * Outputs: Returns true when the image is valid and all tracks attached.
+   */
+  bool load(const uint8_t* image, size_t length);
+
+  /**
+   * Description: Start a load that loadStep() finishes in bounded steps.
+   * Inputs:
+   * - image: show image bytes, 4-byte aligned, kept alive while loaded.
+   * - length: image size in bytes.
+   * Outputs: Returns false when the header or section table is invalid.
+   */
+  bool beginLoad(const uint8_t* image, size_t length);
+
+  /**
+   * Description: Validate one channel, or up to LOAD_EVENTS_PER_STEP events, of a load begun by beginLoad().
+   * Inputs: None.
+   * Outputs: Returns Done once the show is loaded, Failed (show cleared) on an invalid image.
+   */
+  ShowStep loadStep();
+
+  /**
+   * Description: Unload the show.
+   * Inputs: None.
+   * Outputs: Clears all tracks.
+   */
+  void clear();
+
+  /**
+   * Description: Check whether a show is loaded.
+   * Inputs: None.
+   * Outputs: Returns true after a successful load().
+   */
+  bool isLoaded() const { return _loaded; }
+
+  /**
+   * Description: Get the number of motion channels.
+   * Inputs: None.
+   * Outputs: Returns the channel count.
+   */
+  uint8_t channelCount() const { return _channelCount; }
+
+  /**
+   * Description: Get the show length.
+   * Inputs: None.
+   * Outputs: Returns the duration in milliseconds.
+   */
+  uint32_t durationMs() const { return _durationMs; }
+
+  /**
+   * Description: Access a channel's motion track.
+   * Inputs:
+   * - channel: channel index [0..channelCount-1].
+   * Outputs: Returns the track.
+   */
+  const Track& track(uint8_t channel) const { return _tracks[channel]; }
+
+  /**
+   * Description: Access the event track.
+   * Inputs: None.
+   * Outputs: Returns the time-sorted event array (nullptr when empty).
+   */
+  const ShowEvent* events() const { return _events; }
+
+  /**
+   * Description: Get the number of events on the event track.
+   * Inputs: None.
+   * Outputs: Returns the event count.
+   */
+  uint32_t eventCount() const { return _eventCount; }
+
+  /**
+   * Description: Get the envelope storage analyze() needs.
+   * Inputs: None.
+   * Outputs: Returns the number of block envelopes (one per checkpoint).
+   */
+  uint32_t envelopeBlocksNeeded() const;
+
+  /**
+   * Description: Precompute kinematic envelopes for every track (call once after load()).
+   * Inputs:
+   * - blocks: storage for envelopeBlocksNeeded() block envelopes, kept alive while loaded.
+   * - capacity: number of envelopes blocks can hold.
+   * Outputs: Returns false if the storage is too small.
+   */
+  bool analyze(KinematicEnvelope* blocks, uint32_t capacity);
+
+  /**
+   * Description: Start an analysis that analyzeStep() finishes in bounded steps.
+   * Inputs:
+   * - blocks: storage for envelopeBlocksNeeded() block envelopes, kept alive while loaded.
+   * - capacity: number of envelopes blocks can hold.
+   * Outputs: Returns false if no show is loaded or the storage is too small.
+   */
+  bool beginAnalyze(KinematicEnvelope* blocks, uint32_t capacity);
+
+  /**
+   * Description: Analyze up to maxKeys keys of the current channel (at most one channel per call).
+   * Inputs:
+   * - maxKeys: key segments to cover in this call.
+   * Outputs: Returns Done once every channel is analyzed, Busy otherwise.
+   */
+  ShowStep analyzeStep(uint32_t maxKeys);
+
+  /**
+   * Description: Check whether analyze() has run for this show.
+   * Inputs: None.
+   * Outputs: Returns true when envelopes are available.
+   */
+  bool isAnalyzed() const { return _analyzed; }
+
+  /**
+   * Description: Get a channel's whole-track envelope.
+   * Inputs:
+   * - channel: channel index [0..channelCount-1].
+   * Outputs: Returns the envelope (empty before analyze()).
+   */
+  const KinematicEnvelope& envelope(uint8_t channel) const { return _envelopes[channel]; }
+
+  /**
+   * Description: Get a channel's per-block envelopes.
+   * Inputs:
+   * - channel: channel index [0..channelCount-1].
+   * Outputs: Returns one envelope per checkpoint block (block = key index / TRACK_CHECKPOINT_INTERVAL),
+   *          or nullptr before analyze().
+   */
+  const KinematicEnvelope* blockEnvelopes(uint8_t channel) const { return _blockEnvelopes[channel]; }
+
+private:
+  Track _tracks[SHOW_MAX_CHANNELS];
+  const ShowEvent* _events = nullptr;
+  uint32_t _eventCount = 0;
+  uint8_t _channelCount = 0;
+  uint32_t _durationMs = 0;
+  bool _loaded = false;
+  bool _analyzed = false;
+  KinematicEnvelope _envelopes[SHOW_MAX_CHANNELS];
+  const KinematicEnvelope* _blockEnvelopes[SHOW_MAX_CHANNELS] = {};
+
+  // Incremental load/analysis position (beginLoad()/beginAnalyze()).
+  const ShowFileHeader* _stepHeader = nullptr;
+  const uint8_t* _stepImage = nullptr;
+  uint8_t _stepChannel = 0;
+  uint32_t _stepEvent = 0;
+  KinematicEnvelope* _stepBlocks = nullptr;
+  EnvelopeScan _scan;
+};
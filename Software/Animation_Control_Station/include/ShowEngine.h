@@ -1,25 +1,48 @@
 #pragma once
 #include <Arduino.h>
 #include "Timebase.h"
+#include "Show.h"
+#include "MotionProfile.h"
+#include "CueScheduler.h"
+#include "ChannelTransform.h"
+
+// Per-channel output of the show evaluator.
+struct ChannelSetpoint {
+  float pos = 0.0f;
+  float vel = 0.0f; // real-time units per second (playback rate applied)
+};
 
 class ShowEngine {
 public:
+  // Playback rate is fixed point Q16 (65536 = 1x).
+  static constexpr uint32_t RATE_ONE_Q16 = 65536u;
+  static constexpr uint32_t RATE_MIN_Q16 = RATE_ONE_Q16 / 4;   // 25%
+  static constexpr uint32_t RATE_MAX_Q16 = RATE_ONE_Q16 * 2;   // 200%
+  static constexpr uint32_t RATE_SLEW_Q16_PER_SEC = RATE_ONE_Q16; // 1x per second
+  static constexpr uint32_t SWITCH_AT_END = 0xFFFFFFFFu; // queueSwitch(): at end of current show
+
   /**
    * Description: Initialize the show timebase.
    * Inputs: None.
-   * Outputs: Resets the internal timebase.
+   * Outputs: Resets the internal timebase and show clock.
    */
-  void begin() { _tb.reset(); }
+  void begin() {
+    _tb.reset();
+    _lastRealUs = 0;
+    _showTimeQ16 = 0;
+    _rateQ16 = _targetRateQ16 = RATE_ONE_Q16;
+    _slewBudget = 0;
+  }
 
   /**
-   * Description: Set play/pause state and manage timing offsets.
+   * Description: Set play/pause state.
    * Inputs:
    * - playing: true to play, false to pause.
-   * Outputs: Updates internal play state and timing offsets.
+   * Outputs: Updates play state; show time holds while paused.
    */
   void setPlaying(bool playing) {
-    if (playing && !_playing) { _tb.reset(); _resumeOffsetMs = _pausedAtMs; }
-    if (!playing && _playing) { _pausedAtMs = currentTimeMs(); }
+    if (playing && !_playing) { _lastRealUs = _tb.nowUs(); }
+    if (!playing && _playing) { update(); }
     _playing = playing;
   }
 
@@ -30,19 +53,362 @@ public:
    */
   bool isPlaying() const { return _playing; }
 
+  /**
+   * Description: Request a playback rate; the applied rate slews toward it.
+   * Inputs:
+   * - rate: playback rate (1.0 = real time), clamped to 0.25..2.0.
+   * Outputs: Updates the target rate.
+   */
+  void setPlaybackRate(float rate) {
+    float q16 = rate * (float)RATE_ONE_Q16;
+    if (q16 < (float)RATE_MIN_Q16) q16 = (float)RATE_MIN_Q16;
+    if (q16 > (float)RATE_MAX_Q16) q16 = (float)RATE_MAX_Q16;
+    _targetRateQ16 = (uint32_t)q16;
+  }
+
+  /**
+   * Description: Get the currently applied (slew-limited) playback rate.
+   * Inputs: None.
+   * Outputs: Returns the playback rate (1.0 = real time).
+   */
+  float playbackRate() const { return (float)_rateQ16 / (float)RATE_ONE_Q16; }
+
+  /**
+   * Description: Advance show time from the timebase at the applied rate.
+   * Inputs: None.
+   * Outputs: Slews the rate and integrates show time; call once per tick.
+   */
+  void update() {
+    if (!_playing) return;
+    const uint32_t realUs = _tb.nowUs();
+    const uint32_t dtUs = realUs - _lastRealUs;
+    _lastRealUs = realUs;
+    if (_approaching) return; // hold show time until the approach move lands
+
+    // Slew-limit the rate so show time never changes speed abruptly. The
+    // envelope ceiling is the only kinematic check left on the tick path.
+    const uint32_t prevRateQ16 = _rateQ16;
+    const uint32_t targetQ16 = (_targetRateQ16 < _rateCeilingQ16) ? _targetRateQ16 : _rateCeilingQ16;
+    // The remainder carries over so short loop passes still make progress.
+    _slewBudget += (uint64_t)dtUs * RATE_SLEW_Q16_PER_SEC;
+    const uint64_t maxStep = _slewBudget / 1000000u;
+    _slewBudget -= maxStep * 1000000u;
+    if (targetQ16 > _rateQ16) {
+      const uint32_t diff = targetQ16 - _rateQ16;
+      _rateQ16 += (diff < maxStep) ? diff : (uint32_t)maxStep;
+    } else if (targetQ16 < _rateQ16) {
+      const uint32_t diff = _rateQ16 - targetQ16;
+      _rateQ16 -= (diff < maxStep) ? diff : (uint32_t)maxStep;
+    } else {
+      _slewBudget = 0;
+    }
+
+    // Integrate in Q16 microseconds: exact at a constant rate, so no drift.
+    _showTimeQ16 += (uint64_t)dtUs * ((prevRateQ16 + _rateQ16) >> 1);
+  }
+
+  /**
+   * Description: Get the current show time in microseconds.
+   * Inputs: None.
+   * Outputs: Returns integrated show time as of the last update().
+   */
+  uint64_t currentTimeUs() const { return _showTimeQ16 >> 16; }
+
   /**
    * Description: Get the current show time in milliseconds.
    * Inputs: None.
-   * Outputs: Returns elapsed or paused time based on play state.
+   * Outputs: Returns integrated show time as of the last update().
+   */
+  uint32_t currentTimeMs() const { return (uint32_t)(currentTimeUs() / 1000u); }
+
+  /**
+   * Description: Rescale a track velocity into a motor velocity setpoint.
+   * Inputs:
+   * - showVel: velocity in show-time units per second.
+   * Outputs: Returns velocity in real-time units per second.
+   */
+  float scaleVelocity(float showVel) const { return showVel * playbackRate(); }
+
+  /**
+   * Description: Rescale a track acceleration into a motor acceleration setpoint.
+   * Inputs:
+   * - showAccel: acceleration in show-time units per second^2.
+   * Outputs: Returns acceleration in real-time units per second^2.
+   */
+  float scaleAccel(float showAccel) const {
+    const float rate = playbackRate();
+    return showAccel * rate * rate;
+  }
+
+  /**
+   * Description: Set the per-channel motor limits used with the show envelopes.
+   * Inputs:
+   * - limits: SHOW_MAX_CHANNELS entries; must stay valid (nullptr = no limits).
+   * Outputs: Recomputes the playback rate ceiling and position clamps.
    */
-  uint32_t currentTimeMs() const {
-    if (_playing) return _resumeOffsetMs + _tb.nowMs();
-    return _pausedAtMs;
+  void setChannelLimits(const ChannelLimits* limits) {
+    _limits = limits;
+    applyLimits();
+  }
+
+  /**
+   * Description: Set the per-channel trim transforms applied after the tracks.
+   * Inputs:
+   * - transforms: SHOW_MAX_CHANNELS entries; must stay valid (nullptr = none).
+   * Outputs: Edits to the table take effect on the next evaluate(); call
+   *          again after an edit to refresh the envelope-derived limits.
+   */
+  void setChannelTransforms(const ChannelTransform* transforms) {
+    _transforms = transforms;
+    applyLimits();
+  }
+
+  /**
+   * Description: Set a channel's output latency lead.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - leadUs: real-time delay between evaluation and the motor receiving the setpoint.
+   * Outputs: The channel is evaluated that far ahead from the next evaluate().
+   */
+  void setChannelLeadUs(uint8_t channel, uint32_t leadUs) {
+    if (channel < SHOW_MAX_CHANNELS) {
+      _leadUs[channel] = leadUs;
+    }
+  }
+
+  /**
+   * Description: Get the highest playback rate the attached show can run at within limits.
+   * Inputs: None.
+   * Outputs: Returns the rate ceiling (1.0 = real time).
+   */
+  float rateCeiling() const { return (float)_rateCeilingQ16 / (float)RATE_ONE_Q16; }
+
+  /**
+   * Description: Attach a loaded show (or nullptr to detach).
+   * Inputs:
+   * - show: show to evaluate; must stay loaded while attached.
+   * Outputs: Rewinds show time and cursors to 0. Follow with seek() to
+   *          approach the first frame safely.
+   */
+  void setShow(const Show* show);
+
+  /**
+   * Description: Get the attached show.
+   * Inputs: None.
+   * Outputs: Returns the show, or nullptr.
+   */
+  const Show* show() const { return _show; }
+
+  /**
+   * Description: Jump to a show time and start a safe approach move to it.
+   * Inputs:
+   * - tMs: show time to jump to (clamped to the show length).
+   * - approachLimits: limits for the move from the current setpoints.
+   * Outputs: Seeks every track in O(log n) and holds show time until the
+   *          approach lands. Repeated calls (scrubbing) retarget smoothly.
+   */
+  void seek(uint32_t tMs, const MotionLimits& approachLimits);
+
+  /**
+   * Description: Check whether a post-seek approach move is in progress.
+   * Inputs: None.
+   * Outputs: Returns true while channels are moving to the seek target.
+   */
+  bool isApproaching() const { return _approaching; }
+
+  /**
+   * Description: Evaluate all channel setpoints at the current show time.
+   * Inputs: None.
+   * Outputs: Updates setpoints; call once per tick after update().
+   */
+  void evaluate();
+
+  /**
+   * Description: Get a channel's latest setpoint.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * Outputs: Returns the setpoint from the last evaluate().
+   */
+  const ChannelSetpoint& setpoint(uint8_t channel) const { return _setpoints[channel]; }
+
+  /**
+   * Description: Sample a channel ahead of the current show time without moving its cursor.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - aheadUs: real time ahead of now (scaled by the playback rate, plus the channel lead).
+   * Outputs: Returns the transformed, position-clamped setpoint the channel will have then.
+   */
+  ChannelSetpoint preview(uint8_t channel, uint32_t aheadUs) const;
+
+  /**
+   * Description: Queue a switch to another show at a cue point or the show end.
+   * Inputs:
+   * - next: fully loaded show to switch to.
+   * - atMs: current-show time to switch at, or SWITCH_AT_END.
+   * - blendMs: crossfade from the outgoing setpoints (0 = hard cut).
+   * Outputs: The swap happens at the start of the first evaluate() at or
+   *          past the switch point; playback continues without a pause.
+   */
+  void queueSwitch(const Show* next, uint32_t atMs, uint32_t blendMs);
+
+  /**
+   * Description: Check whether a show switch is queued.
+   * Inputs: None.
+   * Outputs: Returns true until the queued switch happens.
+   */
+  bool switchPending() const { return _nextShow != nullptr; }
+
+  /**
+   * Description: Get the show a pending switch will move to.
+   * Inputs: None.
+   * Outputs: Returns the queued show, or nullptr.
+   */
+  const Show* pendingShow() const { return _nextShow; }
+
+  /**
+   * Description: Get the time spent swapping shows on the last switch.
+   * Inputs: None.
+   * Outputs: Returns microseconds from switch start to a fully re-cued engine.
+   */
+  uint32_t lastSwitchUs() const { return _lastSwitchUs; }
+
+  /**
+   * Description: Get the number of ticks that found the active show not loaded.
+   * Inputs: None.
+   * Outputs: Returns the counter (expected to stay 0).
+   */
+  uint32_t unloadedTicks() const { return _unloadedTicks; }
+
+  /**
+   * Description: Access the discrete event scheduler driven by show time.
+   * Inputs: None.
+   * Outputs: Returns the scheduler; drain() it from idle time.
+   */
+  CueScheduler& cues() { return _cues; }
+
+  /**
+   * Description: Play a channel from a replacement track (e.g. a recorded take).
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - track: track to play instead of the show's, or nullptr to restore it.
+   * Outputs: Re-cues the channel at the current show time. The track's
+   *          envelope feeds the position clamps and the rate ceiling.
+   *          Overrides are dropped when the show changes.
+   */
+  void setTrackOverride(uint8_t channel, const Track* track);
+
+  /**
+   * Description: Replace a channel's setpoint for this tick with a live value.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * - setpoint: live setpoint (e.g. while recording the channel).
+   * Outputs: Overwrites the setpoint until the next evaluate().
+   */
+  void setLiveSetpoint(uint8_t channel, const ChannelSetpoint& setpoint) {
+    if (channel < SHOW_MAX_CHANNELS) {
+      _setpoints[channel] = setpoint;
+    }
   }
 
 private:
   Timebase _tb;
   bool _playing = false;
-  uint32_t _pausedAtMs = 0;
-  uint32_t _resumeOffsetMs = 0;
+  uint32_t _lastRealUs = 0;
+  uint64_t _showTimeQ16 = 0;
+  uint32_t _rateQ16 = RATE_ONE_Q16;
+  uint32_t _targetRateQ16 = RATE_ONE_Q16;
+  uint64_t _slewBudget = 0; // Q16 rate * microseconds not yet applied
+  uint32_t _rateCeilingQ16 = RATE_MAX_Q16; // from the show envelope and motor limits
+  const ChannelLimits* _limits = nullptr;
+  const ChannelTransform* _transforms = nullptr;
+  uint32_t _leadUs[SHOW_MAX_CHANNELS] = {}; // output latency compensation per channel
+  uint16_t _clampMask = 0; // channels whose envelope leaves the position limits
+
+  const Show* _show = nullptr;
+  TrackCursor _cursors[SHOW_MAX_CHANNELS];
+  ChannelSetpoint _setpoints[SHOW_MAX_CHANNELS];
+  const Track* _overrides[SHOW_MAX_CHANNELS] = {};
+  KinematicEnvelope _overrideEnvelopes[SHOW_MAX_CHANNELS]; // analyzed when the override is set
+  MotionProfile _approach[SHOW_MAX_CHANNELS];
+  bool _approaching = false;
+  CueScheduler _cues;
+
+  const Show* _nextShow = nullptr;
+  uint32_t _switchAtMs = SWITCH_AT_END;
+  uint32_t _blendMs = 0;
+  uint32_t _blendStartUs = 0;
+  bool _blending = false;
+  float _blendFrom[SHOW_MAX_CHANNELS] = {};
+  uint32_t _lastSwitchUs = 0;
+  uint32_t _unloadedTicks = 0;
+
+  /**
+   * Description: Check whether the queued switch point has been reached.
+   * Inputs: None.
+   * Outputs: Returns true when the switch should happen this tick.
+   */
+  bool switchDue() const;
+
+  /**
+   * Description: Get the track a channel plays from.
+   * Inputs:
+   * - channel: channel index within the show.
+   * Outputs: Returns the override track if set, else the show's track.
+   */
+  const Track& trackFor(uint8_t channel) const {
+    return _overrides[channel] ? *_overrides[channel] : _show->track(channel);
+  }
+
+  /**
+   * Description: Get a channel's track time including its transform time offset.
+   * Inputs:
+   * - channel: channel index.
+   * - tUs: show time in microseconds.
+   * Outputs: Returns the channel's evaluation time in microseconds (>= 0).
+   */
+  uint64_t channelTimeUs(uint8_t channel, uint64_t tUs) const {
+    // Output latency is real time, so it covers more show time at higher rates.
+    int64_t offsetUs = (int64_t)(((uint64_t)_leadUs[channel] * _rateQ16) >> 16);
+    if (_transforms) offsetUs += (int64_t)_transforms[channel].timeOffsetMs * 1000;
+    if (offsetUs == 0) return tUs;
+    const int64_t t = (int64_t)tUs + offsetUs;
+    return (t > 0) ? (uint64_t)t : 0;
+  }
+
+  /**
+   * Description: Hold a setpoint inside its channel's position limits.
+   * Inputs:
+   * - channel: channel index.
+   * - sp: setpoint to clamp in place.
+   * Outputs: Clamps sp.pos if the envelope flagged the channel; shared by
+   *          evaluate() and preview() so both see the same positions.
+   */
+  void clampPosition(uint8_t channel, ChannelSetpoint& sp) const {
+    if (!(_clampMask & (1u << channel))) return;
+    if (sp.pos < _limits[channel].minPos) sp.pos = _limits[channel].minPos;
+    if (sp.pos > _limits[channel].maxPos) sp.pos = _limits[channel].maxPos;
+  }
+
+  /**
+   * Description: Apply a channel's trim transform to a track sample.
+   * Inputs:
+   * - channel: channel index.
+   * - sample: track output in show-time units.
+   * Outputs: Returns the transformed sample.
+   */
+  TrackSample transform(uint8_t channel, const TrackSample& sample) const;
+
+  /**
+   * Description: Derive the rate ceiling and position clamps from the show envelope.
+   * Inputs: None.
+   * Outputs: Updates _rateCeilingQ16 and _clampMask.
+   */
+  void applyLimits();
+
+  /**
+   * Description: Swap to the queued show.
+   * Inputs: None.
+   * Outputs: Starts the new show at the time played past the switch point and starts the blend.
+   */
+  void performSwitch();
 };
@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+
+// Binary show image layout (little-endian, 4-byte aligned sections):
+//   ShowFileHeader
+//   ShowTrackEntry[channelCount]
+//   per track: TrackCheckpoint[checkpointCount], TrackKey[keyCount]
+//   ShowEvent[eventCount], sorted by time
+// Offsets are bytes from the start of the image.
+
+static constexpr uint32_t SHOW_MAGIC = 0x31534341u; // "ACS1"
+static constexpr uint16_t SHOW_FORMAT_VERSION = 2;
+
+struct ShowFileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t channelCount;
+  uint8_t reserved0;
+  uint32_t durationMs;
+  uint32_t eventOffset;
+  uint32_t eventCount;
+  uint32_t reserved1;
+};
+
+// Discrete show event types.
+enum class ShowEventType : uint8_t {
+  Output = 0, // target: LED/relay index, value: 0 = off, otherwise duty (1-255)
+  Audio,      // target: player index, value: clip number
+  Mark,       // value: ShowMarkAction
+
+  COUNT
+};
+
+// Actions carried by ShowEventType::Mark.
+enum class ShowMarkAction : uint16_t {
+  Note = 0, // log only
+  Pause,    // pause playback at the mark
+};
+
+// One discrete event on the show's event track (8 bytes).
+struct ShowEvent {
+  uint32_t timeMs;
+  uint8_t type;   // ShowEventType
+  uint8_t target;
+  uint16_t value;
+};
+
+struct ShowTrackEntry {
+  uint32_t checkpointOffset;
+  uint32_t checkpointCount;
+  uint32_t keyOffset;
+  uint32_t keyCount;
+};
+
+static_assert(sizeof(ShowFileHeader) == 24, "ShowFileHeader layout");
+static_assert(sizeof(ShowEvent) == 8, "ShowEvent layout");
+static_assert(sizeof(ShowTrackEntry) == 16, "ShowTrackEntry layout");
@@ -0,0 +1,180 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include "Show.h"
+
+enum class SlotState : uint8_t {
+  Empty = 0,
+  Loading, // file is being read in the background
+  Ready,   // image parsed and validated; safe to hand to ShowEngine
+  Failed
+};
+
+// Show slots let the next show load from SD while the current one plays.
+// A slot's Show only becomes visible (show() != nullptr) once the whole
+// image is in memory and validated, so the engine never sees a partial show.
+class ShowSlots {
+public:
+  static constexpr uint8_t SLOT_COUNT = 2;
+  static constexpr size_t LOAD_CHUNK_BYTES = 4096;     // read per poll() to bound loop time
+  static constexpr uint32_t ANALYZE_KEYS_PER_POLL = 1024; // envelope analysis per poll()
+
+  /**
+   * Description: Initialize the SD card used as the show source.
+   * Inputs: None.
+   * Outputs: Returns true when the card is available.
+   */
+  bool begin();
+
+  /**
+   * Description: Start loading a show image file into a slot.
+   * Inputs:
+   * - slot: slot index [0..SLOT_COUNT-1]; must not be in use by the engine.
+   * - path: file path on the SD card.
+   * Outputs: Returns false if the file cannot be opened or memory is short.
+   */
+  bool beginLoad(uint8_t slot, const char* path);
+
+  /**
+   * Description: Continue background loading (call from idle time).
+   * Inputs: None.
+   * Outputs: Does one bounded step: reads up to LOAD_CHUNK_BYTES, validates one
+   *          channel (or a run of events), or analyzes up to ANALYZE_KEYS_PER_POLL keys.
+   */
+  void poll();
+
+  /**
+   * Description: Free a slot's image.
+   * Inputs:
+   * - slot: slot index; must not be in use by the engine.
+   * Outputs: Returns the slot to Empty.
+   */
+  void release(uint8_t slot);
+
+  /**
+   * Description: Get a slot's state.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns the slot state.
+   */
+  SlotState state(uint8_t slot) const { return _slots[slot].state; }
+
+  /**
+   * Description: Check whether any slot is still loading.
+   * Inputs: None.
+   * Outputs: Returns true while poll() has work to do.
+   */
+  bool loading() const {
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+      if (_slots[i].state == SlotState::Loading) return true;
+    }
+    return false;
+  }
+
+  /**
+   * Description: Get a slot's show once it is ready.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns the show, or nullptr unless the slot is Ready.
+   */
+  const Show* show(uint8_t slot) const;
+
+  /**
+   * Description: Get loading progress for a slot.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns 0-100.
+   */
+  uint8_t progressPct(uint8_t slot) const;
+
+  /**
+   * Description: Get the file name loaded into a slot.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns the path passed to beginLoad().
+   */
+  const char* name(uint8_t slot) const { return _slots[slot].name; }
+
+  /**
+   * Description: Set the per-channel motor limits loaded shows are checked against.
+   * Inputs:
+   * - limits: SHOW_MAX_CHANNELS entries; must stay valid (nullptr = no check).
+   * Outputs: Applies to shows that finish loading afterwards.
+   */
+  void setLimits(const ChannelLimits* limits) { _limits = limits; }
+
+  /**
+   * Description: Get the time spent on kinematic analysis of a slot's show.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns microseconds summed over the analysis steps (0 until Ready).
+   */
+  uint32_t analysisUs(uint8_t slot) const { return _slots[slot].analysisUs; }
+
+  /**
+   * Description: Get a slot's image size.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns the size in bytes.
+   */
+  size_t imageSize(uint8_t slot) const { return _slots[slot].size; }
+
+  /**
+   * Description: Get the channels whose envelope exceeded the limits at load.
+   * Inputs:
+   * - slot: slot index.
+   * Outputs: Returns a bit per channel (0 = all channels within limits).
+   */
+  uint16_t violationMask(uint8_t slot) const { return _slots[slot].violations; }
+
+private:
+  // Work left for a Loading slot; each poll() does one bounded step of it.
+  enum class LoadPhase : uint8_t {
+    Read = 0,
+    Validate,
+    Analyze
+  };
+
+  /**
+   * Description: Allocate envelope storage and start the kinematic analysis.
+   * Inputs:
+   * - index: slot index.
+   * Outputs: Returns false if envelope storage cannot be allocated.
+   */
+  bool beginAnalysis(uint8_t index);
+
+  /**
+   * Description: Check a fully analyzed show against the limits.
+   * Inputs:
+   * - index: slot index.
+   * Outputs: Sets the slot's violation mask and logs the analysis time.
+   */
+  void checkLimits(uint8_t index);
+
+  /**
+   * Description: End a load: publish the slot or mark it failed.
+   * Inputs:
+   * - index: slot index.
+   * - ok: true when the image was read, validated and analyzed.
+   * Outputs: Sets the slot state to Ready or Failed.
+   */
+  void finishLoad(uint8_t index, bool ok);
+
+  struct Slot {
+    SlotState state = SlotState::Empty;
+    LoadPhase phase = LoadPhase::Read;
+    Show show;
+    File file;
+    uint8_t* image = nullptr;
+    size_t size = 0;
+    size_t loaded = 0;
+    KinematicEnvelope* envelopes = nullptr;
+    uint32_t analysisUs = 0;
+    uint16_t violations = 0;
+    char name[32] = {};
+  };
+
+  Slot _slots[SLOT_COUNT];
+  const ChannelLimits* _limits = nullptr;
+  bool _sdReady = false;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "Track.h"
+#include "ShowFormat.h"
+
+// Key and checkpoint arrays for one channel, as produced by TrackBuilder.
+struct ShowWriterTrack {
+  const TrackKey* keys = nullptr;
+  uint32_t keyCount = 0;
+  const TrackCheckpoint* checkpoints = nullptr;
+  uint32_t checkpointCount = 0;
+};
+
+// Serializes tracks and events into a show image that Show::load() accepts.
+// Shared by the firmware (saving recorded takes) and the offline compiler.
+class ShowWriter {
+public:
+  /**
+   * Description: Compute the image size for a set of tracks and events.
+   * Inputs:
+   * - tracks: per-channel key/checkpoint arrays.
+   * - channelCount: number of channels.
+   * - eventCount: number of events.
+   * Outputs: Returns the image size in bytes.
+   */
+  static size_t imageSize(const ShowWriterTrack* tracks, uint8_t channelCount, uint32_t eventCount);
+
+  /**
+   * Description: Write a show image.
+   * Inputs:
+   * - out: destination buffer, 4-byte aligned.
+   * - capacity: size of out in bytes.
+   * - tracks: per-channel key/checkpoint arrays.
+   * - channelCount: number of channels.
+   * - durationMs: show length in milliseconds.
+   * - events: time-sorted events (may be nullptr when eventCount is 0).
+   * - eventCount: number of events.
+   * Outputs: Returns the bytes written, or 0 if the buffer is too small or
+   *          a track's checkpoints do not match its keys.
+   */
+  static size_t write(uint8_t* out, size_t capacity,
+                      const ShowWriterTrack* tracks, uint8_t channelCount, uint32_t durationMs,
+                      const ShowEvent* events, uint32_t eventCount);
+};
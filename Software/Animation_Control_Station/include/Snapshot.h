@@ -0,0 +1,150 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+// Lock-free snapshot exchange between one writer (the control tick, or an
+// ISR once control moves there) and readers in the loop. Neither side
+// disables interrupts or waits for the other.
+//
+// Seqlock<T>: one copy guarded by a sequence counter that is odd while a
+// write is in progress. Readers copy and retry if a write overlapped the
+// copy. Best for small T; read cost grows with sizeof(T) and with how often
+// the writer runs.
+//
+// TripleBuffer<T>: three copies. The writer fills its private back buffer
+// and swaps it with the shared middle one; the reader swaps the middle one
+// into its front buffer when it is newer. No copies, no retries, and the
+// reader always gets the newest complete snapshot, for 3x the memory.
+//
+// Both are single-writer. The fences are DMBs on the M7 and keep the
+// exchange correct between threads on the host.
+
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "seqlock readers copy T with plain loads");
+
+public:
+  /**
+   * Description: Start updating the value in place (writer side).
+   * Inputs: None.
+   * Outputs: Returns the value to modify; follow with endWrite().
+   */
+  T& beginWrite() {
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return _value;
+  }
+
+  /**
+   * Description: Publish an in-place update (writer side).
+   * Inputs: None.
+   * Outputs: Makes the update visible to readers.
+   */
+  void endWrite() {
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * Description: Replace the value (writer side).
+   * Inputs:
+   * - value: new value.
+   * Outputs: Copies and publishes it.
+   */
+  void publish(const T& value) {
+    beginWrite() = value;
+    endWrite();
+  }
+
+  /**
+   * Description: Try once to copy a consistent value.
+   * Inputs:
+   * - out: receives the value (may be torn when false is returned).
+   * Outputs: Returns false if a write overlapped the copy.
+   */
+  bool tryRead(T& out) const {
+    const uint32_t before = _seq.load(std::memory_order_acquire);
+    if (before & 1u) {
+      return false;
+    }
+    out = _value;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return _seq.load(std::memory_order_relaxed) == before;
+  }
+
+  /**
+   * Description: Copy a consistent value, retrying while a write is in progress.
+   * Inputs:
+   * - out: receives the value.
+   * Outputs: Returns the number of retries (0 in the common case).
+   */
+  uint32_t read(T& out) const {
+    uint32_t retries = 0;
+    while (!tryRead(out)) {
+      retries++;
+    }
+    return retries;
+  }
+
+  /**
+   * Description: Get the sequence counter.
+   * Inputs: None.
+   * Outputs: Returns twice the number of completed writes (odd while writing).
+   */
+  uint32_t sequence() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+  T _value{};
+  std::atomic<uint32_t> _seq{0};
+};
+
+template <typename T>
+class TripleBuffer {
+public:
+  /**
+   * Description: Get the buffer to fill (writer side).
+   * Inputs: None.
+   * Outputs: Returns the back buffer; it holds an older snapshot, so set every field before publish().
+   */
+  T& back() { return _buffers[_back]; }
+
+  /**
+   * Description: Hand the back buffer to the reader (writer side).
+   * Inputs: None.
+   * Outputs: Swaps it with the middle buffer and marks that as new.
+   */
+  void publish() {
+    const uint8_t old = _middle.exchange((uint8_t)(_back | FRESH), std::memory_order_acq_rel);
+    _back = old & INDEX_MASK;
+  }
+
+  /**
+   * Description: Take the newest published snapshot if there is one (reader side).
+   * Inputs: None.
+   * Outputs: Returns true if front() changed.
+   */
+  bool update() {
+    if ((_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+      return false;
+    }
+    const uint8_t old = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = old & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * Description: Get the reader's snapshot.
+   * Inputs: None.
+   * Outputs: Returns the front buffer; stable until the next update().
+   */
+  const T& front() const { return _buffers[_front]; }
+
+private:
+  static constexpr uint8_t INDEX_MASK = 0x03;
+  static constexpr uint8_t FRESH = 0x04; // middle holds a snapshot the reader has not taken
+
+  T _buffers[3]{};
+  uint8_t _back = 0;                 // writer only
+  std::atomic<uint8_t> _middle{1};   // shared: index | FRESH
+  uint8_t _front = 2;                // reader only
+};
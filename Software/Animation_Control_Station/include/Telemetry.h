@@ -0,0 +1,148 @@
+#pragma once
+#include <Arduino.h>
+#include "Show.h"
+#include "Snapshot.h"
+
+// Telemetry fields in priority order (earlier wins a tie for the port).
+enum class TelemetryField : uint8_t {
+  Position = 0, // encoder counts
+  Current,      // motor current
+  Status,       // controller error/warning bits
+  Temperature,  // board temperature
+
+  COUNT
+};
+static constexpr uint8_t TELEMETRY_FIELD_COUNT = (uint8_t)TelemetryField::COUNT;
+
+// Latest readings for one channel (temperature/status are per controller
+// and shared by both of its channels).
+struct ChannelTelemetry {
+  int32_t encoder = 0;
+  int16_t currentCa = 0;   // 10 mA units
+  int16_t tempDeciC = 0;   // 0.1 C units
+  uint32_t status = 0;
+  uint32_t updatedUs[TELEMETRY_FIELD_COUNT] = {}; // 0 = never
+};
+
+// Per-channel telemetry written by the output stage and read from anywhere.
+// Each entry is its own Seqlock (see Snapshot.h), so neither side ever
+// blocks or disables interrupts.
+class TelemetryTable {
+public:
+  /**
+   * Description: Start updating a channel entry.
+   * Inputs:
+   * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+   * Outputs: Returns the entry to modify; follow with endWrite().
+   */
+  ChannelTelemetry& beginWrite(uint8_t channel) { return _entries[channel].beginWrite(); }
+
+  /**
+   * Description: Publish a channel entry.
+   * Inputs:
+   * - channel: channel index.
+   * Outputs: Makes the update visible to readers.
+   */
+  void endWrite(uint8_t channel) { _entries[channel].endWrite(); }
+
+  /**
+   * Description: Copy a consistent channel entry.
+   * Inputs:
+   * - channel: channel index.
+   * - out: receives the entry.
+   * Outputs: Retries while a write is in progress.
+   */
+  void read(uint8_t channel, ChannelTelemetry& out) const { _entries[channel].read(out); }
+
+private:
+  Seqlock<ChannelTelemetry> _entries[SHOW_MAX_CHANNELS];
+};
+
+// Chooses which telemetry request a port sends next. Fields are requested
+// at their target periods (position fast, temperature slow) out of a
+// token bucket of port time. The bucket refills at whatever share of the
+// port motion frames left over in the previous window, so telemetry backs
+// off automatically when motion traffic is heavy.
+class TelemetryScheduler {
+public:
+  static constexpr uint32_t FIELD_PERIOD_US[TELEMETRY_FIELD_COUNT] = {20000, 100000, 200000, 1000000};
+  static constexpr uint32_t WINDOW_US = 1000000;
+  static constexpr uint16_t UTILIZATION_PERMILLE = 800; // port time usable by motion + telemetry
+  static constexpr uint16_t MIN_SHARE_PERMILLE = 50;    // telemetry floor under heavy motion
+  static constexpr uint32_t BUCKET_MAX_US = 20000;      // burst allowance
+
+  /**
+   * Description: Restart scheduling and rate counters.
+   * Inputs:
+   * - nowUs: current time.
+   * Outputs: All fields due now; full share until motion usage is known.
+   */
+  void reset(uint32_t nowUs);
+
+  /**
+   * Description: Account port time used by a motion frame.
+   * Inputs:
+   * - us: frame plus ack time on the line.
+   * Outputs: Counts toward this window's motion share.
+   */
+  void noteMotion(uint32_t us) { _motionUs += us; }
+
+  /**
+   * Description: Pick the next field to request if one is due and affordable.
+   * Inputs:
+   * - nowUs: current time.
+   * - costUs: port time of one request and reply.
+   * - field: receives the field.
+   * Outputs: Returns true and charges the bucket when a request should go out.
+   */
+  bool next(uint32_t nowUs, uint32_t costUs, TelemetryField& field);
+
+  /**
+   * Description: Count a successful reply.
+   * Inputs:
+   * - field: field that was read.
+   * Outputs: Counts toward the achieved rate.
+   */
+  void completed(TelemetryField field) { _samples[(uint8_t)field]++; }
+
+  /**
+   * Description: Get the achieved sample rate of a field over the last window.
+   * Inputs:
+   * - field: field.
+   * Outputs: Returns samples per second.
+   */
+  uint32_t achievedHz(TelemetryField field) const { return _rateHz[(uint8_t)field]; }
+
+  /**
+   * Description: Get the port share telemetry may use this window.
+   * Inputs: None.
+   * Outputs: Returns permille of port time.
+   */
+  uint16_t sharePermille() const { return _sharePermille; }
+
+  /**
+   * Description: Get the port share motion used in the last window.
+   * Inputs: None.
+   * Outputs: Returns permille of port time.
+   */
+  uint16_t motionPermille() const { return _motionPermille; }
+
+private:
+  /**
+   * Description: Close the rate window and recompute the telemetry share.
+   * Inputs:
+   * - nowUs: current time.
+   * Outputs: Updates rates and the share.
+   */
+  void rollWindow(uint32_t nowUs);
+
+  uint32_t _dueUs[TELEMETRY_FIELD_COUNT] = {};
+  uint32_t _samples[TELEMETRY_FIELD_COUNT] = {};
+  uint32_t _rateHz[TELEMETRY_FIELD_COUNT] = {};
+  uint32_t _windowStartUs = 0;
+  uint32_t _motionUs = 0;
+  uint32_t _bucketUs = 0;
+  uint32_t _lastRefillUs = 0;
+  uint16_t _sharePermille = UTILIZATION_PERMILLE;
+  uint16_t _motionPermille = 0;
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <Arduino.h>
+#include "TraceFormat.h"
+
+// Input/serial trace for deterministic replay. While a capture runs, the
+// scheduler run hook, the input poll, the console and the RS422 readers
+// and writers report what they see; records are encoded into a RAM/PSRAM
+// ring in the TraceFormat.h layout and written to SD from idle time by
+// traceWrite(). Buttons, pots and the e-stop level are recorded only when
+// they change. All calls come from loop context (not ISRs); every call is
+// a single flag check while no capture runs.
+//
+// A capture must start at boot, before the first task runs, so a replay
+// can begin from the same state: the "trace arm" command sets a config
+// flag and App::begin() starts the capture on the next boot.
+//
+// Host replay (host/replay_main.cpp) installs a sink instead: with a sink
+// set, traceStart() opens no file and each record goes to the sink as it
+// happens, so the replay can drive the clock and the inputs from the
+// recorded trace and compare what the firmware sends.
+static constexpr uint32_t TRACE_PSRAM_BYTES = 512u * 1024u; // ~30 s of SD stalls at a busy loop
+static constexpr uint32_t TRACE_RAM_BYTES = 32u * 1024u;    // fallback without PSRAM
+static constexpr uint32_t TRACE_FLUSH_MS = 1000;            // SD directory update period
+static constexpr const char* TRACE_FILE = "/trace.act";
+
+// Capture counters for the "trace" command.
+struct TraceStats {
+  bool active = false;
+  uint32_t records = 0;
+  uint32_t dropped = 0;       // ring full at the call
+  uint64_t bytesWritten = 0;  // to SD, including the header
+  uint32_t pending = 0;       // bytes waiting in the ring now
+  uint32_t maxPending = 0;
+  uint32_t ringBytes = 0;
+};
+
+// One record as seen by a sink (fields as in traceGetRecord()).
+struct TraceEvent {
+  TraceRecord type;
+  uint8_t arg;
+  uint32_t timeUs;
+  const uint8_t* data;
+  uint8_t len;
+  uint32_t value;
+};
+
+// A sink may change timeUs of a Run or Job event to the time that run
+// should start; the scheduler then uses it as the run's start time.
+using TraceSink = bool (*)(TraceEvent& event, void* context);
+
+/**
+ * Description: Start a capture from boot (or announce the start to the sink).
+ * Inputs:
+ * - config: settings image in effect (written to the file header).
+ * - configBytes: size of the image.
+ * Outputs: Returns false if the ring cannot be allocated or the file cannot be created.
+ */
+bool traceStart(const void* config, uint16_t configBytes);
+
+/**
+ * Description: End the capture: write the End record, everything still queued, and close the file.
+ * Inputs: None.
+ * Outputs: Blocks for the SD writes; later trace calls are ignored.
+ */
+void traceStop();
+
+/**
+ * Description: Check whether a capture (or a replay sink) is running.
+ * Inputs: None.
+ * Outputs: Returns true between traceStart() and traceStop().
+ */
+bool traceActive();
+
+/**
+ * Description: Send records to a callback instead of the SD file (host replay).
+ * Inputs:
+ * - sink: callback (nullptr to write files again).
+ * - context: passed to the sink.
+ * Outputs: Takes effect at the next traceStart().
+ */
+void traceSetSink(TraceSink sink, void* context);
+
+/**
+ * Description: Record a scheduler task starting.
+ * Inputs:
+ * - task: scheduler table index.
+ * - startUs: start time the task will see (a replay sink may move it).
+ * Outputs: Returns false only when a replay sink holds the run back.
+ */
+bool traceRun(uint8_t task, uint32_t& startUs);
+
+/**
+ * Description: Record a background job starting (only jobs whose work the tasks can see).
+ * Inputs:
+ * - job: scheduler table index.
+ * - startUs: start time the job will see (a replay sink may move it).
+ * Outputs: Returns false when a replay sink holds the job back for this pass.
+ */
+bool traceJob(uint8_t job, uint32_t& startUs);
+
+/**
+ * Description: Record the pressed buttons (only when they changed).
+ * Inputs:
+ * - mask: bit per Button, 1 = pressed.
+ * Outputs: Appends a Buttons record on a change.
+ */
+void traceButtons(uint8_t mask);
+
+/**
+ * Description: Record a pot reading (only when it changed).
+ * Inputs:
+ * - pot: which pot.
+ * - raw: analogRead() value.
+ * Outputs: Appends a Pot record on a change.
+ */
+void tracePot(TracePot pot, uint16_t raw);
+
+/**
+ * Description: Record jog wheel counts consumed by the input task.
+ * Inputs:
+ * - counts: counts since the last poll.
+ * Outputs: Appends an Encoder record when counts is not 0.
+ */
+void traceEncoder(int32_t counts);
+
+/**
+ * Description: Record the e-stop input level (only when it changed).
+ * Inputs:
+ * - level: digitalReadFast() of the e-stop pin.
+ * Outputs: Appends an Estop record on a change.
+ */
+void traceEstop(uint8_t level);
+
+/**
+ * Description: Record a console line as it is dispatched.
+ * Inputs:
+ * - line, len: line without the newline (truncated to TRACE_MAX_DATA_BYTES).
+ * Outputs: Appends a Console record.
+ */
+void traceConsole(const char* line, size_t len);
+
+/**
+ * Description: Record a byte read from an RS422 port.
+ * Inputs:
+ * - port: port index.
+ * - b: byte read.
+ * Outputs: Adds the byte to the pending Rx record for the port.
+ */
+void traceRxByte(uint8_t port, uint8_t b);
+
+/**
+ * Description: Record bytes written to an RS422 port.
+ * Inputs:
+ * - port: port index.
+ * - data, len: bytes written.
+ * Outputs: Appends a Tx record with the length and hash.
+ */
+void traceTx(uint8_t port, const uint8_t* data, size_t len);
+
+/**
+ * Description: Write queued records to the SD file (call from idle time).
+ * Inputs:
+ * - maxBytes: write limit for this call.
+ * Outputs: Returns the bytes written.
+ */
+uint32_t traceWrite(uint32_t maxBytes);
+
+/**
+ * Description: Get the capture counters.
+ * Inputs: None.
+ * Outputs: Returns a snapshot of the counters.
+ */
+TraceStats traceStats();
@@ -0,0 +1,138 @@
+#pragma once
+#include <Arduino.h>
+#include "FlightFormat.h"
+
+// Input/serial trace file layout (little-endian), as written to SD:
+//   TraceFileHeader
+//   ConfigData image as restored at boot (configBytes)
+//   a Start record at startUs, then records until an End record (or the
+//   end of the file after a power cut)
+// A record is a type byte (TraceRecord in bits 0-3, a small argument in
+// bits 4-7), the zigzag varint of its micros() time minus the previous
+// record's (the first is relative to startUs), then the type's payload.
+// Run and Job records mark a scheduler task or background job starting;
+// the records after one up to the next Run/Job are what it observed or
+// sent. Received bytes and
+// console lines are kept whole, transmitted frames only as length + hash,
+// since a replay regenerates them and only needs to compare.
+
+static constexpr uint32_t TRACE_MAGIC = 0x31544341u; // "ACT1"
+static constexpr uint16_t TRACE_FORMAT_VERSION = 1;
+static constexpr uint8_t TRACE_MAX_DATA_BYTES = 128; // console line or RX chunk per record
+static constexpr uint32_t TRACE_MAX_RECORD_BYTES = 1 + 5 + 1 + TRACE_MAX_DATA_BYTES;
+static constexpr uint32_t TRACE_HASH_SEED = 2166136261u; // FNV-1a offset basis
+
+enum class TraceRecord : uint8_t {
+  Start = 0, // capture began; no payload
+  Run,       // arg = scheduler task index; no payload
+  Job,       // arg = scheduler index of a background job that changes task state; no payload
+  Buttons,   // u8 pressed mask, bit per Button
+  Pot,       // arg = TracePot; u16 raw ADC reading
+  Encoder,   // zigzag varint jog wheel counts consumed
+  Estop,     // arg = e-stop input level; applies before the next Run/Job
+  Console,   // u8 length, console line without the newline
+  Rx,        // arg = RS422 port; u8 length, bytes read
+  Tx,        // arg = RS422 port; u8 length, u32 FNV-1a of the bytes written
+  End,       // u32 records dropped because the ring was full
+  Count
+};
+
+enum class TracePot : uint8_t {
+  Speed = 0,
+  Accel
+};
+
+struct TraceFileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t configBytes; // ConfigData image that follows the header
+  uint32_t startUs;     // micros() when the capture started
+  uint32_t reserved;
+};
+
+static_assert(sizeof(TraceFileHeader) == 16, "TraceFileHeader layout");
+
+/**
+ * Description: Build a record's type byte.
+ * Inputs:
+ * - type: record type.
+ * - arg: argument (0-15).
+ * Outputs: Returns the byte that starts the record.
+ */
+inline uint8_t traceTag(TraceRecord type, uint8_t arg) {
+  return (uint8_t)((uint8_t)type | (uint8_t)(arg << 4));
+}
+
+/**
+ * Description: Decode one record from a trace file (host tools).
+ * Inputs:
+ * - p: read cursor, advanced past the record.
+ * - end: end of the buffered bytes.
+ * - timeUs: previous record's time, advanced by the record's delta.
+ * - type, arg: receive the record type and argument.
+ * - data, len: receive the payload bytes (console line, RX bytes) or nullptr.
+ * - value: receives the numeric payload (mask, raw ADC, counts, TX hash, dropped count).
+ * Outputs: Returns false when the buffer ends inside the record or the type is unknown.
+ */
+inline bool traceGetRecord(const uint8_t*& p, const uint8_t* end, uint32_t& timeUs, TraceRecord& type,
+                           uint8_t& arg, const uint8_t*& data, uint8_t& len, uint32_t& value) {
+  const uint8_t* q = p;
+  if (q >= end) {
+    return false;
+  }
+  const uint8_t tag = *q++;
+  type = (TraceRecord)(tag & 0x0Fu);
+  arg = (uint8_t)(tag >> 4);
+  int32_t delta = 0;
+  if (!flightGetDelta(q, end, delta)) {
+    return false;
+  }
+  data = nullptr;
+  len = 0;
+  value = 0;
+  switch (type) {
+    case TraceRecord::Start:
+    case TraceRecord::Run:
+    case TraceRecord::Job:
+    case TraceRecord::Estop:
+      break;
+    case TraceRecord::Buttons:
+      if (q + 1 > end) return false;
+      value = *q++;
+      break;
+    case TraceRecord::Pot:
+      if (q + 2 > end) return false;
+      value = (uint32_t)q[0] | ((uint32_t)q[1] << 8);
+      q += 2;
+      break;
+    case TraceRecord::Encoder: {
+      int32_t counts = 0;
+      if (!flightGetDelta(q, end, counts)) return false;
+      value = (uint32_t)counts;
+      break;
+    }
+    case TraceRecord::Console:
+    case TraceRecord::Rx:
+      if (q + 1 > end || q + 1 + q[0] > end) return false;
+      len = *q++;
+      data = q;
+      q += len;
+      break;
+    case TraceRecord::Tx:
+      if (q + 5 > end) return false;
+      len = *q++;
+      memcpy(&value, q, sizeof(value));
+      q += 4;
+      break;
+    case TraceRecord::End:
+      if (q + 4 > end) return false;
+      memcpy(&value, q, sizeof(value));
+      q += 4;
+      break;
+    default:
+      return false;
+  }
+  timeUs += (uint32_t)delta;
+  p = q;
+  return true;
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+
+// Interpolation applied from a key to the next one.
+enum class Ease : uint8_t {
+  Step = 0, // hold value until the next key
+  Linear,
+  Smooth,   // smoothstep ease in/out
+  EaseIn,
+  EaseOut,
+
+  COUNT
+};
+
+// Delta-encoded keyframe (6 bytes). Key 0's deltas are ignored; its absolute
+// time/value live in checkpoint 0.
+struct TrackKey {
+  uint16_t dtMs;   // time since previous key
+  int16_t dValue;  // value change since previous key
+  uint8_t ease;    // Ease toward the next key
+  uint8_t reserved;
+};
+
+// Absolute anchor for every TRACK_CHECKPOINT_INTERVAL-th key. The checkpoint
+// array doubles as the track's time index for seeking.
+struct TrackCheckpoint {
+  uint32_t timeMs;
+  int32_t value;
+  uint32_t keyIndex;
+};
+
+static constexpr uint32_t TRACK_CHECKPOINT_INTERVAL = 32;
+
+// Evaluator state for one track: the key pair bracketing the current time.
+struct TrackCursor {
+  uint32_t index = 0; // key at or before the current time
+  uint32_t t0 = 0, t1 = 0;
+  int32_t v0 = 0, v1 = 0;
+  uint8_t ease = (uint8_t)Ease::Step;
+};
+
+// Interpolated track output.
+struct TrackSample {
+  float pos = 0.0f;
+  float vel = 0.0f; // units per second of show time
+};
+
+class Track {
+public:
+  /**
+   * Description: Point the track at key and checkpoint storage (not copied).
+   * Inputs:
+   * - keys: delta-encoded keys.
+   * - keyCount: number of keys.
+   * - checkpoints: checkpoints built for these keys.
+   * - checkpointCount: number of checkpoints.
+   * Outputs: Returns false when the checkpoints do not index the keys (count,
+   *          key indices or time order).
+   */
+  bool attach(const TrackKey* keys, uint32_t keyCount,
+              const TrackCheckpoint* checkpoints, uint32_t checkpointCount);
+
+  /**
+   * Description: Detach from any storage.
+   * Inputs: None.
+   * Outputs: Leaves an empty track that evaluates to zero.
+   */
+  void clear();
+
+  /**
+   * Description: Get the number of keys.
+   * Inputs: None.
+   * Outputs: Returns the key count.
+   */
+  uint32_t keyCount() const { return _keyCount; }
+
+  /**
+   * Description: Get the time of the last key.
+   * Inputs: None.
+   * Outputs: Returns the track length in milliseconds.
+   */
+  uint32_t durationMs() const { return _durationMs; }
+
+  /**
+   * Description: Position a cursor at a time using the checkpoint index.
+   * Inputs:
+   * - cursor: cursor to position.
+   * - tMs: show time in milliseconds.
+   * Outputs: Updates cursor in O(log n) plus at most one checkpoint interval.
+   */
+  void seek(TrackCursor& cursor, uint32_t tMs) const;
+
+  /**
+   * Description: Move a cursor forward to a later time.
+   * Inputs:
+   * - cursor: cursor to advance.
+   * - tMs: show time in milliseconds.
+   * Outputs: Updates cursor; amortized O(1) during playback, seeks if time went back.
+   */
+  void advance(TrackCursor& cursor, uint32_t tMs) const;
+
+  /**
+   * Description: Move a cursor to the next key (for walking keys in order).
+   * Inputs:
+   * - cursor: cursor positioned by seek()/advance()/step().
+   * Outputs: Returns false when the cursor is already at the last key.
+   */
+  bool step(TrackCursor& cursor) const;
+
+  /**
+   * Description: Interpolate the track value at a time within the cursor's keys.
+   * Inputs:
+   * - cursor: cursor positioned for tUs.
+   * - tUs: show time in microseconds.
+   * Outputs: Returns position and show-time velocity.
+   */
+  static TrackSample sample(const TrackCursor& cursor, uint64_t tUs);
+
+  /**
+   * Description: Build the checkpoint index for a key array.
+   * Inputs:
+   * - keys: delta-encoded keys.
+   * - keyCount: number of keys.
+   * - firstTimeMs: absolute time of key 0.
+   * - firstValue: absolute value of key 0.
+   * - out: checkpoint storage.
+   * - maxOut: capacity of out.
+   * Outputs: Returns the number of checkpoints written, or 0 if out is too small.
+   */
+  static uint32_t buildCheckpoints(const TrackKey* keys, uint32_t keyCount,
+                                   uint32_t firstTimeMs, int32_t firstValue,
+                                   TrackCheckpoint* out, uint32_t maxOut);
+
+  /**
+   * Description: Number of checkpoints required for a key count.
+   * Inputs:
+   * - keyCount: number of keys.
+   * Outputs: Returns ceil(keyCount / TRACK_CHECKPOINT_INTERVAL).
+   */
+  static uint32_t checkpointsFor(uint32_t keyCount) {
+    return (keyCount + TRACK_CHECKPOINT_INTERVAL - 1) / TRACK_CHECKPOINT_INTERVAL;
+  }
+
+private:
+  /**
+   * Description: Load the key pair starting at an absolute key into a cursor.
+   * Inputs:
+   * - cursor: cursor to fill.
+   * - index: key index.
+   * - timeMs: absolute time of the key.
+   * - value: absolute value of the key.
+   * Outputs: Fills the cursor bracket.
+   */
+  void loadPair(TrackCursor& cursor, uint32_t index, uint32_t timeMs, int32_t value) const;
+
+  const TrackKey* _keys = nullptr;
+  const TrackCheckpoint* _checkpoints = nullptr;
+  uint32_t _keyCount = 0;
+  uint32_t _checkpointCount = 0;
+  uint32_t _durationMs = 0;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <Arduino.h>
+#include "Track.h"
+
+// Encodes absolute keyframes into delta-encoded TrackKeys plus checkpoints,
+// splitting gaps and jumps that do not fit the 16-bit deltas.
+class TrackBuilder {
+public:
+  /**
+   * Description: Start building into caller-provided storage.
+   * Inputs:
+   * - keys: key storage.
+   * - maxKeys: capacity of keys.
+   * - checkpoints: checkpoint storage.
+   * - maxCheckpoints: capacity of checkpoints.
+   * Outputs: Resets the builder to an empty track.
+   */
+  void begin(TrackKey* keys, uint32_t maxKeys, TrackCheckpoint* checkpoints, uint32_t maxCheckpoints);
+
+  /**
+   * Description: Append an absolute keyframe.
+   * Inputs:
+   * - timeMs: key time (must not precede the previous key).
+   * - value: key value.
+   * - ease: interpolation from this key to the next.
+   * Outputs: Returns false when storage is full or time runs backwards.
+   */
+  bool append(uint32_t timeMs, int32_t value, Ease ease);
+
+  /**
+   * Description: Attach the built keys to a track.
+   * Inputs:
+   * - track: track to attach.
+   * Outputs: Returns true on success.
+   */
+  bool attach(Track& track) const;
+
+  /**
+   * Description: Get the number of keys written.
+   * Inputs: None.
+   * Outputs: Returns the key count.
+   */
+  uint32_t keyCount() const { return _keyCount; }
+
+  /**
+   * Description: Get the number of checkpoints written.
+   * Inputs: None.
+   * Outputs: Returns the checkpoint count.
+   */
+  uint32_t checkpointCount() const { return Track::checkpointsFor(_keyCount); }
+
+  /**
+   * Description: Access the key storage.
+   * Inputs: None.
+   * Outputs: Returns the keys written so far.
+   */
+  const TrackKey* keys() const { return _keys; }
+
+  /**
+   * Description: Access the checkpoint storage.
+   * Inputs: None.
+   * Outputs: Returns the checkpoints written so far.
+   */
+  const TrackCheckpoint* checkpoints() const { return _checkpoints; }
+
+  /**
+   * Description: Get the time of the last key.
+   * Inputs: None.
+   * Outputs: Returns the last key time in milliseconds.
+   */
+  uint32_t lastTimeMs() const { return _lastTimeMs; }
+
+private:
+  /**
+   * Description: Write one key whose deltas are known to fit.
+   * Inputs:
+   * - timeMs: key time.
+   * - value: key value.
+   * - ease: interpolation from this key to the next.
+   * Outputs: Returns false when storage is full.
+   */
+  bool push(uint32_t timeMs, int32_t value, Ease ease);
+
+  TrackKey* _keys = nullptr;
+  TrackCheckpoint* _checkpoints = nullptr;
+  uint32_t _maxKeys = 0;
+  uint32_t _maxCheckpoints = 0;
+  uint32_t _keyCount = 0;
+  uint32_t _lastTimeMs = 0;
+  int32_t _lastValue = 0;
+};
@@ -1,23 +1,63 @@
 #pragma once
 #include <Arduino.h>
-#include <elapsedMillis.h>
+#include "ChannelTransform.h"
+#include "Show.h"
 
+// Transform field edited by the front-panel trim editor.
+enum class TrimField : uint8_t {
+  Gain = 0,
+  Offset,
+  Shift,
+  Invert,
+
+  COUNT
+};
+
+// Per-channel state in a ControlStatus.
+struct ChannelStatus {
+  int32_t target = 0;     // last commanded position
+  int32_t position = 0;   // encoder telemetry
+  int16_t currentCa = 0;  // 10 mA units
+};
+
+// Control-side state published once per control tick (a TripleBuffer in
+// App) and copied into the UiModel by the UI task, so the UI never reads
+// control state while it is half updated.
+struct ControlStatus {
+  uint32_t showTimeMs = 0;
+  float playbackRate = 1.0f;
+  float motionPos = 0.0f;
+  float motionVel = 0.0f;
+  uint32_t faults = 0;
+  const char* fault = nullptr; // fault shown by the degrade-UI reaction (nullptr = none)
+  bool stopped = false;
+  ChannelStatus channels[SHOW_MAX_CHANNELS];
+};
 
 struct UiModel {
   bool playing = false;
   uint32_t showTimeMs = 0;
+  float playbackRate = 1.0f;
   uint8_t selectedMotor = 0;
   float speedNorm = 0.0f;
   float accelNorm = 0.0f;
   int32_t jogPos = 0;
+  float motionPos = 0.0f;
+  float motionVel = 0.0f;
+  bool trimActive = false;
+  uint8_t trimField = 0;   // TrimField
+  ChannelTransform trim;   // transform of the selected motor
+  bool stopped = false;    // e-stop latched
+  const char* fault = nullptr; // fault shown by the degrade-UI reaction (nullptr = none)
+  ChannelStatus channel;   // selected motor
 };
 
 class Ui {
-  elapsedMillis _timeSinceLastRender;
   bool _ready = false;
-  static constexpr unsigned long RENDER_PERIOD_MSEC = 100;
 
 public:
+  static constexpr unsigned long RENDER_PERIOD_MSEC = 100; // "ui" task period
+
   /**
    * Description: Initialize the display and draw the startup screen.
    * Inputs: None.
@@ -29,7 +69,7 @@ public:
    * Description: Render the UI based on the current model snapshot.
    * Inputs:
    * - model: UI model data to display.
-   * Outputs: Updates the display if the render period has elapsed.
+   * Outputs: Draws and flushes one frame (the scheduler calls it once per render period).
    */
   void render(const UiModel& model);
 };
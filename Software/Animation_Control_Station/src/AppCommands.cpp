@@ -0,0 +1,1557 @@
+#include "App.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Faults.h"
+#include "Trace.h"
+#include <cstring>
+#include <cstdlib>
+
+// Seek benchmark: synthetic single-channel shows with one key every 500 ms.
+static constexpr uint32_t SEEK_BENCH_KEY_SPACING_MS = 500;
+static constexpr uint32_t SEEK_BENCH_SEEKS = 1000;
+static constexpr uint32_t SEEK_BENCH_SCANS = 20;
+static constexpr uint32_t SEEK_BENCH_MINUTES[] = {1, 5, 15, 30, 60, 120};
+
+// Cue benchmark: 20k events spread over a 10 minute show.
+static constexpr uint32_t CUE_BENCH_EVENTS = 20000;
+static constexpr uint32_t CUE_BENCH_LENGTH_MS = 600000;
+static constexpr uint32_t LOG_BENCH_CALLS = 64;     // per path; well under the log ring size
+static constexpr uint32_t SNAP_BENCH_CALLS = 256;   // per operation and snapshot size
+
+// Loopback test: echoes per run and per-echo timeout.
+static constexpr uint32_t LOOPBACK_DEFAULT_COUNT = 100;
+static constexpr uint32_t LOOPBACK_TIMEOUT_US = 10000;
+
+// Skew model: 10 s of 50 Hz frames on 115200 baud ports whose background
+// traffic grows with the port index, plus up to 200 us controller jitter.
+static constexpr uint32_t SKEW_SIM_FRAMES = 500;
+static constexpr uint32_t SKEW_SIM_BAUD = 115200;
+static constexpr uint32_t SKEW_SIM_BYTES_PER_PORT = 24;
+static constexpr uint32_t SKEW_SIM_JITTER_US = 200;
+
+// Following error model: 50 Hz encoder samples of a first-order plant
+// (50 ms lag) tracking a 2000 count, 0.5 Hz sine; the stall run freezes
+// the plant at STALL_AT_US.
+static constexpr uint32_t FOLLOW_SIM_SAMPLE_US = 20000;
+static constexpr uint32_t FOLLOW_SIM_LENGTH_US = 30000000;
+static constexpr uint32_t FOLLOW_SIM_STALL_AT_US = 3000000;
+static constexpr float FOLLOW_SIM_AMPLITUDE = 2000.0f;
+static constexpr float FOLLOW_SIM_FREQ_HZ = 0.5f;
+static constexpr float FOLLOW_SIM_LAG_S = 0.05f;
+static constexpr int32_t FOLLOW_SIM_NOISE = 20;
+
+// Default simplification tolerance for recorded takes (units).
+static constexpr float RECORD_DEFAULT_TOLERANCE = 2.0f;
+
+/**
+ * Description: Small deterministic PRNG for benchmark inputs.
+ * Inputs:
+ * - state: generator state, updated in place.
+ * Outputs: Returns the next pseudo-random value.
+ */
+static inline uint32_t benchRand(uint32_t& state) {
+  state = state * 1664525u + 1013904223u;
+  return state;
+}
+
+// Snapshot timing for one size (profiler ticks per call).
+struct SnapBenchResult {
+  uint32_t seqWrite = 0;
+  uint32_t seqRead = 0;
+  uint32_t tripleWrite = 0;
+  uint32_t tripleRead = 0;
+};
+
+/**
+ * Description: Time the snapshot exchanges for one snapshot type.
+ * Inputs: None (T is the snapshot type).
+ * Outputs: Returns average ticks per publish and per consistent read for Seqlock and TripleBuffer.
+ */
+template <typename T>
+static SnapBenchResult benchSnapshot() {
+  static Seqlock<T> seq;
+  static TripleBuffer<T> triple;
+  static T value;
+  volatile uint32_t sink = 0;
+  uint32_t seqWrite = 0, seqRead = 0, tripleWrite = 0, tripleRead = 0;
+  for (uint32_t i = 0; i < SNAP_BENCH_CALLS; i++) {
+    reinterpret_cast<uint8_t*>(&value)[0] = (uint8_t)i;
+
+    uint32_t t0 = profileNow();
+    seq.publish(value);
+    seqWrite += profileNow() - t0;
+
+    t0 = profileNow();
+    seq.read(value);
+    seqRead += profileNow() - t0;
+
+    // The writer fills the back buffer in place, so its copy is the fill.
+    t0 = profileNow();
+    triple.back() = value;
+    triple.publish();
+    tripleWrite += profileNow() - t0;
+
+    // The reader uses front() in place; touch one byte so the swap is not idle.
+    t0 = profileNow();
+    triple.update();
+    sink = sink + reinterpret_cast<const uint8_t*>(&triple.front())[sizeof(T) - 1];
+    tripleRead += profileNow() - t0;
+  }
+  (void)sink;
+  return SnapBenchResult{seqWrite / SNAP_BENCH_CALLS, seqRead / SNAP_BENCH_CALLS,
+                         tripleWrite / SNAP_BENCH_CALLS, tripleRead / SNAP_BENCH_CALLS};
+}
+
+// Raw snapshot of N bytes for the benchmark.
+template <size_t N>
+struct SnapBytes {
+  uint8_t bytes[N];
+};
+
+/**
+ * Description: Execute a console command.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Runs the matching command handler or reports an unknown command.
+ */
+void App::handleCommand(const CommandMsg& msg) {
+  if (strcmp(msg.cmd, "help") == 0) {
+    cmdHelp(msg);
+  } else if (strcmp(msg.cmd, "play") == 0 || strcmp(msg.cmd, "pause") == 0) {
+    cmdPlay(msg);
+  } else if (strcmp(msg.cmd, "seek") == 0) {
+    cmdSeek(msg);
+  } else if (strcmp(msg.cmd, "load") == 0) {
+    cmdLoad(msg);
+  } else if (strcmp(msg.cmd, "switch") == 0) {
+    cmdSwitch(msg);
+  } else if (strcmp(msg.cmd, "slots") == 0) {
+    cmdSlots(msg);
+  } else if (strcmp(msg.cmd, "xform") == 0) {
+    cmdXform(msg);
+  } else if (strcmp(msg.cmd, "save") == 0) {
+    cmdSave(msg);
+  } else if (strcmp(msg.cmd, "limits") == 0) {
+    cmdLimits(msg);
+  } else if (strcmp(msg.cmd, "rec") == 0) {
+    cmdRec(msg);
+  } else if (strcmp(msg.cmd, "motors") == 0) {
+    cmdMotors(msg);
+  } else if (strcmp(msg.cmd, "latency") == 0) {
+    cmdLatency(msg);
+  } else if (strcmp(msg.cmd, "telemetry") == 0) {
+    cmdTelemetry(msg);
+  } else if (strcmp(msg.cmd, "follow") == 0) {
+    cmdFollow(msg);
+  } else if (strcmp(msg.cmd, "estop") == 0) {
+    cmdEStop(msg);
+  } else if (strcmp(msg.cmd, "baud") == 0) {
+    cmdBaud(msg);
+  } else if (strcmp(msg.cmd, "tune") == 0) {
+    cmdTune(msg);
+  } else if (strcmp(msg.cmd, "loopback") == 0) {
+    cmdLoopback(msg);
+  } else if (strcmp(msg.cmd, "skewsim") == 0) {
+    cmdSkewSim(msg);
+  } else if (strcmp(msg.cmd, "seekbench") == 0) {
+    cmdSeekBench(msg);
+  } else if (strcmp(msg.cmd, "cuebench") == 0) {
+    cmdCueBench(msg);
+  } else if (strcmp(msg.cmd, "logbench") == 0) {
+    cmdLogBench(msg);
+  } else if (strcmp(msg.cmd, "stats") == 0) {
+    cmdStats(msg);
+  } else if (strcmp(msg.cmd, "perf") == 0) {
+    cmdPerf(msg);
+  } else if (strcmp(msg.cmd, "flight") == 0) {
+    cmdFlight(msg);
+  } else if (strcmp(msg.cmd, "faults") == 0) {
+    cmdFaults(msg);
+  } else if (strcmp(msg.cmd, "tasks") == 0) {
+    cmdTasks(msg);
+  } else if (strcmp(msg.cmd, "snapbench") == 0) {
+    cmdSnapBench(msg);
+  } else if (strcmp(msg.cmd, "trace") == 0) {
+    cmdTrace(msg);
+  } else {
+    LOGI("Unknown command '%s' (try 'help')", msg.cmd);
+  }
+}
+
+/**
+ * Description: Console "help": list available commands.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints the command list.
+ */
+void App::cmdHelp(const CommandMsg& msg) {
+  (void)msg;
+  LOGI("Commands:");
+  LOGI("  help          list commands");
+  LOGI("  play | pause  start or hold show playback");
+  LOGI("  seek <ms>     jump the show to a time (safe approach)");
+  LOGI("  load <slot> <file>   load a show image from SD in the background");
+  LOGI("  switch <slot> [atMs|end] [blendMs]   queue a show switch");
+  LOGI("  slots         slot states and switch latency");
+  LOGI("  xform [ch [gain <g>|offset <u>|clamp <min> <max>|invert <0|1>|shift <ms>|reset]]   channel trim");
+  LOGI("  save          write settings to EEPROM now");
+  LOGI("  limits [ch minPos maxPos maxVel maxAccel [maxJerk]]   show or set motor limits");
+  LOGI("  rec <ch> <jog|speed|accel> [tol]   record a channel while the show plays");
+  LOGI("  rec stop | cancel | clear <ch>     finish, abandon or drop a take");
+  LOGI("  rec           take statistics");
+  LOGI("  motors on|off stream setpoints to the RoboClaws");
+  LOGI("  latency [reset]       per-port output latency, channel skew and sync start skew");
+  LOGI("  telemetry [on|off|<ch>]   telemetry rates per port, or one channel's readings");
+  LOGI("  follow [reset|sim]    following error per channel, clear, or stall detection model");
+  LOGI("  estop [trip|reset]    emergency stop latency, manual trip, or clear the latch");
+  LOGI("  baud [port rate]      per-port baud rates (saved)");
+  LOGI("  tune [port|all]       find the fastest reliable baud per port (motors off)");
+  LOGI("  loopback <port> [count]   echo round trip (needs a TX->RX jumper, motors off)");
+  LOGI("  skewsim       modeled skew with and without latency lookahead");
+  LOGI("  seekbench     seek latency for 1 min..2 h shows");
+  LOGI("  cuebench      cue scheduler cost with 20k events");
+  LOGI("  logbench      cycles per log call, deferred vs Serial.printf");
+  LOGI("  stats [reset|policy <resp|log> <newest|oldest>]   console output and logger counters");
+  LOGI("  perf [hist]   loop time per subsystem since the last perf (then resets)");
+  LOGI("  flight [arm|freeze|dump]   flight recorder state, re-arm, freeze, or binary dump over USB");
+  LOGI("  faults [reset]   active faults with raise counts and times, or clear the history");
+  LOGI("  tasks [reset]    scheduler tasks: runs, load, deadline misses and budget overruns");
+  LOGI("  snapbench     seqlock vs triple buffer publish/read cost by snapshot size");
+  LOGI("  trace [arm|stop]   input/serial capture for replay: status, capture from next boot, or end it");
+}
+
+/**
+ * Description: Console "seek <ms>": jump the attached show to a time.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Seeks the show engine with a safe approach move.
+ */
+void App::cmdSeek(const CommandMsg& msg) {
+  if (msg.argc < 1) {
+    LOGI("usage: seek <ms>");
+    return;
+  }
+  if (!_show.show()) {
+    LOGI("seek: no show loaded");
+    return;
+  }
+  const uint32_t tMs = (uint32_t)strtoul(msg.argv[0], nullptr, 10);
+  cancelRecording("seek");
+  _show.seek(tMs, _jogLimits);
+  LOGI("seek: %lu ms", (unsigned long)_show.currentTimeMs());
+}
+
+/**
+ * Description: Console "play" / "pause": start or hold show playback.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Updates the show engine play state.
+ */
+void App::cmdPlay(const CommandMsg& msg) {
+  if (strcmp(msg.cmd, "play") == 0) {
+    if (startPlayback("play") && _show.isPlaying()) {
+      LOGI("play at %lu ms", (unsigned long)_show.currentTimeMs());
+    }
+    return;
+  }
+  _show.setPlaying(false);
+  _model.playing = false;
+  LOGI("pause at %lu ms", (unsigned long)_show.currentTimeMs());
+}
+
+/**
+ * Description: Start show playback as "play" does.
+ * Inputs:
+ * - name: command name for the log.
+ * Outputs: Returns false while the e-stop is latched; otherwise arms a
+ *   synchronized start or starts playback, and returns true.
+ */
+bool App::startPlayback(const char* name) {
+  if (_motors.isStopped()) {
+    LOGI("%s: e-stop latched ('estop reset' first)", name);
+    return false;
+  }
+  _model.playing = true;
+  // With motors streaming, a start from rest is released on all ports at
+  // once; the show clock starts when the release fires (see loop()).
+  if (!_show.isPlaying() && !_show.isApproaching() && _motors.armSyncStart(_show, micros())) {
+    LOGI("%s: synchronized start armed at %lu ms", name, (unsigned long)_show.currentTimeMs());
+    return true;
+  }
+  _show.setPlaying(true);
+  return true;
+}
+
+/**
+ * Description: Console "rec ...": record a live input onto a channel during playback.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Starts, stops, cancels or clears a take, or prints take statistics.
+ */
+void App::cmdRec(const CommandMsg& msg) {
+  if (msg.argc == 0) {
+    const RecordStats& st = _recorder.stats();
+    const float ratio = (st.keys > 0) ? (float)st.samples / (float)st.keys : 0.0f;
+    LOGI("rec: %s ch %u, %lu samples -> %lu keys (%.1f:1), max error %.2f (tol %.2f)%s",
+         _recorder.isRecording() ? "recording" : "idle", _recorder.channel(),
+         (unsigned long)st.samples, (unsigned long)st.keys, ratio, st.maxError, st.tolerance,
+         st.overflow ? " OVERFLOW" : "");
+    return;
+  }
+  if (strcmp(msg.argv[0], "stop") == 0) {
+    if (!_recorder.isRecording()) {
+      LOGI("rec: not recording");
+      return;
+    }
+    const uint8_t ch = _recorder.channel();
+    // Detach any previous take first; stop() replaces its storage.
+    _show.setTrackOverride(ch, nullptr);
+    const bool stored = _recorder.stop();
+    _show.setTrackOverride(ch, _recorder.take(ch));
+    _recordShow = nullptr;
+    LOGI("rec: ch %u %s", ch, stored ? "take stored" : "take FAILED (previous track kept)");
+    cmdRec(CommandMsg{});
+    return;
+  }
+  if (strcmp(msg.argv[0], "cancel") == 0) {
+    cancelRecording("cancelled");
+    return;
+  }
+  if (strcmp(msg.argv[0], "clear") == 0) {
+    if (msg.argc < 2) {
+      LOGI("usage: rec clear <ch>");
+      return;
+    }
+    const uint8_t ch = (uint8_t)atoi(msg.argv[1]);
+    if (_recorder.isRecording() && _recorder.channel() == ch) {
+      LOGI("rec: ch %u is recording", ch);
+      return;
+    }
+    _show.setTrackOverride(ch, nullptr);
+    _recorder.discard(ch);
+    LOGI("rec: ch %u back to show track", ch);
+    return;
+  }
+
+  if (msg.argc < 2) {
+    LOGI("usage: rec <ch> <jog|speed|accel> [tol]");
+    return;
+  }
+  const Show* show = _show.show();
+  const uint8_t ch = (uint8_t)atoi(msg.argv[0]);
+  if (!show || ch >= show->channelCount()) {
+    LOGI("rec: no show loaded or channel out of range");
+    return;
+  }
+  if (strcmp(msg.argv[1], "jog") == 0) {
+    _recordSource = RecordSource::Jog;
+  } else if (strcmp(msg.argv[1], "speed") == 0) {
+    _recordSource = RecordSource::SpeedPot;
+  } else if (strcmp(msg.argv[1], "accel") == 0) {
+    _recordSource = RecordSource::AccelPot;
+  } else {
+    LOGI("rec: source must be jog, speed or accel");
+    return;
+  }
+  const float tolerance = (msg.argc >= 3) ? (float)atof(msg.argv[2]) : RECORD_DEFAULT_TOLERANCE;
+  if (_motors.isStopped()) {
+    LOGI("rec: e-stop latched ('estop reset' first)");
+    return;
+  }
+
+  // Overdub on top of the existing take, if any, so passes can be layered.
+  // Takes of another show (or of this slot before a reload) must not be reused.
+  discardStaleTakes();
+  const Track* original = _recorder.take(ch);
+  if (!original) {
+    original = &show->track(ch);
+  }
+  if (!_recorder.start(ch, original, _show.currentTimeMs(), tolerance)) {
+    LOGI("rec: cannot start");
+    return;
+  }
+  _recordShow = show;
+  _takesShow = show;
+  if (!_show.isPlaying()) {
+    startPlayback("rec");
+  }
+  LOGI("rec: ch %u from %s at %lu ms, tol %.2f", ch, msg.argv[1],
+       (unsigned long)_show.currentTimeMs(), tolerance);
+}
+
+/**
+ * Description: Abandon a recording in progress.
+ * Inputs:
+ * - reason: text for the log.
+ * Outputs: Cancels the recorder; the channel keeps its previous track.
+ */
+void App::cancelRecording(const char* reason) {
+  if (!_recorder.isRecording()) {
+    return;
+  }
+  _recorder.cancel();
+  _recordShow = nullptr;
+  LOGI("rec: ch %u cancelled (%s)", _recorder.channel(), reason);
+}
+
+/**
+ * Description: Drop every stored take once the show they were recorded against is no longer active.
+ * Inputs: None.
+ * Outputs: Frees the takes (the engine dropped their overrides when the show changed).
+ */
+void App::discardStaleTakes() {
+  if (_takesShow == _show.show()) {
+    return;
+  }
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    _recorder.discard(ch);
+  }
+  _takesShow = nullptr;
+}
+
+/**
+ * Description: Check whether a slot holds the active or queued show.
+ * Inputs:
+ * - slot: slot index.
+ * Outputs: Returns true if the slot must not be reloaded.
+ */
+bool App::slotInUse(uint8_t slot) const {
+  const Show* show = _slots.show(slot);
+  return show && (show == _show.show() || show == _show.pendingShow());
+}
+
+/**
+ * Description: Console "load <slot> <file>": load a show image from SD in the background.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Starts loading unless the slot is in use by the engine.
+ */
+void App::cmdLoad(const CommandMsg& msg) {
+  if (msg.argc < 2) {
+    LOGI("usage: load <slot> <file>");
+    return;
+  }
+  const uint8_t slot = (uint8_t)atoi(msg.argv[0]);
+  if (slot >= ShowSlots::SLOT_COUNT) {
+    LOGI("load: slot must be 0..%u", ShowSlots::SLOT_COUNT - 1);
+    return;
+  }
+  if (slotInUse(slot)) {
+    LOGI("load: slot %u is playing or queued", slot);
+    return;
+  }
+  if (!_slots.beginLoad(slot, msg.argv[1])) {
+    LOGI("load: cannot load '%s'", msg.argv[1]);
+    return;
+  }
+  LOGI("load: slot %u loading '%s'", slot, msg.argv[1]);
+}
+
+/**
+ * Description: Console "switch <slot> [atMs|end] [blendMs]": queue a show switch.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Queues the switch (or approaches the first show directly).
+ */
+void App::cmdSwitch(const CommandMsg& msg) {
+  if (msg.argc < 1) {
+    LOGI("usage: switch <slot> [atMs|end] [blendMs]");
+    return;
+  }
+  const uint8_t slot = (uint8_t)atoi(msg.argv[0]);
+  const Show* next = (slot < ShowSlots::SLOT_COUNT) ? _slots.show(slot) : nullptr;
+  if (!next) {
+    LOGI("switch: slot %u is not ready", slot);
+    return;
+  }
+
+  if (!_show.show()) {
+    // Nothing playing yet: attach and make a safe approach to the first frame.
+    _show.setShow(next);
+    _show.seek(0, _jogLimits);
+    LOGI("switch: slot %u attached", slot);
+    return;
+  }
+
+  uint32_t atMs = ShowEngine::SWITCH_AT_END;
+  if (msg.argc >= 2 && strcmp(msg.argv[1], "end") != 0) {
+    atMs = (uint32_t)strtoul(msg.argv[1], nullptr, 10);
+  }
+  const uint32_t blendMs = (msg.argc >= 3) ? (uint32_t)strtoul(msg.argv[2], nullptr, 10) : 0;
+  _show.queueSwitch(next, atMs, blendMs);
+  LOGI("switch: slot %u queued", slot);
+}
+
+/**
+ * Description: Console "slots": show slot states and switch statistics.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints one line per slot plus switch latency.
+ */
+void App::cmdSlots(const CommandMsg& msg) {
+  (void)msg;
+  static const char* const STATE_NAMES[] = {"empty", "loading", "ready", "failed"};
+  for (uint8_t i = 0; i < ShowSlots::SLOT_COUNT; i++) {
+    const Show* show = _slots.show(i);
+    const char* role = "";
+    if (show && show == _show.show()) role = " [active]";
+    else if (show && show == _show.pendingShow()) role = " [queued]";
+    LOGI("slot %u: %s %u%% %s%s", i, STATE_NAMES[(uint8_t)_slots.state(i)],
+         _slots.progressPct(i), _slots.name(i), role);
+  }
+  LOGI("last switch: %lu us, unloaded ticks: %lu",
+       (unsigned long)_show.lastSwitchUs(), (unsigned long)_show.unloadedTicks());
+  for (uint8_t i = 0; i < ShowSlots::SLOT_COUNT; i++) {
+    if (_slots.state(i) != SlotState::Ready) {
+      continue;
+    }
+    const size_t size = _slots.imageSize(i);
+    const uint32_t usPerMb = (size > 0) ? (uint32_t)((uint64_t)_slots.analysisUs(i) * 1048576u / size) : 0;
+    LOGI("slot %u envelope: %lu us (%lu us/MB), over-limit channels 0x%04X",
+         i, (unsigned long)_slots.analysisUs(i), (unsigned long)usPerMb, _slots.violationMask(i));
+  }
+  LOGI("rate ceiling: %.2fx", _show.rateCeiling());
+}
+
+/**
+ * Description: Print one channel's transform.
+ * Inputs:
+ * - ch: channel index.
+ * - xf: transform to print.
+ * Outputs: Logs one line.
+ */
+static void printTransform(uint8_t ch, const ChannelTransform& xf) {
+  LOGI("ch %2u: gain %.4f offset %ld clamp %ld..%ld invert %u shift %d ms", ch,
+       (double)xf.gainQ16 / (double)TRANSFORM_ONE_Q16, (long)xf.offset,
+       (long)xf.clampMin, (long)xf.clampMax, xf.invert, xf.timeOffsetMs);
+}
+
+/**
+ * Description: Console "xform [ch [gain|offset|clamp|invert|shift|reset ...]]": show or edit channel transforms.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints transforms or updates one; takes effect on the next tick and is saved.
+ */
+void App::cmdXform(const CommandMsg& msg) {
+  ChannelTransform* transforms = _config.data().transforms;
+  if (msg.argc == 0) {
+    bool any = false;
+    for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+      if (!transforms[ch].isIdentity()) {
+        printTransform(ch, transforms[ch]);
+        any = true;
+      }
+    }
+    if (!any) {
+      LOGI("xform: all channels untrimmed");
+    }
+    return;
+  }
+  const uint8_t ch = (uint8_t)atoi(msg.argv[0]);
+  if (ch >= SHOW_MAX_CHANNELS) {
+    LOGI("xform: channel must be 0..%u", SHOW_MAX_CHANNELS - 1);
+    return;
+  }
+  ChannelTransform& xf = transforms[ch];
+  if (msg.argc == 1) {
+    printTransform(ch, xf);
+    return;
+  }
+
+  const char* field = msg.argv[1];
+  const bool hasValue = (msg.argc >= 3);
+  if (strcmp(field, "reset") == 0) {
+    xf = ChannelTransform{};
+  } else if (strcmp(field, "gain") == 0 && hasValue) {
+    xf.gainQ16 = (int32_t)lround(atof(msg.argv[2]) * TRANSFORM_ONE_Q16);
+  } else if (strcmp(field, "offset") == 0 && hasValue) {
+    xf.offset = (int32_t)atol(msg.argv[2]);
+  } else if (strcmp(field, "clamp") == 0 && msg.argc >= 4) {
+    const int32_t lo = (int32_t)atol(msg.argv[2]);
+    const int32_t hi = (int32_t)atol(msg.argv[3]);
+    if (lo > hi) {
+      LOGI("xform: clamp min must not exceed max");
+      return;
+    }
+    xf.clampMin = lo;
+    xf.clampMax = hi;
+  } else if (strcmp(field, "invert") == 0 && hasValue) {
+    xf.invert = (atoi(msg.argv[2]) != 0) ? 1 : 0;
+  } else if (strcmp(field, "shift") == 0 && hasValue) {
+    const long shiftMs = atol(msg.argv[2]);
+    xf.timeOffsetMs = (int16_t)((shiftMs > INT16_MAX) ? INT16_MAX : (shiftMs < INT16_MIN) ? INT16_MIN : shiftMs);
+  } else {
+    LOGI("usage: xform <ch> gain <g> | offset <u> | clamp <min> <max> | invert <0|1> | shift <ms> | reset");
+    return;
+  }
+  settingsChanged();
+  printTransform(ch, xf);
+}
+
+/**
+ * Description: Console "save": write settings to EEPROM now.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Saves the config and reports the result.
+ */
+void App::cmdSave(const CommandMsg& msg) {
+  (void)msg;
+  LOGI("save: %s", _config.save() ? "ok" : "FAILED");
+}
+
+/**
+ * Description: Publish edited transforms/limits to the engine and schedule a save.
+ * Inputs: None.
+ * Outputs: Refreshes envelope-derived limits and marks the config dirty.
+ */
+void App::settingsChanged() {
+  _show.setChannelTransforms(_config.data().transforms);
+  _config.markDirty();
+}
+
+/**
+ * Description: Console "limits [ch minPos maxPos maxVel maxAccel [maxJerk]]": show or set motor limits.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints the limits table or updates one channel and re-checks the show.
+ */
+void App::cmdLimits(const CommandMsg& msg) {
+  if (msg.argc == 0) {
+    const Show* show = _show.show();
+    for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+      const ChannelLimits& lim = _config.data().limits[ch];
+      if (show && show->isAnalyzed() && ch < show->channelCount()) {
+        const KinematicEnvelope& env = show->envelope(ch);
+        LOGI("ch %2u: pos %.0f..%.0f vel %.0f acc %.0f jerk %.0f | show pos %.0f..%.0f vel %.0f acc %.0f jerk %.0f%s",
+             ch, lim.minPos, lim.maxPos, lim.maxVel, lim.maxAccel, lim.maxJerk,
+             env.minPos, env.maxPos, env.maxVel, env.maxAccel, env.maxJerk,
+             Envelope::check(env, lim) ? " OVER" : "");
+      } else {
+        LOGI("ch %2u: pos %.0f..%.0f vel %.0f acc %.0f jerk %.0f",
+             ch, lim.minPos, lim.maxPos, lim.maxVel, lim.maxAccel, lim.maxJerk);
+      }
+    }
+    LOGI("rate ceiling: %.2fx", _show.rateCeiling());
+    return;
+  }
+  if (msg.argc < 5) {
+    LOGI("usage: limits <ch> <minPos> <maxPos> <maxVel> <maxAccel> [maxJerk]  (0 = unchecked)");
+    return;
+  }
+  const uint8_t ch = (uint8_t)atoi(msg.argv[0]);
+  if (ch >= SHOW_MAX_CHANNELS) {
+    LOGI("limits: channel must be 0..%u", SHOW_MAX_CHANNELS - 1);
+    return;
+  }
+  ChannelLimits next;
+  next.minPos = (float)atof(msg.argv[1]);
+  next.maxPos = (float)atof(msg.argv[2]);
+  next.maxVel = (float)atof(msg.argv[3]);
+  next.maxAccel = (float)atof(msg.argv[4]);
+  next.maxJerk = (msg.argc >= 6) ? (float)atof(msg.argv[5]) : 0.0f;
+  // An inverted range would clamp every setpoint to one end; a negative
+  // limit would be read as "over" by every check.
+  if (next.minPos != 0.0f && next.maxPos != 0.0f && next.minPos > next.maxPos) {
+    LOGI("limits: minPos must not exceed maxPos");
+    LOGI("usage: limits <ch> <minPos> <maxPos> <maxVel> <maxAccel> [maxJerk]  (0 = unchecked)");
+    return;
+  }
+  if (next.maxVel < 0.0f || next.maxAccel < 0.0f || next.maxJerk < 0.0f) {
+    LOGI("limits: vel, accel and jerk must not be negative");
+    LOGI("usage: limits <ch> <minPos> <maxPos> <maxVel> <maxAccel> [maxJerk]  (0 = unchecked)");
+    return;
+  }
+  _config.data().limits[ch] = next;
+  settingsChanged();
+  LOGI("limits: ch %u updated, rate ceiling %.2fx", ch, _show.rateCeiling());
+}
+
+/**
+ * Description: Check that a console benchmark may run; they block the console task for a long time.
+ * Inputs:
+ * - name: command name for the refusal message.
+ * Outputs: Returns false, and says why, while motors are on, a show is playing or a
+ *          flight dump is streaming (bench output would corrupt it).
+ */
+bool App::benchAllowed(const char* name) const {
+  if (_motors.isEnabled()) {
+    LOGI("%s: turn motors off first", name);
+    return false;
+  }
+  if (_show.isPlaying()) {
+    LOGI("%s: stop playback first", name);
+    return false;
+  }
+  if (_flight.dumping()) {
+    LOGI("%s: wait for the flight dump to finish", name);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Description: Console "seekbench": measure seek latency for 1 min..2 h shows.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints indexed seek and from-zero scan latency per show length;
+ *          refused while benchAllowed() says no.
+ */
+void App::cmdSeekBench(const CommandMsg& msg) {
+  (void)msg;
+  if (!benchAllowed("seekbench")) {
+    return;
+  }
+  LOGI("seekbench: minutes, keys, indexed ns/seek, scan-from-zero ns/seek");
+  for (uint32_t minutes : SEEK_BENCH_MINUTES) {
+    const uint32_t lengthMs = minutes * 60000u;
+    const uint32_t keyCount = lengthMs / SEEK_BENCH_KEY_SPACING_MS;
+    const uint32_t checkpointCount = Track::checkpointsFor(keyCount);
+    TrackKey* keys = (TrackKey*)malloc(keyCount * sizeof(TrackKey));
+    TrackCheckpoint* checkpoints = (TrackCheckpoint*)malloc(checkpointCount * sizeof(TrackCheckpoint));
+    if (!keys || !checkpoints) {
+      LOGI("seekbench: %lu min: out of memory", (unsigned long)minutes);
+      free(keys);
+      free(checkpoints);
+      break;
+    }
+
+    uint32_t rng = 12345u;
+    for (uint32_t i = 0; i < keyCount; i++) {
+      keys[i].dtMs = (i == 0) ? 0 : (uint16_t)SEEK_BENCH_KEY_SPACING_MS;
+      keys[i].dValue = (int16_t)((int32_t)(benchRand(rng) >> 20) - 2048);
+      keys[i].ease = (uint8_t)Ease::Smooth;
+      keys[i].reserved = 0;
+    }
+    Track::buildCheckpoints(keys, keyCount, 0, 0, checkpoints, checkpointCount);
+    Track track;
+    track.attach(keys, keyCount, checkpoints, checkpointCount);
+
+    // Indexed seek: binary search on checkpoints, then a short forward walk.
+    TrackCursor cursor;
+    volatile float sink = 0.0f;
+    uint32_t t0 = micros();
+    for (uint32_t i = 0; i < SEEK_BENCH_SEEKS; i++) {
+      const uint32_t tMs = benchRand(rng) % lengthMs;
+      track.seek(cursor, tMs);
+      sink = sink + Track::sample(cursor, (uint64_t)tMs * 1000u).pos;
+    }
+    const uint32_t indexedUs = micros() - t0;
+
+    // Naive reference: accumulate deltas from time zero.
+    t0 = micros();
+    for (uint32_t i = 0; i < SEEK_BENCH_SCANS; i++) {
+      const uint32_t tMs = benchRand(rng) % lengthMs;
+      uint32_t timeMs = 0;
+      int32_t value = 0;
+      for (uint32_t k = 1; k < keyCount && timeMs + keys[k].dtMs <= tMs; k++) {
+        timeMs += keys[k].dtMs;
+        value += keys[k].dValue;
+      }
+      sink = sink + (float)value;
+    }
+    const uint32_t scanUs = micros() - t0;
+
+    LOGI("seekbench: %3lu, %6lu, %6lu, %9lu", (unsigned long)minutes, (unsigned long)keyCount,
+         (unsigned long)((uint64_t)indexedUs * 1000u / SEEK_BENCH_SEEKS),
+         (unsigned long)((uint64_t)scanUs * 1000u / SEEK_BENCH_SCANS));
+    free(keys);
+    free(checkpoints);
+  }
+}
+
+/**
+ * Description: Cue handler used by the benchmark: counts events only.
+ * Inputs:
+ * - event: drained event.
+ * - context: uint32_t counter.
+ * Outputs: Increments the counter.
+ */
+static void countCue(const ShowEvent& event, void* context) {
+  (void)event;
+  (*static_cast<uint32_t*>(context))++;
+}
+
+/**
+ * Description: Console "cuebench": time the cue scheduler on a 20k-event show.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints per-tick dispatch cost and fired/expected counts; refused
+ *          while benchAllowed() says no.
+ */
+void App::cmdCueBench(const CommandMsg& msg) {
+  (void)msg;
+  if (!benchAllowed("cuebench")) {
+    return;
+  }
+  ShowEvent* events = (ShowEvent*)malloc(CUE_BENCH_EVENTS * sizeof(ShowEvent));
+  CueScheduler* cues = new CueScheduler();
+  if (!events || !cues) {
+    LOGI("cuebench: out of memory");
+    free(events);
+    delete cues;
+    return;
+  }
+
+  // Sorted random times (sum of random gaps) so bursts and gaps both occur.
+  uint32_t rng = 777u;
+  uint32_t timeMs = 0;
+  const uint32_t meanGapMs = CUE_BENCH_LENGTH_MS / CUE_BENCH_EVENTS;
+  for (uint32_t i = 0; i < CUE_BENCH_EVENTS; i++) {
+    timeMs += benchRand(rng) % (2 * meanGapMs);
+    events[i] = ShowEvent{timeMs, (uint8_t)ShowEventType::Output, (uint8_t)(i & 7), 0};
+  }
+  const uint32_t endMs = timeMs + 1;
+
+  // Playback at 1x and 2x (1 and 2 ms of show time per 1 ms tick).
+  for (uint32_t stepMs = 1; stepMs <= 2; stepMs++) {
+    cues->setEvents(events, CUE_BENCH_EVENTS);
+    uint32_t fired = 0;
+    uint32_t maxTickUs = 0;
+    const uint32_t t0 = micros();
+    for (uint32_t t = 0; t <= endMs; t += stepMs) {
+      const uint32_t tickStart = micros();
+      cues->advance(t);
+      cues->drain(countCue, &fired);
+      const uint32_t tickUs = micros() - tickStart;
+      if (tickUs > maxTickUs) maxTickUs = tickUs;
+    }
+    const uint32_t totalUs = micros() - t0;
+    const uint32_t ticks = endMs / stepMs + 1;
+    LOGI("cuebench: rate %lux, %lu ticks, %lu ns/tick avg, %lu us max, fired %lu/%lu, late %lu",
+         (unsigned long)stepMs, (unsigned long)ticks,
+         (unsigned long)((uint64_t)totalUs * 1000u / ticks), (unsigned long)maxTickUs,
+         (unsigned long)fired, (unsigned long)CUE_BENCH_EVENTS, (unsigned long)cues->lateCount());
+  }
+
+  // Seek to the middle: only events at or after the seek time may fire.
+  const uint32_t seekMs = endMs / 2;
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < CUE_BENCH_EVENTS; i++) {
+    if (events[i].timeMs >= seekMs) expected++;
+  }
+  cues->setEvents(events, CUE_BENCH_EVENTS);
+  cues->seek(seekMs);
+  uint32_t fired = 0;
+  for (uint32_t t = seekMs; t <= endMs; t++) {
+    cues->advance(t);
+    cues->drain(countCue, &fired);
+  }
+  LOGI("cuebench: seek %lu ms, fired %lu/%lu", (unsigned long)seekMs, (unsigned long)fired, (unsigned long)expected);
+
+  delete cues;
+  free(events);
+}
+
+/**
+ * Description: Console "motors on|off": start or stop streaming setpoints to the RoboClaws.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Enables/disables motor output and reports the state.
+ */
+void App::cmdMotors(const CommandMsg& msg) {
+  if (msg.argc >= 1) {
+    if (strcmp(msg.argv[0], "on") == 0) {
+      _motors.setEnabled(true);
+    } else if (strcmp(msg.argv[0], "off") == 0) {
+      _motors.setEnabled(false);
+    } else {
+      LOGI("usage: motors on|off");
+      return;
+    }
+  }
+  LOGI("motors: %s", _motors.isEnabled() ? "on" : "off");
+}
+
+/**
+ * Description: Console "latency [reset]": per-port output latency and inter-channel skew.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints latency estimates, ack counters and skew with/without compensation.
+ */
+void App::cmdLatency(const CommandMsg& msg) {
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    _motors.resetStats();
+    LOGI("latency: reset");
+    return;
+  }
+  LOGI("latency: port, baud, frames, acks, timeouts, est/min/max us, queue us");
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    const OutputPortStats& st = _motors.portStats(p);
+    LOGI("latency: %u, %6lu, %6lu, %6lu, %4lu, %5lu/%5lu/%5lu, %5lu", (unsigned)p,
+         (unsigned long)_rs422.port(p).baud, (unsigned long)st.framesSent, (unsigned long)st.acks,
+         (unsigned long)st.timeouts, (unsigned long)st.latency.estimateUs(),
+         (unsigned long)st.latency.minUs(), (unsigned long)st.latency.maxUs(),
+         (unsigned long)st.lastQueueUs);
+  }
+  const SkewTracker& skew = _motors.skew();
+  LOGI("latency: skew last %lu us (max %lu), uncompensated last %lu us (max %lu)",
+       (unsigned long)skew.lastSkewUs(), (unsigned long)skew.maxSkewUs(),
+       (unsigned long)skew.lastUncompensatedUs(), (unsigned long)skew.maxUncompensatedUs());
+  const SyncStartStats& sync = _motors.syncStats();
+  LOGI("latency: sync starts %lu, release skew last %lu ns (max %lu), late %lu us (max %lu), hold %lu us",
+       (unsigned long)sync.releases, (unsigned long)sync.lastSkewNs, (unsigned long)sync.maxSkewNs,
+       (unsigned long)sync.lastLateUs, (unsigned long)sync.maxLateUs, (unsigned long)sync.lastHoldUs);
+}
+
+/**
+ * Description: Console "telemetry [on|off|<ch>]": telemetry rates per port, or one channel's readings.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints achieved rates and budgets, a channel's latest values, or toggles polling.
+ */
+void App::cmdTelemetry(const CommandMsg& msg) {
+  if (msg.argc >= 1 && (strcmp(msg.argv[0], "on") == 0 || strcmp(msg.argv[0], "off") == 0)) {
+    _motors.setTelemetryEnabled(strcmp(msg.argv[0], "on") == 0);
+    LOGI("telemetry: %s", _motors.telemetryEnabled() ? "on" : "off");
+    return;
+  }
+  if (msg.argc >= 1) {
+    const uint8_t ch = (uint8_t)atoi(msg.argv[0]);
+    if (ch >= SHOW_MAX_CHANNELS) {
+      LOGI("usage: telemetry [on|off|<ch>]");
+      return;
+    }
+    ChannelTelemetry t;
+    _motors.telemetry().read(ch, t);
+    const uint32_t nowUs = micros();
+    uint32_t ageMs[TELEMETRY_FIELD_COUNT];
+    for (uint8_t f = 0; f < TELEMETRY_FIELD_COUNT; f++) {
+      ageMs[f] = t.updatedUs[f] ? (nowUs - t.updatedUs[f]) / 1000u : 0xFFFFFFFFu;
+    }
+    LOGI("telemetry: ch %u enc %ld (%lu ms ago), current %.2f A (%lu ms), status 0x%08lX (%lu ms), temp %.1f C (%lu ms)",
+         (unsigned)ch, (long)t.encoder, (unsigned long)ageMs[0], t.currentCa * 0.01f, (unsigned long)ageMs[1],
+         (unsigned long)t.status, (unsigned long)ageMs[2], t.tempDeciC * 0.1f, (unsigned long)ageMs[3]);
+    return;
+  }
+  const uint32_t* periods = TelemetryScheduler::FIELD_PERIOD_US;
+  LOGI("telemetry: %s; target pos/cur/status/temp %lu/%lu/%lu/%lu Hz", _motors.telemetryEnabled() ? "on" : "off",
+       (unsigned long)(1000000u / periods[0]), (unsigned long)(1000000u / periods[1]),
+       (unsigned long)(1000000u / periods[2]), (unsigned long)(1000000u / periods[3]));
+  LOGI("telemetry: port, motion/telemetry share permille, pos/cur/status/temp Hz, requests, timeouts, crc errors");
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    const TelemetryScheduler& sched = _motors.telemetryScheduler(p);
+    const OutputPortStats& st = _motors.portStats(p);
+    LOGI("telemetry: %u, %3u/%3u, %2lu/%2lu/%2lu/%2lu, %lu, %lu, %lu", (unsigned)p,
+         (unsigned)sched.motionPermille(), (unsigned)sched.sharePermille(),
+         (unsigned long)sched.achievedHz(TelemetryField::Position),
+         (unsigned long)sched.achievedHz(TelemetryField::Current),
+         (unsigned long)sched.achievedHz(TelemetryField::Status),
+         (unsigned long)sched.achievedHz(TelemetryField::Temperature),
+         (unsigned long)st.telemetryRequests, (unsigned long)st.telemetryTimeouts, (unsigned long)st.crcErrors);
+  }
+}
+
+/**
+ * Description: Console "follow [reset|sim]": following error statistics, reset, or the stall simulation.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints per-channel statistics, clears them, or reports modeled detection
+ *          latency (refused while benchAllowed() says no).
+ */
+void App::cmdFollow(const CommandMsg& msg) {
+  static const char* const LEVEL_NAMES[] = {"ok", "warning", "slow", "stop"};
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    if (_followLevel == FollowLevel::Stop) {
+      LOGI("follow: stopped, use 'estop reset'");
+      return;
+    }
+    _follow.reset();
+    LOGI("follow: reset");
+    return;
+  }
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "sim") == 0) {
+    if (!benchAllowed("follow sim")) {
+      return;
+    }
+    // Run 0 has no stall (false alarm check), run 1 stalls the plant.
+    for (uint8_t run = 0; run < 2; run++) {
+      FollowingMonitor* monitor = new FollowingMonitor();
+      if (!monitor) {
+        LOGI("follow: out of memory");
+        return;
+      }
+      const bool stall = (run == 1);
+      uint32_t rng = 99u;
+      float plant = 0.0f;
+      uint32_t detectUs[4] = {0, 0, 0, 0};
+      FollowLevel worst = FollowLevel::Ok;
+      const float alpha = (float)FOLLOW_SIM_SAMPLE_US * 1e-6f / FOLLOW_SIM_LAG_S;
+      for (uint32_t tUs = FOLLOW_SIM_SAMPLE_US; tUs <= FOLLOW_SIM_LENGTH_US; tUs += FOLLOW_SIM_SAMPLE_US) {
+        const float commanded = FOLLOW_SIM_AMPLITUDE * sinf(2.0f * (float)M_PI * FOLLOW_SIM_FREQ_HZ * (float)tUs * 1e-6f);
+        if (!stall || tUs < FOLLOW_SIM_STALL_AT_US) {
+          plant += (commanded - plant) * alpha;
+        }
+        const float noise = (float)((int32_t)(benchRand(rng) % (2 * FOLLOW_SIM_NOISE + 1)) - FOLLOW_SIM_NOISE);
+        const FollowLevel level = monitor->sample(0, commanded, plant + noise, tUs);
+        if (level > worst) {
+          worst = level;
+          detectUs[(uint8_t)level] = tUs;
+        }
+        if (level == FollowLevel::Stop) {
+          break;
+        }
+      }
+      const FollowStats& st = monitor->stats(0);
+      if (!stall) {
+        LOGI("follow sim: no stall, %lu s: worst level %s, peak error %.0f, ewma %.0f",
+             (unsigned long)(FOLLOW_SIM_LENGTH_US / 1000000u), LEVEL_NAMES[(uint8_t)worst], st.peak, st.ewma);
+      } else {
+        LOGI("follow sim: stall at %lu ms, detected warning +%ld ms, slow +%ld ms, stop +%ld ms (peak error %.0f)",
+             (unsigned long)(FOLLOW_SIM_STALL_AT_US / 1000u),
+             detectUs[1] ? (long)(detectUs[1] - FOLLOW_SIM_STALL_AT_US) / 1000 : -1L,
+             detectUs[2] ? (long)(detectUs[2] - FOLLOW_SIM_STALL_AT_US) / 1000 : -1L,
+             detectUs[3] ? (long)(detectUs[3] - FOLLOW_SIM_STALL_AT_US) / 1000 : -1L, st.peak);
+      }
+      delete monitor;
+    }
+    return;
+  }
+
+  LOGI("follow: level %s; thresholds warn/slow/stop %.0f/%.0f/%.0f, horizon %.0f ms",
+       LEVEL_NAMES[(uint8_t)_followLevel], FollowingMonitor::WARN_COUNTS, FollowingMonitor::SLOW_COUNTS,
+       FollowingMonitor::STOP_COUNTS, FollowingMonitor::HORIZON_S * 1000.0f);
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    const FollowStats& st = _follow.stats(ch);
+    if (st.samples == 0) {
+      continue;
+    }
+    LOGI("follow: ch %2u %-7s last %6.0f ewma %6.0f peak %6.0f trend %7.0f/s (%lu samples)", (unsigned)ch,
+         LEVEL_NAMES[(uint8_t)st.level], st.last, st.ewma, st.peak, st.trend, (unsigned long)st.samples);
+  }
+}
+
+/**
+ * Description: Console "estop [trip|reset]": emergency stop status, manual trip or reset.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints stop latency statistics, trips the stop, or clears a latched stop.
+ */
+void App::cmdEStop(const CommandMsg& msg) {
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "trip") == 0) {
+    _motors.emergencyStop(StopSource::Console);
+  } else if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    if (_motors.isStopped() && !_motors.resetStop()) {
+      LOGI("estop: input still open, cannot reset");
+      return;
+    }
+    // A following stop is cleared with the e-stop; the monitor starts over.
+    _follow.reset();
+    _followLevel = FollowLevel::Ok;
+    FAULT_CLEAR(FAULT_FOLLOWING_WARNING);
+    FAULT_CLEAR(FAULT_FOLLOWING_SLOWDOWN);
+    FAULT_CLEAR(FAULT_FOLLOWING_STOP);
+    LOGI("estop: reset, motion allowed (show stays paused)");
+    return;
+  } else if (msg.argc >= 1) {
+    LOGI("usage: estop [trip|reset]");
+    return;
+  }
+  static const char* const SOURCE_NAMES[] = {"none", "input", "button", "console", "following", "fault"};
+  const EStopStats& st = _motors.stopStats();
+  LOGI("estop: %s, %lu trips, last by %s", _motors.isStopped() ? "LATCHED" : "clear",
+       (unsigned long)st.trips, SOURCE_NAMES[(uint8_t)st.lastSource]);
+  LOGI("estop: last trip->last byte %lu us (max %lu), isr %lu ns, queues drained after %lu us",
+       (unsigned long)st.lastWorstUs, (unsigned long)st.maxWorstUs, (unsigned long)st.lastIsrNs,
+       (unsigned long)st.lastDrainedUs);
+  // Worst case is a full position frame already on the wire ahead of the stop.
+  static const uint32_t BAUDS[] = {115200, 230400, 460800, 921600};
+  for (uint32_t baud : BAUDS) {
+    LOGI("estop: worst case at %6lu baud: %lu us", (unsigned long)baud,
+         (unsigned long)MotorOutput::worstStopUs(baud));
+  }
+}
+
+/**
+ * Description: Console "baud [port rate]": show per-port baud rates or set one.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints the rates or reopens a port at a new rate and saves it.
+ */
+void App::cmdBaud(const CommandMsg& msg) {
+  if (msg.argc >= 2) {
+    const uint8_t p = (uint8_t)atoi(msg.argv[0]);
+    const uint32_t baud = (uint32_t)strtoul(msg.argv[1], nullptr, 10);
+    if (p >= RS422_PORT_COUNT || baud < 2400 || baud > 1000000) {
+      LOGI("usage: baud [port 2400..1000000]");
+      return;
+    }
+    _rs422.setBaud(p, baud);
+    _config.data().portBaud[p] = baud;
+    _config.markDirty();
+  } else if (msg.argc == 1) {
+    LOGI("usage: baud [port rate]");
+    return;
+  }
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    const uint32_t baud = _rs422.port(p).baud;
+    LOGI("baud: port %u %6lu (max %lu motion frames/s)", (unsigned)p, (unsigned long)baud,
+         (unsigned long)(1000000u / serialBytesUs(RoboClaw::MIXED_POSITION_FRAME_BYTES + 1, baud)));
+  }
+}
+
+/**
+ * Description: Console "tune [port|all]": find the fastest reliable baud rate per port.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints per-rate results and frames/s before and after; saves the chosen rates.
+ */
+void App::cmdTune(const CommandMsg& msg) {
+  if (_motors.isEnabled()) {
+    LOGI("tune: turn motors off first");
+    return;
+  }
+  uint8_t first = 0, last = RS422_PORT_COUNT - 1;
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "all") != 0) {
+    first = last = (uint8_t)atoi(msg.argv[0]);
+    if (first >= RS422_PORT_COUNT) {
+      LOGI("usage: tune [port|all]");
+      return;
+    }
+  }
+  for (uint8_t p = first; p <= last; p++) {
+    const LinkTestResult before = LinkTuner::test(_rs422, p);
+    LinkTestResult results[LinkTuner::CANDIDATE_COUNT];
+    const uint32_t chosen = LinkTuner::tune(_rs422, p, results);
+    for (uint8_t i = 0; i < LinkTuner::CANDIDATE_COUNT; i++) {
+      const LinkTestResult& r = results[i];
+      LOGI("tune: port %u %6lu: %u/%u good, %u crc, %u timeout, %lu frames/s%s", (unsigned)p,
+           (unsigned long)r.baud, r.good, r.requests, r.crcErrors, r.timeouts, (unsigned long)r.framesPerSec,
+           LinkTuner::reliable(r) ? "" : " (unreliable)");
+    }
+    const LinkTestResult after = LinkTuner::test(_rs422, p);
+    if (!LinkTuner::reliable(after)) {
+      LOGI("tune: port %u: no controller answered reliably, kept %lu", (unsigned)p, (unsigned long)chosen);
+      continue;
+    }
+    LOGI("tune: port %u: %lu -> %lu baud, %lu -> %lu frames/s", (unsigned)p, (unsigned long)before.baud,
+         (unsigned long)chosen, (unsigned long)before.framesPerSec, (unsigned long)after.framesPerSec);
+    _config.data().portBaud[p] = chosen;
+    _config.markDirty();
+  }
+}
+
+/**
+ * Description: Console "loopback <port> [count]": time byte echoes through a TX->RX jumper.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints min/avg/max round trip for the port.
+ */
+void App::cmdLoopback(const CommandMsg& msg) {
+  if (msg.argc < 1) {
+    LOGI("usage: loopback <port> [count]");
+    return;
+  }
+  if (_motors.isEnabled()) {
+    LOGI("loopback: turn motors off first");
+    return;
+  }
+  const uint8_t p = (uint8_t)atoi(msg.argv[0]);
+  if (p >= RS422_PORT_COUNT || !_rs422.port(p).serial) {
+    LOGI("loopback: bad port");
+    return;
+  }
+  const uint32_t count = (msg.argc >= 2) ? (uint32_t)atoi(msg.argv[1]) : LOOPBACK_DEFAULT_COUNT;
+  HardwareSerial* serial = _rs422.port(p).serial;
+  while (serial->available()) traceRxByte(p, (uint8_t)serial->read());
+
+  uint32_t minUs = 0xFFFFFFFFu, maxUs = 0, totalUs = 0, echoes = 0, lost = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint8_t probe = (uint8_t)(0x55 ^ i);
+    const uint32_t t0 = micros();
+    serial->write(probe);
+    traceTx(p, &probe, 1);
+    bool echoed = false;
+    while (micros() - t0 < LOOPBACK_TIMEOUT_US) {
+      if (!serial->available()) {
+        continue;
+      }
+      const uint8_t b = (uint8_t)serial->read();
+      traceRxByte(p, b);
+      if (b == probe) {
+        echoed = true;
+        break;
+      }
+    }
+    const uint32_t rttUs = micros() - t0;
+    if (!echoed) {
+      lost++;
+      continue;
+    }
+    echoes++;
+    totalUs += rttUs;
+    if (rttUs < minUs) minUs = rttUs;
+    if (rttUs > maxUs) maxUs = rttUs;
+  }
+  if (echoes == 0) {
+    LOGI("loopback: port %u: no echo (jumper TX to RX)", (unsigned)p);
+    return;
+  }
+  LOGI("loopback: port %u, %lu echoes, %lu lost, rtt min/avg/max %lu/%lu/%lu us (1 byte = %lu us)",
+       (unsigned)p, (unsigned long)echoes, (unsigned long)lost, (unsigned long)minUs,
+       (unsigned long)(totalUs / echoes), (unsigned long)maxUs,
+       (unsigned long)serialBytesUs(1, _rs422.port(p).baud));
+}
+
+/**
+ * Description: Console "skewsim": model unequal port loads and compare skew with and without lookahead.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints average and worst skew for both cases; refused while motors
+ *          are on or a show is playing.
+ */
+void App::cmdSkewSim(const CommandMsg& msg) {
+  (void)msg;
+  if (!benchAllowed("skewsim")) {
+    return;
+  }
+  // Same estimator the output stage uses; each frame is evaluated with the
+  // estimate from the acks received so far.
+  LatencyEstimator estimators[RS422_PORT_COUNT];
+  uint32_t rng = 4242u;
+  uint64_t rawSum = 0, compSum = 0;
+  uint32_t rawMax = 0, compMax = 0;
+  for (uint32_t frame = 0; frame < SKEW_SIM_FRAMES; frame++) {
+    uint32_t rawLo = 0xFFFFFFFFu, rawHi = 0;
+    int32_t compLo = INT32_MAX, compHi = INT32_MIN;
+    for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+      // Background traffic ahead of the frame varies +/-50% around the port's load.
+      const uint32_t load = SKEW_SIM_BYTES_PER_PORT * p;
+      const uint32_t queued = load ? (load / 2 + benchRand(rng) % (load + 1)) : 0;
+      const uint32_t latencyUs = serialBytesUs(queued + RoboClaw::MIXED_POSITION_FRAME_BYTES, SKEW_SIM_BAUD) +
+                                 benchRand(rng) % SKEW_SIM_JITTER_US;
+      const int32_t residual = (int32_t)latencyUs - (int32_t)estimators[p].estimateUs();
+      estimators[p].addSample(latencyUs);
+      if (latencyUs < rawLo) rawLo = latencyUs;
+      if (latencyUs > rawHi) rawHi = latencyUs;
+      if (residual < compLo) compLo = residual;
+      if (residual > compHi) compHi = residual;
+    }
+    const uint32_t raw = rawHi - rawLo;
+    const uint32_t comp = (uint32_t)(compHi - compLo);
+    rawSum += raw;
+    if (raw > rawMax) rawMax = raw;
+    // The first frames have no estimate yet; judge compensation once it has converged.
+    if (frame >= 50) {
+      compSum += comp;
+      if (comp > compMax) compMax = comp;
+    }
+  }
+  LOGI("skewsim: %u ports, %lu frames, background 0..%lu bytes",
+       (unsigned)RS422_PORT_COUNT, (unsigned long)SKEW_SIM_FRAMES,
+       (unsigned long)(SKEW_SIM_BYTES_PER_PORT * (RS422_PORT_COUNT - 1) * 3 / 2));
+  LOGI("skewsim: uncompensated avg %lu us, max %lu us", (unsigned long)(rawSum / SKEW_SIM_FRAMES),
+       (unsigned long)rawMax);
+  LOGI("skewsim: compensated   avg %lu us, max %lu us", (unsigned long)(compSum / (SKEW_SIM_FRAMES - 50)),
+       (unsigned long)compMax);
+}
+
+/**
+ * Description: Console "logbench": cycles per log call for the deferred logger and for Serial.printf.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints avg/max cycles per call for both paths and the logger counters;
+ *          refused while benchAllowed() says no.
+ */
+void App::cmdLogBench(const CommandMsg& msg) {
+  (void)msg;
+  if (!benchAllowed("logbench")) {
+    return;
+  }
+  // Empty the ring first so every deferred call finds space.
+  logDrain();
+
+  const uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000u;
+  uint64_t deferredSum = 0, syncSum = 0;
+  uint32_t deferredMax = 0, syncMax = 0;
+  for (uint32_t i = 0; i < LOG_BENCH_CALLS; i++) {
+    const uint32_t c0 = ARM_DWT_CYCCNT;
+    LOGI("logbench %lu pos=%ld %s %.2f", (unsigned long)i, (long)(i * 37), "deferred", (double)i * 0.5);
+    const uint32_t cycles = ARM_DWT_CYCCNT - c0;
+    deferredSum += cycles;
+    if (cycles > deferredMax) deferredMax = cycles;
+  }
+  logDrain();
+
+  // The previous LOGI expansion: format and write inline.
+  for (uint32_t i = 0; i < LOG_BENCH_CALLS; i++) {
+    const uint32_t c0 = ARM_DWT_CYCCNT;
+    Serial.printf("[I] logbench %lu pos=%ld %s %.2f", (unsigned long)i, (long)(i * 37), "printf", (double)i * 0.5);
+    Serial.print("\n");
+    const uint32_t cycles = ARM_DWT_CYCCNT - c0;
+    syncSum += cycles;
+    if (cycles > syncMax) syncMax = cycles;
+  }
+
+  const LogStats stats = logStats();
+  LOGI("logbench: %lu calls, 4 args @ %lu MHz", (unsigned long)LOG_BENCH_CALLS, (unsigned long)cyclesPerUs);
+  LOGI("logbench: deferred avg %lu cycles, max %lu", (unsigned long)(deferredSum / LOG_BENCH_CALLS),
+       (unsigned long)deferredMax);
+  LOGI("logbench: printf   avg %lu cycles, max %lu", (unsigned long)(syncSum / LOG_BENCH_CALLS),
+       (unsigned long)syncMax);
+  LOGI("logbench: written %lu, dropped %lu, max lag %lu us, pending %u", (unsigned long)stats.records,
+       (unsigned long)stats.dropped, (unsigned long)stats.maxLagUs, (unsigned)stats.pending);
+}
+
+/**
+ * Description: Console "stats [reset|policy <resp|log> <newest|oldest>]": console output counters.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints per-lane bytes, drops and fill plus logger counters, clears them, or sets a drop policy.
+ */
+void App::cmdStats(const CommandMsg& msg) {
+  static const char* const LANE_NAMES[] = {"resp", "log"};
+  static const char* const POLICY_NAMES[] = {"newest", "oldest"};
+
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    consoleTxResetStats();
+    LOGI("stats: counters cleared");
+    return;
+  }
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "policy") == 0) {
+    if (msg.argc < 3) {
+      LOGI("usage: stats policy <resp|log> <newest|oldest>");
+      return;
+    }
+    int lane = -1, policy = -1;
+    for (uint8_t i = 0; i < 2; i++) {
+      if (strcmp(msg.argv[1], LANE_NAMES[i]) == 0) lane = i;
+      if (strcmp(msg.argv[2], POLICY_NAMES[i]) == 0) policy = i;
+    }
+    if (lane < 0 || policy < 0) {
+      LOGI("usage: stats policy <resp|log> <newest|oldest>");
+      return;
+    }
+    consoleTxSetPolicy((ConsoleLane)lane, (TxDropPolicy)policy);
+    LOGI("stats: %s lane drops %s on overflow", LANE_NAMES[lane], POLICY_NAMES[policy]);
+    return;
+  }
+
+  for (uint8_t i = 0; i < (uint8_t)ConsoleLane::Count; i++) {
+    const ConsoleLaneStats lane = consoleTxStats((ConsoleLane)i);
+    LOGI("stats: %-4s in %lu out %lu, dropped %lu bytes / %lu writes, queued %u/%u (peak %u), drop %s",
+         LANE_NAMES[i], (unsigned long)lane.bytesIn, (unsigned long)lane.bytesOut,
+         (unsigned long)lane.droppedBytes, (unsigned long)lane.droppedWrites, (unsigned)lane.queued,
+         (unsigned)lane.capacity, (unsigned)lane.highWater, POLICY_NAMES[(uint8_t)lane.policy]);
+  }
+  const LogStats log = logStats();
+  LOGI("stats: log records %lu, dropped %lu, max lag %lu us, pending %u; usb stalled %lu ms",
+       (unsigned long)log.records, (unsigned long)log.dropped, (unsigned long)log.maxLagUs,
+       (unsigned)log.pending, (unsigned long)consoleTxStalledMs());
+}
+
+/**
+ * Description: Console "perf [hist]": per-subsystem loop timing since the last perf.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints calls and min/avg/max per probe (and log2 histograms with "hist"), then resets the probes.
+ */
+void App::cmdPerf(const CommandMsg& msg) {
+  static uint32_t lastResetMs = 0;
+  const bool hist = (msg.argc >= 1 && strcmp(msg.argv[0], "hist") == 0);
+  const float ticksPerUs = (float)profileTicksPerUs();
+  const uint32_t windowMs = millis() - lastResetMs;
+  const ProbeStats& loop = g_probes[(uint8_t)ProbeId::Loop];
+
+  LOGI("perf: %lu ms window, %lu loops (%lu Hz)", (unsigned long)windowMs, (unsigned long)loop.count,
+       (unsigned long)(windowMs ? (uint64_t)loop.count * 1000u / windowMs : 0));
+  LOGI("perf: probe        calls     min us    avg us    max us  %%loop");
+  for (uint8_t i = 0; i < (uint8_t)ProbeId::Count; i++) {
+    const ProbeStats& p = g_probes[i];
+    if (p.count == 0) {
+      LOGI("perf: %-10s %7lu", profileName((ProbeId)i), 0ul);
+      continue;
+    }
+    const float share = loop.totalTicks ? 100.0f * (float)p.totalTicks / (float)loop.totalTicks : 0.0f;
+    LOGI("perf: %-10s %7lu %10.2f %9.2f %9.2f  %5.1f", profileName((ProbeId)i), (unsigned long)p.count,
+         (double)(p.minTicks / ticksPerUs), (double)((float)p.totalTicks / (float)p.count / ticksPerUs),
+         (double)(p.maxTicks / ticksPerUs), (double)share);
+  }
+
+  if (hist) {
+    // Bucket b counts durations below 2^b ticks (and at least 2^(b-1)).
+    for (uint8_t i = 0; i < (uint8_t)ProbeId::Count; i++) {
+      const ProbeStats& p = g_probes[i];
+      for (uint8_t b = 0; b < PROFILE_BUCKETS; b++) {
+        if (p.histogram[b]) {
+          LOGI("perf: %-10s < %10.2f us %7lu", profileName((ProbeId)i),
+               (double)((float)(1ull << b) / ticksPerUs), (unsigned long)p.histogram[b]);
+        }
+      }
+    }
+  }
+
+  profileReset();
+  lastResetMs = millis();
+}
+
+/**
+ * Description: Console "flight [arm|freeze|dump]": flight recorder status and control.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints ring state and record cost, re-arms, freezes, or streams the ring over USB.
+ */
+void App::cmdFlight(const CommandMsg& msg) {
+  if (_flight.blockCount() == 0) {
+    LOGI("flight: no recorder memory");
+    return;
+  }
+  if (msg.argc >= 1) {
+    if (strcmp(msg.argv[0], "arm") == 0) {
+      _flight.arm();
+      LOGI("flight: armed");
+    } else if (strcmp(msg.argv[0], "freeze") == 0) {
+      _flight.freeze();
+      LOGI("flight: frozen");
+    } else if (strcmp(msg.argv[0], "dump") == 0) {
+      if (_flight.dumping()) {
+        LOGI("flight: dump already running");
+      } else if (_flight.startDump()) {
+        // Decode the capture with the host tool: flightdec capture.bin out.csv
+        LOGI("flight: dumping %lu bytes after this line", (unsigned long)_flight.dumpBytes());
+      } else {
+        LOGI("flight: nothing recorded");
+      }
+    } else {
+      LOGI("usage: flight [arm|freeze|dump]");
+    }
+    return;
+  }
+
+  const FlightStats& stats = _flight.stats();
+  const uint32_t ticksPerUs = profileTicksPerUs();
+  const uint32_t avgFrameBytes = stats.frames ? (uint32_t)(stats.encodedBytes / stats.frames) + 1 : FLIGHT_MAX_FRAME_BYTES;
+  const uint32_t capacityFrames = _flight.blockCount() * (uint32_t)((FlightRecorder::BLOCK_BYTES - sizeof(FlightBlockHeader)) / avgFrameBytes);
+  LOGI("flight: %s, %lu frames, %lu/%lu blocks (%s), %lu us period",
+       _flight.frozen() ? "frozen" : "recording", (unsigned long)stats.frames,
+       (unsigned long)stats.blocksFilled, (unsigned long)_flight.blockCount(),
+       _flight.inPsram() ? "PSRAM" : "RAM", (unsigned long)FlightRecorder::PERIOD_US);
+  LOGI("flight: record avg %lu ns, max %lu ns; frame avg %lu max %lu bytes (bound %lu); ~%lu s retained",
+       (unsigned long)(stats.frames ? stats.totalTicks * 1000u / ticksPerUs / stats.frames : 0),
+       (unsigned long)((uint64_t)stats.maxTicks * 1000u / ticksPerUs), (unsigned long)avgFrameBytes,
+       (unsigned long)stats.maxFrameBytes,
+       (unsigned long)FLIGHT_MAX_FRAME_BYTES,
+       (unsigned long)((uint64_t)capacityFrames * FlightRecorder::PERIOD_US / 1000000u));
+  if (_flight.triggered()) {
+    LOGI("flight: triggered by faults 0x%08lX", (unsigned long)_flight.triggerFaults());
+  }
+}
+
+/**
+ * Description: Console "faults [reset]": active faults with raise counts and times.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints the fault table or clears the raise history.
+ */
+void App::cmdFaults(const CommandMsg& msg) {
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    reset_fault_history();
+    LOGI("faults: history cleared");
+    return;
+  }
+  LOGI("faults: active 0x%08lX, reactions 0x%08lX", (unsigned long)faults_active(),
+       (unsigned long)(faults_active() & FAULT_REACTION_MASK));
+  print_faults();
+}
+
+/**
+ * Description: Console "tasks [reset]": per-task scheduler statistics.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints runs, CPU share, lateness, run time, misses and overruns, or clears them.
+ */
+void App::cmdTasks(const CommandMsg& msg) {
+  if (msg.argc >= 1 && strcmp(msg.argv[0], "reset") == 0) {
+    _sched.resetStats();
+    LOGI("tasks: statistics cleared");
+    return;
+  }
+  const uint32_t elapsedUs = _sched.statsElapsedUs();
+  LOGI("tasks: %lu ms window", (unsigned long)(elapsedUs / 1000u));
+  LOGI("tasks: name       pri  period us  budget us     runs  %%cpu  late max  run avg  run max  miss  skip  over");
+  for (uint8_t i = 0; i < _sched.taskCount(); i++) {
+    const SchedulerTask& t = _sched.task(i);
+    const TaskStats& s = t.stats;
+    const float cpu = elapsedUs ? 100.0f * (float)s.totalRunUs / (float)elapsedUs : 0.0f;
+    char pri[4] = "bg";
+    if (t.periodUs != 0) {
+      snprintf(pri, sizeof(pri), "%u", (unsigned)t.priority);
+    }
+    LOGI("tasks: %-10s %3s %10lu %10lu %8lu %5.1f %9lu %8lu %8lu %5lu %5lu %5lu", t.name, pri,
+         (unsigned long)(t.periodUs ? t.periodUs : t.maxWaitUs), (unsigned long)t.budgetUs,
+         (unsigned long)s.runs, (double)cpu, (unsigned long)s.maxLateUs,
+         (unsigned long)(s.runs ? s.totalRunUs / s.runs : 0), (unsigned long)s.maxRunUs,
+         (unsigned long)s.misses, (unsigned long)s.skipped, (unsigned long)s.overruns);
+  }
+}
+
+/**
+ * Description: Console "snapbench": publish and read cost of the snapshot exchanges by size.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints ns per call for Seqlock and TripleBuffer at several sizes and for ControlStatus;
+ *          refused while benchAllowed() says no.
+ */
+void App::cmdSnapBench(const CommandMsg& msg) {
+  (void)msg;
+  if (!benchAllowed("snapbench")) {
+    return;
+  }
+  struct Row {
+    const char* name;
+    size_t bytes;
+    SnapBenchResult r;
+  };
+  const Row rows[] = {
+    {"16 B", 16, benchSnapshot<SnapBytes<16>>()},
+    {"64 B", 64, benchSnapshot<SnapBytes<64>>()},
+    {"256 B", 256, benchSnapshot<SnapBytes<256>>()},
+    {"1 KB", 1024, benchSnapshot<SnapBytes<1024>>()},
+    {"status", sizeof(ControlStatus), benchSnapshot<ControlStatus>()},
+  };
+  const uint32_t ticksPerUs = profileTicksPerUs();
+  LOGI("snapbench: %lu calls each, ns per call (uncontended)", (unsigned long)SNAP_BENCH_CALLS);
+  LOGI("snapbench: size     bytes  seq write  seq read  tri write  tri read");
+  for (const Row& row : rows) {
+    LOGI("snapbench: %-7s %6lu %10lu %9lu %10lu %9lu", row.name, (unsigned long)row.bytes,
+         (unsigned long)((uint64_t)row.r.seqWrite * 1000u / ticksPerUs),
+         (unsigned long)((uint64_t)row.r.seqRead * 1000u / ticksPerUs),
+         (unsigned long)((uint64_t)row.r.tripleWrite * 1000u / ticksPerUs),
+         (unsigned long)((uint64_t)row.r.tripleRead * 1000u / ticksPerUs));
+  }
+}
+
+/**
+ * Description: Console "trace [arm|stop]": input/serial trace capture for replay.
+ * Inputs:
+ * - msg: parsed command message.
+ * Outputs: Prints capture counters, arms a capture from the next boot, or ends the capture.
+ */
+void App::cmdTrace(const CommandMsg& msg) {
+  ConfigData& config = _config.data();
+  if (msg.argc >= 1) {
+    if (strcmp(msg.argv[0], "arm") == 0) {
+      // A replay starts from boot, so the capture does too.
+      config.traceAtBoot = 1;
+      const bool saved = _config.save();
+      LOGI("trace: %s", saved ? "armed, capture starts at the next boot" : "config save failed");
+    } else if (strcmp(msg.argv[0], "stop") == 0) {
+      const bool wasActive = traceActive();
+      traceStop();
+      config.traceAtBoot = 0;
+      _config.save();
+      LOGI("trace: %s", wasActive ? "stopped, file closed" : "disarmed");
+    } else {
+      LOGI("usage: trace [arm|stop]");
+    }
+    return;
+  }
+
+  const TraceStats stats = traceStats();
+  LOGI("trace: %s%s, file %s", stats.active ? "capturing" : "off",
+       config.traceAtBoot ? " (armed at boot)" : "", TRACE_FILE);
+  LOGI("  %lu records, %lu dropped, %lu KB written",
+       (unsigned long)stats.records, (unsigned long)stats.dropped, (unsigned long)(stats.bytesWritten / 1024u));
+  LOGI("  ring %lu/%lu KB queued, max %lu KB",
+       (unsigned long)(stats.pending / 1024u), (unsigned long)(stats.ringBytes / 1024u),
+       (unsigned long)(stats.maxPending / 1024u));
+}
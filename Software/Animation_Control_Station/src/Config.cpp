@@ -0,0 +1,99 @@
+#include "Config.h"
+#include "Faults.h"
+#include "Log.h"
+#include <EEPROM.h>
+
+static constexpr int CONFIG_EEPROM_ADDR = 0;
+
+/**
+ * Description: CRC-32 (IEEE, bitwise) of a byte range.
+ * Inputs:
+ * - data: bytes to check.
+ * - length: number of bytes.
+ * Outputs: Returns the CRC.
+ */
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+/**
+ * Description: Restore settings from EEPROM.
+ * Inputs: None.
+ * Outputs: Returns true when a valid image was read.
+ */
+bool Config::load() {
+  Header header;
+  EEPROM.get(CONFIG_EEPROM_ADDR, header);
+  if (header.magic != MAGIC) {
+    LOGI("Config: no saved settings, using defaults");
+    return false;
+  }
+  // Older versions are a prefix of the current layout; newer ones are unknown.
+  const bool current = (header.version == VERSION && header.size == sizeof(ConfigData));
+  const bool older = (header.version < VERSION && header.size > 0 && header.size < sizeof(ConfigData));
+  if (!current && !older) {
+    LOGI("Config: saved settings are version %u, using defaults", header.version);
+    FAULT_SET(FAULT_CONFIG_RESTORE_FAULT);
+    return false;
+  }
+
+  ConfigData stored = _data; // defaults for fields an older image lacks
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(&stored);
+  for (uint16_t i = 0; i < header.size; i++) {
+    bytes[i] = EEPROM.read(CONFIG_EEPROM_ADDR + (int)sizeof(Header) + i);
+  }
+  if (crc32(bytes, header.size) != header.crc) {
+    LOGI("Config: CRC mismatch, using defaults");
+    FAULT_SET(FAULT_CONFIG_RESTORE_FAULT);
+    return false;
+  }
+  if (older) {
+    LOGI("Config: upgraded settings from version %u", header.version);
+  }
+  _data = stored;
+  return true;
+}
+
+/**
+ * Description: Write settings to EEPROM now.
+ * Inputs: None.
+ * Outputs: Returns true when the image fits and was written.
+ */
+bool Config::save() {
+  if (sizeof(Header) + sizeof(ConfigData) > (size_t)EEPROM.length()) {
+    return false;
+  }
+  Header header;
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.size = (uint16_t)sizeof(ConfigData);
+  header.crc = crc32(reinterpret_cast<const uint8_t*>(&_data), sizeof(_data));
+  // put() only rewrites bytes that changed, which limits EEPROM wear.
+  EEPROM.put(CONFIG_EEPROM_ADDR + (int)sizeof(Header), _data);
+  EEPROM.put(CONFIG_EEPROM_ADDR, header);
+  _dirty = false;
+  return true;
+}
+
+/**
+ * Description: Perform a pending deferred save.
+ * Inputs: None.
+ * Outputs: Saves once SAVE_DELAY_MS has passed since the last edit.
+ */
+void Config::poll() {
+  if (_dirty && (millis() - _dirtyMs) >= SAVE_DELAY_MS) {
+    if (save()) {
+      LOGI("Config: saved");
+    } else {
+      LOGI("Config: save failed");
+      _dirty = false;
+    }
+  }
+}
@@ -1,5 +1,7 @@
 #include "Console.h"
 #include <cstring>
+#include "Log.h"
+#include "Trace.h"
 
 /**
  * Description: Initialize the console serial input capture.
@@ -36,6 +38,7 @@ void Console::poll() {
     if (ch == '\n') {
       if (_lineLength > 0) {
         _lineBuffer[_lineLength] = '\0';
+        traceConsole(_lineBuffer, _lineLength);
         CommandMsg message;
         tokenizeLine(_lineBuffer, message);
         if (message.cmd[0] != '\0') {
@@ -122,10 +125,12 @@ void Console::tokenizeLine(const char *line, CommandMsg &out) const {
  * Description: Dispatch a parsed command message if a handler is registered.
  * Inputs:
  * - msg: parsed command message.
- * Outputs: Calls the registered handler when available.
+ * Outputs: Calls the registered handler when available; its output uses the response lane.
  */
 void Console::dispatchCommand(const CommandMsg &msg) const {
   if (_dispatchCommand) {
+    logSetLane(ConsoleLane::Response);
     _dispatchCommand(msg);
+    logSetLane(ConsoleLane::Log);
   }
 }
@@ -0,0 +1,219 @@
+#include "ConsoleTx.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+static constexpr size_t CONSOLE_TX_PRINTF_BYTES = 256;
+
+DMAMEM static char s_responseBytes[CONSOLE_TX_RESPONSE_BYTES];
+DMAMEM static char s_logBytes[CONSOLE_TX_LOG_BYTES];
+
+// One byte ring; written and drained from the main loop only.
+struct TxLane {
+  char* bytes;
+  size_t capacity;
+  TxDropPolicy policy;
+  size_t head;  // next byte to write
+  size_t count; // queued bytes
+  ConsoleLaneStats stats;
+};
+
+static TxLane s_lanes[(uint8_t)ConsoleLane::Count] = {
+  // Responses keep what is queued (a listing stays coherent); logs favour the newest lines.
+  {s_responseBytes, CONSOLE_TX_RESPONSE_BYTES, TxDropPolicy::DropNewest, 0, 0, {}},
+  {s_logBytes, CONSOLE_TX_LOG_BYTES, TxDropPolicy::DropOldest, 0, 0, {}},
+};
+static uint32_t s_lastOutMs = 0;
+static bool s_stalled = false;
+
+/**
+ * Description: Discard queued bytes from the front of a lane up to and including a newline.
+ * Inputs:
+ * - lane: lane to trim.
+ * - needed: free bytes required.
+ * Outputs: Drops whole oldest lines (or raw bytes when no newline is queued) until needed bytes are free.
+ */
+static void dropOldest(TxLane& lane, size_t needed) {
+  while (lane.capacity - lane.count < needed && lane.count > 0) {
+    size_t tail = (lane.head + lane.capacity - lane.count) % lane.capacity;
+    size_t dropped = 0;
+    while (lane.count > 0) {
+      const char c = lane.bytes[tail];
+      tail = (tail + 1) % lane.capacity;
+      lane.count--;
+      dropped++;
+      if (c == '\n') {
+        break;
+      }
+    }
+    lane.stats.droppedBytes += dropped;
+    lane.stats.droppedWrites++;
+  }
+}
+
+/**
+ * Description: Queue bytes for the console without blocking.
+ * Inputs:
+ * - lane: output lane.
+ * - data: bytes to send.
+ * - len: number of bytes.
+ * Outputs: Returns false if any bytes were dropped (counted per lane).
+ */
+bool consoleTxWrite(ConsoleLane laneId, const char* data, size_t len) {
+  TxLane& lane = s_lanes[(uint8_t)laneId];
+  if (len == 0) {
+    return true;
+  }
+  if (len > lane.capacity) {
+    lane.stats.droppedBytes += len;
+    lane.stats.droppedWrites++;
+    return false;
+  }
+  if (lane.capacity - lane.count < len) {
+    if (lane.policy == TxDropPolicy::DropNewest) {
+      lane.stats.droppedBytes += len;
+      lane.stats.droppedWrites++;
+      return false;
+    }
+    dropOldest(lane, len);
+  }
+
+  const size_t first = (lane.capacity - lane.head < len) ? lane.capacity - lane.head : len;
+  memcpy(lane.bytes + lane.head, data, first);
+  memcpy(lane.bytes, data + first, len - first);
+  lane.head = (lane.head + len) % lane.capacity;
+  lane.count += len;
+  lane.stats.bytesIn += len;
+  if (lane.count > lane.stats.highWater) {
+    lane.stats.highWater = (uint16_t)lane.count;
+  }
+  return true;
+}
+
+/**
+ * Description: Queue formatted text for the console without blocking.
+ * Inputs:
+ * - lane: output lane.
+ * - fmt: printf format string.
+ * - ...: format arguments.
+ * Outputs: Returns false if the text was truncated or dropped.
+ */
+bool consoleTxPrintf(ConsoleLane lane, const char* fmt, ...) {
+  char text[CONSOLE_TX_PRINTF_BYTES];
+  va_list args;
+  va_start(args, fmt);
+  const int n = vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  if (n < 0) {
+    return false;
+  }
+  const size_t len = ((size_t)n < sizeof(text)) ? (size_t)n : sizeof(text) - 1;
+  return consoleTxWrite(lane, text, len) && (size_t)n == len;
+}
+
+/**
+ * Description: Hand a lane's queued bytes to USB up to a byte budget.
+ * Inputs:
+ * - lane: lane to send from.
+ * - budget: bytes USB will take without blocking.
+ * Outputs: Returns the number of bytes written.
+ */
+static size_t sendLane(TxLane& lane, size_t budget) {
+  size_t sent = 0;
+  while (lane.count > 0 && sent < budget) {
+    const size_t tail = (lane.head + lane.capacity - lane.count) % lane.capacity;
+    size_t chunk = lane.capacity - tail; // contiguous up to the wrap
+    if (chunk > lane.count) chunk = lane.count;
+    if (chunk > budget - sent) chunk = budget - sent;
+    const size_t written = Serial.write((const uint8_t*)lane.bytes + tail, chunk);
+    lane.count -= written;
+    lane.stats.bytesOut += written;
+    sent += written;
+    if (written < chunk) {
+      break;
+    }
+  }
+  return sent;
+}
+
+/**
+ * Description: Move queued bytes to USB as far as the host has room (call every loop pass).
+ * Inputs: None.
+ * Outputs: Writes response bytes first, then log bytes; never waits.
+ */
+void consoleTxPoll() {
+  if (!consoleTxPending()) {
+    s_stalled = false;
+    return;
+  }
+  const int room = Serial.availableForWrite();
+  size_t budget = (room > 0) ? (size_t)room : 0;
+  size_t sent = 0;
+  for (TxLane& lane : s_lanes) {
+    sent += sendLane(lane, budget - sent);
+  }
+  if (sent > 0 || !s_stalled) {
+    s_lastOutMs = millis();
+  }
+  s_stalled = (sent == 0);
+}
+
+/**
+ * Description: Check whether any console output is still queued.
+ * Inputs: None.
+ * Outputs: Returns true while either lane holds bytes.
+ */
+bool consoleTxPending() {
+  for (const TxLane& lane : s_lanes) {
+    if (lane.count > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Description: Set a lane's overflow policy.
+ * Inputs:
+ * - lane: output lane.
+ * - policy: drop policy.
+ * Outputs: Applies to later writes.
+ */
+void consoleTxSetPolicy(ConsoleLane lane, TxDropPolicy policy) {
+  s_lanes[(uint8_t)lane].policy = policy;
+}
+
+/**
+ * Description: Get a lane's counters.
+ * Inputs:
+ * - lane: output lane.
+ * Outputs: Returns byte, drop and fill counters.
+ */
+ConsoleLaneStats consoleTxStats(ConsoleLane laneId) {
+  const TxLane& lane = s_lanes[(uint8_t)laneId];
+  ConsoleLaneStats stats = lane.stats;
+  stats.queued = (uint16_t)lane.count;
+  stats.capacity = (uint16_t)lane.capacity;
+  stats.policy = lane.policy;
+  return stats;
+}
+
+/**
+ * Description: Get how long USB has refused output while bytes were queued.
+ * Inputs: None.
+ * Outputs: Returns milliseconds since the last byte went out (0 when idle or flowing).
+ */
+uint32_t consoleTxStalledMs() {
+  return s_stalled ? millis() - s_lastOutMs : 0;
+}
+
+/**
+ * Description: Clear the byte, drop and high-water counters.
+ * Inputs: None.
+ * Outputs: Leaves queued bytes and policies unchanged.
+ */
+void consoleTxResetStats() {
+  for (TxLane& lane : s_lanes) {
+    lane.stats = ConsoleLaneStats{};
+    lane.stats.highWater = (uint16_t)lane.count;
+  }
+}
@@ -0,0 +1,262 @@
+#include "CueScheduler.h"
+
+/**
+ * Description: Attach a time-sorted event track (or nullptr to detach).
+ * Inputs:
+ * - events: sorted events; must stay valid while attached.
+ * - count: number of events.
+ * Outputs: Clears the wheel and rewinds to time 0.
+ */
+void CueScheduler::setEvents(const ShowEvent* events, uint32_t count) {
+  _events = events;
+  _eventCount = events ? count : 0;
+  seek(0);
+}
+
+/**
+ * Description: Reposition after a show time jump.
+ * Inputs:
+ * - tMs: new show time; events at or after it will fire.
+ * Outputs: Clears the wheel and finds the first pending event in O(log n).
+ */
+void CueScheduler::seek(uint32_t tMs) {
+  clearWheel();
+  _nextMs = tMs;
+
+  uint32_t lo = 0;
+  uint32_t hi = _eventCount;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (_events[mid].timeMs < tMs) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  _cursor = lo;
+}
+
+/**
+ * Description: Dispatch every event due up to and including tMs.
+ * Inputs:
+ * - tMs: current show time (must not go backwards without seek()).
+ * Outputs: Queues due events on the deferred queue.
+ */
+void CueScheduler::advance(uint32_t tMs) {
+  if (_eventCount == 0) {
+    _nextMs = tMs + 1;
+    return;
+  }
+
+  // Walk one 256 ms block at a time; a faster playback rate just covers
+  // more milliseconds per call, so nothing is skipped.
+  while (_nextMs <= tMs) {
+    if ((_nextMs & (WHEEL_SLOTS - 1)) == 0) {
+      cascade(_nextMs);
+    }
+    refill(_nextMs);
+    const uint32_t blockEnd = _nextMs | (WHEEL_SLOTS - 1);
+    const uint32_t last = (tMs < blockEnd) ? tMs : blockEnd;
+    uint16_t stalledSlot = 0;
+    if (!dispatchSlots((uint16_t)(_nextMs & (WHEEL_SLOTS - 1)), (uint16_t)(last & (WHEEL_SLOTS - 1)), stalledSlot)) {
+      // Deferred queue full: resume at the pending slot once drain() catches up.
+      _nextMs = (_nextMs & ~(uint32_t)(WHEEL_SLOTS - 1)) | stalledSlot;
+      _stalls++;
+      return;
+    }
+    _nextMs = last + 1;
+    if (_nextMs == 0) {
+      break; // end of the 32-bit timeline
+    }
+  }
+}
+
+/**
+ * Description: Run handlers for queued events.
+ * Inputs:
+ * - handler: callback for each event.
+ * - context: opaque pointer passed to the handler.
+ * - maxEvents: upper bound on events handled in this call.
+ * Outputs: Returns the number of events handled.
+ */
+uint32_t CueScheduler::drain(CueHandlerFn handler, void* context, uint32_t maxEvents) {
+  uint32_t handled = 0;
+  while (_deferredTail != _deferredHead && handled < maxEvents) {
+    const ShowEvent event = _deferred[_deferredTail];
+    _deferredTail = (uint16_t)((_deferredTail + 1) & (DEFERRED_QUEUE_SIZE - 1));
+    if (handler) {
+      handler(event, context);
+    }
+    handled++;
+  }
+  return handled;
+}
+
+/**
+ * Description: Reset the wheel, node pool and bitmap.
+ * Inputs: None.
+ * Outputs: Returns every node to the free list.
+ */
+void CueScheduler::clearWheel() {
+  for (uint16_t i = 0; i < WHEEL_SLOTS; i++) {
+    _level0[i] = SlotList{};
+    _level1[i] = SlotList{};
+  }
+  for (uint16_t i = 0; i < WHEEL_SLOTS / 32; i++) {
+    _level0Occupied[i] = 0;
+  }
+  for (uint16_t i = 0; i < NODE_POOL_SIZE; i++) {
+    _nodeNext[i] = (uint16_t)(i + 1);
+  }
+  _nodeNext[NODE_POOL_SIZE - 1] = NIL;
+  _freeHead = 0;
+}
+
+/**
+ * Description: Insert events from the track that entered the horizon.
+ * Inputs:
+ * - nowMs: first unprocessed millisecond.
+ * Outputs: Moves events into the wheel until the horizon or pool is exhausted.
+ */
+void CueScheduler::refill(uint32_t nowMs) {
+  while (_cursor < _eventCount) {
+    const uint32_t timeMs = _events[_cursor].timeMs;
+    if (timeMs < nowMs) {
+      // Held back by a full node pool: fire late rather than never.
+      if (!enqueue(_events[_cursor])) {
+        break;
+      }
+      _late++;
+      _cursor++;
+      continue;
+    }
+    if ((timeMs >> 16) != (nowMs >> 16)) {
+      break; // beyond the level 1 horizon
+    }
+    if (!insert(_cursor, nowMs)) {
+      break;
+    }
+    _cursor++;
+  }
+}
+
+/**
+ * Description: Place one event into the wheel slot for its time.
+ * Inputs:
+ * - eventIndex: index into the event track.
+ * - nowMs: first unprocessed millisecond.
+ * Outputs: Returns false when the node pool is empty.
+ */
+bool CueScheduler::insert(uint32_t eventIndex, uint32_t nowMs) {
+  const uint16_t node = _freeHead;
+  if (node == NIL) {
+    return false;
+  }
+  _freeHead = _nodeNext[node];
+  _nodeEvent[node] = eventIndex;
+  _nodeNext[node] = NIL;
+
+  const uint32_t timeMs = _events[eventIndex].timeMs;
+  SlotList* slot;
+  if ((timeMs >> 8) == (nowMs >> 8)) {
+    const uint16_t index = (uint16_t)(timeMs & (WHEEL_SLOTS - 1));
+    slot = &_level0[index];
+    _level0Occupied[index >> 5] |= (1u << (index & 31));
+  } else {
+    slot = &_level1[(timeMs >> 8) & (WHEEL_SLOTS - 1)];
+  }
+
+  // Append so events sharing a millisecond keep track order.
+  if (slot->tail == NIL) {
+    slot->head = node;
+  } else {
+    _nodeNext[slot->tail] = node;
+  }
+  slot->tail = node;
+  return true;
+}
+
+/**
+ * Description: Move the level 1 slot for a new block into level 0.
+ * Inputs:
+ * - blockStartMs: first millisecond of the block being entered.
+ * Outputs: Redistributes the slot's nodes by millisecond.
+ */
+void CueScheduler::cascade(uint32_t blockStartMs) {
+  SlotList& source = _level1[(blockStartMs >> 8) & (WHEEL_SLOTS - 1)];
+  uint16_t node = source.head;
+  source = SlotList{};
+  while (node != NIL) {
+    const uint16_t next = _nodeNext[node];
+    _nodeNext[node] = NIL;
+    const uint16_t index = (uint16_t)(_events[_nodeEvent[node]].timeMs & (WHEEL_SLOTS - 1));
+    SlotList& slot = _level0[index];
+    if (slot.tail == NIL) {
+      slot.head = node;
+    } else {
+      _nodeNext[slot.tail] = node;
+    }
+    slot.tail = node;
+    _level0Occupied[index >> 5] |= (1u << (index & 31));
+    node = next;
+  }
+}
+
+/**
+ * Description: Dispatch all occupied level 0 slots in a range.
+ * Inputs:
+ * - firstSlot: first slot (inclusive).
+ * - lastSlot: last slot (inclusive).
+ * - stalledSlot: receives the slot left pending when the queue fills.
+ * Outputs: Queues events and frees their nodes. Returns false on a stall.
+ */
+bool CueScheduler::dispatchSlots(uint16_t firstSlot, uint16_t lastSlot, uint16_t& stalledSlot) {
+  for (uint16_t word = firstSlot >> 5; word <= (lastSlot >> 5); word++) {
+    const uint16_t base = (uint16_t)(word << 5);
+    uint32_t bits = _level0Occupied[word];
+    if (firstSlot > base) {
+      bits &= ~0u << (firstSlot - base);
+    }
+    if (lastSlot - base < 31) {
+      bits &= (2u << (lastSlot - base)) - 1u;
+    }
+
+    // Only occupied slots are visited; empty milliseconds cost nothing.
+    while (bits) {
+      const uint16_t index = (uint16_t)(base + __builtin_ctz(bits));
+      bits &= bits - 1u;
+
+      SlotList& slot = _level0[index];
+      while (slot.head != NIL) {
+        const uint16_t node = slot.head;
+        if (!enqueue(_events[_nodeEvent[node]])) {
+          stalledSlot = index;
+          return false;
+        }
+        slot.head = _nodeNext[node];
+        _nodeNext[node] = _freeHead;
+        _freeHead = node;
+      }
+      slot.tail = NIL;
+      _level0Occupied[word] &= ~(1u << (index & 31));
+    }
+  }
+  return true;
+}
+
+/**
+ * Description: Push an event onto the deferred queue.
+ * Inputs:
+ * - event: event to queue (copied).
+ * Outputs: Returns false when the queue is full.
+ */
+bool CueScheduler::enqueue(const ShowEvent& event) {
+  const uint16_t next = (uint16_t)((_deferredHead + 1) & (DEFERRED_QUEUE_SIZE - 1));
+  if (next == _deferredTail) {
+    return false;
+  }
+  _deferred[_deferredHead] = event;
+  _deferredHead = next;
+  _dispatched++;
+  return true;
+}
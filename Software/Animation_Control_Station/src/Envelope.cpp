@@ -0,0 +1,215 @@
+#include "Envelope.h"
+#include <math.h>
+
+static constexpr float UNLIMITED_RATE = 1.0e6f;
+
+// Signed velocity/acceleration at both ends of a key segment plus the
+// largest magnitudes inside it.
+struct SegmentKinematics {
+  float velStart, velEnd;
+  float accStart, accEnd;
+  float peakVel, peakAccel, peakJerk;
+};
+
+/**
+ * Description: Closed-form kinematics of one eased key segment.
+ * Inputs:
+ * - cursor: cursor holding the segment's keys.
+ * Outputs: Returns end-point and peak values in show-time units.
+ */
+static SegmentKinematics segmentKinematics(const TrackCursor& cursor) {
+  SegmentKinematics k = {};
+  const float delta = (float)(cursor.v1 - cursor.v0);
+  const float span = (float)(cursor.t1 - cursor.t0) * 1e-3f;
+  if (delta == 0.0f) {
+    return k;
+  }
+  if (span <= 0.0f || (Ease)cursor.ease == Ease::Step) {
+    // A jump at the end of the segment: the motor sees it over one window.
+    const float w = Envelope::WINDOW_S;
+    k.peakVel = fabsf(delta) / w;
+    k.peakAccel = fabsf(delta) / (w * w);
+    k.peakJerk = fabsf(delta) / (w * w * w);
+    return k;
+  }
+  const float v = delta / span;
+  const float a = delta / (span * span);
+  switch ((Ease)cursor.ease) {
+    case Ease::Linear:
+      k.velStart = k.velEnd = v;
+      break;
+    case Ease::Smooth:
+      k.accStart = 6.0f * a;
+      k.accEnd = -6.0f * a;
+      k.peakVel = 1.5f * fabsf(v);
+      k.peakAccel = 6.0f * fabsf(a);
+      k.peakJerk = 12.0f * fabsf(a) / span;
+      break;
+    case Ease::EaseIn:
+      k.velEnd = 2.0f * v;
+      k.accStart = k.accEnd = 2.0f * a;
+      break;
+    case Ease::EaseOut:
+      k.velStart = 2.0f * v;
+      k.accStart = k.accEnd = -2.0f * a;
+      break;
+    default:
+      break;
+  }
+  const float endVel = fmaxf(fabsf(k.velStart), fabsf(k.velEnd));
+  if (endVel > k.peakVel) k.peakVel = endVel;
+  const float endAcc = fmaxf(fabsf(k.accStart), fabsf(k.accEnd));
+  if (endAcc > k.peakAccel) k.peakAccel = endAcc;
+  return k;
+}
+
+/**
+ * Description: Widen an envelope with a value range and kinematic peaks.
+ * Inputs:
+ * - env: envelope to update.
+ * - pos0: first position.
+ * - pos1: second position.
+ * - vel: velocity magnitude.
+ * - accel: acceleration magnitude.
+ * - jerk: jerk magnitude.
+ * Outputs: Updates env in place.
+ */
+static inline void widen(KinematicEnvelope& env, float pos0, float pos1, float vel, float accel, float jerk) {
+  KinematicEnvelope e;
+  e.minPos = fminf(pos0, pos1);
+  e.maxPos = fmaxf(pos0, pos1);
+  e.maxVel = vel;
+  e.maxAccel = accel;
+  e.maxJerk = jerk;
+  env.merge(e);
+}
+
+/**
+ * Description: Analyze a track into per-block and whole-track envelopes.
+ * Inputs:
+ * - track: track to analyze.
+ * - blocks: one envelope per checkpoint block, or nullptr for the total only.
+ * - total: receives the whole-track envelope.
+ * Outputs: Fills blocks and total in one pass over the keys.
+ */
+void Envelope::analyze(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total) {
+  EnvelopeScan state;
+  beginScan(track, blocks, total, state);
+  scan(track, blocks, total, state, 0xFFFFFFFFu);
+}
+
+/**
+ * Description: Start an analysis that scan() carries out a few keys at a time.
+ * Inputs:
+ * - track: track to analyze.
+ * - blocks: one envelope per checkpoint block, or nullptr for the total only.
+ * - total: receives the whole-track envelope.
+ * - state: receives the scan position.
+ * Outputs: Clears blocks and total.
+ */
+void Envelope::beginScan(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total,
+                         EnvelopeScan& state) {
+  total = KinematicEnvelope{};
+  const uint32_t keyCount = track.keyCount();
+  for (uint32_t b = 0; blocks && b < Track::checkpointsFor(keyCount); b++) {
+    blocks[b] = KinematicEnvelope{};
+  }
+  state = EnvelopeScan{};
+  state.done = (keyCount == 0);
+  if (!state.done) {
+    track.seek(state.cursor, 0);
+  }
+}
+
+/**
+ * Description: Continue an analysis started by beginScan().
+ * Inputs:
+ * - track, blocks, total: as passed to beginScan().
+ * - state: scan position.
+ * - maxKeys: key segments to cover in this call.
+ * Outputs: Returns true once the whole track is covered and total is filled.
+ */
+bool Envelope::scan(const Track& track, KinematicEnvelope* blocks, KinematicEnvelope& total,
+                    EnvelopeScan& state, uint32_t maxKeys) {
+  if (state.done) {
+    return true;
+  }
+
+  // Tracks start and end at rest; prevVel/prevAcc carry the corner state
+  // from one call to the next.
+  const float w = WINDOW_S;
+  TrackCursor& cursor = state.cursor;
+  for (uint32_t n = 0; n < maxKeys; n++) {
+    const SegmentKinematics k = segmentKinematics(cursor);
+    // Corner at this key: steps in velocity/acceleration over one window.
+    const float dv = fabsf(k.velStart - state.prevVel);
+    const float da = fabsf(k.accStart - state.prevAcc);
+    const float cornerAccel = dv / w;
+    const float cornerJerk = da / w + dv / (w * w);
+
+    KinematicEnvelope& block = blocks ? blocks[cursor.index / TRACK_CHECKPOINT_INTERVAL] : total;
+    widen(block, (float)cursor.v0, (float)cursor.v1, k.peakVel,
+          fmaxf(k.peakAccel, cornerAccel), fmaxf(k.peakJerk, cornerJerk));
+    state.prevVel = k.velEnd;
+    state.prevAcc = k.accEnd;
+    if (!track.step(cursor)) {
+      state.done = true;
+      break;
+    }
+  }
+  if (!state.done) {
+    return false;
+  }
+
+  // Final hold: come to rest after the last segment.
+  const uint32_t keyCount = track.keyCount();
+  const float prevVel = state.prevVel;
+  const float prevAcc = state.prevAcc;
+  KinematicEnvelope& last = blocks ? blocks[(keyCount - 1) / TRACK_CHECKPOINT_INTERVAL] : total;
+  widen(last, (float)cursor.v1, (float)cursor.v1, 0.0f,
+        fabsf(prevVel) / w, fabsf(prevAcc) / w + fabsf(prevVel) / (w * w));
+
+  for (uint32_t b = 0; blocks && b < Track::checkpointsFor(keyCount); b++) {
+    total.merge(blocks[b]);
+  }
+  return true;
+}
+
+/**
+ * Description: Compare an envelope against motor limits at 1x playback.
+ * Inputs:
+ * - env: track envelope.
+ * - limits: motor limits.
+ * Outputs: Returns ENVELOPE_* flags for each exceeded limit (0 = safe).
+ */
+uint8_t Envelope::check(const KinematicEnvelope& env, const ChannelLimits& limits) {
+  uint8_t flags = 0;
+  if (env.maxPos >= env.minPos && (env.minPos < limits.minPos || env.maxPos > limits.maxPos)) {
+    flags |= ENVELOPE_POS;
+  }
+  if (limits.maxVel > 0.0f && env.maxVel > limits.maxVel) flags |= ENVELOPE_VEL;
+  if (limits.maxAccel > 0.0f && env.maxAccel > limits.maxAccel) flags |= ENVELOPE_ACCEL;
+  if (limits.maxJerk > 0.0f && env.maxJerk > limits.maxJerk) flags |= ENVELOPE_JERK;
+  return flags;
+}
+
+/**
+ * Description: Highest playback rate at which an envelope stays within limits.
+ * Inputs:
+ * - env: track envelope.
+ * - limits: motor limits.
+ * Outputs: Returns the rate ceiling; large when nothing is limited.
+ */
+float Envelope::maxSafeRate(const KinematicEnvelope& env, const ChannelLimits& limits) {
+  float rate = UNLIMITED_RATE;
+  if (limits.maxVel > 0.0f && env.maxVel > 0.0f) {
+    rate = fminf(rate, limits.maxVel / env.maxVel);
+  }
+  if (limits.maxAccel > 0.0f && env.maxAccel > 0.0f) {
+    rate = fminf(rate, sqrtf(limits.maxAccel / env.maxAccel));
+  }
+  if (limits.maxJerk > 0.0f && env.maxJerk > 0.0f) {
+    rate = fminf(rate, cbrtf(limits.maxJerk / env.maxJerk));
+  }
+  return rate;
+}
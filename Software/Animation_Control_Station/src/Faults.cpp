@@ -2,18 +2,21 @@
 #include "Faults.h"
 #include "Log.h"
 
-uint32_t system_faults = 0;
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "fault bits must be raised without locks (ISR safe)");
+
+std::atomic<uint32_t> system_faults{0};
+FaultRecord fault_records[FAULT_MAX_INDEX];
 const char *FAULT_STRING[] = {
   "CONSOLE_TASK_FAULT",
   "COMMAND_EXEC_TASK_FAULT",
   "SHOW_TASK_FAULT",
   "CONFIG_RESTORE_FAULT",
   "IO_EXPANDER_FAULT",
-  "UNDEFINED_FAULT",
-  "UNDEFINED_FAULT",
-  "UNDEFINED_FAULT",
-  "UNDEFINED_FAULT",
-  "UNDEFINED_FAULT",
+  "LCD_DISPLAY_FAULT",
+  "ESTOP_FAULT",
+  "FOLLOWING_WARNING",
+  "FOLLOWING_SLOWDOWN",
+  "FOLLOWING_STOP",
   "UNDEFINED_FAULT",
   "UNDEFINED_FAULT",
   "UNDEFINED_FAULT",
@@ -38,15 +41,62 @@ const char *FAULT_STRING[] = {
   "UNDEFINED_FAULT"
 };
 
+/**
+ * Description: Record a rising fault edge (count and timestamps).
+ * Inputs:
+ * - fault: fault index.
+ * Outputs: Updates the fault's history; ISR safe.
+ */
+void fault_record_edge(uint8_t fault) {
+  if (fault >= FAULT_MAX_INDEX) {
+    return;
+  }
+  FaultRecord& record = fault_records[fault];
+  const uint32_t nowMs = millis() | 1u; // 0 marks "never"
+  uint32_t never = 0;
+  record.firstMs.compare_exchange_strong(never, nowMs, std::memory_order_relaxed);
+  record.lastMs.store(nowMs, std::memory_order_relaxed);
+  record.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Description: Print active faults and the raise history.
+ * Inputs: None.
+ * Outputs: Logs one line per fault that is active or has ever been raised.
+ */
 void print_faults() {
-  bool any_active = false;
-    for (int i = 0; i < FAULT_MAX_INDEX; i++) {
-      if (FAULT_ACTIVE(i)) {
-        LOGI("%s\n", FAULT_STRING[i]);
-        any_active = true;
-      }
+  bool any = false;
+  const uint32_t nowMs = millis();
+  for (uint8_t i = 0; i < FAULT_MAX_INDEX; i++) {
+    const uint32_t count = fault_records[i].count.load(std::memory_order_relaxed);
+    if (!FAULT_ACTIVE(i) && count == 0) {
+      continue;
     }
-    if (!any_active) {
-      LOGI("None\n");
+    any = true;
+    const uint32_t firstMs = fault_records[i].firstMs.load(std::memory_order_relaxed);
+    if (firstMs == 0) {
+      // Still active from before a history reset: no edge to report.
+      LOGI("%-20s active, no history", FAULT_STRING[i]);
+      continue;
     }
+    LOGI("%-20s %-6s raised %lu x, first %lu ms ago, last %lu ms ago", FAULT_STRING[i],
+         FAULT_ACTIVE(i) ? "ACTIVE" : "clear", (unsigned long)count, (unsigned long)(nowMs - firstMs),
+         (unsigned long)(nowMs - fault_records[i].lastMs.load(std::memory_order_relaxed)));
+  }
+  if (!any) {
+    LOGI("None");
+  }
+}
+
+/**
+ * Description: Clear the raise history of every fault.
+ * Inputs: None.
+ * Outputs: Zeroes counts and timestamps; active bits are unchanged.
+ */
+void reset_fault_history() {
+  for (FaultRecord& record : fault_records) {
+    record.count.store(0, std::memory_order_relaxed);
+    record.firstMs.store(0, std::memory_order_relaxed);
+    record.lastMs.store(0, std::memory_order_relaxed);
   }
+}
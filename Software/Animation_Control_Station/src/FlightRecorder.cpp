@@ -0,0 +1,232 @@
+#include "FlightRecorder.h"
+#include "Profiler.h"
+
+static constexpr uintptr_t PSRAM_BASE = 0x70000000u; // FlexSPI2 external RAM window
+static constexpr uintptr_t PSRAM_END = 0x80000000u;
+static constexpr uint32_t FNV_OFFSET = 2166136261u;
+static constexpr uint32_t BLOCK_PAYLOAD_BYTES = FlightRecorder::BLOCK_BYTES - sizeof(FlightBlockHeader);
+static_assert(FLIGHT_MAX_FRAME_BYTES <= BLOCK_PAYLOAD_BYTES, "a frame must fit in one block");
+static_assert(BLOCK_PAYLOAD_BYTES <= 0xFFFFu, "payloadBytes is 16 bits");
+static const char FLIGHT_END_TEXT[] = "\nFLIGHT END\n";
+
+/**
+ * Description: Allocate the ring and arm the recorder.
+ * Inputs: None.
+ * Outputs: Returns false if no memory could be allocated.
+ */
+bool FlightRecorder::begin() {
+  // extmem_malloc() falls back to RAM without PSRAM, where the full ring
+  // will not fit; retry with the small ring in that case.
+  _buf = static_cast<uint8_t*>(extmem_malloc(PSRAM_BYTES));
+  uint32_t bytes = PSRAM_BYTES;
+  if (!_buf) {
+    _buf = static_cast<uint8_t*>(extmem_malloc(RAM_BYTES));
+    bytes = RAM_BYTES;
+  }
+  if (!_buf) {
+    _blockCount = 0;
+    return false;
+  }
+  _inPsram = (uintptr_t)_buf >= PSRAM_BASE && (uintptr_t)_buf < PSRAM_END;
+  _blockCount = bytes / BLOCK_BYTES;
+  arm();
+  return true;
+}
+
+/**
+ * Description: Clear the ring and resume recording.
+ * Inputs: None.
+ * Outputs: Drops all frames and statistics.
+ */
+void FlightRecorder::arm() {
+  if (!_buf) {
+    return;
+  }
+  _head = 0;
+  *block(0) = FlightBlockHeader{0, 0, 0};
+  _stats = FlightStats{};
+  _stats.blocksFilled = 1;
+  _triggerFrame = FLIGHT_NO_TRIGGER;
+  _triggerFaults = 0;
+  _postRemaining = 0;
+  _frozen = false;
+  _dumping = false;
+}
+
+/**
+ * Description: Move to the next block, overwriting the oldest when full.
+ * Inputs: None.
+ * Outputs: Starts an empty block whose first frame is absolute.
+ */
+void FlightRecorder::nextBlock() {
+  _head = (_head + 1) % _blockCount;
+  if (_stats.blocksFilled < _blockCount) {
+    _stats.blocksFilled++;
+  }
+  *block(_head) = FlightBlockHeader{_stats.frames, 0, 0};
+}
+
+/**
+ * Description: Append one snapshot (bounded: FLIGHT_FIELD_COUNT varints).
+ * Inputs:
+ * - values: FLIGHT_FIELD_COUNT values in FlightField order.
+ * Outputs: Encodes the frame; triggers on a rising fault bit and freezes after the post-trigger window.
+ */
+void FlightRecorder::record(const uint32_t* values) {
+  if (!_buf || _frozen || _dumping) {
+    return;
+  }
+  const uint32_t start = profileNow();
+  _lastUs = values[(uint8_t)FlightField::TimeUs];
+
+  // Trigger on any fault bit that rises after the first frame (faults
+  // already present at boot are the baseline, not an event).
+  const uint32_t faults = values[(uint8_t)FlightField::Faults];
+  const uint32_t rising = faults & ~_lastFaults;
+  _lastFaults = faults;
+  if (rising && _stats.frames > 0 && !triggered()) {
+    _triggerFrame = _stats.frames;
+    _triggerFaults = rising;
+    _postRemaining = POST_TRIGGER_FRAMES;
+  }
+
+  FlightBlockHeader* b = block(_head);
+  if (BLOCK_PAYLOAD_BYTES - b->payloadBytes < FLIGHT_MAX_FRAME_BYTES) {
+    nextBlock();
+    b = block(_head);
+  }
+  if (b->frameCount == 0) {
+    b->firstFrame = _stats.frames;
+    memset(_prev, 0, sizeof(_prev)); // block starts from absolute values
+  }
+
+  uint8_t* out = reinterpret_cast<uint8_t*>(b + 1) + b->payloadBytes;
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < FLIGHT_FIELD_COUNT; i++) {
+    n += flightPutDelta(out + n, (int32_t)(values[i] - _prev[i]));
+    _prev[i] = values[i];
+  }
+  b->payloadBytes = (uint16_t)(b->payloadBytes + n);
+  b->frameCount++;
+  _stats.frames++;
+  _stats.encodedBytes += n;
+  if (n > _stats.maxFrameBytes) _stats.maxFrameBytes = n;
+
+  if (triggered()) {
+    if (_postRemaining == 0) {
+      _frozen = true;
+    } else {
+      _postRemaining--;
+    }
+  }
+
+  const uint32_t ticks = profileNow() - start;
+  _stats.totalTicks += ticks;
+  if (ticks > _stats.maxTicks) _stats.maxTicks = ticks;
+}
+
+/**
+ * Description: Get a block index in dump order.
+ * Inputs:
+ * - n: position from the oldest filled block.
+ * Outputs: Returns the ring index.
+ */
+uint32_t FlightRecorder::dumpBlock(uint32_t n) const {
+  const uint32_t oldest = (_head + _blockCount - (_stats.blocksFilled - 1)) % _blockCount;
+  return (oldest + n) % _blockCount;
+}
+
+/**
+ * Description: Get the number of bytes a dump will send after the BEGIN line.
+ * Inputs: None.
+ * Outputs: Returns the binary size.
+ */
+uint32_t FlightRecorder::dumpBytes() const {
+  uint32_t bytes = sizeof(FlightDumpHeader);
+  for (uint32_t i = 0; i < _stats.blocksFilled; i++) {
+    bytes += sizeof(FlightBlockHeader) + block(dumpBlock(i))->payloadBytes;
+  }
+  return bytes;
+}
+
+/**
+ * Description: Start streaming the frozen ring to USB (freezes first if needed).
+ * Inputs: None.
+ * Outputs: Returns false if the ring is empty; call pollDump() until dumping() is false.
+ */
+bool FlightRecorder::startDump() {
+  if (!_buf || _stats.frames == 0) {
+    return false;
+  }
+  _frozen = true;
+
+  uint32_t checksum = FNV_OFFSET;
+  for (uint32_t i = 0; i < _stats.blocksFilled; i++) {
+    const FlightBlockHeader* b = block(dumpBlock(i));
+    checksum = flightFnv1a(checksum, reinterpret_cast<const uint8_t*>(b), sizeof(FlightBlockHeader) + b->payloadBytes);
+  }
+  _dumpHeader = FlightDumpHeader{FLIGHT_MAGIC, FLIGHT_FORMAT_VERSION, FLIGHT_FIELD_COUNT, PERIOD_US,
+                                 _stats.blocksFilled, _triggerFrame, _triggerFaults, checksum, 0};
+  snprintf(_dumpText, sizeof(_dumpText), "FLIGHT BEGIN %lu\n", (unsigned long)dumpBytes());
+  _dumpStage = 0;
+  _dumpIndex = 0;
+  _dumpOffset = 0;
+  _dumping = true;
+  return true;
+}
+
+/**
+ * Description: Continue a dump without blocking (call every loop pass while dumping).
+ * Inputs: None.
+ * Outputs: Writes as many bytes as USB accepts now.
+ */
+void FlightRecorder::pollDump() {
+  int room = Serial.availableForWrite();
+  while (_dumping && room > 0) {
+    const uint8_t* piece = nullptr;
+    uint32_t len = 0;
+    switch (_dumpStage) {
+      case 0:
+        piece = reinterpret_cast<const uint8_t*>(_dumpText);
+        len = strlen(_dumpText);
+        break;
+      case 1:
+        piece = reinterpret_cast<const uint8_t*>(&_dumpHeader);
+        len = sizeof(_dumpHeader);
+        break;
+      case 2: {
+        const FlightBlockHeader* b = block(dumpBlock(_dumpIndex));
+        piece = reinterpret_cast<const uint8_t*>(b);
+        len = sizeof(FlightBlockHeader) + b->payloadBytes;
+        break;
+      }
+      default:
+        piece = reinterpret_cast<const uint8_t*>(FLIGHT_END_TEXT);
+        len = sizeof(FLIGHT_END_TEXT) - 1;
+        break;
+    }
+
+    uint32_t chunk = len - _dumpOffset;
+    if (chunk > (uint32_t)room) chunk = (uint32_t)room;
+    const size_t written = Serial.write(piece + _dumpOffset, chunk);
+    _dumpOffset += written;
+    room -= (int)written;
+    if (written < chunk) {
+      return;
+    }
+    if (_dumpOffset < len) {
+      continue;
+    }
+
+    // Piece finished: move to the next one.
+    _dumpOffset = 0;
+    if (_dumpStage == 2 && ++_dumpIndex < _stats.blocksFilled) {
+      continue;
+    }
+    if (_dumpStage == 3) {
+      _dumping = false;
+    } else {
+      _dumpStage++;
+    }
+  }
+}
@@ -0,0 +1,78 @@
+#include "FollowingError.h"
+
+/**
+ * Description: Clear all channel statistics and levels.
+ * Inputs: None.
+ * Outputs: Every channel back to Ok.
+ */
+void FollowingMonitor::reset() {
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    _stats[ch] = FollowStats{};
+  }
+}
+
+/**
+ * Description: Add a following error sample for a channel.
+ * Inputs:
+ * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+ * - commanded: position last sent to the motor.
+ * - measured: encoder position.
+ * - sampleUs: time of the encoder reading (repeats are ignored).
+ * Outputs: Returns the channel's level after the sample.
+ */
+FollowLevel FollowingMonitor::sample(uint8_t channel, float commanded, float measured, uint32_t sampleUs) {
+  FollowStats& st = _stats[channel];
+  if (st.samples > 0 && sampleUs == st.lastSampleUs) {
+    return st.level;
+  }
+  const float error = fabsf(commanded - measured);
+  if (st.samples == 0) {
+    st.ewma = error;
+  } else {
+    const float dtS = (float)(sampleUs - st.lastSampleUs) * 1e-6f;
+    const float rate = (dtS > 0.0f) ? (error - st.last) / dtS : 0.0f;
+    st.ewma += (error - st.ewma) * EWMA_WEIGHT;
+    st.trend += (rate - st.trend) * EWMA_WEIGHT;
+  }
+  st.last = error;
+  if (error > st.peak) st.peak = error;
+  st.lastSampleUs = sampleUs;
+  st.samples++;
+
+  if (st.level == FollowLevel::Stop) {
+    return st.level;
+  }
+  const float projected = st.ewma + ((st.trend > 0.0f) ? st.trend * HORIZON_S : 0.0f);
+  FollowLevel target = FollowLevel::Ok;
+  if (projected >= STOP_COUNTS && st.ewma >= SLOW_COUNTS) {
+    target = FollowLevel::Stop;
+  } else if (projected >= SLOW_COUNTS) {
+    target = FollowLevel::SlowDown;
+  } else if (projected >= WARN_COUNTS) {
+    target = FollowLevel::Warning;
+  }
+
+  if (target > st.level) {
+    st.level = target;
+  } else if (target < st.level) {
+    // Step down one level at a time, once well clear of the current one.
+    const float threshold = (st.level == FollowLevel::SlowDown) ? SLOW_COUNTS : WARN_COUNTS;
+    if (st.ewma < threshold * CLEAR_RATIO) {
+      st.level = (FollowLevel)((uint8_t)st.level - 1);
+    }
+  }
+  return st.level;
+}
+
+/**
+ * Description: Get the worst level over all channels.
+ * Inputs: None.
+ * Outputs: Returns the level.
+ */
+FollowLevel FollowingMonitor::level() const {
+  FollowLevel worst = FollowLevel::Ok;
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    if (_stats[ch].level > worst) worst = _stats[ch].level;
+  }
+  return worst;
+}
@@ -2,22 +2,24 @@
 #include "BoardPins.h"
 #include "Faults.h"
 #include "Log.h"
+#include "Trace.h"
 
 #include <Wire.h>
 #include <SparkFunSX1509.h>
 
 static SX1509 g_sx;
 static bool g_sxReady = false;
-static constexpr uint8_t kLedPinBase = 8;
 
 /**
  * Description: Read and normalize a potentiometer to 0.0-1.0 with end deadbands.
  * Inputs:
  * - pin: analog pin to sample.
+ * - pot: which pot, for the trace.
  * Outputs: Returns normalized value with deadband and rescaled mid-range.
  */
-static float readPotNorm(uint8_t pin) {
+static float readPotNorm(uint8_t pin, TracePot pot) {
   const int adcValue = analogRead(pin);
+  tracePot(pot, (uint16_t)adcValue);
   constexpr float maxValue = 4095.0f;    // 12-bit peak for Teensy 4.1 ADC
   constexpr float edgeDeadband = 0.01f; // 1% gap at each end to guarantee 0/100%
 
@@ -66,7 +68,7 @@ static void initButtons() {
  */
 static void initLeds() {
   for (uint8_t idx = 0; idx < LED_COUNT; idx++) {
-    const uint8_t pin = kLedPinBase + idx;
+    const uint8_t pin = LED_SX_PIN_BASE + idx;
     g_sx.ledDriverInit(pin); // linear, default freq
     // Drive inverted: ULN2803A sinks when input is high, so keep off at max.
     g_sx.analogWrite(pin, 255);
@@ -80,7 +82,7 @@ static void initLeds() {
  * Outputs: Returns the SX1509 pin number.
  */
 static inline uint8_t ledPinForIdx(uint8_t idx) {
-  return kLedPinBase + idx; // LEDs map to SX1509 pins 8..15
+  return LED_SX_PIN_BASE + idx; // LEDs map to SX1509 pins 8..15
 }
 
 /**
@@ -130,8 +132,8 @@ bool Input::begin() {
 InputState Input::poll() {
   InputState state;
   if (!g_sxReady) {
-    state.potSpeedNorm = readPotNorm(PIN_POT_SPEED);
-    state.potAccelNorm = readPotNorm(PIN_POT_ACCEL);
+    state.potSpeedNorm = readPotNorm(PIN_POT_SPEED, TracePot::Speed);
+    state.potAccelNorm = readPotNorm(PIN_POT_ACCEL, TracePot::Accel);
     return state;
   }
 
@@ -149,19 +151,13 @@ InputState Input::poll() {
   //   }
   // }
 
-  // Button order must match _last[] order (8 buttons)
-  std::array<bool, BUTTON_COUNT> buttonStates = {
-    readBtn((uint8_t)SXPin::SX_BUTTON_5),
-    readBtn((uint8_t)SXPin::SX_BUTTON_3),
-    readBtn((uint8_t)SXPin::SX_BUTTON_4),
-    readBtn((uint8_t)SXPin::SX_BUTTON_1),
-    readBtn((uint8_t)SXPin::SX_BUTTON_2),
-    readBtn((uint8_t)SXPin::SX_BUTTON_6),
-    readBtn((uint8_t)SXPin::SX_BUTTON_7),
-    readBtn((uint8_t)SXPin::SX_BUTTON_8),
-  };
-
-
+  std::array<bool, BUTTON_COUNT> buttonStates;
+  uint8_t pressedMask = 0;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    buttonStates[i] = readBtn((uint8_t)BUTTON_SX_PINS[i]);
+    pressedMask |= (uint8_t)((buttonStates[i] ? 1u : 0u) << i);
+  }
+  traceButtons(pressedMask);
 
   for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
     state.isPressed[i]      = buttonStates[i];
@@ -174,8 +170,8 @@ InputState Input::poll() {
   updateLeds();
 
   // Pots
-  state.potSpeedNorm = readPotNorm(PIN_POT_SPEED);
-  state.potAccelNorm = readPotNorm(PIN_POT_ACCEL);
+  state.potSpeedNorm = readPotNorm(PIN_POT_SPEED, TracePot::Speed);
+  state.potAccelNorm = readPotNorm(PIN_POT_ACCEL, TracePot::Accel);
 
   // encoderDelta is filled by App from EncoderJog (not here)
   state.encoderDelta = 0;
@@ -0,0 +1,85 @@
+#include "LinkTuner.h"
+#include "RoboClaw.h"
+#include "Trace.h"
+
+/**
+ * Description: Run a read test on a port at its current baud rate.
+ * Inputs:
+ * - ports: RS422 ports.
+ * - port: port index.
+ * - requests: number of reads.
+ * Outputs: Returns counts and the achieved frame rate (blocks for the test; ends
+ *          after PROBE_REQUESTS when none of them was answered).
+ */
+LinkTestResult LinkTuner::test(Rs422Ports& ports, uint8_t port, uint16_t requests) {
+  LinkTestResult result;
+  Rs422Port& link = ports.port(port);
+  result.baud = link.baud;
+  if (!link.serial) {
+    return result;
+  }
+  const RoboClawCmd cmd = RoboClawCmd::ReadEncoders;
+  const size_t replyLength = RoboClaw::replyBytes(cmd);
+  uint8_t request[RoboClaw::READ_REQUEST_BYTES];
+  RoboClaw::buildRead(request, ROBOCLAW_DEFAULT_ADDRESS, cmd);
+  link.serial->clear();
+
+  const uint32_t startUs = micros();
+  for (uint16_t i = 0; i < requests; i++) {
+    link.serial->write(request, sizeof(request));
+    traceTx(port, request, sizeof(request));
+    uint8_t reply[RoboClaw::MAX_REPLY_BYTES];
+    size_t count = 0;
+    const uint32_t sentUs = micros();
+    while (count < replyLength && (micros() - sentUs) < REPLY_TIMEOUT_US) {
+      if (link.serial->available()) {
+        reply[count++] = (uint8_t)link.serial->read();
+        traceRxByte(port, reply[count - 1]);
+      }
+    }
+    result.requests++;
+    if (count < replyLength) {
+      result.timeouts++;
+      // Let a late reply finish before the next request so it cannot be misread.
+      delayMicroseconds(serialBytesUs(replyLength, link.baud));
+      link.serial->clear();
+    } else if (!RoboClaw::checkReply(ROBOCLAW_DEFAULT_ADDRESS, cmd, reply)) {
+      result.crcErrors++;
+      link.serial->clear();
+    } else {
+      result.good++;
+    }
+    // No controller (or one at another rate): the rest would only time out
+    // too, at REPLY_TIMEOUT_US each.
+    if (result.requests == PROBE_REQUESTS && result.timeouts == result.requests) {
+      break;
+    }
+  }
+  const uint32_t elapsedUs = micros() - startUs;
+  result.framesPerSec = elapsedUs ? (uint32_t)((uint64_t)result.good * 1000000u / elapsedUs) : 0;
+  return result;
+}
+
+/**
+ * Description: Try every candidate rate on a port and keep the fastest reliable one.
+ * Inputs:
+ * - ports: RS422 ports.
+ * - port: port index.
+ * - results: CANDIDATE_COUNT entries, filled per candidate.
+ * Outputs: Returns the chosen baud, or the original rate when no candidate is reliable.
+ */
+uint32_t LinkTuner::tune(Rs422Ports& ports, uint8_t port, LinkTestResult* results) {
+  const uint32_t original = ports.port(port).baud;
+  uint32_t best = 0;
+  for (uint8_t i = 0; i < CANDIDATE_COUNT; i++) {
+    ports.setBaud(port, CANDIDATE_BAUDS[i]);
+    // A controller at another rate gives nothing back, so this ends early.
+    results[i] = test(ports, port);
+    if (reliable(results[i])) {
+      best = CANDIDATE_BAUDS[i];
+    }
+  }
+  const uint32_t chosen = best ? best : original;
+  ports.setBaud(port, chosen);
+  return chosen;
+}
@@ -0,0 +1,273 @@
+#include "Log.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+static constexpr uint32_t LOG_RING_MASK = LOG_RING_RECORDS - 1;
+static constexpr size_t LOG_LINE_BYTES = 256;
+static_assert((LOG_RING_RECORDS & LOG_RING_MASK) == 0, "LOG_RING_RECORDS must be a power of two");
+
+// Records live in DMAMEM (OCRAM) to keep ~40 KB out of DTCM; logInit() clears them.
+DMAMEM static LogRecord s_ring[LOG_RING_RECORDS];
+static std::atomic<uint32_t> s_head{0}; // next record to reserve (producers)
+static std::atomic<uint32_t> s_tail{0}; // next record to format (drain only)
+static std::atomic<uint32_t> s_dropped{0};
+static uint32_t s_records = 0;
+static uint32_t s_maxLagUs = 0;
+static volatile uint8_t s_lane = (uint8_t)ConsoleLane::Log;
+
+static const char* const LEVEL_PREFIX[] = {"", "[I] ", "[D] ", "[V] "};
+
+/**
+ * Description: Initialize the serial logger at the specified baud rate.
+ * Inputs:
+ * - baud: serial baud rate (default 115200).
+ * Outputs: Opens the Serial port, waits briefly for USB and empties the log ring.
+ */
+void logInit(unsigned long baud) {
+  for (uint32_t i = 0; i < LOG_RING_RECORDS; i++) {
+    s_ring[i].ready.store(0, std::memory_order_relaxed);
+  }
+  s_head.store(0);
+  s_tail.store(0);
+  s_dropped.store(0);
+  s_records = 0;
+  s_maxLagUs = 0;
+
+  Serial.begin(baud);
+  // Don’t block forever if USB isn’t connected
+  const uint32_t t0 = millis();
+  while (!Serial && (millis() - t0) < 500) {}
+}
+
+/**
+ * Description: Reserve a ring record for a log call (ISR safe).
+ * Inputs:
+ * - level: log level (1 = I, 2 = D, 3 = V).
+ * - fmt: printf format string (must be a literal).
+ * Outputs: Returns the record to fill, or nullptr (counted as dropped) when the ring is full.
+ */
+LogRecord* logReserve(uint8_t level, const char* fmt) {
+  uint32_t head = s_head.load(std::memory_order_relaxed);
+  do {
+    if (head - s_tail.load(std::memory_order_acquire) >= LOG_RING_RECORDS) {
+      s_dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  } while (!s_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+
+  LogRecord* record = &s_ring[head & LOG_RING_MASK];
+  record->fmt = fmt;
+  record->timeUs = micros();
+  record->level = level;
+  record->lane = s_lane;
+  record->argCount = 0;
+  record->textUsed = 0;
+  return record;
+}
+
+/**
+ * Description: Format one conversion spec with a captured argument.
+ * Inputs:
+ * - out: destination buffer.
+ * - outSize: space left in out.
+ * - spec: NUL-terminated spec ("%-08.3lld" etc.).
+ * - conv: conversion character.
+ * - longs: number of 'l' length modifiers in the spec.
+ * - record: record holding the argument.
+ * - index: argument index.
+ * Outputs: Returns the snprintf result (characters that would have been written).
+ */
+static int formatArg(char* out, size_t outSize, const char* spec, char conv, uint8_t longs,
+                     const LogRecord& record, uint8_t index) {
+  const LogArgType type = record.types[index];
+  const uint64_t raw = record.args[index];
+  double d = 0.0;
+  if (type == LogArgType::Double) {
+    memcpy(&d, &raw, sizeof(d));
+  }
+
+  switch (conv) {
+    case 'd':
+    case 'i':
+    case 'c': {
+      const int64_t v = (type == LogArgType::Double) ? (int64_t)d : (int64_t)raw;
+      if (longs >= 2) return snprintf(out, outSize, spec, (long long)v);
+      if (longs == 1) return snprintf(out, outSize, spec, (long)v);
+      return snprintf(out, outSize, spec, (int)v);
+    }
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o': {
+      const uint64_t v = (type == LogArgType::Double) ? (uint64_t)d : raw;
+      if (longs >= 2) return snprintf(out, outSize, spec, (unsigned long long)v);
+      if (longs == 1) return snprintf(out, outSize, spec, (unsigned long)v);
+      return snprintf(out, outSize, spec, (unsigned)v);
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G': {
+      if (type == LogArgType::Int) d = (double)(int64_t)raw;
+      else if (type == LogArgType::Uint) d = (double)raw;
+      return snprintf(out, outSize, spec, d);
+    }
+    case 's': {
+      const char* text = (type == LogArgType::Text && raw < LOG_TEXT_BYTES)
+                           ? &record.text[raw] : "?";
+      return snprintf(out, outSize, spec, text);
+    }
+    case 'p':
+      return snprintf(out, outSize, spec, (void*)(uintptr_t)raw);
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Description: Expand a record's format string with its captured arguments.
+ * Inputs:
+ * - record: ready record.
+ * - out: destination buffer.
+ * - outSize: size of out.
+ * Outputs: Returns the line length (truncated to the buffer).
+ */
+static size_t formatRecord(const LogRecord& record, char* out, size_t outSize) {
+  size_t len = 0;
+  uint8_t argIndex = 0;
+  auto put = [&](char c) {
+    if (len + 1 < outSize) out[len++] = c;
+  };
+
+  for (const char* p = record.fmt; *p != '\0'; p++) {
+    if (*p != '%') {
+      put(*p);
+      continue;
+    }
+    if (p[1] == '%') {
+      put('%');
+      p++;
+      continue;
+    }
+
+    // Copy the spec, dropping length modifiers (re-applied from the count of 'l').
+    char spec[16];
+    size_t specLen = 0;
+    uint8_t longs = 0;
+    spec[specLen++] = *p++;
+    while (*p != '\0' && strchr("-+ #0123456789.*", *p)) {
+      if (specLen < sizeof(spec) - 4) spec[specLen++] = *p;
+      p++;
+    }
+    while (*p != '\0' && strchr("hlLqjzt", *p)) {
+      if (*p == 'l') longs++;
+      p++;
+    }
+    if (*p == '\0') {
+      break;
+    }
+    const char conv = *p;
+    for (uint8_t i = 0; i < longs && i < 2; i++) spec[specLen++] = 'l';
+    spec[specLen++] = conv;
+    spec[specLen] = '\0';
+
+    if (argIndex >= record.argCount) {
+      put('?');
+      continue;
+    }
+    const int n = formatArg(out + len, outSize - len, spec, conv, longs, record, argIndex++);
+    if (n > 0) {
+      len += ((size_t)n < outSize - len) ? (size_t)n : outSize - len - 1;
+    }
+  }
+  out[len] = '\0';
+  return len;
+}
+
+/**
+ * Description: Format and write queued records (call from idle time).
+ * Inputs:
+ * - maxRecords: upper bound on records written in this call.
+ * Outputs: Returns the number of records queued to the console.
+ */
+uint32_t logDrain(uint32_t maxRecords) {
+  uint32_t written = 0;
+  uint32_t tail = s_tail.load(std::memory_order_relaxed);
+  while (written < maxRecords && tail != s_head.load(std::memory_order_acquire)) {
+    LogRecord& record = s_ring[tail & LOG_RING_MASK];
+    if (!record.ready.load(std::memory_order_acquire)) {
+      break; // reserved but still being filled
+    }
+
+    char line[LOG_LINE_BYTES];
+    const char* prefix = LEVEL_PREFIX[record.level < 4 ? record.level : 0];
+    const size_t prefixLen = strlen(prefix);
+    memcpy(line, prefix, prefixLen);
+    size_t len = prefixLen + formatRecord(record, line + prefixLen, sizeof(line) - prefixLen - 1);
+    line[len++] = '\n';
+    consoleTxWrite((ConsoleLane)record.lane, line, len);
+
+    const uint32_t lagUs = micros() - record.timeUs;
+    if (lagUs > s_maxLagUs) s_maxLagUs = lagUs;
+    s_records++;
+    written++;
+
+    record.ready.store(0, std::memory_order_relaxed);
+    tail++;
+    s_tail.store(tail, std::memory_order_release);
+  }
+  return written;
+}
+
+/**
+ * Description: Format a log line immediately, bypassing the record ring.
+ * Inputs:
+ * - level: log level.
+ * - fmt: printf format string.
+ * - ...: format arguments.
+ * Outputs: Queues the formatted line on the current console lane.
+ */
+void logSync(uint8_t level, const char* fmt, ...) {
+  char line[LOG_LINE_BYTES];
+  const char* prefix = LEVEL_PREFIX[level < 4 ? level : 0];
+  const size_t prefixLen = strlen(prefix);
+  memcpy(line, prefix, prefixLen);
+  va_list args;
+  va_start(args, fmt);
+  const int n = vsnprintf(line + prefixLen, sizeof(line) - prefixLen - 1, fmt, args);
+  va_end(args);
+  size_t len = prefixLen;
+  if (n > 0) {
+    len += ((size_t)n < sizeof(line) - prefixLen - 1) ? (size_t)n : sizeof(line) - prefixLen - 2;
+  }
+  line[len++] = '\n';
+  consoleTxWrite((ConsoleLane)s_lane, line, len);
+}
+
+/**
+ * Description: Select the console lane for lines logged from now on.
+ * Inputs:
+ * - lane: ConsoleLane::Response while a command runs, ConsoleLane::Log otherwise.
+ * Outputs: Tags later records with the lane.
+ */
+void logSetLane(ConsoleLane lane) {
+  s_lane = (uint8_t)lane;
+}
+
+/**
+ * Description: Get logger counters.
+ * Inputs: None.
+ * Outputs: Returns records written, drops, worst lag and the current backlog.
+ */
+LogStats logStats() {
+  LogStats stats;
+  stats.records = s_records;
+  stats.dropped = s_dropped.load(std::memory_order_relaxed);
+  stats.maxLagUs = s_maxLagUs;
+  stats.pending = (uint16_t)(s_head.load(std::memory_order_relaxed) -
+                             s_tail.load(std::memory_order_relaxed));
+  return stats;
+}
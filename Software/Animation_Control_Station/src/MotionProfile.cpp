@@ -0,0 +1,277 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+static constexpr float POS_EPSILON = 1e-3f;     // position tolerance (units)
+static constexpr float VEL_EPSILON = 1e-3f;     // velocity tolerance (units/s)
+static constexpr float HOLD_DURATION_S = 1e9f;  // final hold segment never ends
+static constexpr uint8_t PEAK_SEARCH_STEPS = 24; // bisection steps for peak velocity
+
+/**
+ * Description: Return the sign of a value as +1 or -1.
+ * Inputs:
+ * - value: value to test.
+ * Outputs: Returns -1.0 for negative values, otherwise +1.0.
+ */
+static inline float signOf(float value) {
+  return (value < 0.0f) ? -1.0f : 1.0f;
+}
+
+/**
+ * Description: Reset the profile to a state that may be moving.
+ * Inputs:
+ * - pos: current position.
+ * - vel: current velocity (units per second).
+ * - nowUs: current time in microseconds.
+ * Outputs: Clears the plan and coasts at vel from pos (holds when vel is 0).
+ */
+void MotionProfile::reset(float pos, float vel, uint32_t nowUs) {
+  _target = pos;
+  _t0Us = nowUs;
+  _cursor = 0;
+  _segmentCount = 1;
+  _segments[0] = Segment{0.0f, HOLD_DURATION_S, pos, vel, 0.0f, 0.0f};
+  _planCount = 0;
+}
+
+/**
+ * Description: Plan a move to a new target starting from the current state.
+ * Inputs:
+ * - target: destination position.
+ * - limits: kinematic limits for the move.
+ * - nowUs: current time in microseconds.
+ * Outputs: Replaces the active plan; motion stays continuous.
+ */
+void MotionProfile::moveTo(float target, const MotionLimits& limits, uint32_t nowUs) {
+  const MotionSample current = sample(nowUs);
+  _target = target;
+  _limits = limits;
+  _t0Us = nowUs;
+  plan(current);
+  _planCount++;
+}
+
+/**
+ * Description: Change the limits of the active move without restarting it.
+ * Inputs:
+ * - limits: new kinematic limits.
+ * - nowUs: current time in microseconds.
+ * Outputs: Replans toward the existing target from the current state.
+ */
+void MotionProfile::setLimits(const MotionLimits& limits, uint32_t nowUs) {
+  if (limits.maxVel == _limits.maxVel &&
+      limits.maxAccel == _limits.maxAccel &&
+      limits.maxJerk == _limits.maxJerk) {
+    return;
+  }
+  moveTo(_target, limits, nowUs);
+}
+
+/**
+ * Description: Evaluate the profile at a point in time.
+ * Inputs:
+ * - nowUs: current time in microseconds (monotonic between calls).
+ * Outputs: Returns position, velocity and acceleration.
+ */
+MotionSample MotionProfile::sample(uint32_t nowUs) {
+  MotionSample out;
+  if (_segmentCount == 0) {
+    return out;
+  }
+
+  // Time only moves forward between plans, so the cursor advances at most
+  // MAX_SEGMENTS times over the life of a plan.
+  const float t = (float)(uint32_t)(nowUs - _t0Us) * 1e-6f;
+  while ((uint8_t)(_cursor + 1) < _segmentCount && t >= _segments[_cursor + 1].tStart) {
+    _cursor++;
+  }
+
+  const Segment& seg = _segments[_cursor];
+  float dt = t - seg.tStart;
+  if (dt < 0.0f) dt = 0.0f;
+  if (dt > seg.duration) dt = seg.duration;
+
+  out.acc = seg.a0 + seg.j * dt;
+  out.vel = seg.v0 + (seg.a0 + 0.5f * seg.j * dt) * dt;
+  out.pos = seg.p0 + (seg.v0 + (0.5f * seg.a0 + (1.0f / 6.0f) * seg.j * dt) * dt) * dt;
+  return out;
+}
+
+/**
+ * Description: Check whether the move has reached its target.
+ * Inputs:
+ * - nowUs: current time in microseconds.
+ * Outputs: Returns true once the final hold segment is active.
+ */
+bool MotionProfile::isDone(uint32_t nowUs) const {
+  if (_segmentCount == 0) {
+    return true;
+  }
+  const float t = (float)(uint32_t)(nowUs - _t0Us) * 1e-6f;
+  return t >= _segments[_segmentCount - 1].tStart;
+}
+
+/**
+ * Description: Duration of a ramp between two velocities.
+ * Inputs:
+ * - deltaVel: absolute velocity change.
+ * Outputs: Returns the ramp duration in seconds.
+ */
+float MotionProfile::rampTime(float deltaVel) const {
+  const float accel = _limits.maxAccel;
+  if (_shape == ProfileShape::Trapezoid || _limits.maxJerk <= 0.0f) {
+    return deltaVel / accel;
+  }
+  const float jerk = _limits.maxJerk;
+  if (deltaVel * jerk >= accel * accel) {
+    // Jerk up to full accel, hold it, jerk back down.
+    return deltaVel / accel + accel / jerk;
+  }
+  // Triangular accel: peak accel never reached.
+  return 2.0f * sqrtf(deltaVel / jerk);
+}
+
+/**
+ * Description: Distance travelled while ramping between two velocities.
+ * Inputs:
+ * - vStart: starting velocity (>= 0).
+ * - vEnd: ending velocity (>= 0).
+ * Outputs: Returns the distance covered by the ramp.
+ */
+float MotionProfile::rampDistance(float vStart, float vEnd) const {
+  // Both ramp shapes are symmetric, so the mean velocity is the midpoint.
+  return 0.5f * (vStart + vEnd) * rampTime(fabsf(vEnd - vStart));
+}
+
+/**
+ * Description: Append a constant-jerk segment continuing from the running state.
+ * Inputs:
+ * - state: running state, advanced to the end of the segment.
+ * - duration: segment duration in seconds.
+ * - jerk: constant jerk over the segment.
+ * Outputs: Appends one segment when duration is positive.
+ */
+void MotionProfile::appendSegment(MotionSample& state, float duration, float jerk) {
+  if (duration <= 0.0f || _segmentCount >= MAX_SEGMENTS - 1) {
+    return;
+  }
+  float tStart = 0.0f;
+  if (_segmentCount > 0) {
+    const Segment& prev = _segments[_segmentCount - 1];
+    tStart = prev.tStart + prev.duration;
+  }
+  _segments[_segmentCount++] = Segment{tStart, duration, state.pos, state.vel, state.acc, jerk};
+
+  const float t = duration;
+  state.pos += (state.vel + (0.5f * state.acc + (1.0f / 6.0f) * jerk * t) * t) * t;
+  state.vel += (state.acc + 0.5f * jerk * t) * t;
+  state.acc += jerk * t;
+}
+
+/**
+ * Description: Append the ramp that changes velocity from the running state to vEnd.
+ * Inputs:
+ * - state: running state with zero acceleration.
+ * - vEnd: velocity at the end of the ramp.
+ * Outputs: Appends one (trapezoid) or two/three (S-curve) segments.
+ */
+void MotionProfile::appendVelocityChange(MotionSample& state, float vEnd) {
+  const float deltaVel = fabsf(vEnd - state.vel);
+  if (deltaVel <= VEL_EPSILON) {
+    state.vel = vEnd;
+    return;
+  }
+  const float dir = signOf(vEnd - state.vel);
+  const float accel = _limits.maxAccel;
+
+  if (_shape == ProfileShape::Trapezoid || _limits.maxJerk <= 0.0f) {
+    state.acc = dir * accel;
+    appendSegment(state, deltaVel / accel, 0.0f);
+  } else {
+    const float jerk = _limits.maxJerk;
+    if (deltaVel * jerk >= accel * accel) {
+      const float tJerk = accel / jerk;
+      appendSegment(state, tJerk, dir * jerk);
+      appendSegment(state, deltaVel / accel - tJerk, 0.0f);
+      appendSegment(state, tJerk, -dir * jerk);
+    } else {
+      const float tJerk = sqrtf(deltaVel / jerk);
+      appendSegment(state, tJerk, dir * jerk);
+      appendSegment(state, tJerk, -dir * jerk);
+    }
+  }
+
+  // Snap away rounding so the next ramp starts from an exact state.
+  state.vel = vEnd;
+  state.acc = 0.0f;
+}
+
+/**
+ * Description: Build the segment table from a starting state.
+ * Inputs:
+ * - start: state at the plan origin.
+ * Outputs: Fills _segments and _segmentCount.
+ */
+void MotionProfile::plan(const MotionSample& start) {
+  _segmentCount = 0;
+  _cursor = 0;
+  MotionSample state = start;
+
+  const bool limitsValid = _limits.maxVel > 0.0f && _limits.maxAccel > 0.0f;
+  if (limitsValid) {
+    if (_shape == ProfileShape::Trapezoid || _limits.maxJerk <= 0.0f) {
+      state.acc = 0.0f;
+    } else if (fabsf(state.acc) > 0.0f) {
+      // Replanning mid-ramp: bleed off acceleration first so it stays continuous.
+      appendSegment(state, fabsf(state.acc) / _limits.maxJerk, -signOf(state.acc) * _limits.maxJerk);
+      state.acc = 0.0f;
+    }
+
+    float dist = _target - state.pos;
+    float dir = (fabsf(dist) > POS_EPSILON) ? signOf(dist) : -signOf(state.vel);
+    float velAlong = state.vel * dir;
+
+    // Moving away from the target, or too fast to stop in time: come to rest first.
+    if (velAlong < 0.0f || rampDistance(velAlong, 0.0f) > fabsf(dist) + POS_EPSILON) {
+      appendVelocityChange(state, 0.0f);
+      dist = _target - state.pos;
+      dir = signOf(dist);
+      velAlong = 0.0f;
+    }
+
+    const float distAbs = fabsf(dist);
+    if (distAbs > POS_EPSILON) {
+      // Find the highest peak velocity whose ramps fit in the remaining distance.
+      float peakVel = _limits.maxVel;
+      float rampsDist = rampDistance(velAlong, peakVel) + rampDistance(peakVel, 0.0f);
+      if (rampsDist > distAbs) {
+        float good = velAlong; // ramps fit (stopping distance checked above)
+        float bad = peakVel;
+        for (uint8_t i = 0; i < PEAK_SEARCH_STEPS; i++) {
+          const float mid = 0.5f * (good + bad);
+          if (rampDistance(velAlong, mid) + rampDistance(mid, 0.0f) <= distAbs) {
+            good = mid;
+          } else {
+            bad = mid;
+          }
+        }
+        peakVel = good;
+        rampsDist = rampDistance(velAlong, peakVel) + rampDistance(peakVel, 0.0f);
+      }
+
+      appendVelocityChange(state, dir * peakVel);
+      if (peakVel > VEL_EPSILON) {
+        appendSegment(state, (distAbs - rampsDist) / peakVel, 0.0f);
+      }
+      appendVelocityChange(state, 0.0f);
+    }
+  }
+
+  // Final hold at the exact target (or the current position if limits are unusable).
+  float tStart = 0.0f;
+  if (_segmentCount > 0) {
+    const Segment& prev = _segments[_segmentCount - 1];
+    tStart = prev.tStart + prev.duration;
+  }
+  const float holdPos = limitsValid ? _target : start.pos;
+  _segments[_segmentCount++] = Segment{tStart, HOLD_DURATION_S, holdPos, 0.0f, 0.0f, 0.0f};
+}
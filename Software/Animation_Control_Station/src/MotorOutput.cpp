@@ -0,0 +1,524 @@
+#include "MotorOutput.h"
+#include "Faults.h"
+#include "Trace.h"
+
+static constexpr float OUTPUT_SPEED_MARGIN = 1.25f;  // headroom over the setpoint velocity
+static constexpr uint32_t OUTPUT_MIN_SPEED = 100;    // counts/s, so small corrections still move
+static constexpr uint32_t OUTPUT_DEFAULT_ACCEL = 100000; // counts/s^2 when the channel has no limit
+
+// Read command per TelemetryField.
+static constexpr RoboClawCmd TELEMETRY_COMMANDS[TELEMETRY_FIELD_COUNT] = {
+  RoboClawCmd::ReadEncoders, RoboClawCmd::ReadCurrents, RoboClawCmd::ReadStatus, RoboClawCmd::ReadTemperature};
+
+/**
+ * Description: Add one acknowledged frame.
+ * Inputs:
+ * - residualUs: actual latency minus the lead used.
+ * - latencyUs: actual latency.
+ * - nowUs: current time.
+ * Outputs: Closes the window and updates the maxima once WINDOW_US has passed.
+ */
+void SkewTracker::add(int32_t residualUs, uint32_t latencyUs, uint32_t nowUs) {
+  if (_open && (nowUs - _windowStartUs) >= WINDOW_US) {
+    _lastSkewUs = (uint32_t)(_maxResidual - _minResidual);
+    _lastRawUs = _maxLatency - _minLatency;
+    if (_lastSkewUs > _maxSkewUs) _maxSkewUs = _lastSkewUs;
+    if (_lastRawUs > _maxRawUs) _maxRawUs = _lastRawUs;
+    _open = false;
+  }
+  if (!_open) {
+    _open = true;
+    _windowStartUs = nowUs;
+    _minResidual = _maxResidual = residualUs;
+    _minLatency = _maxLatency = latencyUs;
+    return;
+  }
+  if (residualUs < _minResidual) _minResidual = residualUs;
+  if (residualUs > _maxResidual) _maxResidual = residualUs;
+  if (latencyUs < _minLatency) _minLatency = latencyUs;
+  if (latencyUs > _maxLatency) _maxLatency = latencyUs;
+}
+
+/**
+ * Description: Attach the output stage to the serial ports.
+ * Inputs:
+ * - ports: RS422 ports (already started).
+ * - limits: per-channel motor limits.
+ * Outputs: Resets statistics; output starts disabled.
+ */
+void MotorOutput::begin(Rs422Ports* ports, const ChannelLimits* limits) {
+  _self = this;
+  _ports = ports;
+  _limits = limits;
+  _enabled = false;
+  resetStats();
+
+  // The stop frame never changes, so the trip path only copies bytes.
+  for (uint8_t a = 0; a < STOP_ADDRESS_COUNT; a++) {
+    RoboClaw::buildMixedSpeed(_stopFrame + a * RoboClaw::MIXED_SPEED_FRAME_BYTES, STOP_ADDRESSES[a], 0, 0);
+  }
+}
+
+/**
+ * Description: Clear latency and skew statistics.
+ * Inputs: None.
+ * Outputs: Resets all counters.
+ */
+void MotorOutput::resetStats() {
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    _stats[p] = OutputPortStats{};
+    _state[p] = PortState{};
+    _telemetrySched[p].reset(micros());
+  }
+  _skew.reset();
+  _syncStats = SyncStartStats{};
+  _stopStats.maxWorstUs = 0;
+}
+
+/**
+ * Description: Read acknowledgements and update latency.
+ * Inputs:
+ * - nowUs: current time.
+ * Outputs: Updates per-port latency and skew statistics.
+ */
+void MotorOutput::poll(uint32_t nowUs) {
+  if (_ports && _stopDraining) {
+    bool drained = true;
+    for (uint8_t p = 0; p < RS422_PORT_COUNT && drained; p++) {
+      drained = (_ports->txQueued(p) == 0);
+    }
+    if (drained) {
+      _stopStats.lastDrainedUs = nowUs - _stopTripUs;
+      _stopDraining = false;
+    }
+  }
+  if (!_ports || !_enabled) {
+    return;
+  }
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    Rs422Port& port = _ports->port(p);
+    PortState& st = _state[p];
+    OutputPortStats& stats = _stats[p];
+    while (port.serial && port.serial->available()) {
+      const int b = port.serial->read();
+      traceRxByte(p, (uint8_t)b);
+      if (st.pending == Pending::Telemetry) {
+        receiveTelemetry(p, (uint8_t)b, nowUs);
+        continue;
+      }
+      if (st.pending != Pending::Motion || b != ROBOCLAW_ACK) {
+        continue;
+      }
+      // Round trip minus the ack byte on the wire is when the controller
+      // had the whole frame.
+      const uint32_t rttUs = nowUs - st.sentUs;
+      const uint32_t ackUs = serialBytesUs(1, port.baud);
+      const uint32_t latencyUs = (rttUs > ackUs) ? (rttUs - ackUs) : 0;
+      stats.latency.addSample(latencyUs);
+      stats.acks++;
+      _skew.add((int32_t)latencyUs - (int32_t)st.leadUs, latencyUs, nowUs);
+      st.pending = Pending::None;
+    }
+    if (st.pending != Pending::None && (nowUs - st.sentUs) >= ACK_TIMEOUT_US) {
+      if (st.pending == Pending::Motion) {
+        stats.timeouts++;
+      } else {
+        stats.telemetryTimeouts++;
+      }
+      st.pending = Pending::None;
+    }
+  }
+}
+
+/**
+ * Description: Consume a received byte of a telemetry reply.
+ * Inputs:
+ * - p: port index.
+ * - b: received byte.
+ * - nowUs: current time.
+ * Outputs: Stores the reading once the reply is complete and its CRC matches.
+ */
+void MotorOutput::receiveTelemetry(uint8_t p, uint8_t b, uint32_t nowUs) {
+  PortState& st = _state[p];
+  const RoboClawCmd cmd = TELEMETRY_COMMANDS[(uint8_t)st.field];
+  st.rx[st.rxCount++] = b;
+  if (st.rxCount < RoboClaw::replyBytes(cmd)) {
+    return;
+  }
+  st.pending = Pending::None;
+  if (!RoboClaw::checkReply(ROBOCLAW_DEFAULT_ADDRESS, cmd, st.rx)) {
+    _stats[p].crcErrors++;
+    return;
+  }
+
+  const uint8_t ch1 = (uint8_t)(p * MOTORS_PER_PORT);
+  for (uint8_t m = 0; m < MOTORS_PER_PORT; m++) {
+    ChannelTelemetry& t = _telemetry.beginWrite((uint8_t)(ch1 + m));
+    switch (st.field) {
+      case TelemetryField::Position: t.encoder = (int32_t)RoboClaw::get32(st.rx + 4 * m); break;
+      case TelemetryField::Current: t.currentCa = (int16_t)RoboClaw::get16(st.rx + 2 * m); break;
+      case TelemetryField::Status: t.status = RoboClaw::get32(st.rx); break;
+      case TelemetryField::Temperature: t.tempDeciC = (int16_t)RoboClaw::get16(st.rx); break;
+      default: break;
+    }
+    t.updatedUs[(uint8_t)st.field] = nowUs ? nowUs : 1;
+    _telemetry.endWrite((uint8_t)(ch1 + m));
+  }
+  _telemetrySched[p].completed(st.field);
+}
+
+/**
+ * Description: Push each port's measured latency into the show engine as channel leads.
+ * Inputs:
+ * - show: engine to update (before evaluate()).
+ * Outputs: Sets a lead per channel (0 while disabled).
+ */
+void MotorOutput::applyLeads(ShowEngine& show) const {
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    const uint8_t p = portOf(ch);
+    show.setChannelLeadUs(ch, (_enabled && p < RS422_PORT_COUNT) ? _stats[p].latency.estimateUs() : 0);
+  }
+}
+
+/**
+ * Description: Convert a setpoint into a RoboClaw move.
+ * Inputs:
+ * - channel: channel index.
+ * - sp: setpoint.
+ * Outputs: Returns the move with speed/accel from the setpoint and limits.
+ */
+RoboClawMove MotorOutput::moveFor(uint8_t channel, const ChannelSetpoint& sp) const {
+  RoboClawMove move;
+  move.position = (int32_t)lroundf(sp.pos);
+  float speed = fabsf(sp.vel) * OUTPUT_SPEED_MARGIN;
+  uint32_t accel = OUTPUT_DEFAULT_ACCEL;
+  if (_limits) {
+    const ChannelLimits& lim = _limits[channel];
+    if (lim.maxVel > 0.0f && speed > lim.maxVel) speed = lim.maxVel;
+    if (lim.maxAccel > 0.0f) accel = (uint32_t)lim.maxAccel;
+  }
+  move.speed = ((uint32_t)speed > OUTPUT_MIN_SPEED) ? (uint32_t)speed : OUTPUT_MIN_SPEED;
+  move.accel = accel;
+  move.deccel = accel;
+  return move;
+}
+
+/**
+ * Description: Send frames for ports that are due.
+ * Inputs:
+ * - show: engine with fresh setpoints.
+ * - nowUs: current time.
+ * Outputs: Writes at most one frame per port.
+ */
+void MotorOutput::send(const ShowEngine& show, uint32_t nowUs) {
+  if (!_ports || !_enabled || _syncArmed) {
+    return;
+  }
+  const Show* active = show.show();
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    PortState& st = _state[p];
+    Rs422Port& port = _ports->port(p);
+    if (!port.serial || st.pending != Pending::None) {
+      continue;
+    }
+    const uint8_t ch1 = (uint8_t)(p * MOTORS_PER_PORT);
+    const bool motionActive = active && ch1 < active->channelCount() && !_stopped;
+    if (!motionActive || (nowUs - st.lastFrameUs) < FRAME_PERIOD_US) {
+      sendTelemetry(p, motionActive, nowUs);
+      continue;
+    }
+    const uint8_t ch2 = (uint8_t)(ch1 + 1);
+    const RoboClawMove m1 = moveFor(ch1, show.setpoint(ch1));
+    const RoboClawMove m2 = (ch2 < active->channelCount()) ? moveFor(ch2, show.setpoint(ch2)) : m1;
+
+    uint8_t frame[RoboClaw::MAX_FRAME_BYTES];
+    const size_t len = RoboClaw::buildMixedPosition(frame, ROBOCLAW_DEFAULT_ADDRESS, m1, m2, true);
+    _stats[p].lastQueueUs = serialBytesUs(_ports->txQueued(p), port.baud);
+    // A stop frame must never land in the middle of this one.
+    noInterrupts();
+    if (_stopped) {
+      interrupts();
+      return;
+    }
+    port.serial->write(frame, len);
+    interrupts();
+    traceTx(p, frame, len);
+
+    st.pending = Pending::Motion;
+    st.sentUs = nowUs;
+    st.leadUs = _stats[p].latency.estimateUs();
+    st.lastFrameUs = nowUs;
+    _stats[p].framesSent++;
+    _commanded[ch1] = m1.position;
+    _commandedMask |= (uint16_t)(1u << ch1);
+    if (ch2 < active->channelCount()) {
+      _commanded[ch2] = m2.position;
+      _commandedMask |= (uint16_t)(1u << ch2);
+    }
+    _telemetrySched[p].noteMotion(serialBytesUs(len + 1, port.baud));
+  }
+}
+
+/**
+ * Description: Send the next due telemetry request on an idle port.
+ * Inputs:
+ * - p: port index.
+ * - motionActive: true when the port carries motion frames.
+ * - nowUs: current time.
+ * Outputs: Writes at most one request.
+ */
+void MotorOutput::sendTelemetry(uint8_t p, bool motionActive, uint32_t nowUs) {
+  if (!_telemetryEnabled) {
+    return;
+  }
+  PortState& st = _state[p];
+  Rs422Port& port = _ports->port(p);
+  // Budget every read at the longest reply; never let one delay the next motion frame.
+  const uint32_t costUs = serialBytesUs(RoboClaw::READ_REQUEST_BYTES + RoboClaw::MAX_REPLY_BYTES, port.baud);
+  if (motionActive && (nowUs - st.lastFrameUs) + costUs > FRAME_PERIOD_US) {
+    return;
+  }
+  TelemetryField field;
+  if (!_telemetrySched[p].next(nowUs, costUs, field)) {
+    return;
+  }
+  uint8_t request[RoboClaw::READ_REQUEST_BYTES];
+  const size_t len = RoboClaw::buildRead(request, ROBOCLAW_DEFAULT_ADDRESS, TELEMETRY_COMMANDS[(uint8_t)field]);
+  while (port.serial->available()) {
+    traceRxByte(p, (uint8_t)port.serial->read()); // stale bytes from a timed-out reply
+  }
+  noInterrupts();
+  port.serial->write(request, len);
+  interrupts();
+  traceTx(p, request, len);
+
+  st.pending = Pending::Telemetry;
+  st.field = field;
+  st.rxCount = 0;
+  st.sentUs = nowUs;
+  _stats[p].telemetryRequests++;
+}
+
+/**
+ * Description: Prime every port with its first frame and schedule a common release.
+ * Inputs:
+ * - show: engine positioned at the start point (paused).
+ * - nowUs: current time.
+ * Outputs: Returns false if output is off, no show is attached or a start is already armed.
+ */
+bool MotorOutput::armSyncStart(const ShowEngine& show, uint32_t nowUs) {
+  const Show* active = show.show();
+  if (!_ports || !_enabled || !active || _syncArmed || _stopped) {
+    return false;
+  }
+
+  // First frame: where each channel will be one frame period after the
+  // start, at the speed that gets it there in that period.
+  const float periodS = (float)FRAME_PERIOD_US * 1e-6f;
+  uint32_t holdUs = 0;
+  _syncMask = 0;
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    const uint8_t ch1 = (uint8_t)(p * MOTORS_PER_PORT);
+    Rs422Port& port = _ports->port(p);
+    if (ch1 >= active->channelCount() || !port.serial) {
+      continue;
+    }
+    RoboClawMove moves[MOTORS_PER_PORT];
+    for (uint8_t m = 0; m < MOTORS_PER_PORT; m++) {
+      const uint8_t ch = (ch1 + m < active->channelCount()) ? (uint8_t)(ch1 + m) : ch1;
+      ChannelSetpoint target = show.preview(ch, FRAME_PERIOD_US);
+      target.vel = (target.pos - show.setpoint(ch).pos) / periodS;
+      moves[m] = moveFor(ch, target);
+      _commanded[ch] = moves[m].position;
+      _commandedMask |= (uint16_t)(1u << ch);
+    }
+    uint8_t frame[RoboClaw::MAX_FRAME_BYTES];
+    const size_t len = RoboClaw::buildMixedPosition(frame, ROBOCLAW_DEFAULT_ADDRESS, moves[0], moves[1], true);
+    noInterrupts();
+    if (_stopped) {
+      interrupts();
+      break;
+    }
+    port.serial->write(frame, len - 1);
+    _syncTrigger[p] = frame[len - 1];
+    _syncMask |= (uint8_t)(1u << p);
+    interrupts();
+    traceTx(p, frame, len); // the trigger byte goes out from the release timer
+    _state[p].pending = Pending::None; // acks still in flight belong to the old stream
+
+    const uint32_t drainUs = serialBytesUs(_ports->txQueued(p), port.baud);
+    if (drainUs > holdUs) holdUs = drainUs;
+  }
+  if (_syncMask == 0 || _stopped) {
+    return false;
+  }
+
+  // Release once every port's primed bytes are on the wire, so each
+  // trigger byte starts transmitting the moment it is written.
+  holdUs += SYNC_MARGIN_US;
+  _syncPrimeUs = nowUs;
+  _syncPlannedUs = nowUs + holdUs;
+  _syncFired = false;
+  _syncArmed = true;
+  _syncTimer.begin(syncReleaseIsr, holdUs);
+  return true;
+}
+
+/**
+ * Description: Timer compare ISR: write the held trigger bytes to all primed ports.
+ * Inputs: None (ISR context).
+ * Outputs: Stops the timer and records per-port write cycle counts.
+ */
+void MotorOutput::syncReleaseIsr() {
+  MotorOutput* self = _self;
+  self->_syncTimer.end();
+  if (!self->_syncArmed || self->_syncFired) {
+    return;
+  }
+  const uint32_t first = ARM_DWT_CYCCNT;
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    if (self->_syncMask & (1u << p)) {
+      self->_ports->port(p).serial->write(self->_syncTrigger[p]);
+    }
+  }
+  self->_syncLastCycles = ARM_DWT_CYCCNT;
+  self->_syncFirstCycles = first;
+  self->_syncFiredUs = micros();
+  self->_syncFired = true;
+}
+
+/**
+ * Description: Collect a synchronized start once released.
+ * Inputs:
+ * - releaseUs: receives the release time.
+ * Outputs: Returns true once per release; resumes periodic frames in phase from it.
+ */
+bool MotorOutput::takeSyncRelease(uint32_t& releaseUs) {
+  if (!_syncArmed || !_syncFired) {
+    return false;
+  }
+  releaseUs = _syncFiredUs;
+  const uint32_t cycles = _syncLastCycles - _syncFirstCycles;
+  const uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000u;
+  const int32_t lateUs = (int32_t)(releaseUs - _syncPlannedUs);
+
+  _syncStats.releases++;
+  _syncStats.lastSkewNs = (uint32_t)((uint64_t)cycles * 1000u / (cyclesPerUs ? cyclesPerUs : 1));
+  _syncStats.lastLateUs = (lateUs > 0) ? (uint32_t)lateUs : 0;
+  _syncStats.lastHoldUs = releaseUs - _syncPrimeUs;
+  if (_syncStats.lastSkewNs > _syncStats.maxSkewNs) _syncStats.maxSkewNs = _syncStats.lastSkewNs;
+  if (_syncStats.lastLateUs > _syncStats.maxLateUs) _syncStats.maxLateUs = _syncStats.lastLateUs;
+
+  // The trigger completes each frame: time its ack from here and start the
+  // periodic stream on the same phase for every port.
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    if (!(_syncMask & (1u << p))) {
+      continue;
+    }
+    PortState& st = _state[p];
+    st.pending = Pending::Motion;
+    st.sentUs = releaseUs - serialBytesUs(RoboClaw::MIXED_POSITION_FRAME_BYTES - 1, _ports->port(p).baud);
+    st.leadUs = _stats[p].latency.estimateUs();
+    st.lastFrameUs = releaseUs;
+    _stats[p].framesSent++;
+  }
+  _syncArmed = false;
+  return true;
+}
+
+/**
+ * Description: Attach the hardwired e-stop input (active low) to the stop interrupt.
+ * Inputs:
+ * - pin: GPIO pin.
+ * Outputs: A falling edge calls emergencyStop() from the pin interrupt.
+ */
+void MotorOutput::attachStopInput(uint8_t pin) {
+  _self = this;
+  _stopPin = pin;
+  pinMode(pin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(pin), MotorOutput::stopInputIsr, FALLING);
+  if (digitalReadFast(pin) == LOW) {
+    emergencyStop(StopSource::Input); // loop already open at power up
+  }
+}
+
+/**
+ * Description: E-stop pin interrupt.
+ * Inputs: None (ISR context).
+ * Outputs: Trips the stop.
+ */
+void MotorOutput::stopInputIsr() {
+  if (_self) {
+    _self->emergencyStop(StopSource::Input);
+  }
+}
+
+/**
+ * Description: Stop every motor now (ISR safe).
+ * Inputs:
+ * - source: what tripped the stop.
+ * Outputs: Writes the stop frames, latches the fault and blocks frames until resetStop().
+ */
+void MotorOutput::emergencyStop(StopSource source) {
+  if (!_ports) {
+    return;
+  }
+  const uint32_t entryCycles = ARM_DWT_CYCCNT;
+  const uint32_t entryUs = micros();
+  noInterrupts();
+  if (_stopped) {
+    interrupts();
+    return;
+  }
+  _stopped = true;
+
+  // A primed sync frame is waiting for its CRC byte; a wrong one makes the
+  // controller drop it instead of reading the stop frame as its tail.
+  const bool syncHeld = _syncArmed && !_syncFired;
+  if (_syncArmed) {
+    _syncTimer.end();
+    _syncArmed = false;
+  }
+  uint32_t worstUs = 0;
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    Rs422Port& port = _ports->port(p);
+    if (!port.serial) {
+      continue;
+    }
+    if (syncHeld && (_syncMask & (1u << p))) {
+      port.serial->write((uint8_t)(_syncTrigger[p] ^ 0xFF));
+    }
+    port.serial->write(_stopFrame, STOP_BYTES);
+    _state[p].pending = Pending::None;
+    const uint32_t lastByteUs = serialBytesUs(_ports->txQueued(p), port.baud);
+    if (lastByteUs > worstUs) worstUs = lastByteUs;
+  }
+  interrupts();
+  FAULT_SET(FAULT_ESTOP_FAULT);
+
+  const uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000u;
+  const uint32_t isrNs = (uint32_t)((uint64_t)(ARM_DWT_CYCCNT - entryCycles) * 1000u / (cyclesPerUs ? cyclesPerUs : 1));
+  _stopStats.trips++;
+  _stopStats.lastSource = source;
+  _stopStats.lastIsrNs = isrNs;
+  _stopStats.lastWorstUs = isrNs / 1000u + worstUs;
+  if (_stopStats.lastWorstUs > _stopStats.maxWorstUs) _stopStats.maxWorstUs = _stopStats.lastWorstUs;
+  _stopTripUs = entryUs;
+  _stopDraining = true;
+}
+
+/**
+ * Description: Clear a latched stop.
+ * Inputs: None.
+ * Outputs: Returns false (still latched) while the e-stop input is asserted.
+ */
+bool MotorOutput::resetStop() {
+  if (_stopPin != 255 && digitalReadFast(_stopPin) == LOW) {
+    return false;
+  }
+  noInterrupts();
+  _stopped = false;
+  interrupts();
+  FAULT_CLEAR(FAULT_ESTOP_FAULT);
+  return true;
+}
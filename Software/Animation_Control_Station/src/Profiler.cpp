@@ -0,0 +1,32 @@
+#include "Profiler.h"
+
+static const char* const PROBE_NAMES[] = {
+  "loop",
+  "console",
+  "input",
+  "rs422test",
+  "jog",
+  "show",
+  "motors",
+  "evaluate",
+  "send",
+  "flight",
+  "ui",
+  "cues",
+  "slots",
+  "config",
+  "log",
+  "trace",
+};
+static_assert(sizeof(PROBE_NAMES) / sizeof(PROBE_NAMES[0]) == (size_t)ProbeId::Count,
+              "PROBE_NAMES must match ProbeId");
+
+/**
+ * Description: Get a probe's printable name.
+ * Inputs:
+ * - id: probe.
+ * Outputs: Returns a short lowercase name.
+ */
+const char* profileName(ProbeId id) {
+  return ((uint8_t)id < (uint8_t)ProbeId::Count) ? PROBE_NAMES[(uint8_t)id] : "?";
+}
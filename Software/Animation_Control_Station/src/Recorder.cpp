@@ -0,0 +1,233 @@
+#include "Recorder.h"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Scratch storage for the take being recorded; finished takes are copied
+// into exactly sized buffers so several channels can hold overdubs.
+DMAMEM static TrackKey s_scratchKeys[Recorder::SCRATCH_KEYS];
+DMAMEM static TrackCheckpoint s_scratchCheckpoints[(Recorder::SCRATCH_KEYS + TRACK_CHECKPOINT_INTERVAL - 1) / TRACK_CHECKPOINT_INTERVAL];
+
+static constexpr float SLOPE_OPEN = 3.0e38f;
+
+/**
+ * Description: Punch in on a channel.
+ * Inputs:
+ * - channel: channel to record.
+ * - original: current track for the channel (may be nullptr or empty).
+ * - startMs: show time of the punch-in.
+ * - tolerance: maximum deviation of the recorded track from the input (units).
+ * Outputs: Returns false for an invalid channel or if already recording.
+ */
+bool Recorder::start(uint8_t channel, const Track* original, uint32_t startMs, float tolerance) {
+  if (_recording || channel >= SHOW_MAX_CHANNELS) {
+    return false;
+  }
+  _builder.begin(s_scratchKeys, SCRATCH_KEYS, s_scratchCheckpoints,
+                 sizeof(s_scratchCheckpoints) / sizeof(s_scratchCheckpoints[0]));
+  _original = original;
+  _channel = channel;
+  _stats = RecordStats{};
+  _stats.tolerance = tolerance;
+  // Keys are whole units, so leave room for rounding inside the tolerance.
+  _door = (tolerance > 0.5f) ? (tolerance - 0.5f) : 0.0f;
+  _haveAnchor = false;
+  _segCount = 0;
+
+  // Keep the original keys before the punch-in.
+  if (_original && _original->keyCount() > 0) {
+    TrackCursor cursor;
+    _original->seek(cursor, 0);
+    do {
+      if (cursor.t0 >= startMs) break;
+      emitKey(cursor.t0, cursor.v0, (Ease)cursor.ease);
+    } while (_original->step(cursor));
+  }
+  _recording = true;
+  return true;
+}
+
+/**
+ * Description: Feed one input sample.
+ * Inputs:
+ * - tMs: show time; repeated milliseconds are ignored.
+ * - value: live input value.
+ * Outputs: Extends the current segment or emits a key.
+ */
+void Recorder::sample(uint32_t tMs, float value) {
+  if (!_recording || _stats.overflow) {
+    return;
+  }
+  if (!_haveAnchor) {
+    if (_builder.keyCount() > 0 && tMs < _builder.lastTimeMs()) {
+      return;
+    }
+    _anchorT = tMs;
+    _anchorV = (int32_t)lroundf(value);
+    emitKey(_anchorT, _anchorV, Ease::Linear);
+    _haveAnchor = true;
+    _slopeLo = -SLOPE_OPEN;
+    _slopeHi = SLOPE_OPEN;
+    _lastT = tMs;
+    _lastV = value;
+    _stats.samples++;
+    return;
+  }
+  if (tMs <= _lastT) {
+    return;
+  }
+  _stats.samples++;
+
+  float dt = (float)(tMs - _anchorT);
+  float hi = (value + _door - (float)_anchorV) / dt;
+  float lo = (value - _door - (float)_anchorV) / dt;
+  const float newHi = (hi < _slopeHi) ? hi : _slopeHi;
+  const float newLo = (lo > _slopeLo) ? lo : _slopeLo;
+
+  if (newLo > newHi || _segCount >= SEGMENT_MAX_SAMPLES) {
+    // The door closed: end the segment at the previous sample and reopen
+    // from there with this sample.
+    closeSegment();
+    dt = (float)(tMs - _anchorT);
+    _slopeHi = (value + _door - (float)_anchorV) / dt;
+    _slopeLo = (value - _door - (float)_anchorV) / dt;
+  } else {
+    _slopeHi = newHi;
+    _slopeLo = newLo;
+  }
+
+  _segT[_segCount] = tMs;
+  _segV[_segCount] = value;
+  _segCount++;
+  _lastT = tMs;
+  _lastV = value;
+}
+
+/**
+ * Description: Close the current segment at the last sample.
+ * Inputs: None.
+ * Outputs: Emits one key and starts a new segment from it.
+ */
+void Recorder::closeSegment() {
+  if (_segCount == 0) {
+    return;
+  }
+  const float span = (float)(_lastT - _anchorT);
+  float slope = (_lastV - (float)_anchorV) / span;
+  if (slope > _slopeHi) slope = _slopeHi;
+  if (slope < _slopeLo) slope = _slopeLo;
+  const int32_t endV = (int32_t)lroundf((float)_anchorV + slope * span);
+
+  // Measure the real error of the emitted line over the segment's samples.
+  const float rise = (float)(endV - _anchorV);
+  for (uint16_t i = 0; i < _segCount; i++) {
+    const float line = (float)_anchorV + rise * (float)(_segT[i] - _anchorT) / span;
+    const float err = fabsf(_segV[i] - line);
+    if (err > _stats.maxError) _stats.maxError = err;
+  }
+
+  emitKey(_lastT, endV, Ease::Linear);
+  _anchorT = _lastT;
+  _anchorV = endV;
+  _slopeLo = -SLOPE_OPEN;
+  _slopeHi = SLOPE_OPEN;
+  _segCount = 0;
+}
+
+/**
+ * Description: Append a key to the scratch track.
+ * Inputs:
+ * - tMs: key time.
+ * - value: key value.
+ * - ease: interpolation toward the next key.
+ * Outputs: Flags overflow when scratch storage is full.
+ */
+void Recorder::emitKey(uint32_t tMs, int32_t value, Ease ease) {
+  if (!_builder.append(tMs, value, ease)) {
+    _stats.overflow = true;
+    return;
+  }
+  if (_recording) {
+    _stats.keys++;
+  }
+}
+
+/**
+ * Description: Punch out and publish the recorded take for the channel.
+ * Inputs: None.
+ * Outputs: Returns true when the take was stored.
+ */
+bool Recorder::stop() {
+  if (!_recording) {
+    return false;
+  }
+  closeSegment();
+  _recording = false;
+
+  // Keep the original keys after the punch-out.
+  if (_original && _original->keyCount() > 0 && _haveAnchor) {
+    TrackCursor cursor;
+    _original->seek(cursor, _lastT);
+    while (cursor.t0 <= _lastT && _original->step(cursor)) {
+    }
+    if (cursor.t0 > _lastT) {
+      do {
+        emitKey(cursor.t0, cursor.v0, (Ease)cursor.ease);
+      } while (_original->step(cursor));
+    }
+  }
+  if (_stats.overflow || _builder.keyCount() == 0) {
+    return false;
+  }
+
+  // Copy into exactly sized storage so the scratch buffer can be reused.
+  const uint32_t keyCount = _builder.keyCount();
+  const uint32_t checkpointCount = _builder.checkpointCount();
+  TrackKey* keys = (TrackKey*)malloc(keyCount * sizeof(TrackKey));
+  TrackCheckpoint* checkpoints = (TrackCheckpoint*)malloc(checkpointCount * sizeof(TrackCheckpoint));
+  if (!keys || !checkpoints) {
+    free(keys);
+    free(checkpoints);
+    return false;
+  }
+  memcpy(keys, _builder.keys(), keyCount * sizeof(TrackKey));
+  memcpy(checkpoints, _builder.checkpoints(), checkpointCount * sizeof(TrackCheckpoint));
+
+  discard(_channel);
+  Take& take = _takes[_channel];
+  take.keys = keys;
+  take.checkpoints = checkpoints;
+  take.track.attach(keys, keyCount, checkpoints, checkpointCount);
+  return true;
+}
+
+/**
+ * Description: Get the finished take for a channel.
+ * Inputs:
+ * - channel: channel index.
+ * Outputs: Returns the track, or nullptr when there is no take.
+ */
+const Track* Recorder::take(uint8_t channel) const {
+  if (channel >= SHOW_MAX_CHANNELS || !_takes[channel].keys) {
+    return nullptr;
+  }
+  return &_takes[channel].track;
+}
+
+/**
+ * Description: Free a channel's take.
+ * Inputs:
+ * - channel: channel index; detach it from the engine first.
+ * Outputs: Releases the take's storage.
+ */
+void Recorder::discard(uint8_t channel) {
+  if (channel >= SHOW_MAX_CHANNELS) {
+    return;
+  }
+  Take& take = _takes[channel];
+  take.track.clear();
+  free(take.keys);
+  free(take.checkpoints);
+  take.keys = nullptr;
+  take.checkpoints = nullptr;
+}
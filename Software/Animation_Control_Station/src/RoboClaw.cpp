@@ -0,0 +1,140 @@
+#include "RoboClaw.h"
+
+/**
+ * Description: Append a big-endian 32-bit value.
+ * Inputs:
+ * - out: write position, advanced past the value.
+ * - value: value to write.
+ * Outputs: None.
+ */
+static inline void put32(uint8_t*& out, uint32_t value) {
+  *out++ = (uint8_t)(value >> 24);
+  *out++ = (uint8_t)(value >> 16);
+  *out++ = (uint8_t)(value >> 8);
+  *out++ = (uint8_t)value;
+}
+
+/**
+ * Description: Append the CRC of everything written so far.
+ * Inputs:
+ * - start: frame start.
+ * - out: write position, advanced past the CRC.
+ * Outputs: Returns the frame length.
+ */
+static inline size_t finishFrame(uint8_t* start, uint8_t*& out) {
+  const uint16_t crc = RoboClaw::crc16(start, (size_t)(out - start));
+  *out++ = (uint8_t)(crc >> 8);
+  *out++ = (uint8_t)crc;
+  return (size_t)(out - start);
+}
+
+/**
+ * Description: CRC16 (CCITT, polynomial 0x1021) used by packet serial.
+ * Inputs:
+ * - data: bytes to check.
+ * - length: number of bytes.
+ * - crc: running CRC (0 to start).
+ * Outputs: Returns the updated CRC.
+ */
+uint16_t RoboClaw::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * Description: Build a two-motor position command (command 67).
+ * Inputs:
+ * - out: frame buffer (MIXED_POSITION_FRAME_BYTES).
+ * - address: controller address (0x80..0x87).
+ * - m1: motor 1 move.
+ * - m2: motor 2 move.
+ * - immediate: true to replace any running move, false to queue behind it.
+ * Outputs: Returns the frame length.
+ */
+size_t RoboClaw::buildMixedPosition(uint8_t* out, uint8_t address,
+                                    const RoboClawMove& m1, const RoboClawMove& m2, bool immediate) {
+  uint8_t* p = out;
+  *p++ = address;
+  *p++ = (uint8_t)RoboClawCmd::MixedSpeedAccelDeccelPosition;
+  put32(p, m1.accel);
+  put32(p, m1.speed);
+  put32(p, m1.deccel);
+  put32(p, (uint32_t)m1.position);
+  put32(p, m2.accel);
+  put32(p, m2.speed);
+  put32(p, m2.deccel);
+  put32(p, (uint32_t)m2.position);
+  *p++ = immediate ? 1 : 0;
+  return finishFrame(out, p);
+}
+
+/**
+ * Description: Build a two-motor speed command (command 37).
+ * Inputs:
+ * - out: frame buffer (MIXED_SPEED_FRAME_BYTES).
+ * - address: controller address.
+ * - speed1: motor 1 signed speed (counts/s).
+ * - speed2: motor 2 signed speed (counts/s).
+ * Outputs: Returns the frame length.
+ */
+size_t RoboClaw::buildMixedSpeed(uint8_t* out, uint8_t address, int32_t speed1, int32_t speed2) {
+  uint8_t* p = out;
+  *p++ = address;
+  *p++ = (uint8_t)RoboClawCmd::MixedSpeed;
+  put32(p, (uint32_t)speed1);
+  put32(p, (uint32_t)speed2);
+  return finishFrame(out, p);
+}
+
+/**
+ * Description: Build a read request.
+ * Inputs:
+ * - out: frame buffer (READ_REQUEST_BYTES).
+ * - address: controller address.
+ * - command: one of the Read* commands.
+ * Outputs: Returns the request length.
+ */
+size_t RoboClaw::buildRead(uint8_t* out, uint8_t address, RoboClawCmd command) {
+  out[0] = address;
+  out[1] = (uint8_t)command;
+  return READ_REQUEST_BYTES;
+}
+
+/**
+ * Description: Get the reply length of a read command.
+ * Inputs:
+ * - command: one of the Read* commands.
+ * Outputs: Returns data plus CRC bytes (0 for non-read commands).
+ */
+size_t RoboClaw::replyBytes(RoboClawCmd command) {
+  switch (command) {
+    case RoboClawCmd::ReadEncoders: return 8 + 2;
+    case RoboClawCmd::ReadCurrents: return 4 + 2;
+    case RoboClawCmd::ReadTemperature: return 2 + 2;
+    case RoboClawCmd::ReadStatus: return 4 + 2;
+    default: return 0;
+  }
+}
+
+/**
+ * Description: Check a read reply's CRC.
+ * Inputs:
+ * - address: controller address the request went to.
+ * - command: read command.
+ * - reply: received bytes (replyBytes(command) long).
+ * Outputs: Returns true when the CRC matches.
+ */
+bool RoboClaw::checkReply(uint8_t address, RoboClawCmd command, const uint8_t* reply) {
+  const size_t length = replyBytes(command);
+  if (length < 2) {
+    return false;
+  }
+  const uint8_t header[2] = {address, (uint8_t)command};
+  const uint16_t crc = crc16(reply, length - 2, crc16(header, sizeof(header)));
+  return get16(reply + length - 2) == crc;
+}
@@ -27,8 +27,44 @@ static HardwareSerial* pickSerialForIndex(uint8_t portIndex) {
  * Outputs: Initializes serial ports and stores handles.
  */
 void Rs422Ports::begin(unsigned long baud) {
-  for (uint8_t i = 0; i < 8; i++) {
+  uint32_t bauds[RS422_PORT_COUNT];
+  for (uint8_t i = 0; i < RS422_PORT_COUNT; i++) {
+    bauds[i] = (uint32_t)baud;
+  }
+  begin(bauds);
+}
+
+/**
+ * Description: Initialize all RS422 ports, each at its own baud rate.
+ * Inputs:
+ * - bauds: RS422_PORT_COUNT baud rates.
+ * Outputs: Initializes serial ports and stores handles.
+ */
+void Rs422Ports::begin(const uint32_t* bauds) {
+  DMAMEM static uint8_t txExtra[RS422_PORT_COUNT][RS422_TX_EXTRA_BYTES];
+  for (uint8_t i = 0; i < RS422_PORT_COUNT; i++) {
     _ports[i].serial = pickSerialForIndex(i);
-    _ports[i].serial->begin(baud);
+    _ports[i].serial->begin(bauds[i]);
+    _ports[i].serial->addMemoryForWrite(txExtra[i], sizeof(txExtra[i]));
+    _ports[i].baud = bauds[i];
+    _ports[i].idleWriteSpace = _ports[i].serial->availableForWrite();
+  }
+}
+
+/**
+ * Description: Change one port's baud rate.
+ * Inputs:
+ * - portIndex: port index [0..7].
+ * - baud: new baud rate.
+ * Outputs: Waits for queued TX to finish, then reopens the port at the new rate.
+ */
+void Rs422Ports::setBaud(uint8_t portIndex, uint32_t baud) {
+  Rs422Port& p = _ports[portIndex];
+  if (!p.serial || p.baud == baud) {
+    return;
   }
+  p.serial->flush();
+  p.serial->begin(baud);
+  p.serial->clear();
+  p.baud = baud;
 }
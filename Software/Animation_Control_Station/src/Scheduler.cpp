@@ -0,0 +1,204 @@
+#include "Scheduler.h"
+
+/**
+ * Description: Set the clock and drop all tasks.
+ * Inputs:
+ * - clock: microsecond clock (micros() on the Teensy, a virtual clock on the host).
+ * Outputs: Scheduler is empty and ready for addTask()/addBackground().
+ */
+void Scheduler::begin(SchedulerClock clock) {
+  _clock = clock;
+  _count = 0;
+  _statsStartUs = _clock();
+}
+
+/**
+ * Description: Insert a task keeping the table in priority order.
+ * Inputs:
+ * - task: filled-in task.
+ * Outputs: Returns false if the table is full.
+ */
+bool Scheduler::insert(const SchedulerTask& task) {
+  if (_count >= MAX_TASKS) {
+    return false;
+  }
+  // Periodic tasks by priority, then background jobs in registration order.
+  uint8_t at = _count;
+  while (at > 0) {
+    const SchedulerTask& prev = _tasks[at - 1];
+    const bool after = task.periodUs != 0 &&
+                       (prev.periodUs == 0 || prev.priority > task.priority);
+    if (!after) {
+      break;
+    }
+    _tasks[at] = prev;
+    at--;
+  }
+  _tasks[at] = task;
+  _count++;
+  return true;
+}
+
+/**
+ * Description: Register a periodic task.
+ * Inputs:
+ * - name: label for the "tasks" command (not copied).
+ * - fn: task body.
+ * - context: passed to fn.
+ * - periodUs: release period (> 0); the first release is now.
+ * - priority: 0 runs first; equal priorities run in registration order.
+ * - budgetUs: expected worst run time.
+ * Outputs: Returns false if the table is full or the period is 0.
+ */
+bool Scheduler::addTask(const char* name, TaskFn fn, void* context, uint32_t periodUs, uint8_t priority, uint32_t budgetUs) {
+  if (periodUs == 0) {
+    return false;
+  }
+  SchedulerTask task;
+  task.name = name;
+  task.fn = fn;
+  task.context = context;
+  task.periodUs = periodUs;
+  task.budgetUs = budgetUs;
+  task.priority = priority;
+  task.releaseUs = _clock();
+  return insert(task);
+}
+
+/**
+ * Description: Register a background job that runs in idle time.
+ * Inputs:
+ * - name: label for the "tasks" command (not copied).
+ * - fn: job body (should do a bounded slice of work per call).
+ * - context: passed to fn.
+ * - budgetUs: idle time the job needs before it is started.
+ * - maxWaitUs: run regardless of idle time after waiting this long.
+ * Outputs: Returns false if the table is full.
+ */
+bool Scheduler::addBackground(const char* name, TaskFn fn, void* context, uint32_t budgetUs, uint32_t maxWaitUs) {
+  SchedulerTask task;
+  task.name = name;
+  task.fn = fn;
+  task.context = context;
+  task.budgetUs = budgetUs;
+  task.maxWaitUs = maxWaitUs;
+  task.releaseUs = _clock();
+  return insert(task);
+}
+
+/**
+ * Description: Run one task and fold the run into its statistics.
+ * Inputs:
+ * - task: task to run.
+ * - startUs: clock at the start of the run.
+ * Outputs: Returns the clock at the end of the run.
+ */
+uint32_t Scheduler::run(SchedulerTask& task, uint32_t startUs) {
+  _runStartUs = startUs;
+  task.fn(task.context);
+  const uint32_t endUs = _clock();
+  const uint32_t runUs = endUs - startUs;
+  TaskStats& s = task.stats;
+  s.runs++;
+  s.totalRunUs += runUs;
+  if (runUs > s.maxRunUs) s.maxRunUs = runUs;
+  if (runUs > task.budgetUs) s.overruns++;
+  return endUs;
+}
+
+/**
+ * Description: Get the time until the next periodic release.
+ * Inputs:
+ * - nowUs: current clock.
+ * Outputs: Returns microseconds of idle time (0 if a task is due).
+ */
+uint32_t Scheduler::slackUs(uint32_t nowUs) const {
+  uint32_t slack = 0xFFFFFFFFu;
+  for (uint8_t i = 0; i < _count && _tasks[i].periodUs != 0; i++) {
+    const int32_t untilUs = (int32_t)(_tasks[i].releaseUs - nowUs);
+    if (untilUs <= 0) {
+      return 0;
+    }
+    if ((uint32_t)untilUs < slack) slack = (uint32_t)untilUs;
+  }
+  return slack;
+}
+
+/**
+ * Description: Run every due task in priority order, then background jobs that fit (call from loop()).
+ * Inputs: None.
+ * Outputs: Updates per-task statistics and releases.
+ */
+void Scheduler::runOnce() {
+  uint32_t nowUs = _clock();
+
+  // Always the highest-priority due task next, so a task released while a
+  // lower one ran still goes first. Bounded so a pass always returns.
+  for (uint8_t pass = 0; pass < _count; pass++) {
+    SchedulerTask* next = nullptr;
+    for (uint8_t i = 0; i < _count && _tasks[i].periodUs != 0; i++) {
+      if ((int32_t)(nowUs - _tasks[i].releaseUs) >= 0) {
+        next = &_tasks[i];
+        break;
+      }
+    }
+    if (!next) {
+      break;
+    }
+    if (_runHook) {
+      _runHook(*next, (uint8_t)(next - _tasks), nowUs, _runHookContext);
+    }
+    TaskStats& s = next->stats;
+    const uint32_t lateUs = nowUs - next->releaseUs;
+    if (lateUs > s.maxLateUs) s.maxLateUs = lateUs;
+    nowUs = run(*next, nowUs);
+
+    // Deadline is the next release. Keep the phase, but drop whole
+    // periods instead of running a burst of catch-up passes.
+    next->releaseUs += next->periodUs;
+    if ((int32_t)(nowUs - next->releaseUs) > 0) {
+      s.misses++;
+      const uint32_t behindUs = nowUs - next->releaseUs;
+      if (behindUs >= next->periodUs) {
+        const uint32_t periods = behindUs / next->periodUs;
+        s.skipped += periods;
+        next->releaseUs += periods * next->periodUs;
+      }
+    }
+  }
+
+  // Background jobs get what is left before the next release.
+  for (uint8_t i = 0; i < _count; i++) {
+    SchedulerTask& job = _tasks[i];
+    if (job.periodUs != 0) {
+      continue;
+    }
+    const uint32_t waitedUs = nowUs - job.releaseUs;
+    const bool starved = waitedUs >= job.maxWaitUs;
+    if (!starved && slackUs(nowUs) < job.budgetUs) {
+      continue;
+    }
+    if (_runHook && !_runHook(job, i, nowUs, _runHookContext)) {
+      continue;
+    }
+    if (starved) {
+      job.stats.misses++;
+      const uint32_t lateUs = waitedUs - job.maxWaitUs;
+      if (lateUs > job.stats.maxLateUs) job.stats.maxLateUs = lateUs;
+    }
+    job.releaseUs = nowUs;
+    nowUs = run(job, nowUs);
+  }
+}
+
+/**
+ * Description: Clear every task's statistics.
+ * Inputs: None.
+ * Outputs: Counters restart; releases are unchanged.
+ */
+void Scheduler::resetStats() {
+  for (uint8_t i = 0; i < _count; i++) {
+    _tasks[i].stats = TaskStats{};
+  }
+  _statsStartUs = _clock();
+}
@@ -0,0 +1,227 @@
+#include "Show.h"
+
+/**
+ * Description: Check that a section lies inside the image and is aligned.
+ * Inputs:
+ * - offset: section offset in bytes.
+ * - count: number of elements.
+ * - elementSize: element size in bytes.
+ * - length: image size in bytes.
+ * Outputs: Returns true when the section is usable.
+ */
+static bool sectionValid(uint32_t offset, uint32_t count, size_t elementSize, size_t length) {
+  if ((offset & 3u) != 0) return false;
+  if (offset > length) return false;
+  return (uint64_t)count * elementSize <= (uint64_t)(length - offset);
+}
+
+/**
+ * Description: Parse a binary show image in place.
+ * Inputs:
+ * - image: show image bytes, 4-byte aligned, kept alive while loaded.
+ * - length: image size in bytes.
+ * Outputs: Returns true when the image is valid and all tracks attached.
+ */
+bool Show::load(const uint8_t* image, size_t length) {
+  if (!beginLoad(image, length)) {
+    return false;
+  }
+  ShowStep step = ShowStep::Busy;
+  while (step == ShowStep::Busy) {
+    step = loadStep();
+  }
+  return step == ShowStep::Done;
+}
+
+/**
+ * Description: Start a load that loadStep() finishes in bounded steps.
+ * Inputs:
+ * - image: show image bytes, 4-byte aligned, kept alive while loaded.
+ * - length: image size in bytes.
+ * Outputs: Returns false when the header or section table is invalid.
+ */
+bool Show::beginLoad(const uint8_t* image, size_t length) {
+  clear();
+  if (!image || ((uintptr_t)image & 3u) != 0 || length < sizeof(ShowFileHeader)) {
+    return false;
+  }
+
+  const ShowFileHeader* header = reinterpret_cast<const ShowFileHeader*>(image);
+  if (header->magic != SHOW_MAGIC || header->version != SHOW_FORMAT_VERSION ||
+      header->channelCount > SHOW_MAX_CHANNELS) {
+    return false;
+  }
+  if (!sectionValid(sizeof(ShowFileHeader), header->channelCount, sizeof(ShowTrackEntry), length)) {
+    return false;
+  }
+  const ShowTrackEntry* entries = reinterpret_cast<const ShowTrackEntry*>(image + sizeof(ShowFileHeader));
+  for (uint8_t ch = 0; ch < header->channelCount; ch++) {
+    const ShowTrackEntry& entry = entries[ch];
+    if (!sectionValid(entry.checkpointOffset, entry.checkpointCount, sizeof(TrackCheckpoint), length) ||
+        !sectionValid(entry.keyOffset, entry.keyCount, sizeof(TrackKey), length)) {
+      return false;
+    }
+  }
+  if (!sectionValid(header->eventOffset, header->eventCount, sizeof(ShowEvent), length)) {
+    return false;
+  }
+
+  _stepHeader = header;
+  _stepImage = image;
+  _stepChannel = 0;
+  _stepEvent = 1;
+  return true;
+}
+
+/**
+ * Description: Validate one channel, or up to LOAD_EVENTS_PER_STEP events, of a load begun by beginLoad().
+ * Inputs: None.
+ * Outputs: Returns Done once the show is loaded, Failed (show cleared) on an invalid image.
+ */
+ShowStep Show::loadStep() {
+  if (_loaded) {
+    return ShowStep::Done;
+  }
+  if (!_stepHeader) {
+    return ShowStep::Failed;
+  }
+  const ShowFileHeader* header = _stepHeader;
+
+  // Tracks first, one per step: attach() checks the checkpoint index.
+  if (_stepChannel < header->channelCount) {
+    const ShowTrackEntry& entry =
+      reinterpret_cast<const ShowTrackEntry*>(_stepImage + sizeof(ShowFileHeader))[_stepChannel];
+    const TrackKey* keys = reinterpret_cast<const TrackKey*>(_stepImage + entry.keyOffset);
+    const TrackCheckpoint* checkpoints = reinterpret_cast<const TrackCheckpoint*>(_stepImage + entry.checkpointOffset);
+    if (!_tracks[_stepChannel].attach(keys, entry.keyCount, checkpoints, entry.checkpointCount)) {
+      clear();
+      return ShowStep::Failed;
+    }
+    _stepChannel++;
+    return ShowStep::Busy;
+  }
+
+  // Then the event order, a bounded run at a time.
+  const ShowEvent* events = reinterpret_cast<const ShowEvent*>(_stepImage + header->eventOffset);
+  uint32_t end = _stepEvent + LOAD_EVENTS_PER_STEP;
+  if (end > header->eventCount) end = header->eventCount;
+  for (; _stepEvent < end; _stepEvent++) {
+    if (events[_stepEvent].timeMs < events[_stepEvent - 1].timeMs) {
+      clear();
+      return ShowStep::Failed;
+    }
+  }
+  if (_stepEvent < header->eventCount) {
+    return ShowStep::Busy;
+  }
+
+  _events = (header->eventCount > 0) ? events : nullptr;
+  _eventCount = header->eventCount;
+  _channelCount = header->channelCount;
+  _durationMs = header->durationMs;
+  _stepHeader = nullptr;
+  _loaded = true;
+  return ShowStep::Done;
+}
+
+/**
+ * Description: Unload the show.
+ * Inputs: None.
+ * Outputs: Clears all tracks.
+ */
+void Show::clear() {
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    _tracks[ch].clear();
+    _envelopes[ch] = KinematicEnvelope{};
+    _blockEnvelopes[ch] = nullptr;
+  }
+  _analyzed = false;
+  _stepHeader = nullptr;
+  _stepImage = nullptr;
+  _stepBlocks = nullptr;
+  _events = nullptr;
+  _eventCount = 0;
+  _channelCount = 0;
+  _durationMs = 0;
+  _loaded = false;
+}
+
+/**
+ * Description: Get the envelope storage analyze() needs.
+ * Inputs: None.
+ * Outputs: Returns the number of block envelopes (one per checkpoint).
+ */
+uint32_t Show::envelopeBlocksNeeded() const {
+  uint32_t blocks = 0;
+  for (uint8_t ch = 0; ch < _channelCount; ch++) {
+    blocks += Track::checkpointsFor(_tracks[ch].keyCount());
+  }
+  return blocks;
+}
+
+/**
+ * Description: Precompute kinematic envelopes for every track.
+ * Inputs:
+ * - blocks: storage for envelopeBlocksNeeded() block envelopes.
+ * - capacity: number of envelopes blocks can hold.
+ * Outputs: Returns false if the storage is too small.
+ */
+bool Show::analyze(KinematicEnvelope* blocks, uint32_t capacity) {
+  if (!beginAnalyze(blocks, capacity)) {
+    return false;
+  }
+  while (analyzeStep(0xFFFFFFFFu) == ShowStep::Busy) {
+  }
+  return true;
+}
+
+/**
+ * Description: Start an analysis that analyzeStep() finishes in bounded steps.
+ * Inputs:
+ * - blocks: storage for envelopeBlocksNeeded() block envelopes.
+ * - capacity: number of envelopes blocks can hold.
+ * Outputs: Returns false if no show is loaded or the storage is too small.
+ */
+bool Show::beginAnalyze(KinematicEnvelope* blocks, uint32_t capacity) {
+  if (!_loaded || capacity < envelopeBlocksNeeded() || (!blocks && capacity > 0)) {
+    return false;
+  }
+  _analyzed = false;
+  _stepChannel = 0;
+  _stepBlocks = blocks;
+  if (_channelCount > 0) {
+    Envelope::beginScan(_tracks[0], _stepBlocks, _envelopes[0], _scan);
+  }
+  return true;
+}
+
+/**
+ * Description: Analyze up to maxKeys keys of the current channel (at most one channel per call).
+ * Inputs:
+ * - maxKeys: key segments to cover in this call.
+ * Outputs: Returns Done once every channel is analyzed, Busy otherwise.
+ */
+ShowStep Show::analyzeStep(uint32_t maxKeys) {
+  if (_analyzed) {
+    return ShowStep::Done;
+  }
+  if (!_loaded || !_stepBlocks) {
+    return ShowStep::Failed;
+  }
+  if (_stepChannel < _channelCount) {
+    const uint8_t ch = _stepChannel;
+    if (!Envelope::scan(_tracks[ch], _stepBlocks, _envelopes[ch], _scan, maxKeys)) {
+      return ShowStep::Busy;
+    }
+    _blockEnvelopes[ch] = _stepBlocks;
+    _stepBlocks += Track::checkpointsFor(_tracks[ch].keyCount());
+    _stepChannel++;
+    if (_stepChannel < _channelCount) {
+      Envelope::beginScan(_tracks[_stepChannel], _stepBlocks, _envelopes[_stepChannel], _scan);
+      return ShowStep::Busy;
+    }
+  }
+  _stepBlocks = nullptr;
+  _analyzed = true;
+  return ShowStep::Done;
+}
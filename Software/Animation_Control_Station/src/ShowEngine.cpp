@@ -0,0 +1,330 @@
+#include "ShowEngine.h"
+
+/**
+ * Description: Attach a loaded show (or nullptr to detach).
+ * Inputs:
+ * - show: show to evaluate; must stay loaded while attached.
+ * Outputs: Rewinds show time and cursors to 0.
+ */
+void ShowEngine::setShow(const Show* show) {
+  _show = show;
+  _showTimeQ16 = 0;
+  _approaching = false;
+  _cues.setEvents(_show ? _show->events() : nullptr, _show ? _show->eventCount() : 0);
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    _overrides[ch] = nullptr;
+    _cursors[ch] = TrackCursor{};
+    if (_show && ch < _show->channelCount()) {
+      _show->track(ch).seek(_cursors[ch], 0);
+    }
+  }
+  applyLimits();
+}
+
+/**
+ * Description: Apply a channel's trim transform to a track sample.
+ * Inputs:
+ * - channel: channel index.
+ * - sample: track output in show-time units.
+ * Outputs: Returns the transformed sample.
+ */
+TrackSample ShowEngine::transform(uint8_t channel, const TrackSample& sample) const {
+  if (!_transforms) {
+    return sample;
+  }
+  const ChannelTransform& xf = _transforms[channel];
+  // Q16.16 position so gain/offset are exact and repeatable tick to tick.
+  int64_t posQ16 = (int64_t)(sample.pos * 65536.0f);
+  posQ16 = (posQ16 * xf.gainQ16) / 65536;
+  int32_t velGainQ16 = xf.gainQ16;
+  if (xf.invert) {
+    posQ16 = -posQ16;
+    velGainQ16 = -velGainQ16;
+  }
+  posQ16 += (int64_t)xf.offset * 65536;
+
+  TrackSample out;
+  out.vel = sample.vel * ((float)velGainQ16 / 65536.0f);
+  const int64_t minQ16 = (int64_t)xf.clampMin * 65536;
+  const int64_t maxQ16 = (int64_t)xf.clampMax * 65536;
+  if (posQ16 < minQ16) {
+    posQ16 = minQ16;
+    out.vel = 0.0f;
+  } else if (posQ16 > maxQ16) {
+    posQ16 = maxQ16;
+    out.vel = 0.0f;
+  }
+  out.pos = (float)posQ16 / 65536.0f;
+  return out;
+}
+
+/**
+ * Description: Derive the rate ceiling and position clamps from the show and override envelopes.
+ * Inputs: None.
+ * Outputs: Updates _rateCeilingQ16 and _clampMask.
+ */
+void ShowEngine::applyLimits() {
+  _rateCeilingQ16 = RATE_MAX_Q16;
+  _clampMask = 0;
+  if (!_show || !_limits) {
+    return;
+  }
+  float ceiling = (float)RATE_MAX_Q16 / (float)RATE_ONE_Q16;
+  for (uint8_t ch = 0; ch < _show->channelCount(); ch++) {
+    // A recorded take replaces the show track, so its own envelope applies.
+    if (!_overrides[ch] && !_show->isAnalyzed()) {
+      continue;
+    }
+    // Check what the motor will actually see: the envelope after the trim.
+    KinematicEnvelope env = _overrides[ch] ? _overrideEnvelopes[ch] : _show->envelope(ch);
+    if (_transforms && env.maxPos >= env.minPos) {
+      TrackSample lo;
+      TrackSample hi;
+      lo.pos = env.minPos;
+      hi.pos = env.maxPos;
+      lo = transform(ch, lo);
+      hi = transform(ch, hi);
+      const float gain = fabsf((float)_transforms[ch].gainQ16 / (float)TRANSFORM_ONE_Q16);
+      env.minPos = fminf(lo.pos, hi.pos);
+      env.maxPos = fmaxf(lo.pos, hi.pos);
+      env.maxVel *= gain;
+      env.maxAccel *= gain;
+      env.maxJerk *= gain;
+    }
+    ceiling = fminf(ceiling, Envelope::maxSafeRate(env, _limits[ch]));
+    if (Envelope::check(env, _limits[ch]) & ENVELOPE_POS) {
+      _clampMask |= (uint16_t)(1u << ch);
+    }
+  }
+  _rateCeilingQ16 = (uint32_t)(ceiling * (float)RATE_ONE_Q16);
+  if (_rateCeilingQ16 == 0) {
+    _rateCeilingQ16 = 1;
+  }
+}
+
+/**
+ * Description: Jump to a show time and start a safe approach move to it.
+ * Inputs:
+ * - tMs: show time to jump to (clamped to the show length).
+ * - approachLimits: limits for the move from the current setpoints.
+ * Outputs: Seeks every track and starts per-channel approach moves.
+ */
+void ShowEngine::seek(uint32_t tMs, const MotionLimits& approachLimits) {
+  if (!_show) {
+    return;
+  }
+  if (tMs > _show->durationMs()) {
+    tMs = _show->durationMs();
+  }
+  _showTimeQ16 = ((uint64_t)tMs * 1000u) << 16;
+  _cues.seek(tMs);
+
+  const uint64_t tUs = (uint64_t)tMs * 1000u;
+  const uint32_t nowUs = _tb.nowUs();
+  for (uint8_t ch = 0; ch < _show->channelCount(); ch++) {
+    const uint64_t chUs = channelTimeUs(ch, tUs);
+    trackFor(ch).seek(_cursors[ch], (uint32_t)(chUs / 1000u));
+    // The approach bypasses evaluate()'s clamp, so clamp its target here.
+    ChannelSetpoint target;
+    target.pos = transform(ch, Track::sample(_cursors[ch], chUs)).pos;
+    clampPosition(ch, target);
+    // A fresh approach starts from the last setpoint, still moving if the
+    // show was playing; while scrubbing the active approach is retargeted
+    // from its current state instead.
+    if (!_approaching) {
+      _approach[ch].reset(_setpoints[ch].pos, _playing ? _setpoints[ch].vel : 0.0f, nowUs);
+    }
+    _approach[ch].moveTo(target.pos, approachLimits, nowUs);
+  }
+  _approaching = true;
+}
+
+/**
+ * Description: Evaluate all channel setpoints at the current show time.
+ * Inputs: None.
+ * Outputs: Updates setpoints from the approach moves or the tracks.
+ */
+void ShowEngine::evaluate() {
+  // Show switches only happen here, between ticks, so a tick always
+  // evaluates one complete show.
+  if (_nextShow && switchDue()) {
+    performSwitch();
+  }
+  if (!_show) {
+    return;
+  }
+  if (!_show->isLoaded()) {
+    _unloadedTicks++;
+    return;
+  }
+  const uint8_t channelCount = _show->channelCount();
+
+  if (_approaching) {
+    const uint32_t nowUs = _tb.nowUs();
+    bool landed = true;
+    for (uint8_t ch = 0; ch < channelCount; ch++) {
+      const MotionSample s = _approach[ch].sample(nowUs);
+      _setpoints[ch].pos = s.pos;
+      _setpoints[ch].vel = s.vel;
+      landed = landed && _approach[ch].isDone(nowUs);
+    }
+    if (landed) {
+      _approaching = false;
+    }
+    return;
+  }
+
+  const uint64_t tUs = currentTimeUs();
+  const uint32_t tMs = (uint32_t)(tUs / 1000u);
+  for (uint8_t ch = 0; ch < channelCount; ch++) {
+    const uint64_t chUs = channelTimeUs(ch, tUs);
+    trackFor(ch).advance(_cursors[ch], (uint32_t)(chUs / 1000u));
+    const TrackSample s = transform(ch, Track::sample(_cursors[ch], chUs));
+    _setpoints[ch].pos = s.pos;
+    _setpoints[ch].vel = scaleVelocity(s.vel);
+  }
+
+  // Position clamps only for channels the load-time envelope flagged.
+  for (uint16_t mask = _clampMask; mask; mask &= (uint16_t)(mask - 1)) {
+    const uint8_t ch = (uint8_t)__builtin_ctz(mask);
+    clampPosition(ch, _setpoints[ch]);
+  }
+
+  if (_blending) {
+    // Smoothstep crossfade from the outgoing show's last setpoints.
+    const uint32_t elapsedUs = _tb.nowUs() - _blendStartUs;
+    const float u = (float)elapsedUs / ((float)_blendMs * 1000.0f);
+    if (u >= 1.0f) {
+      _blending = false;
+    } else {
+      // Velocity is the time derivative of from + (pos - from) * w(u), with
+      // u = elapsed / blend, so the fade itself contributes (pos - from) * dw/dt.
+      const float w = u * u * (3.0f - 2.0f * u);
+      const float dwdt = 6.0f * u * (1.0f - u) / ((float)_blendMs * 0.001f);
+      for (uint8_t ch = 0; ch < channelCount; ch++) {
+        const float delta = _setpoints[ch].pos - _blendFrom[ch];
+        _setpoints[ch].pos = _blendFrom[ch] + delta * w;
+        _setpoints[ch].vel = _setpoints[ch].vel * w + delta * dwdt;
+      }
+    }
+  }
+
+  // Discrete events only queue here; handlers run later from idle time.
+  _cues.advance(tMs);
+}
+
+/**
+ * Description: Sample a channel ahead of the current show time without moving its cursor.
+ * Inputs:
+ * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+ * - aheadUs: real time ahead of now.
+ * Outputs: Returns the transformed setpoint the channel will have then.
+ */
+ChannelSetpoint ShowEngine::preview(uint8_t channel, uint32_t aheadUs) const {
+  ChannelSetpoint out;
+  if (!_show || channel >= _show->channelCount()) {
+    return out;
+  }
+  const uint64_t tUs = currentTimeUs() + (((uint64_t)aheadUs * _rateQ16) >> 16);
+  const uint64_t chUs = channelTimeUs(channel, tUs);
+  TrackCursor cursor = _cursors[channel];
+  trackFor(channel).advance(cursor, (uint32_t)(chUs / 1000u));
+  const TrackSample s = transform(channel, Track::sample(cursor, chUs));
+  out.pos = s.pos;
+  out.vel = scaleVelocity(s.vel);
+  clampPosition(channel, out);
+  return out;
+}
+
+/**
+ * Description: Play a channel from a replacement track.
+ * Inputs:
+ * - channel: channel index [0..SHOW_MAX_CHANNELS-1].
+ * - track: track to play instead of the show's, or nullptr to restore it.
+ * Outputs: Re-cues the channel at the current show time; the track's envelope
+ *          feeds the position clamps and the rate ceiling.
+ */
+void ShowEngine::setTrackOverride(uint8_t channel, const Track* track) {
+  if (channel >= SHOW_MAX_CHANNELS) {
+    return;
+  }
+  _overrides[channel] = track;
+  _overrideEnvelopes[channel] = KinematicEnvelope{};
+  if (track) {
+    Envelope::analyze(*track, nullptr, _overrideEnvelopes[channel]);
+  }
+  if (_show && channel < _show->channelCount()) {
+    trackFor(channel).seek(_cursors[channel], (uint32_t)(channelTimeUs(channel, currentTimeUs()) / 1000u));
+  }
+  applyLimits();
+}
+
+/**
+ * Description: Queue a switch to another show at a cue point or the show end.
+ * Inputs:
+ * - next: fully loaded show to switch to.
+ * - atMs: current-show time to switch at, or SWITCH_AT_END.
+ * - blendMs: crossfade from the outgoing setpoints (0 = hard cut).
+ * Outputs: Stores the pending switch.
+ */
+void ShowEngine::queueSwitch(const Show* next, uint32_t atMs, uint32_t blendMs) {
+  if (!next || !next->isLoaded()) {
+    return;
+  }
+  _nextShow = next;
+  _switchAtMs = atMs;
+  _blendMs = blendMs;
+}
+
+/**
+ * Description: Check whether the queued switch point has been reached.
+ * Inputs: None.
+ * Outputs: Returns true when the switch should happen this tick.
+ */
+bool ShowEngine::switchDue() const {
+  if (!_show) {
+    return true;
+  }
+  if (_approaching) {
+    return false;
+  }
+  const uint32_t tMs = currentTimeMs();
+  if (_switchAtMs == SWITCH_AT_END) {
+    return tMs >= _show->durationMs();
+  }
+  return tMs >= _switchAtMs;
+}
+
+/**
+ * Description: Swap to the queued show.
+ * Inputs: None.
+ * Outputs: Starts the new show at the time played past the switch point and starts the blend.
+ */
+void ShowEngine::performSwitch() {
+  const uint32_t t0 = micros();
+  // Channels the outgoing show lacks still hold their last setpoint, so
+  // every channel fades from where it actually is.
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    _blendFrom[ch] = _setpoints[ch].pos;
+  }
+
+  // The tick that reached the switch point usually ran past it; that show
+  // time belongs to the new show, or every switch would lose up to a tick.
+  uint64_t overshootQ16 = 0;
+  if (_show) {
+    const uint32_t switchMs = (_switchAtMs == SWITCH_AT_END) ? _show->durationMs() : _switchAtMs;
+    const uint64_t switchQ16 = ((uint64_t)switchMs * 1000u) << 16;
+    overshootQ16 = (_showTimeQ16 > switchQ16) ? _showTimeQ16 - switchQ16 : 0;
+  }
+
+  const Show* next = _nextShow;
+  _nextShow = nullptr;
+  _switchAtMs = SWITCH_AT_END;
+  setShow(next); // play state is kept, so playback carries straight on
+  // Cursors and cues start at 0 and catch up in evaluate().
+  _showTimeQ16 = overshootQ16;
+
+  _blending = (_blendMs > 0);
+  _blendStartUs = _tb.nowUs();
+  _lastSwitchUs = micros() - t0;
+}
@@ -0,0 +1,233 @@
+#include "ShowSlots.h"
+#include "Log.h"
+#include <cstring>
+
+/**
+ * Description: Allocate an image buffer, preferring PSRAM when fitted.
+ * Inputs:
+ * - size: bytes required.
+ * Outputs: Returns the buffer, or nullptr.
+ */
+static uint8_t* allocImage(size_t size) {
+  return static_cast<uint8_t*>(extmem_malloc(size)); // falls back to RAM without PSRAM
+}
+
+/**
+ * Description: Initialize the SD card used as the show source.
+ * Inputs: None.
+ * Outputs: Returns true when the card is available.
+ */
+bool ShowSlots::begin() {
+  _sdReady = SD.begin(BUILTIN_SDCARD);
+  if (!_sdReady) {
+    LOGI("ShowSlots: no SD card");
+  }
+  return _sdReady;
+}
+
+/**
+ * Description: Start loading a show image file into a slot.
+ * Inputs:
+ * - slot: slot index; must not be in use by the engine.
+ * - path: file path on the SD card.
+ * Outputs: Returns false if the file cannot be opened or memory is short.
+ */
+bool ShowSlots::beginLoad(uint8_t slot, const char* path) {
+  if (slot >= SLOT_COUNT || !_sdReady) {
+    return false;
+  }
+  release(slot);
+  Slot& s = _slots[slot];
+  strncpy(s.name, path, sizeof(s.name) - 1);
+  s.name[sizeof(s.name) - 1] = '\0';
+
+  s.file = SD.open(path, FILE_READ);
+  if (!s.file) {
+    s.state = SlotState::Failed;
+    return false;
+  }
+  s.size = (size_t)s.file.size();
+  s.image = allocImage(s.size);
+  if (!s.image) {
+    s.file.close();
+    s.state = SlotState::Failed;
+    return false;
+  }
+  s.loaded = 0;
+  s.phase = LoadPhase::Read;
+  s.state = SlotState::Loading;
+  return true;
+}
+
+/**
+ * Description: Continue background loading.
+ * Inputs: None.
+ * Outputs: Does one bounded step: reads up to LOAD_CHUNK_BYTES, validates one
+ *          channel (or a run of events), or analyzes up to ANALYZE_KEYS_PER_POLL keys.
+ */
+void ShowSlots::poll() {
+  for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+    Slot& s = _slots[i];
+    if (s.state != SlotState::Loading) {
+      continue;
+    }
+
+    // One step per poll keeps loop time bounded; the slot stays Loading
+    // (invisible to the engine) until the analysis has finished.
+    switch (s.phase) {
+      case LoadPhase::Read: {
+        const size_t remaining = s.size - s.loaded;
+        const size_t chunk = (remaining < LOAD_CHUNK_BYTES) ? remaining : LOAD_CHUNK_BYTES;
+        const int got = (chunk > 0) ? s.file.read(s.image + s.loaded, chunk) : 0;
+        if (got < 0 || (got == 0 && chunk > 0)) {
+          s.file.close();
+          s.state = SlotState::Failed;
+          LOGI("ShowSlots: read failed in slot %u", i);
+          return;
+        }
+        s.loaded += (size_t)got;
+        if (s.loaded == s.size) {
+          s.file.close();
+          if (!s.show.beginLoad(s.image, s.size)) {
+            finishLoad(i, false);
+            return;
+          }
+          s.phase = LoadPhase::Validate;
+        }
+        break;
+      }
+      case LoadPhase::Validate: {
+        const ShowStep step = s.show.loadStep();
+        if (step == ShowStep::Failed || (step == ShowStep::Done && !beginAnalysis(i))) {
+          finishLoad(i, false);
+        } else if (step == ShowStep::Done) {
+          s.phase = LoadPhase::Analyze;
+        }
+        break;
+      }
+      case LoadPhase::Analyze: {
+        const uint32_t t0 = micros();
+        const ShowStep step = s.show.analyzeStep(ANALYZE_KEYS_PER_POLL);
+        s.analysisUs += micros() - t0;
+        if (step != ShowStep::Busy) {
+          if (step == ShowStep::Done) {
+            checkLimits(i);
+          }
+          finishLoad(i, step == ShowStep::Done);
+        }
+        break;
+      }
+    }
+    return;
+  }
+}
+
+/**
+ * Description: Allocate envelope storage and start the kinematic analysis.
+ * Inputs:
+ * - index: slot index.
+ * Outputs: Returns false if envelope storage cannot be allocated.
+ */
+bool ShowSlots::beginAnalysis(uint8_t index) {
+  Slot& s = _slots[index];
+  const uint32_t blocks = s.show.envelopeBlocksNeeded();
+  s.envelopes = static_cast<KinematicEnvelope*>(extmem_malloc((blocks ? blocks : 1) * sizeof(KinematicEnvelope)));
+  s.analysisUs = 0;
+  return s.envelopes && s.show.beginAnalyze(s.envelopes, blocks);
+}
+
+/**
+ * Description: Check a fully analyzed show against the limits.
+ * Inputs:
+ * - index: slot index.
+ * Outputs: Sets the slot's violation mask and logs the analysis time.
+ */
+void ShowSlots::checkLimits(uint8_t index) {
+  Slot& s = _slots[index];
+  // One comparison per channel here replaces per-tick checks on the control path.
+  s.violations = 0;
+  if (_limits) {
+    for (uint8_t ch = 0; ch < s.show.channelCount(); ch++) {
+      const KinematicEnvelope& env = s.show.envelope(ch);
+      const uint8_t flags = Envelope::check(env, _limits[ch]);
+      if (flags) {
+        s.violations |= (uint16_t)(1u << ch);
+        LOGI("ShowSlots: slot %u ch %u exceeds limits:%s%s%s%s (pos %.0f..%.0f vel %.0f acc %.0f jerk %.0f)",
+             index, ch,
+             (flags & ENVELOPE_POS) ? " pos" : "", (flags & ENVELOPE_VEL) ? " vel" : "",
+             (flags & ENVELOPE_ACCEL) ? " accel" : "", (flags & ENVELOPE_JERK) ? " jerk" : "",
+             env.minPos, env.maxPos, env.maxVel, env.maxAccel, env.maxJerk);
+      }
+    }
+  }
+  const uint32_t usPerMb = (s.size > 0) ? (uint32_t)((uint64_t)s.analysisUs * 1048576u / s.size) : 0;
+  LOGI("ShowSlots: slot %u analyzed in %lu us (%lu us/MB)", index,
+       (unsigned long)s.analysisUs, (unsigned long)usPerMb);
+}
+
+/**
+ * Description: End a load: publish the slot or mark it failed.
+ * Inputs:
+ * - index: slot index.
+ * - ok: true when the image was read, validated and analyzed.
+ * Outputs: Sets the slot state to Ready or Failed.
+ */
+void ShowSlots::finishLoad(uint8_t index, bool ok) {
+  Slot& s = _slots[index];
+  // Only a fully read, validated and analyzed image is published as Ready.
+  s.state = ok ? SlotState::Ready : SlotState::Failed;
+  LOGI("ShowSlots: slot %u %s (%s)", index, ok ? "ready" : "invalid", s.name);
+}
+
+/**
+ * Description: Free a slot's image.
+ * Inputs:
+ * - slot: slot index; must not be in use by the engine.
+ * Outputs: Returns the slot to Empty.
+ */
+void ShowSlots::release(uint8_t slot) {
+  if (slot >= SLOT_COUNT) {
+    return;
+  }
+  Slot& s = _slots[slot];
+  if (s.state == SlotState::Loading) {
+    s.file.close();
+  }
+  s.show.clear();
+  extmem_free(s.image);
+  extmem_free(s.envelopes);
+  s.image = nullptr;
+  s.envelopes = nullptr;
+  s.analysisUs = 0;
+  s.violations = 0;
+  s.size = 0;
+  s.loaded = 0;
+  s.state = SlotState::Empty;
+}
+
+/**
+ * Description: Get a slot's show once it is ready.
+ * Inputs:
+ * - slot: slot index.
+ * Outputs: Returns the show, or nullptr unless the slot is Ready.
+ */
+const Show* ShowSlots::show(uint8_t slot) const {
+  if (slot >= SLOT_COUNT || _slots[slot].state != SlotState::Ready) {
+    return nullptr;
+  }
+  return &_slots[slot].show;
+}
+
+/**
+ * Description: Get loading progress for a slot.
+ * Inputs:
+ * - slot: slot index.
+ * Outputs: Returns 0-100.
+ */
+uint8_t ShowSlots::progressPct(uint8_t slot) const {
+  const Slot& s = _slots[slot];
+  if (s.state == SlotState::Ready) return 100;
+  if (s.state != SlotState::Loading || s.size == 0) return 0;
+  const uint8_t pct = (uint8_t)((uint64_t)s.loaded * 100u / s.size);
+  return (pct < 100) ? pct : 99; // validating/analyzing
+}
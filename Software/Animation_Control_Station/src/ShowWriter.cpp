@@ -0,0 +1,91 @@
+#include "ShowWriter.h"
+#include <string.h>
+
+/**
+ * Description: Round a size up to the 4-byte section alignment.
+ * Inputs:
+ * - size: size in bytes.
+ * Outputs: Returns the aligned size.
+ */
+static inline size_t align4(size_t size) {
+  return (size + 3u) & ~(size_t)3u;
+}
+
+/**
+ * Description: Compute the image size for a set of tracks and events.
+ * Inputs:
+ * - tracks: per-channel key/checkpoint arrays.
+ * - channelCount: number of channels.
+ * - eventCount: number of events.
+ * Outputs: Returns the image size in bytes.
+ */
+size_t ShowWriter::imageSize(const ShowWriterTrack* tracks, uint8_t channelCount, uint32_t eventCount) {
+  size_t size = sizeof(ShowFileHeader) + (size_t)channelCount * sizeof(ShowTrackEntry);
+  for (uint8_t ch = 0; ch < channelCount; ch++) {
+    size += (size_t)tracks[ch].checkpointCount * sizeof(TrackCheckpoint);
+    size = align4(size + (size_t)tracks[ch].keyCount * sizeof(TrackKey));
+  }
+  return size + (size_t)eventCount * sizeof(ShowEvent);
+}
+
+/**
+ * Description: Write a show image.
+ * Inputs:
+ * - out: destination buffer, 4-byte aligned.
+ * - capacity: size of out in bytes.
+ * - tracks: per-channel key/checkpoint arrays.
+ * - channelCount: number of channels.
+ * - durationMs: show length in milliseconds.
+ * - events: time-sorted events (may be nullptr when eventCount is 0).
+ * - eventCount: number of events.
+ * Outputs: Returns the bytes written, or 0 on error.
+ */
+size_t ShowWriter::write(uint8_t* out, size_t capacity,
+                         const ShowWriterTrack* tracks, uint8_t channelCount, uint32_t durationMs,
+                         const ShowEvent* events, uint32_t eventCount) {
+  const size_t size = imageSize(tracks, channelCount, eventCount);
+  if (!out || size > capacity || (eventCount > 0 && !events)) {
+    return 0;
+  }
+  for (uint8_t ch = 0; ch < channelCount; ch++) {
+    if (tracks[ch].checkpointCount != Track::checkpointsFor(tracks[ch].keyCount)) {
+      return 0;
+    }
+  }
+  memset(out, 0, size);
+
+  ShowFileHeader header = {};
+  header.magic = SHOW_MAGIC;
+  header.version = SHOW_FORMAT_VERSION;
+  header.channelCount = channelCount;
+  header.durationMs = durationMs;
+  header.eventCount = eventCount;
+
+  size_t offset = sizeof(ShowFileHeader) + (size_t)channelCount * sizeof(ShowTrackEntry);
+  for (uint8_t ch = 0; ch < channelCount; ch++) {
+    const ShowWriterTrack& track = tracks[ch];
+    ShowTrackEntry entry = {};
+    entry.checkpointOffset = (uint32_t)offset;
+    entry.checkpointCount = track.checkpointCount;
+    if (track.keyCount > 0) {
+      memcpy(out + offset, track.checkpoints, (size_t)track.checkpointCount * sizeof(TrackCheckpoint));
+    }
+    offset += (size_t)track.checkpointCount * sizeof(TrackCheckpoint);
+
+    entry.keyOffset = (uint32_t)offset;
+    entry.keyCount = track.keyCount;
+    if (track.keyCount > 0) {
+      memcpy(out + offset, track.keys, (size_t)track.keyCount * sizeof(TrackKey));
+    }
+    offset = align4(offset + (size_t)track.keyCount * sizeof(TrackKey));
+
+    memcpy(out + sizeof(ShowFileHeader) + (size_t)ch * sizeof(ShowTrackEntry), &entry, sizeof(entry));
+  }
+
+  header.eventOffset = (uint32_t)offset;
+  if (eventCount > 0) {
+    memcpy(out + offset, events, (size_t)eventCount * sizeof(ShowEvent));
+  }
+  memcpy(out, &header, sizeof(header));
+  return size;
+}
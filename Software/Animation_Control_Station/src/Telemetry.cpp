@@ -0,0 +1,84 @@
+#include "Telemetry.h"
+
+/**
+ * Description: Restart scheduling and rate counters.
+ * Inputs:
+ * - nowUs: current time.
+ * Outputs: All fields due now; full share until motion usage is known.
+ */
+void TelemetryScheduler::reset(uint32_t nowUs) {
+  *this = TelemetryScheduler{};
+  for (uint8_t f = 0; f < TELEMETRY_FIELD_COUNT; f++) {
+    _dueUs[f] = nowUs;
+  }
+  _windowStartUs = nowUs;
+  _lastRefillUs = nowUs;
+}
+
+/**
+ * Description: Close the rate window and recompute the telemetry share.
+ * Inputs:
+ * - nowUs: current time.
+ * Outputs: Updates rates and the share.
+ */
+void TelemetryScheduler::rollWindow(uint32_t nowUs) {
+  const uint32_t elapsedUs = nowUs - _windowStartUs;
+  for (uint8_t f = 0; f < TELEMETRY_FIELD_COUNT; f++) {
+    _rateHz[f] = (uint32_t)(((uint64_t)_samples[f] * 1000000u + elapsedUs / 2) / elapsedUs);
+    _samples[f] = 0;
+  }
+  const uint32_t motion = (uint32_t)((uint64_t)_motionUs * 1000u / elapsedUs);
+  _motionPermille = (uint16_t)((motion < 1000u) ? motion : 1000u);
+  const int32_t left = (int32_t)UTILIZATION_PERMILLE - (int32_t)_motionPermille;
+  _sharePermille = (uint16_t)((left > (int32_t)MIN_SHARE_PERMILLE) ? left : MIN_SHARE_PERMILLE);
+  _motionUs = 0;
+  _windowStartUs = nowUs;
+}
+
+/**
+ * Description: Pick the next field to request if one is due and affordable.
+ * Inputs:
+ * - nowUs: current time.
+ * - costUs: port time of one request and reply.
+ * - field: receives the field.
+ * Outputs: Returns true and charges the bucket when a request should go out.
+ */
+bool TelemetryScheduler::next(uint32_t nowUs, uint32_t costUs, TelemetryField& field) {
+  if (nowUs - _windowStartUs >= WINDOW_US) {
+    rollWindow(nowUs);
+  }
+  const uint32_t refill = (uint32_t)((uint64_t)(nowUs - _lastRefillUs) * _sharePermille / 1000u);
+  _bucketUs = (_bucketUs + refill < BUCKET_MAX_US) ? _bucketUs + refill : BUCKET_MAX_US;
+  _lastRefillUs = nowUs;
+  if (_bucketUs < costUs) {
+    return false;
+  }
+
+  // Most overdue relative to its period first, so under a tight budget every
+  // field slows down by the same factor; ties go to the higher priority.
+  int8_t best = -1;
+  int32_t bestLate = -1;
+  uint32_t bestScore = 0;
+  for (uint8_t f = 0; f < TELEMETRY_FIELD_COUNT; f++) {
+    const int32_t late = (int32_t)(nowUs - _dueUs[f]);
+    if (late < 0) {
+      continue;
+    }
+    const uint32_t score = (uint32_t)(((uint64_t)late << 10) / FIELD_PERIOD_US[f]) + 1;
+    if (score > bestScore) {
+      best = (int8_t)f;
+      bestLate = late;
+      bestScore = score;
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+
+  // Keep the cadence, but do not build up a backlog after a starved stretch.
+  const uint32_t period = FIELD_PERIOD_US[best];
+  _dueUs[best] = ((uint32_t)bestLate < period) ? _dueUs[best] + period : nowUs + period;
+  _bucketUs -= costUs;
+  field = (TelemetryField)best;
+  return true;
+}
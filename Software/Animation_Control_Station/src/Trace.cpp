@@ -0,0 +1,411 @@
+#include "Trace.h"
+#include <SD.h>
+
+static_assert((TRACE_PSRAM_BYTES & (TRACE_PSRAM_BYTES - 1)) == 0, "TRACE_PSRAM_BYTES must be a power of two");
+static_assert((TRACE_RAM_BYTES & (TRACE_RAM_BYTES - 1)) == 0, "TRACE_RAM_BYTES must be a power of two");
+
+// Ring of encoded records (one producer and one consumer, both in loop
+// context). Allocated on the first traceStart() only, so an unarmed build
+// costs no memory.
+static uint8_t* s_ring = nullptr;
+static uint32_t s_ringBytes = 0;
+static uint32_t s_head = 0; // total bytes queued
+static uint32_t s_tail = 0; // total bytes written to SD
+static bool s_active = false;
+static File s_file;
+static uint32_t s_flushMs = 0;
+static uint32_t s_lastUs = 0;
+static TraceStats s_stats;
+static TraceSink s_sink = nullptr;
+static void* s_sinkContext = nullptr;
+
+// Last reported inputs; only changes are recorded.
+static int16_t s_buttons = -1;
+static int32_t s_pots[2] = {-1, -1};
+static int16_t s_estop = -1;
+
+// Bytes read since the last record, coalesced into one Rx record per port.
+static uint8_t s_rxPort = 0;
+static uint8_t s_rxLen = 0;
+static uint32_t s_rxTimeUs = 0;
+static uint8_t s_rxData[TRACE_MAX_DATA_BYTES];
+
+/**
+ * Description: Encode a record into the ring, or hand it to the sink.
+ * Inputs:
+ * - type, arg: record type and argument.
+ * - timeUs: record time.
+ * - data, len: byte payload (console line, RX bytes), or nullptr.
+ * - value: numeric payload.
+ * Outputs: Returns the sink's verdict (true without a sink); counts a drop when the ring is full.
+ */
+static bool emit(TraceRecord type, uint8_t arg, uint32_t timeUs, const uint8_t* data, uint8_t len, uint32_t value) {
+  if (s_sink) {
+    s_stats.records++;
+    TraceEvent event = {type, arg, timeUs, data, len, value};
+    return s_sink(event, s_sinkContext);
+  }
+  uint8_t record[TRACE_MAX_RECORD_BYTES];
+  uint32_t n = 0;
+  record[n++] = traceTag(type, arg);
+  n += flightPutDelta(record + n, (int32_t)(timeUs - s_lastUs));
+  switch (type) {
+    case TraceRecord::Buttons:
+      record[n++] = (uint8_t)value;
+      break;
+    case TraceRecord::Pot:
+      record[n++] = (uint8_t)value;
+      record[n++] = (uint8_t)(value >> 8);
+      break;
+    case TraceRecord::Encoder:
+      n += flightPutDelta(record + n, (int32_t)value);
+      break;
+    case TraceRecord::Console:
+    case TraceRecord::Rx:
+      record[n++] = len;
+      memcpy(record + n, data, len);
+      n += len;
+      break;
+    case TraceRecord::Tx:
+      record[n++] = len;
+      memcpy(record + n, &value, sizeof(value));
+      n += sizeof(value);
+      break;
+    case TraceRecord::End:
+      memcpy(record + n, &value, sizeof(value));
+      n += sizeof(value);
+      break;
+    default:
+      break;
+  }
+  if (s_head - s_tail + n > s_ringBytes) {
+    s_stats.dropped++;
+    return true;
+  }
+  s_lastUs = timeUs;
+  const uint32_t mask = s_ringBytes - 1;
+  for (uint32_t i = 0; i < n; i++) {
+    s_ring[(s_head + i) & mask] = record[i];
+  }
+  s_head += n;
+  s_stats.records++;
+  const uint32_t pending = s_head - s_tail;
+  if (pending > s_stats.maxPending) s_stats.maxPending = pending;
+  return true;
+}
+
+/**
+ * Description: Emit the pending Rx record, if any.
+ * Inputs: None.
+ * Outputs: The coalescing buffer is empty.
+ */
+static void flushRx() {
+  if (s_rxLen == 0) {
+    return;
+  }
+  emit(TraceRecord::Rx, s_rxPort, s_rxTimeUs, s_rxData, s_rxLen, 0);
+  s_rxLen = 0;
+}
+
+/**
+ * Description: Flush pending bytes and emit a record stamped now.
+ * Inputs:
+ * - type, arg, data, len, value: as for emit().
+ * Outputs: Returns the sink's verdict (true without a sink).
+ */
+static bool record(TraceRecord type, uint8_t arg, const uint8_t* data, uint8_t len, uint32_t value) {
+  flushRx();
+  return emit(type, arg, micros(), data, len, value);
+}
+
+/**
+ * Description: Start a capture from boot (or announce the start to the sink).
+ * Inputs:
+ * - config: settings image in effect (written to the file header).
+ * - configBytes: size of the image.
+ * Outputs: Returns false if the ring cannot be allocated or the file cannot be created.
+ */
+bool traceStart(const void* config, uint16_t configBytes) {
+  if (s_active) {
+    return true;
+  }
+  s_stats = TraceStats{};
+  s_buttons = -1;
+  s_pots[0] = s_pots[1] = -1;
+  s_estop = -1;
+  s_rxLen = 0;
+  s_lastUs = micros();
+  if (!s_sink) {
+    if (!s_ring) {
+      // extmem_malloc() falls back to RAM without PSRAM; take less there.
+      s_ringBytes = TRACE_PSRAM_BYTES;
+      s_ring = static_cast<uint8_t*>(extmem_malloc(s_ringBytes));
+      if (!s_ring) {
+        s_ringBytes = TRACE_RAM_BYTES;
+        s_ring = static_cast<uint8_t*>(extmem_malloc(s_ringBytes));
+      }
+      if (!s_ring) {
+        s_ringBytes = 0;
+        return false;
+      }
+    }
+    SD.remove(TRACE_FILE);
+    s_file = SD.open(TRACE_FILE, FILE_WRITE);
+    if (!s_file) {
+      return false;
+    }
+    TraceFileHeader header = {};
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_FORMAT_VERSION;
+    header.configBytes = configBytes;
+    header.startUs = s_lastUs;
+    s_file.write(&header, sizeof(header));
+    s_file.write(config, configBytes);
+    s_stats.bytesWritten = sizeof(header) + configBytes;
+    s_head = s_tail = 0;
+    s_flushMs = millis();
+  }
+  s_active = true;
+  emit(TraceRecord::Start, 0, s_lastUs, nullptr, 0, 0);
+  return true;
+}
+
+/**
+ * Description: End the capture: write the End record, everything still queued, and close the file.
+ * Inputs: None.
+ * Outputs: Blocks for the SD writes; later trace calls are ignored.
+ */
+void traceStop() {
+  if (!s_active) {
+    return;
+  }
+  record(TraceRecord::End, 0, nullptr, 0, s_stats.dropped);
+  s_active = false;
+  if (s_file) {
+    while (traceWrite(0xFFFFFFFFu) > 0) {
+    }
+    s_file.close();
+  }
+}
+
+/**
+ * Description: Check whether a capture (or a replay sink) is running.
+ * Inputs: None.
+ * Outputs: Returns true between traceStart() and traceStop().
+ */
+bool traceActive() {
+  return s_active;
+}
+
+/**
+ * Description: Send records to a callback instead of the SD file (host replay).
+ * Inputs:
+ * - sink: callback (nullptr to write files again).
+ * - context: passed to the sink.
+ * Outputs: Takes effect at the next traceStart().
+ */
+void traceSetSink(TraceSink sink, void* context) {
+  if (s_active) {
+    return;
+  }
+  s_sink = sink;
+  s_sinkContext = context;
+}
+
+/**
+ * Description: Emit a Run or Job record stamped with the run's start time.
+ * Inputs:
+ * - type: Run or Job.
+ * - index: scheduler table index.
+ * - startUs: start time; a sink may replace it.
+ * Outputs: Returns the sink's verdict (true without a sink).
+ */
+static bool recordStart(TraceRecord type, uint8_t index, uint32_t& startUs) {
+  flushRx();
+  if (!s_sink) {
+    return emit(type, index, startUs, nullptr, 0, 0);
+  }
+  // The sink may move the start (a replay puts it at the recorded time).
+  s_stats.records++;
+  TraceEvent event = {type, index, startUs, nullptr, 0, 0};
+  const bool run = s_sink(event, s_sinkContext);
+  startUs = event.timeUs;
+  return run;
+}
+
+/**
+ * Description: Record a scheduler task starting.
+ * Inputs:
+ * - task: scheduler table index.
+ * - startUs: start time the task will see (a replay sink may move it).
+ * Outputs: Returns false only when a replay sink holds the run back.
+ */
+bool traceRun(uint8_t task, uint32_t& startUs) {
+  if (!s_active) {
+    return true;
+  }
+  return recordStart(TraceRecord::Run, task, startUs);
+}
+
+/**
+ * Description: Record a background job starting (only jobs whose work the tasks can see).
+ * Inputs:
+ * - job: scheduler table index.
+ * - startUs: start time the job will see (a replay sink may move it).
+ * Outputs: Returns false when a replay sink holds the job back for this pass.
+ */
+bool traceJob(uint8_t job, uint32_t& startUs) {
+  if (!s_active) {
+    return true;
+  }
+  return recordStart(TraceRecord::Job, job, startUs);
+}
+
+/**
+ * Description: Record the pressed buttons (only when they changed).
+ * Inputs:
+ * - mask: bit per Button, 1 = pressed.
+ * Outputs: Appends a Buttons record on a change.
+ */
+void traceButtons(uint8_t mask) {
+  if (!s_active || s_buttons == mask) {
+    return;
+  }
+  s_buttons = mask;
+  record(TraceRecord::Buttons, 0, nullptr, 0, mask);
+}
+
+/**
+ * Description: Record a pot reading (only when it changed).
+ * Inputs:
+ * - pot: which pot.
+ * - raw: analogRead() value.
+ * Outputs: Appends a Pot record on a change.
+ */
+void tracePot(TracePot pot, uint16_t raw) {
+  const uint8_t index = (uint8_t)pot;
+  if (!s_active || s_pots[index] == raw) {
+    return;
+  }
+  s_pots[index] = raw;
+  record(TraceRecord::Pot, index, nullptr, 0, raw);
+}
+
+/**
+ * Description: Record jog wheel counts consumed by the input task.
+ * Inputs:
+ * - counts: counts since the last poll.
+ * Outputs: Appends an Encoder record when counts is not 0.
+ */
+void traceEncoder(int32_t counts) {
+  if (!s_active || counts == 0) {
+    return;
+  }
+  record(TraceRecord::Encoder, 0, nullptr, 0, (uint32_t)counts);
+}
+
+/**
+ * Description: Record the e-stop input level (only when it changed).
+ * Inputs:
+ * - level: digitalReadFast() of the e-stop pin.
+ * Outputs: Appends an Estop record on a change.
+ */
+void traceEstop(uint8_t level) {
+  if (!s_active || s_estop == level) {
+    return;
+  }
+  s_estop = level;
+  record(TraceRecord::Estop, level ? 1 : 0, nullptr, 0, 0);
+}
+
+/**
+ * Description: Record a console line as it is dispatched.
+ * Inputs:
+ * - line, len: line without the newline (truncated to TRACE_MAX_DATA_BYTES).
+ * Outputs: Appends a Console record.
+ */
+void traceConsole(const char* line, size_t len) {
+  if (!s_active) {
+    return;
+  }
+  const uint8_t n = (uint8_t)(len < TRACE_MAX_DATA_BYTES ? len : TRACE_MAX_DATA_BYTES);
+  record(TraceRecord::Console, 0, reinterpret_cast<const uint8_t*>(line), n, 0);
+}
+
+/**
+ * Description: Record a byte read from an RS422 port.
+ * Inputs:
+ * - port: port index.
+ * - b: byte read.
+ * Outputs: Adds the byte to the pending Rx record for the port.
+ */
+void traceRxByte(uint8_t port, uint8_t b) {
+  if (!s_active) {
+    return;
+  }
+  if (s_rxLen > 0 && (port != s_rxPort || s_rxLen == TRACE_MAX_DATA_BYTES)) {
+    flushRx();
+  }
+  if (s_rxLen == 0) {
+    s_rxPort = port;
+    s_rxTimeUs = micros();
+  }
+  s_rxData[s_rxLen++] = b;
+}
+
+/**
+ * Description: Record bytes written to an RS422 port.
+ * Inputs:
+ * - port: port index.
+ * - data, len: bytes written.
+ * Outputs: Appends a Tx record with the length and hash.
+ */
+void traceTx(uint8_t port, const uint8_t* data, size_t len) {
+  if (!s_active) {
+    return;
+  }
+  const uint32_t hash = flightFnv1a(TRACE_HASH_SEED, data, len);
+  record(TraceRecord::Tx, port, nullptr, (uint8_t)(len < 0xFFu ? len : 0xFFu), hash);
+}
+
+/**
+ * Description: Write queued records to the SD file (call from idle time).
+ * Inputs:
+ * - maxBytes: write limit for this call.
+ * Outputs: Returns the bytes written.
+ */
+uint32_t traceWrite(uint32_t maxBytes) {
+  if (!s_file) {
+    return 0;
+  }
+  // One contiguous piece of the ring per call.
+  const uint32_t mask = s_ringBytes - 1;
+  const uint32_t at = s_tail & mask;
+  uint32_t n = s_head - s_tail;
+  if (n > s_ringBytes - at) n = s_ringBytes - at;
+  if (n > maxBytes) n = maxBytes;
+  if (n > 0) {
+    s_file.write(s_ring + at, n);
+    s_tail += n;
+    s_stats.bytesWritten += n;
+  }
+  // Keep the directory entry current so a power cut loses at most a second.
+  if ((uint32_t)(millis() - s_flushMs) >= TRACE_FLUSH_MS) {
+    s_flushMs = millis();
+    s_file.flush();
+  }
+  return n;
+}
+
+/**
+ * Description: Get the capture counters.
+ * Inputs: None.
+ * Outputs: Returns a snapshot of the counters.
+ */
+TraceStats traceStats() {
+  TraceStats stats = s_stats;
+  stats.active = s_active;
+  stats.pending = s_head - s_tail;
+  stats.ringBytes = s_ringBytes;
+  return stats;
+}
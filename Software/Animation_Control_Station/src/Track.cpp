@@ -0,0 +1,233 @@
+#include "Track.h"
+
+/**
+ * Description: Apply an easing curve to a normalized segment position.
+ * Inputs:
+ * - ease: easing type.
+ * - u: position within the segment (0..1).
+ * - slope: receives d(eased)/du.
+ * Outputs: Returns the eased fraction (0..1).
+ */
+static inline float applyEase(uint8_t ease, float u, float& slope) {
+  switch ((Ease)ease) {
+    case Ease::Linear:
+      slope = 1.0f;
+      return u;
+    case Ease::Smooth:
+      slope = 6.0f * u * (1.0f - u);
+      return u * u * (3.0f - 2.0f * u);
+    case Ease::EaseIn:
+      slope = 2.0f * u;
+      return u * u;
+    case Ease::EaseOut:
+      slope = 2.0f * (1.0f - u);
+      return 1.0f - (1.0f - u) * (1.0f - u);
+    case Ease::Step:
+    default:
+      slope = 0.0f;
+      return 0.0f;
+  }
+}
+
+/**
+ * Description: Point the track at key and checkpoint storage (not copied).
+ * Inputs:
+ * - keys: delta-encoded keys.
+ * - keyCount: number of keys.
+ * - checkpoints: checkpoints built for these keys.
+ * - checkpointCount: number of checkpoints.
+ * Outputs: Returns false when the checkpoints do not index the keys (count,
+ *          key indices or time order).
+ */
+bool Track::attach(const TrackKey* keys, uint32_t keyCount,
+                   const TrackCheckpoint* checkpoints, uint32_t checkpointCount) {
+  clear();
+  if (keyCount == 0) {
+    return true;
+  }
+  if (!keys || !checkpoints || checkpointCount != checkpointsFor(keyCount)) {
+    return false;
+  }
+  // Checkpoints come from the card: seek() and the envelope blocks index
+  // keys with them, so each must anchor its own key, in time order.
+  for (uint32_t i = 0; i < checkpointCount; i++) {
+    if (checkpoints[i].keyIndex != i * TRACK_CHECKPOINT_INTERVAL) {
+      return false;
+    }
+    if (i > 0 && checkpoints[i].timeMs < checkpoints[i - 1].timeMs) {
+      return false;
+    }
+  }
+
+  _keys = keys;
+  _keyCount = keyCount;
+  _checkpoints = checkpoints;
+  _checkpointCount = checkpointCount;
+
+  // Duration: last checkpoint plus the keys after it.
+  const TrackCheckpoint& last = _checkpoints[_checkpointCount - 1];
+  uint32_t timeMs = last.timeMs;
+  for (uint32_t i = last.keyIndex + 1; i < _keyCount; i++) {
+    timeMs += _keys[i].dtMs;
+  }
+  _durationMs = timeMs;
+  return true;
+}
+
+/**
+ * Description: Detach from any storage.
+ * Inputs: None.
+ * Outputs: Leaves an empty track that evaluates to zero.
+ */
+void Track::clear() {
+  _keys = nullptr;
+  _checkpoints = nullptr;
+  _keyCount = 0;
+  _checkpointCount = 0;
+  _durationMs = 0;
+}
+
+/**
+ * Description: Load the key pair starting at an absolute key into a cursor.
+ * Inputs:
+ * - cursor: cursor to fill.
+ * - index: key index.
+ * - timeMs: absolute time of the key.
+ * - value: absolute value of the key.
+ * Outputs: Fills the cursor bracket.
+ */
+void Track::loadPair(TrackCursor& cursor, uint32_t index, uint32_t timeMs, int32_t value) const {
+  cursor.index = index;
+  cursor.t0 = timeMs;
+  cursor.v0 = value;
+  cursor.ease = _keys[index].ease;
+  if (index + 1 < _keyCount) {
+    cursor.t1 = timeMs + _keys[index + 1].dtMs;
+    cursor.v1 = value + _keys[index + 1].dValue;
+  } else {
+    cursor.t1 = timeMs;
+    cursor.v1 = value;
+  }
+}
+
+/**
+ * Description: Position a cursor at a time using the checkpoint index.
+ * Inputs:
+ * - cursor: cursor to position.
+ * - tMs: show time in milliseconds.
+ * Outputs: Updates cursor in O(log n) plus at most one checkpoint interval.
+ */
+void Track::seek(TrackCursor& cursor, uint32_t tMs) const {
+  if (_keyCount == 0) {
+    cursor = TrackCursor{};
+    return;
+  }
+
+  // Last checkpoint at or before tMs (checkpoint 0 when tMs precedes the track).
+  uint32_t lo = 0;
+  uint32_t hi = _checkpointCount;
+  while (hi - lo > 1) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (_checkpoints[mid].timeMs <= tMs) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  const TrackCheckpoint& cp = _checkpoints[lo];
+  loadPair(cursor, cp.keyIndex, cp.timeMs, cp.value);
+  advance(cursor, tMs);
+}
+
+/**
+ * Description: Move a cursor forward to a later time.
+ * Inputs:
+ * - cursor: cursor to advance.
+ * - tMs: show time in milliseconds.
+ * Outputs: Updates cursor; amortized O(1) during playback, seeks if time went back.
+ */
+void Track::advance(TrackCursor& cursor, uint32_t tMs) const {
+  if (_keyCount == 0) {
+    return;
+  }
+  if (tMs < cursor.t0 && cursor.index > 0) {
+    seek(cursor, tMs);
+    return;
+  }
+  while (cursor.index + 1 < _keyCount && tMs >= cursor.t1) {
+    loadPair(cursor, cursor.index + 1, cursor.t1, cursor.v1);
+  }
+}
+
+/**
+ * Description: Move a cursor to the next key.
+ * Inputs:
+ * - cursor: cursor positioned by seek()/advance()/step().
+ * Outputs: Returns false when the cursor is already at the last key.
+ */
+bool Track::step(TrackCursor& cursor) const {
+  if (cursor.index + 1 >= _keyCount) {
+    return false;
+  }
+  loadPair(cursor, cursor.index + 1, cursor.t1, cursor.v1);
+  return true;
+}
+
+/**
+ * Description: Interpolate the track value at a time within the cursor's keys.
+ * Inputs:
+ * - cursor: cursor positioned for tUs.
+ * - tUs: show time in microseconds.
+ * Outputs: Returns position and show-time velocity.
+ */
+TrackSample Track::sample(const TrackCursor& cursor, uint64_t tUs) {
+  TrackSample out;
+  const uint64_t startUs = (uint64_t)cursor.t0 * 1000u;
+  const uint32_t spanMs = cursor.t1 - cursor.t0;
+  if (spanMs == 0 || tUs <= startUs) {
+    out.pos = (float)cursor.v0;
+    return out;
+  }
+
+  float u = (float)(tUs - startUs) / ((float)spanMs * 1000.0f);
+  if (u > 1.0f) u = 1.0f;
+  float slope = 0.0f;
+  const float eased = applyEase(cursor.ease, u, slope);
+  const float delta = (float)(cursor.v1 - cursor.v0);
+  out.pos = (float)cursor.v0 + delta * eased;
+  out.vel = delta * slope * (1000.0f / (float)spanMs);
+  return out;
+}
+
+/**
+ * Description: Build the checkpoint index for a key array.
+ * Inputs:
+ * - keys: delta-encoded keys.
+ * - keyCount: number of keys.
+ * - firstTimeMs: absolute time of key 0.
+ * - firstValue: absolute value of key 0.
+ * - out: checkpoint storage.
+ * - maxOut: capacity of out.
+ * Outputs: Returns the number of checkpoints written, or 0 if out is too small.
+ */
+uint32_t Track::buildCheckpoints(const TrackKey* keys, uint32_t keyCount,
+                                 uint32_t firstTimeMs, int32_t firstValue,
+                                 TrackCheckpoint* out, uint32_t maxOut) {
+  const uint32_t needed = checkpointsFor(keyCount);
+  if (needed > maxOut) {
+    return 0;
+  }
+  uint32_t timeMs = firstTimeMs;
+  int32_t value = firstValue;
+  for (uint32_t i = 0; i < keyCount; i++) {
+    if (i > 0) {
+      timeMs += keys[i].dtMs;
+      value += keys[i].dValue;
+    }
+    if ((i % TRACK_CHECKPOINT_INTERVAL) == 0) {
+      out[i / TRACK_CHECKPOINT_INTERVAL] = TrackCheckpoint{timeMs, value, i};
+    }
+  }
+  return needed;
+}
@@ -0,0 +1,117 @@
+#include "TrackBuilder.h"
+
+static constexpr uint32_t MAX_KEY_DT_MS = 0xFFFF;
+static constexpr int32_t MAX_KEY_DVALUE = 0x7FFF;
+
+/**
+ * Description: Start building into caller-provided storage.
+ * Inputs:
+ * - keys: key storage.
+ * - maxKeys: capacity of keys.
+ * - checkpoints: checkpoint storage.
+ * - maxCheckpoints: capacity of checkpoints.
+ * Outputs: Resets the builder to an empty track.
+ */
+void TrackBuilder::begin(TrackKey* keys, uint32_t maxKeys, TrackCheckpoint* checkpoints, uint32_t maxCheckpoints) {
+  _keys = keys;
+  _maxKeys = maxKeys;
+  _checkpoints = checkpoints;
+  _maxCheckpoints = maxCheckpoints;
+  _keyCount = 0;
+  _lastTimeMs = 0;
+  _lastValue = 0;
+}
+
+/**
+ * Description: Append an absolute keyframe.
+ * Inputs:
+ * - timeMs: key time (must not precede the previous key).
+ * - value: key value.
+ * - ease: interpolation from this key to the next.
+ * Outputs: Returns false when storage is full or time runs backwards.
+ */
+bool TrackBuilder::append(uint32_t timeMs, int32_t value, Ease ease) {
+  if (_keyCount == 0) {
+    return push(timeMs, value, ease);
+  }
+  if (timeMs < _lastTimeMs) {
+    return false;
+  }
+
+  // Split gaps/jumps too large for one key into evenly spaced steps along
+  // the straight line. A Step segment holds its value across the gap and
+  // jumps at the end, so its jump is split into zero-length Step keys.
+  const uint32_t dt = timeMs - _lastTimeMs;
+  const int64_t dv = (int64_t)value - _lastValue;
+  const uint64_t absDv = (dv < 0) ? (uint64_t)(-dv) : (uint64_t)dv;
+  const uint32_t stepsForTime = (dt + MAX_KEY_DT_MS - 1) / MAX_KEY_DT_MS;
+  const uint32_t stepsForValue = (uint32_t)((absDv + MAX_KEY_DVALUE - 1) / MAX_KEY_DVALUE);
+
+  const uint32_t startTime = _lastTimeMs;
+  const int32_t startValue = _lastValue;
+  if (_keys[_keyCount - 1].ease == (uint8_t)Ease::Step) {
+    for (uint32_t i = 1; i < stepsForTime; i++) {
+      if (!push(startTime + (uint32_t)((uint64_t)dt * i / stepsForTime), startValue, Ease::Step)) {
+        return false;
+      }
+    }
+    const int32_t jump = (dv < 0) ? -MAX_KEY_DVALUE : MAX_KEY_DVALUE;
+    for (uint32_t i = 1; i < stepsForValue; i++) {
+      if (!push(timeMs, _lastValue + jump, Ease::Step)) {
+        return false;
+      }
+    }
+    return push(timeMs, value, ease);
+  }
+
+  const uint32_t steps = (stepsForTime > stepsForValue) ? stepsForTime : stepsForValue;
+  for (uint32_t i = 1; i < steps; i++) {
+    const uint32_t t = startTime + (uint32_t)((uint64_t)dt * i / steps);
+    const int32_t v = (int32_t)(startValue + dv * (int64_t)i / (int64_t)steps);
+    if (!push(t, v, Ease::Linear)) {
+      return false;
+    }
+  }
+  return push(timeMs, value, ease);
+}
+
+/**
+ * Description: Write one key whose deltas are known to fit.
+ * Inputs:
+ * - timeMs: key time.
+ * - value: key value.
+ * - ease: interpolation from this key to the next.
+ * Outputs: Returns false when storage is full.
+ */
+bool TrackBuilder::push(uint32_t timeMs, int32_t value, Ease ease) {
+  if (_keyCount >= _maxKeys) {
+    return false;
+  }
+  if ((_keyCount % TRACK_CHECKPOINT_INTERVAL) == 0) {
+    const uint32_t cp = _keyCount / TRACK_CHECKPOINT_INTERVAL;
+    if (cp >= _maxCheckpoints) {
+      return false;
+    }
+    _checkpoints[cp] = TrackCheckpoint{timeMs, value, _keyCount};
+  }
+
+  TrackKey& key = _keys[_keyCount];
+  key.dtMs = (_keyCount == 0) ? 0 : (uint16_t)(timeMs - _lastTimeMs);
+  key.dValue = (_keyCount == 0) ? 0 : (int16_t)(value - _lastValue);
+  key.ease = (uint8_t)ease;
+  key.reserved = 0;
+  _keyCount++;
+  _lastTimeMs = timeMs;
+  _lastValue = value;
+  return true;
+}
+
+/**
+ * Description: Attach the built keys to a track.
+ * Inputs:
+ * - track: track to attach.
+ * Outputs: Returns true on success.
+ */
+bool TrackBuilder::attach(Track& track) const {
+  return track.attach(_keys, _keyCount, _checkpoints, checkpointCount());
+}
@@ -94,7 +94,7 @@ void Ui::begin() {
 }
 
 /**
- * Description: Render the main UI at a fixed cadence.
+ * Description: Render the main UI (once per scheduler "ui" period).
  * Inputs:
  * - model: UI model data to draw.
  * Outputs: Updates the canvas and flushes to the display.
@@ -104,11 +104,6 @@ void Ui::render(const UiModel& model) {
     return;
   }
 
-  if (_timeSinceLastRender < RENDER_PERIOD_MSEC)
-    return;
-
-  _timeSinceLastRender = 0;
-
   #ifdef TEST_GRID
   // Screen perimeter test pattern
   canvas->fillRect(0,0, tft.width(), tft.height(), ILI9341_T4_COLOR_NAVY);
@@ -139,7 +134,7 @@ canvas->fillRect(0,0, 64, 32, ILI9341_T4_COLOR_RED);
 canvas->setTextColor(ILI9341_T4_COLOR_WHITE);
 canvas->setTextSize(2);
 canvas->setCursor(6, 8); // Half character size from corner
-canvas->printf("PLAY");
+canvas->printf(model.stopped ? "STOP" : "PLAY");
 
 // Draw bottom button guide
 canvas->fillRect(0,tft.height()-32, 106, tft.height(), ILI9341_T4_COLOR_RED);
@@ -172,6 +167,30 @@ canvas->setCursor(0, 48);
 canvas->setTextColor(ILI9341_T4_COLOR_WHITE);
 canvas->printf("SPEED: %3d%%\n", (int)(model.speedNorm * 100.0f));
 canvas->printf("ACCEL: %3d%%\n", (int)(model.accelNorm * 100.0f));
+canvas->printf("POS: %7ld\n", (long)model.motionPos);
+canvas->printf("VEL: %7ld\n", (long)model.motionVel);
+canvas->printf("RATE: %3d%%  T: %lu.%01lu\n", (int)(model.playbackRate * 100.0f + 0.5f),
+               (unsigned long)(model.showTimeMs / 1000u), (unsigned long)((model.showTimeMs / 100u) % 10u));
+canvas->printf("CH%u: %ld / %ld  %.2fA\n", model.selectedMotor, (long)model.channel.position,
+               (long)model.channel.target, (double)model.channel.currentCa / 100.0);
+if (model.trimActive) {
+  static const char* const FIELD_NAMES[] = {"GAIN", "OFFS", "SHIFT", "INV"};
+  const ChannelTransform& xf = model.trim;
+  canvas->setTextColor(ILI9341_T4_COLOR_YELLOW);
+  canvas->printf("TRIM CH%u %s: ", model.selectedMotor, FIELD_NAMES[model.trimField % (uint8_t)TrimField::COUNT]);
+  switch ((TrimField)model.trimField) {
+    case TrimField::Gain:   canvas->printf("%.3f\n", (double)xf.gainQ16 / (double)TRANSFORM_ONE_Q16); break;
+    case TrimField::Offset: canvas->printf("%ld\n", (long)xf.offset); break;
+    case TrimField::Shift:  canvas->printf("%d ms\n", xf.timeOffsetMs); break;
+    default:                canvas->printf("%s\n", xf.invert ? "ON" : "OFF"); break;
+  }
+  canvas->setTextColor(ILI9341_T4_COLOR_WHITE);
+}
+if (model.fault) {
+  canvas->setTextColor(ILI9341_T4_COLOR_YELLOW);
+  canvas->printf("FAULT: %s\n", model.fault);
+  canvas->setTextColor(ILI9341_T4_COLOR_WHITE);
+}
 auto stats = tft.statsFPS();
 canvas->printf("FPS: %f\n", stats.avg());
 
@@ -3,6 +3,57 @@
 #include "App.h"
 #include "BoardPins.h"
 #include "Faults.h"
+#include "Profiler.h"
+#include "Trace.h"
+
+// Jog move limits at full pot travel (encoder units).
+static constexpr float JOG_UNITS_PER_DETENT = 10.0f;
+static constexpr float JOG_MAX_VEL = 2000.0f;     // units/s
+static constexpr float JOG_MAX_ACCEL = 8000.0f;   // units/s^2
+static constexpr float JOG_MAX_JERK = 80000.0f;   // units/s^3
+static constexpr float JOG_MIN_SCALE = 0.05f;     // keep moves finite with pots at zero
+static constexpr float POT_REPLAN_HYSTERESIS = 0.01f;
+static constexpr int32_t SCRUB_MS_PER_DETENT = 100; // jog scrub step while paused
+static constexpr uint32_t CUE_DRAIN_PER_PASS = 16;  // show events handled per loop pass
+static constexpr uint32_t LOG_DRAIN_PER_PASS = 8;   // log lines formatted per loop pass
+static constexpr float CHANNEL_MIN_POS = -100000.0f; // default motor limits (encoder units)
+static constexpr float CHANNEL_MAX_POS = 100000.0f;
+static constexpr float CHANNEL_MAX_VEL = 20000.0f;    // units/s
+static constexpr float CHANNEL_MAX_ACCEL = 200000.0f; // units/s^2
+static constexpr int32_t TRIM_GAIN_STEP_Q16 = TRANSFORM_ONE_Q16 / 200; // 0.5% per detent
+static constexpr int32_t TRIM_OFFSET_STEP = 10;   // units per detent
+static constexpr int16_t TRIM_SHIFT_STEP_MS = 1;  // ms per detent
+static constexpr float RECORD_POT_RANGE = 1000.0f;  // units at full pot travel when recording a pot
+static constexpr uint32_t RS422_DEFAULT_BAUD = 115200; // until a port is tuned
+static constexpr float FOLLOW_SLOW_RATE = 0.5f;     // playback rate factor while following error is high
+static constexpr uint16_t FAULT_BLINK_MS = 100;      // RUN/HALT LED on/off time for blink reactions
+
+// Loop tasks: release period and run-time budget (microseconds).
+static constexpr uint32_t CONTROL_PERIOD_US = 500;    // show clock, RoboClaw acks/setpoints, flight snapshot
+static constexpr uint32_t CONTROL_BUDGET_US = 300;
+static constexpr uint32_t INPUT_PERIOD_US = 2000;     // I2C expander, pots, jog wheel
+static constexpr uint32_t INPUT_BUDGET_US = 400;
+static constexpr uint32_t CUES_PERIOD_US = 1000;
+static constexpr uint32_t CUES_BUDGET_US = 200;
+static constexpr uint32_t CONSOLE_PERIOD_US = 5000;
+static constexpr uint32_t CONSOLE_BUDGET_US = 2000;   // long commands (tune, benchmarks) overrun by design
+static constexpr uint32_t RS422_TEST_PERIOD_US = 10000;
+static constexpr uint32_t RS422_TEST_BUDGET_US = 500;
+static constexpr uint8_t RS422_HELLO_PASSES = 10;     // hello lines every 10th pass (10 Hz)
+static constexpr uint32_t UI_BUDGET_US = 10000;
+// Background jobs: idle time needed to start, and longest wait before they run anyway.
+static constexpr uint32_t LOG_BUDGET_US = 200;
+static constexpr uint32_t LOG_MAX_WAIT_US = 5000;
+static constexpr uint32_t SLOTS_BUDGET_US = 500;
+static constexpr uint32_t SLOTS_MAX_WAIT_US = 20000;
+static constexpr uint32_t CONFIG_BUDGET_US = 200;
+static constexpr uint32_t CONFIG_MAX_WAIT_US = 100000;
+static constexpr uint32_t TRACE_BUDGET_US = 300;
+static constexpr uint32_t TRACE_MAX_WAIT_US = 20000;
+static constexpr uint32_t TRACE_WRITE_BYTES = 4096;  // SD write per pass while a trace runs
+
+// Application instance (defined below); console commands are forwarded to it.
+extern App g_app;
 
 /**
  * Description: Dispatch console commands for the application.
@@ -15,6 +66,52 @@ static void handleConsoleCommand(const CommandMsg &msg) {
   for (uint8_t i = 0; i < msg.argc; i++) {
     LOGI("  arg[%u]=%s", i, msg.argv[i]);
   }
+  g_app.handleCommand(msg);
+}
+
+/**
+ * Description: Scale the jog move limits by the speed/accel pots.
+ * Inputs:
+ * - speedScale: speed pot value (0..1).
+ * - accelScale: accel pot value (0..1).
+ * Outputs: Returns the velocity, acceleration and jerk limits to plan with.
+ */
+static MotionLimits scaledJogLimits(float speedScale, float accelScale) {
+  const float speed = (speedScale < JOG_MIN_SCALE) ? JOG_MIN_SCALE : speedScale;
+  const float accel = (accelScale < JOG_MIN_SCALE) ? JOG_MIN_SCALE : accelScale;
+  MotionLimits limits;
+  limits.maxVel = JOG_MAX_VEL * speed;
+  limits.maxAccel = JOG_MAX_ACCEL * accel;
+  limits.maxJerk = JOG_MAX_JERK * accel;
+  return limits;
+}
+
+/**
+ * Description: Map the speed pot to a playback rate with 1x at mid travel.
+ * Inputs:
+ * - speedNorm: speed pot value (0..1).
+ * Outputs: Returns 0.25..1.0 over the lower half and 1.0..2.0 over the upper half.
+ */
+static float playbackRateFromPot(float speedNorm) {
+  if (speedNorm < 0.5f) {
+    return 0.25f + speedNorm * 1.5f;
+  }
+  return 1.0f + (speedNorm - 0.5f) * 2.0f;
+}
+
+/**
+ * Description: Latch a pot value only when it moves past the hysteresis band.
+ * Inputs:
+ * - latched: previously latched value, updated in place.
+ * - pot: latest pot reading (0..1).
+ * Outputs: Returns true when the latched value changed.
+ */
+static bool latchPot(float &latched, float pot) {
+  if (fabsf(pot - latched) < POT_REPLAN_HYSTERESIS) {
+    return false;
+  }
+  latched = pot;
+  return true;
 }
 
 /**
@@ -32,102 +129,172 @@ void App::begin() {
   _enc.begin(PIN_ENC_A, PIN_ENC_B);
 
   _ui.begin();
+  // Defaults first; saved settings replace them when the EEPROM image is valid.
+  ConfigData& config = _config.data();
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    config.limits[ch].minPos = CHANNEL_MIN_POS;
+    config.limits[ch].maxPos = CHANNEL_MAX_POS;
+    config.limits[ch].maxVel = CHANNEL_MAX_VEL;
+    config.limits[ch].maxAccel = CHANNEL_MAX_ACCEL;
+  }
+  for (uint8_t p = 0; p < RS422_PORT_COUNT; p++) {
+    config.portBaud[p] = RS422_DEFAULT_BAUD;
+  }
+  config.traceAtBoot = 0;
+  const bool restored = _config.load();
+  LOGI("Config restore: %s", restored ? "OK" : "defaults");
+
   _show.begin();
+  _show.setChannelLimits(config.limits);
+  _show.setChannelTransforms(config.transforms);
+  _slots.setLimits(config.limits);
+  _slots.begin();
 
-  // Choose a starting baud for RoboClaw comms; we can change later.
-  _rs422.begin(115200);
+  // Per-port RoboClaw baud rates from config ('baud'/'tune' change them).
+  _rs422.begin(config.portBaud);
+  _motors.begin(&_rs422, config.limits);
+  _motors.attachStopInput(PIN_ESTOP);
+
+  const bool flightOk = _flight.begin();
+  LOGI("Flight recorder: %s, %lu KB", flightOk ? (_flight.inPsram() ? "PSRAM" : "RAM") : "FAIL",
+       (unsigned long)(_flight.blockCount() * FlightRecorder::BLOCK_BYTES / 1024u));
+
+  _jogProfile.setShape(ProfileShape::SCurve);
+  _jogProfile.reset(0.0f, micros());
 
   _model.playing = false;
   _model.selectedMotor = 0;
+
+  // A trace has to cover every task run from the first one to be replayable.
+  if (config.traceAtBoot) {
+    const bool traceOk = traceStart(&config, sizeof(config));
+    LOGI("Trace capture: %s", traceOk ? TRACE_FILE : "FAIL");
+  }
+
+  registerTasks();
 }
 
 /**
- * Description: Main application loop to update state and render UI.
+ * Description: Main application loop: one scheduler pass.
  * Inputs: None.
- * Outputs: Updates model values and drives outputs each tick.
+ * Outputs: Runs due tasks in priority order, then background jobs in idle time.
  */
 void App::loop() {
-  // Process console commands via USB serial of Teensy 4.1
-  _console.poll();
-
-  // Process button inputs from user interface.
-  InputState inputState = _input.poll();
-
-  // Update the jog wheel encoder counts.
-  inputState.encoderDelta = _enc.consumeDelta();
-  _model.jogPos += inputState.encoderDelta;
+  PROFILE_SCOPE(Loop);
+  _sched.runOnce();
+}
 
-  // TEST CODE
-  // Periodic serial test messages (10 Hz per port)
-  static uint32_t lastSerialTick = 0;
-  static uint32_t serialSeq[8] = {0};
-  if (millis() - lastSerialTick >= 100) {
-    lastSerialTick = millis();
-    for (uint8_t i = 0; i < 8; i++) {
-      auto* serialPort = _rs422.port(i).serial;
-      if (serialPort) {
-        serialPort->printf("Hello from port %u, %lu\r\n", (unsigned)i + 1, (unsigned long)serialSeq[i]++);
-      }
+/**
+ * Description: Register the loop tasks and background jobs with the scheduler.
+ * Inputs: None.
+ * Outputs: Fills the scheduler table; the first releases are due immediately.
+ */
+void App::registerTasks() {
+  _sched.begin(micros);
+  _sched.addTask("control", [](void* app) { static_cast<App*>(app)->controlTask(); }, this,
+                 CONTROL_PERIOD_US, 0, CONTROL_BUDGET_US);
+  _sched.addTask("input", [](void* app) { static_cast<App*>(app)->inputTask(); }, this,
+                 INPUT_PERIOD_US, 1, INPUT_BUDGET_US);
+  _sched.addTask("cues", [](void* app) { static_cast<App*>(app)->cuesTask(); }, this,
+                 CUES_PERIOD_US, 2, CUES_BUDGET_US);
+  _sched.addTask("console", [](void* app) { static_cast<App*>(app)->consoleTask(); }, this,
+                 CONSOLE_PERIOD_US, 3, CONSOLE_BUDGET_US);
+  _sched.addTask("rs422test", [](void* app) { static_cast<App*>(app)->rs422TestTask(); }, this,
+                 RS422_TEST_PERIOD_US, 4, RS422_TEST_BUDGET_US);
+  _sched.addTask("ui", [](void* app) { static_cast<App*>(app)->uiTask(); }, this,
+                 Ui::RENDER_PERIOD_MSEC * 1000u, 5, UI_BUDGET_US);
+  _sched.addBackground("log", [](void* app) { static_cast<App*>(app)->logTask(); }, this,
+                       LOG_BUDGET_US, LOG_MAX_WAIT_US);
+  _sched.addBackground("slots", [](void* app) { static_cast<App*>(app)->slotsTask(); }, this,
+                       SLOTS_BUDGET_US, SLOTS_MAX_WAIT_US);
+  _sched.addBackground("config", [](void* app) { static_cast<App*>(app)->configTask(); }, this,
+                       CONFIG_BUDGET_US, CONFIG_MAX_WAIT_US);
+  if (traceActive()) {
+    _sched.addBackground("trace", [](void* app) { static_cast<App*>(app)->traceTask(); }, this,
+                         TRACE_BUDGET_US, TRACE_MAX_WAIT_US);
+    for (uint8_t i = 0; i < _sched.taskCount(); i++) {
+      if (strcmp(_sched.task(i).name, "slots") == 0) _slotsJob = i;
     }
+    _sched.setRunHook(traceRunHook, this);
+  }
+}
 
-    // Dump status to console
-    Serial.printf("%d, %d, %d\n", (int)(_model.speedNorm * 100.0f), (int)(_model.accelNorm * 100.0f), _model.jogPos);
+/**
+ * Description: Scheduler run hook while a trace runs: e-stop level, then the Run record.
+ * Inputs:
+ * - task: task about to run.
+ * - index: its scheduler table index.
+ * - startUs: start time of the run (moved by a replay).
+ * - context: App instance.
+ * Outputs: Returns false when a replay holds a background job back.
+ */
+bool App::traceRunHook(const SchedulerTask& task, uint8_t index, uint32_t& startUs, void* context) {
+  App* app = static_cast<App*>(context);
+  // Background jobs run nearly every pass; only a show load changes what
+  // the tasks see, so the other jobs stay out of the trace.
+  if (task.periodUs == 0 && !(index == app->_slotsJob && app->_slots.loading())) {
+    return true;
   }
+  traceEstop((uint8_t)digitalReadFast(PIN_ESTOP));
+  return (task.periodUs == 0) ? traceJob(index, startUs) : traceRun(index, startUs);
+}
 
-  // Dump serial port RX traffic.
-  for (uint8_t i = 0; i < 8; i++) {
-    auto* serialPort = _rs422.port(i).serial;
-    if (serialPort) {
-      static char line[64];
-      line[0] = '\0';
-      uint8_t count = 0;
-      while (serialPort->available() && count < 16) {
-        const int b = serialPort->read();
-        const int written = snprintf(line + count * 3, sizeof(line) - count * 3, "%02X ", b & 0xFF);
-        (void)written;
-        count++;
-      }
-      if (count) {
-        LOGI("SER %d: RX: %s", i, line);
-      }
+/**
+ * Description: Console task: read USB serial and dispatch complete commands.
+ * Inputs: None.
+ * Outputs: Runs console command handlers.
+ */
+void App::consoleTask() {
+  PROFILE_SCOPE(Console);
+  _console.poll();
+}
 
-    }
+/**
+ * Description: Input task: buttons, pots, LEDs, jog wheel and trim editing.
+ * Inputs: None.
+ * Outputs: Updates _inputState and the model; plans jog/scrub moves; trips the stop on RUN/HALT.
+ */
+void App::inputTask() {
+  // Process button inputs from user interface.
+  {
+    PROFILE_SCOPE(Input);
+    _inputState = _input.poll();
   }
-  
-  // Toggle red led with red button
-  if (inputState.justPressed(Button::BUTTON_RED)) {
-    if (_input.getLedMode(LED::LED_RED_BUTTON) == LedMode::Off) {
-      _input.setLedMode(LED::LED_RED_BUTTON, LedMode::On);
-      Serial.println("Red LED to ON");
-    } else {
-      _input.setLedMode(LED::LED_RED_BUTTON, LedMode::Off);
-      Serial.println("Red LED to OFF");
-    }    
+  const InputState& inputState = _inputState;
+
+  // Update the jog wheel encoder counts.
+  _inputState.encoderDelta = _enc.consumeDelta();
+  traceEncoder(_inputState.encoderDelta);
+  _model.jogPos += inputState.encoderDelta;
+
+  // Red button is RUN/HALT: halt trips the same stop path as the e-stop input.
+  if (inputState.justPressed(Button::BUTTON_RED) && !_motors.isStopped()) {
+    _motors.emergencyStop(StopSource::Button);
   }
 
   if (inputState.justPressed(Button::BUTTON_YELLOW)) {
     if (_input.getLedMode(LED::LED_YELLOW_BUTTON) == LedMode::Off) {
       _input.setLedMode(LED::LED_YELLOW_BUTTON, LedMode::Blink);
-      Serial.println("Yellow LED to Blink");
+      LOGI("Yellow LED to Blink");
     } else {
       _input.setLedMode(LED::LED_YELLOW_BUTTON, LedMode::Off);
-      Serial.println("Yellow LED to Off");
+      LOGI("Yellow LED to Off");
     }    
   }
 
     if (inputState.justPressed(Button::BUTTON_GREEN)) {
     if (_input.getLedMode(LED::LED_GREEN_BUTTON) == LedMode::Off) {
       _input.setLedMode(LED::LED_GREEN_BUTTON, LedMode::Blink, 50, 450);
-      Serial.println("Green LED to Blink");
+      LOGI("Green LED to Blink");
     } else {
       _input.setLedMode(LED::LED_GREEN_BUTTON, LedMode::Off);
-      Serial.println("Green LED to Off");
+      LOGI("Green LED to Off");
     }    
   }
 
   for (uint8_t i = 0; i < 8; i++) {
     if (inputState.justPressed((Button)i)) {
-      Serial.printf("BUTTON %d pressed!\n", i);
+      LOGI("BUTTON %d pressed!", i);
     }
   }
   // // Button test: log events and mirror button->LED
@@ -155,14 +322,486 @@ void App::loop() {
   // if (inputState.justPressed(Button::BUTTON_UP)  && _model.selectedMotor > 0) _model.selectedMotor--;
   // if (inputState.justPressed(Button::BUTTON_OK) && _model.selectedMotor < 15) _model.selectedMotor++; // up to 16 motors later
 
-  // _model.showTimeMs = _show.currentTimeMs();
    _model.speedNorm  = inputState.potSpeedNorm;
    _model.accelNorm  = inputState.potAccelNorm;
 
-  // Update the user interface outputs with latest status.
+  // Jog move: the encoder moves the target, the pots scale the live limits.
+  // Pot changes replan from the current state so the move never restarts.
+  PROFILE_SCOPE(Jog);
+  const uint32_t nowUs = _sched.runStartUs();
+  const bool speedMoved = latchPot(_jogSpeedScale, inputState.potSpeedNorm);
+  const bool accelMoved = latchPot(_jogAccelScale, inputState.potAccelNorm);
+  _jogLimits = scaledJogLimits(_jogSpeedScale, _jogAccelScale);
+  const MotionLimits& jogLimits = _jogLimits;
+  const bool scrubbing = _show.show() && !_show.isPlaying();
+  if (handleTrimInput(inputState)) {
+    // Encoder consumed by the trim editor.
+  } else if (inputState.encoderDelta != 0 && scrubbing) {
+    // Paused with a show attached: the jog wheel scrubs show time instead.
+    int64_t scrubMs = (int64_t)_show.currentTimeMs() + (int64_t)inputState.encoderDelta * SCRUB_MS_PER_DETENT;
+    if (scrubMs < 0) scrubMs = 0;
+    cancelRecording("scrub");
+    _show.seek((uint32_t)scrubMs, jogLimits);
+  } else if (inputState.encoderDelta != 0) {
+    _jogProfile.moveTo((float)_model.jogPos * JOG_UNITS_PER_DETENT, jogLimits, nowUs);
+  } else if (speedMoved || accelMoved) {
+    _jogProfile.setLimits(jogLimits, nowUs);
+  }
+}
+
+/**
+ * Description: RS422 test traffic while motor output is off (the ports carry RoboClaw frames otherwise).
+ * Inputs: None.
+ * Outputs: Sends a hello line per port at 10 Hz and logs received bytes.
+ */
+void App::rs422TestTask() {
+  PROFILE_SCOPE(Rs422Test);
+  if (_motors.isEnabled()) {
+    return;
+  }
+
+  // Periodic serial test messages (10 Hz per port)
+  static uint32_t serialSeq[8] = {0};
+  if (++_rs422TestPasses >= RS422_HELLO_PASSES) {
+    _rs422TestPasses = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      auto* serialPort = _rs422.port(i).serial;
+      if (serialPort) {
+        char hello[48];
+        const int n = snprintf(hello, sizeof(hello), "Hello from port %u, %lu\r\n", (unsigned)i + 1,
+                               (unsigned long)serialSeq[i]++);
+        const size_t len = (n > 0) ? ((size_t)n < sizeof(hello) ? (size_t)n : sizeof(hello) - 1) : 0;
+        serialPort->write(reinterpret_cast<const uint8_t*>(hello), len);
+        traceTx(i, reinterpret_cast<const uint8_t*>(hello), len);
+      }
+    }
+
+    // Dump status to console
+    LOGI("%d, %d, %d", (int)(_model.speedNorm * 100.0f), (int)(_model.accelNorm * 100.0f), (int)_model.jogPos);
+  }
+
+  // Dump serial port RX traffic.
+  for (uint8_t i = 0; i < 8; i++) {
+    auto* serialPort = _rs422.port(i).serial;
+    if (serialPort) {
+      static char line[64];
+      line[0] = '\0';
+      uint8_t count = 0;
+      while (serialPort->available() && count < 16) {
+        const int b = serialPort->read();
+        traceRxByte(i, (uint8_t)b);
+        const int written = snprintf(line + count * 3, sizeof(line) - count * 3, "%02X ", b & 0xFF);
+        (void)written;
+        count++;
+      }
+      if (count) {
+        LOGI("SER %d: RX: %s", i, line);
+      }
+
+    }
+  }
+}
+
+/**
+ * Description: Control task: show clock, motor output, flight recorder and live recording.
+ * Inputs: None.
+ * Outputs: Sends one set of setpoints per period and records a flight snapshot.
+ */
+void App::controlTask() {
+  if (_motors.isStopped()) {
+    if (_show.isPlaying()) {
+      _show.setPlaying(false);
+      _model.playing = false;
+      if (_recorder.isRecording()) {
+        cancelRecording("e-stop");
+      }
+      const EStopStats& stop = _motors.stopStats();
+      LOGI("ESTOP: tripped, last byte out in %lu us (isr %lu ns); 'estop reset' to clear",
+           (unsigned long)stop.lastWorstUs, (unsigned long)stop.lastIsrNs);
+    }
+    _input.setLedMode(LED::LED_RED_BUTTON, LedMode::On);
+  } else if (_input.getLedMode(LED::LED_RED_BUTTON) == LedMode::On) {
+    _input.setLedMode(LED::LED_RED_BUTTON, LedMode::Off);
+  }
+
+  // One instant for the whole tick, so a trace replay makes the same decisions.
+  const uint32_t nowUs = _sched.runStartUs();
+  PROFILE_BEGIN(Jog);
+  const MotionSample jog = _jogProfile.sample(nowUs);
+  PROFILE_END(Jog);
+
+  // Rehearsal speed: the speed pot scrubs the playback rate (slew-limited in ShowEngine).
+  const float followScale = (_followLevel >= FollowLevel::SlowDown) ? FOLLOW_SLOW_RATE : 1.0f;
+  _show.setPlaybackRate(playbackRateFromPot(_jogSpeedScale) * followScale);
+  PROFILE_BEGIN(Show);
+  uint32_t releaseUs = 0;
+  if (_motors.takeSyncRelease(releaseUs) && _model.playing) {
+    _show.setPlaying(true);  // unless paused while the start was armed
+    LOGI("play: released on all ports");
+  }
+  _show.update();
+  PROFILE_END(Show);
+  // Each channel is evaluated ahead by its port's measured latency so all
+  // motors receive the setpoint for the same show instant.
+  {
+    PROFILE_SCOPE(Motors);
+    _motors.poll(nowUs);
+    updateFollowing();
+    applyFaultReactions();
+    _motors.applyLeads(_show);
+  }
+  {
+    PROFILE_SCOPE(Evaluate);
+    _show.evaluate();
+  }
+  {
+    PROFILE_SCOPE(Send);
+    _motors.send(_show, nowUs);
+  }
+  {
+    PROFILE_SCOPE(Flight);
+    recordFlight(_inputState);
+  }
+
+  // Live recording: the recorded channel follows the input while the rest play back.
+  if (_recorder.isRecording()) {
+    if (_show.show() != _recordShow) {
+      cancelRecording("show changed");
+    } else if (!_show.isApproaching()) {
+      ChannelSetpoint live;
+      switch (_recordSource) {
+        case RecordSource::SpeedPot:
+          live.pos = _inputState.potSpeedNorm * RECORD_POT_RANGE;
+          break;
+        case RecordSource::AccelPot:
+          live.pos = _inputState.potAccelNorm * RECORD_POT_RANGE;
+          break;
+        case RecordSource::Jog:
+        default:
+          live.pos = jog.pos;
+          live.vel = jog.vel;
+          break;
+      }
+      _recorder.sample(_show.currentTimeMs(), live.pos);
+      _show.setLiveSetpoint(_recorder.channel(), live);
+    }
+  }
+  discardStaleTakes();
+
+  publishStatus(jog);
+}
+
+/**
+ * Description: Publish this control tick's state for the UI.
+ * Inputs:
+ * - jog: jog profile sample of this tick.
+ * Outputs: Fills the status back buffer and swaps it in (never waits for the UI).
+ */
+void App::publishStatus(const MotionSample& jog) {
+  ControlStatus& status = _status.back();
+  status.showTimeMs = _show.currentTimeMs();
+  status.playbackRate = _show.playbackRate();
+  status.motionPos = jog.pos;
+  status.motionVel = jog.vel;
+  status.faults = faults_active();
+  status.fault = _faultShown;
+  status.stopped = _motors.isStopped();
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    ChannelStatus& c = status.channels[ch];
+    ChannelTelemetry t;
+    _motors.telemetry().read(ch, t);
+    c.target = 0;
+    _motors.commandedPos(ch, c.target);
+    c.position = t.encoder;
+    c.currentCa = t.currentCa;
+  }
+  _status.publish();
+}
+
+/**
+ * Description: UI task: refresh the model and render the display.
+ * Inputs: None.
+ * Outputs: Draws one frame per render period.
+ */
+void App::uiTask() {
+  PROFILE_SCOPE(Ui);
+  _status.update();
+  const ControlStatus& status = _status.front();
+  _model.showTimeMs = status.showTimeMs;
+  _model.playbackRate = status.playbackRate;
+  _model.motionPos = status.motionPos;
+  _model.motionVel = status.motionVel;
+  _model.stopped = status.stopped;
+  _model.fault = status.fault;
+  _model.channel = status.channels[_model.selectedMotor];
+  _model.trimActive = _trimActive;
+  _model.trimField = _trimField;
+  _model.trim = _config.data().transforms[_model.selectedMotor];
   _ui.render(_model);
 }
 
+/**
+ * Description: Cue task: perform discrete show events off the control path.
+ * Inputs: None.
+ * Outputs: Drains up to CUE_DRAIN_PER_PASS events.
+ */
+void App::cuesTask() {
+  PROFILE_SCOPE(Cues);
+  _show.cues().drain(showCueThunk, this, CUE_DRAIN_PER_PASS);
+}
+
+/**
+ * Description: Background job: load shows into the inactive slot (SD prefetch).
+ * Inputs: None.
+ * Outputs: Advances a pending load by one step.
+ */
+void App::slotsTask() {
+  PROFILE_SCOPE(Slots);
+  _slots.poll();
+}
+
+/**
+ * Description: Background job: deferred settings save after trim/limit edits.
+ * Inputs: None.
+ * Outputs: Writes the EEPROM image once edits have settled.
+ */
+void App::configTask() {
+  PROFILE_SCOPE(Config);
+  _config.poll();
+}
+
+/**
+ * Description: Background job: write the trace capture to SD.
+ * Inputs: None.
+ * Outputs: Writes one chunk of queued trace records.
+ */
+void App::traceTask() {
+  PROFILE_SCOPE(Trace);
+  traceWrite(TRACE_WRITE_BYTES);
+}
+
+/**
+ * Description: Background job: log formatting and console/flight USB output.
+ * Inputs: None.
+ * Outputs: Formats queued log lines and sends only what USB accepts without blocking.
+ */
+void App::logTask() {
+  PROFILE_SCOPE(Log);
+  logDrain(LOG_DRAIN_PER_PASS);
+  // A flight dump starts once queued console text is out and then owns
+  // USB until its END line; later console output waits in its lanes.
+  if (_flight.dumping() && (_flight.dumpStarted() || !consoleTxPending())) {
+    _flight.pollDump();
+  } else {
+    consoleTxPoll();
+  }
+}
+
+/**
+ * Description: Apply the fault reaction table (once per control tick).
+ * Inputs: None.
+ * Outputs: Trips the e-stop, blinks the RUN/HALT LED and sets the UI fault text for active faults.
+ */
+void App::applyFaultReactions() {
+  const uint32_t active = faults_active() & FAULT_REACTION_MASK;
+  if ((active | _faultsReacted) == 0) {
+    return; // common case: nothing active now or last tick
+  }
+
+  if ((active & FAULT_STOP_MASK) && !_motors.isStopped()) {
+    _motors.emergencyStop(StopSource::Fault);
+  }
+
+  // The LED is solid while stopped (see loop()); blink only while running.
+  const bool blink = (active & FAULT_BLINK_MASK) && !_motors.isStopped();
+  const LedMode led = _input.getLedMode(LED::LED_RED_BUTTON);
+  if (blink && led != LedMode::Blink) {
+    _input.setLedMode(LED::LED_RED_BUTTON, LedMode::Blink, FAULT_BLINK_MS, FAULT_BLINK_MS);
+  } else if (!blink && led == LedMode::Blink) {
+    _input.setLedMode(LED::LED_RED_BUTTON, LedMode::Off);
+  }
+
+  // Lowest-numbered fault with the degrade reaction is shown.
+  const uint32_t degrade = active & FAULT_DEGRADE_MASK;
+  _faultShown = degrade ? FAULT_STRING[__builtin_ctz(degrade)] : nullptr;
+
+  if (active != _faultsReacted) {
+    LOGI("FAULT: reactions for 0x%08lX (was 0x%08lX)", (unsigned long)active, (unsigned long)_faultsReacted);
+  }
+  _faultsReacted = active;
+}
+
+/**
+ * Description: Take a flight recorder snapshot when one is due.
+ * Inputs:
+ * - inputState: latest input snapshot.
+ * Outputs: Records show time, faults, inputs, flags and per-channel target/position/current.
+ */
+void App::recordFlight(const InputState& inputState) {
+  static_assert(FLIGHT_CHANNELS == SHOW_MAX_CHANNELS, "flight frames carry every show channel");
+  const uint32_t nowUs = micros();
+  if (!_flight.due(nowUs)) {
+    return;
+  }
+  uint32_t values[FLIGHT_FIELD_COUNT];
+  uint32_t buttons = 0;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    if (inputState.isPressed[i]) buttons |= 1u << i;
+  }
+  uint32_t flags = (uint32_t)_followLevel << FLIGHT_FOLLOW_SHIFT;
+  if (_show.isPlaying()) flags |= FLIGHT_FLAG_PLAYING;
+  if (_motors.isStopped()) flags |= FLIGHT_FLAG_STOPPED;
+  if (_motors.isEnabled()) flags |= FLIGHT_FLAG_MOTORS_ON;
+  if (_show.isApproaching()) flags |= FLIGHT_FLAG_APPROACHING;
+  if (_recorder.isRecording()) flags |= FLIGHT_FLAG_RECORDING;
+
+  values[(uint8_t)FlightField::TimeUs] = nowUs;
+  values[(uint8_t)FlightField::ShowTimeMs] = _show.currentTimeMs();
+  values[(uint8_t)FlightField::Faults] = faults_active();
+  values[(uint8_t)FlightField::Buttons] = buttons;
+  values[(uint8_t)FlightField::PotSpeed] = (uint32_t)(inputState.potSpeedNorm * 1000.0f);
+  values[(uint8_t)FlightField::PotAccel] = (uint32_t)(inputState.potAccelNorm * 1000.0f);
+  values[(uint8_t)FlightField::JogPos] = (uint32_t)_model.jogPos;
+  values[(uint8_t)FlightField::Flags] = flags;
+  for (uint8_t ch = 0; ch < FLIGHT_CHANNELS; ch++) {
+    uint32_t* v = &values[(uint8_t)FlightField::Channels + ch * FLIGHT_CHANNEL_FIELDS];
+    int32_t target = 0;
+    _motors.commandedPos(ch, target);
+    ChannelTelemetry t;
+    _motors.telemetry().read(ch, t);
+    v[(uint8_t)FlightChannelField::Target] = (uint32_t)target;
+    v[(uint8_t)FlightChannelField::Position] = (uint32_t)t.encoder;
+    v[(uint8_t)FlightChannelField::CurrentCa] = (uint32_t)(int32_t)t.currentCa;
+  }
+
+  const bool wasFrozen = _flight.frozen();
+  _flight.record(values);
+  if (_flight.frozen() && !wasFrozen) {
+    LOGI("FLIGHT: frozen after fault 0x%08lX ('flight dump' to download)", (unsigned long)_flight.triggerFaults());
+  }
+}
+
+/**
+ * Description: Feed fresh encoder readings to the following error monitor and act on its level.
+ * Inputs: None.
+ * Outputs: Sets/clears following faults; slows playback or trips the e-stop on escalation.
+ */
+void App::updateFollowing() {
+  for (uint8_t ch = 0; ch < SHOW_MAX_CHANNELS; ch++) {
+    int32_t commanded = 0;
+    if (!_motors.commandedPos(ch, commanded)) {
+      continue;
+    }
+    ChannelTelemetry t;
+    _motors.telemetry().read(ch, t);
+    const uint32_t sampleUs = t.updatedUs[(uint8_t)TelemetryField::Position];
+    if (sampleUs != 0) {
+      _follow.sample(ch, (float)commanded, (float)t.encoder, sampleUs);
+    }
+  }
+
+  const FollowLevel level = _follow.level();
+  if (level == _followLevel) {
+    return;
+  }
+  static const char* const LEVEL_NAMES[] = {"ok", "warning", "slow down", "stop"};
+  LOGI("FOLLOW: %s -> %s", LEVEL_NAMES[(uint8_t)_followLevel], LEVEL_NAMES[(uint8_t)level]);
+  _followLevel = level;
+  if (level >= FollowLevel::Warning) FAULT_SET(FAULT_FOLLOWING_WARNING); else FAULT_CLEAR(FAULT_FOLLOWING_WARNING);
+  if (level >= FollowLevel::SlowDown) FAULT_SET(FAULT_FOLLOWING_SLOWDOWN); else FAULT_CLEAR(FAULT_FOLLOWING_SLOWDOWN);
+  if (level == FollowLevel::Stop) {
+    FAULT_SET(FAULT_FOLLOWING_STOP);
+    _motors.emergencyStop(StopSource::Following);
+  }
+}
+
+/**
+ * Description: Handle the front-panel trim editor.
+ * Inputs:
+ * - inputState: latest input snapshot.
+ * Outputs: Returns true when the encoder was consumed by the editor.
+ */
+bool App::handleTrimInput(const InputState& inputState) {
+  if (inputState.justPressed(Button::BUTTON_OK)) {
+    _trimActive = !_trimActive;
+    LOGI("Trim %s (ch %u)", _trimActive ? "ON" : "OFF", _model.selectedMotor);
+  }
+  if (!_trimActive) {
+    return false;
+  }
+
+  if (inputState.justPressed(Button::BUTTON_UP) && _model.selectedMotor > 0) _model.selectedMotor--;
+  if (inputState.justPressed(Button::BUTTON_DOWN) && _model.selectedMotor < SHOW_MAX_CHANNELS - 1) _model.selectedMotor++;
+  const uint8_t fieldCount = (uint8_t)TrimField::COUNT;
+  if (inputState.justPressed(Button::BUTTON_LEFT)) _trimField = (uint8_t)((_trimField + fieldCount - 1) % fieldCount);
+  if (inputState.justPressed(Button::BUTTON_RIGHT)) _trimField = (uint8_t)((_trimField + 1) % fieldCount);
+
+  const int32_t delta = inputState.encoderDelta;
+  if (delta == 0) {
+    return true;
+  }
+  ChannelTransform& xf = _config.data().transforms[_model.selectedMotor];
+  switch ((TrimField)_trimField) {
+    case TrimField::Gain:
+      xf.gainQ16 += delta * TRIM_GAIN_STEP_Q16;
+      break;
+    case TrimField::Offset:
+      xf.offset += delta * TRIM_OFFSET_STEP;
+      break;
+    case TrimField::Shift: {
+      const int32_t shift = (int32_t)xf.timeOffsetMs + delta * TRIM_SHIFT_STEP_MS;
+      xf.timeOffsetMs = (int16_t)((shift > INT16_MAX) ? INT16_MAX : (shift < INT16_MIN) ? INT16_MIN : shift);
+      break;
+    }
+    case TrimField::Invert:
+      xf.invert ^= 1u;
+      break;
+    default:
+      break;
+  }
+  settingsChanged();
+  return true;
+}
+
+/**
+ * Description: Cue scheduler callback adapter.
+ * Inputs:
+ * - event: event drained from the cue scheduler.
+ * - context: App instance.
+ * Outputs: Forwards to handleShowCue().
+ */
+void App::showCueThunk(const ShowEvent& event, void* context) {
+  static_cast<App*>(context)->handleShowCue(event);
+}
+
+/**
+ * Description: Perform a discrete show event.
+ * Inputs:
+ * - event: event drained from the cue scheduler.
+ * Outputs: Drives LEDs/outputs, logs audio cues, or applies mark actions.
+ */
+void App::handleShowCue(const ShowEvent& event) {
+  switch ((ShowEventType)event.type) {
+    case ShowEventType::Output:
+      if (event.target < LED_COUNT) {
+        _input.setLedSteady(static_cast<LED>(event.target), (uint8_t)(event.value > 255 ? 255 : event.value));
+      }
+      break;
+    case ShowEventType::Audio:
+      LOGI("CUE %lu: audio player %u clip %u", (unsigned long)event.timeMs, event.target, event.value);
+      break;
+    case ShowEventType::Mark:
+      LOGI("CUE %lu: mark %u", (unsigned long)event.timeMs, event.value);
+      if ((ShowMarkAction)event.value == ShowMarkAction::Pause) {
+        _show.setPlaying(false);
+        _model.playing = false;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
 App g_app;
 
 /**
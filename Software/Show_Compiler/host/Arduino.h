@@ -0,0 +1,11 @@
+#pragma once
+// Minimal stand-in for the Arduino core so the firmware's track and show
+// sources build on the host. Only plain types and memory attributes are used.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#define DMAMEM
+#define FASTRUN
+#define EXTMEM
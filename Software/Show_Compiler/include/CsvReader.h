@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Dense per-frame channel curves: one time column plus one column per channel.
+struct MotionTable {
+  std::vector<std::string> names;           // channel names (header row, or ch<N>)
+  std::vector<double> timesMs;              // sample times in milliseconds
+  std::vector<std::vector<float>> channels; // [channel][row]
+};
+
+// Parses animation exports of the form "time,ch0,ch1,..." (an optional header
+// row names the channels). Large files are split at line boundaries and
+// parsed on several threads.
+class CsvReader {
+public:
+  /**
+   * Description: Read a motion CSV file.
+   * Inputs:
+   * - path: file to read.
+   * - fps: when > 0 the first column is a frame number at this rate,
+   *        otherwise it is time in seconds.
+   * - threads: worker threads to parse with.
+   * - out: receives the table.
+   * Outputs: Returns false with error() set on a read or parse failure.
+   */
+  bool read(const char* path, double fps, unsigned threads, MotionTable& out);
+
+  /**
+   * Description: Get the last error message.
+   * Inputs: None.
+   * Outputs: Returns the error text (empty after success).
+   */
+  const std::string& error() const { return _error; }
+
+private:
+  std::string _error;
+};
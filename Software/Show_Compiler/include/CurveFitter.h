@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "Track.h"
+
+struct FitOptions {
+  float tolerance = 1.0f; // max |input - track| in channel units
+  float scale = 1.0f;     // input value -> channel units
+  float maxVel = 0.0f;    // units/s, 0 = not checked
+  float maxAccel = 0.0f;  // units/s^2, 0 = not checked
+};
+
+struct FitResult {
+  std::vector<TrackKey> keys;
+  std::vector<TrackCheckpoint> checkpoints;
+  uint32_t samples = 0;      // input samples used (after the 1 ms resample)
+  uint32_t durationMs = 0;   // time of the last key
+  float maxError = 0.0f;     // worst |input - track| at the sample times
+  float rmsError = 0.0f;
+  float peakVel = 0.0f;      // units/s
+  float peakAccel = 0.0f;    // units/s^2, over ACCEL_WINDOW_MS
+  uint32_t velViolations = 0;   // windows over maxVel
+  uint32_t accelViolations = 0; // windows over maxAccel
+  uint32_t firstViolationMs = 0;
+  bool ok = false;
+};
+
+// Fits one channel's dense samples with the fewest eased keys that keep every
+// sample within the tolerance. Segments are grown greedily (gallop, then
+// bisection) and each is given the easing curve that fits it best; the fit
+// is measured with Track::sample() so it matches playback exactly.
+class CurveFitter {
+public:
+  static constexpr uint32_t ACCEL_WINDOW_MS = 10; // kinematic check resolution
+
+  /**
+   * Description: Create a fitter.
+   * Inputs:
+   * - options: tolerance, scaling and kinematic limits.
+   * Outputs: None.
+   */
+  explicit CurveFitter(const FitOptions& options) : _options(options) {}
+
+  /**
+   * Description: Fit one channel.
+   * Inputs:
+   * - timesMs: sample times in milliseconds (increasing).
+   * - values: input values (scaled by FitOptions::scale).
+   * - count: number of samples.
+   * - out: receives keys, checkpoints and statistics.
+   * Outputs: Returns false if the channel cannot be encoded.
+   */
+  bool fit(const double* timesMs, const float* values, size_t count, FitResult& out) const;
+
+private:
+  /**
+   * Description: Measure the worst error of one segment with one easing curve.
+   * Inputs:
+   * - a: first sample index (segment start key).
+   * - b: last sample index (segment end key).
+   * - ease: easing curve to test.
+   * - limit: stop early once the error exceeds this.
+   * Outputs: Returns the max error over samples a..b.
+   */
+  float segmentError(size_t a, size_t b, Ease ease, float limit) const;
+
+  /**
+   * Description: Check whether some easing curve fits a segment.
+   * Inputs:
+   * - a: first sample index.
+   * - b: last sample index.
+   * - ease: receives the best fitting curve.
+   * Outputs: Returns true when the segment is encodable and within tolerance.
+   */
+  bool segmentFits(size_t a, size_t b, Ease& ease) const;
+
+  /**
+   * Description: Scan the fitted track for velocity/acceleration limits.
+   * Inputs:
+   * - track: fitted track.
+   * - out: receives peaks and violation counts.
+   * Outputs: None.
+   */
+  void checkKinematics(const Track& track, FitResult& out) const;
+
+  FitOptions _options;
+  // Working set for the channel being fitted (fit() is const but not shared
+  // between threads; each worker owns its fitter).
+  mutable std::vector<uint32_t> _t;  // sample times, whole ms
+  mutable std::vector<float> _v;     // sample values, channel units
+  mutable std::vector<int32_t> _k;   // rounded key value at each sample
+};
@@ -0,0 +1,216 @@
+#include "CsvReader.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+/**
+ * Description: Skip spaces and tabs.
+ * Inputs:
+ * - p: current position.
+ * - end: end of the line.
+ * Outputs: Returns the first non-blank position.
+ */
+static inline const char* skipBlanks(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) p++;
+  return p;
+}
+
+/**
+ * Description: Parse one comma separated line of numbers.
+ * Inputs:
+ * - p: start of the line.
+ * - end: end of the line (excluding the newline).
+ * - out: receives the values.
+ * - maxFields: capacity of out.
+ * Outputs: Returns the number of fields parsed, or -1 on a malformed field.
+ */
+static int parseNumbers(const char* p, const char* end, double* out, size_t maxFields) {
+  size_t count = 0;
+  while (p < end) {
+    p = skipBlanks(p, end);
+    if (count >= maxFields) return -1;
+    const std::from_chars_result r = std::from_chars(p, end, out[count]);
+    if (r.ec != std::errc()) return -1;
+    count++;
+    p = skipBlanks(r.ptr, end);
+    if (p < end) {
+      if (*p != ',') return -1;
+      p++;
+    }
+  }
+  return (int)count;
+}
+
+/**
+ * Description: Find the end of the line starting at p.
+ * Inputs:
+ * - p: start of the line.
+ * - end: end of the buffer.
+ * - next: receives the start of the following line.
+ * Outputs: Returns the line end without any trailing '\r'.
+ */
+static inline const char* lineEnd(const char* p, const char* end, const char*& next) {
+  const char* nl = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+  const char* stop = nl ? nl : end;
+  next = nl ? nl + 1 : end;
+  if (stop > p && stop[-1] == '\r') stop--;
+  return stop;
+}
+
+/**
+ * Description: Read a motion CSV file.
+ * Inputs:
+ * - path: file to read.
+ * - fps: when > 0 the first column is a frame number at this rate.
+ * - threads: worker threads to parse with.
+ * - out: receives the table.
+ * Outputs: Returns false with error() set on a read or parse failure.
+ */
+bool CsvReader::read(const char* path, double fps, unsigned threads, MotionTable& out) {
+  _error.clear();
+  out = MotionTable{};
+
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    _error = std::string("cannot open ") + path;
+    return false;
+  }
+  std::string text;
+  fseek(file, 0, SEEK_END);
+  const long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  text.resize(length > 0 ? (size_t)length : 0);
+  const size_t got = text.empty() ? 0 : fread(&text[0], 1, text.size(), file);
+  fclose(file);
+  if (got != text.size()) {
+    _error = std::string("short read on ") + path;
+    return false;
+  }
+
+  const char* p = text.data();
+  const char* end = p + text.size();
+
+  // Header: a first line that does not start with a number names the columns.
+  const char* next = nullptr;
+  const char* stop = lineEnd(p, end, next);
+  const char* first = skipBlanks(p, stop);
+  double probe = 0.0;
+  const bool hasHeader = (first < stop) && std::from_chars(first, stop, probe).ec != std::errc();
+  size_t columns = 0;
+  if (hasHeader) {
+    const char* field = p;
+    while (field <= stop) {
+      const char* comma = static_cast<const char*>(memchr(field, ',', (size_t)(stop - field)));
+      const char* fieldEnd = comma ? comma : stop;
+      const char* a = skipBlanks(field, fieldEnd);
+      const char* b = fieldEnd;
+      while (b > a && (b[-1] == ' ' || b[-1] == '\t')) b--;
+      if (columns > 0) out.names.emplace_back(a, b);
+      columns++;
+      if (!comma) break;
+      field = comma + 1;
+    }
+    p = next;
+  } else {
+    for (const char* c = p; c < stop; c++) {
+      if (*c == ',') columns++;
+    }
+    columns++;
+  }
+  if (columns < 2) {
+    _error = "need a time column and at least one channel column";
+    return false;
+  }
+  const size_t channelCount = columns - 1;
+  if (out.names.empty()) {
+    for (size_t ch = 0; ch < channelCount; ch++) {
+      out.names.push_back("ch" + std::to_string(ch));
+    }
+  }
+
+  // Split the body at line boundaries, one chunk per thread.
+  if (threads == 0) threads = 1;
+  std::vector<const char*> bounds(threads + 1, end);
+  bounds[0] = p;
+  for (unsigned i = 1; i < threads; i++) {
+    const char* cut = p + (size_t)(end - p) * i / threads;
+    if (cut < bounds[i - 1]) cut = bounds[i - 1];
+    const char* nl = static_cast<const char*>(memchr(cut, '\n', (size_t)(end - cut)));
+    bounds[i] = nl ? nl + 1 : end;
+  }
+
+  // Pass 1: count data rows per chunk so every row has a fixed destination.
+  std::vector<size_t> rowStart(threads + 1, 0);
+  std::vector<std::thread> workers;
+  std::vector<size_t> rowCounts(threads, 0);
+  for (unsigned i = 0; i < threads; i++) {
+    workers.emplace_back([&, i]() {
+      size_t rows = 0;
+      for (const char* q = bounds[i]; q < bounds[i + 1];) {
+        const char* n = nullptr;
+        const char* e = lineEnd(q, bounds[i + 1], n);
+        if (skipBlanks(q, e) < e) rows++;
+        q = n;
+      }
+      rowCounts[i] = rows;
+    });
+  }
+  for (std::thread& t : workers) t.join();
+  workers.clear();
+  for (unsigned i = 0; i < threads; i++) {
+    rowStart[i + 1] = rowStart[i] + rowCounts[i];
+  }
+  const size_t rowCount = rowStart[threads];
+
+  out.timesMs.resize(rowCount);
+  out.channels.assign(channelCount, std::vector<float>(rowCount));
+
+  // Pass 2: parse straight into the column arrays.
+  std::vector<std::string> errors(threads);
+  for (unsigned i = 0; i < threads; i++) {
+    workers.emplace_back([&, i]() {
+      std::vector<double> fields(columns);
+      size_t row = rowStart[i];
+      for (const char* q = bounds[i]; q < bounds[i + 1];) {
+        const char* n = nullptr;
+        const char* e = lineEnd(q, bounds[i + 1], n);
+        if (skipBlanks(q, e) < e) {
+          if (parseNumbers(q, e, fields.data(), columns) != (int)columns) {
+            errors[i] = "malformed data row " + std::to_string(row + 1);
+            return;
+          }
+          out.timesMs[row] = (fps > 0.0) ? fields[0] * 1000.0 / fps : fields[0] * 1000.0;
+          for (size_t ch = 0; ch < channelCount; ch++) {
+            out.channels[ch][row] = (float)fields[ch + 1];
+          }
+          row++;
+        }
+        q = n;
+      }
+    });
+  }
+  for (std::thread& t : workers) t.join();
+  for (const std::string& e : errors) {
+    if (!e.empty()) {
+      _error = e;
+      return false;
+    }
+  }
+
+  if (rowCount < 2) {
+    _error = "need at least two data rows";
+    return false;
+  }
+  for (size_t row = 1; row < rowCount; row++) {
+    if (!(out.timesMs[row] > out.timesMs[row - 1])) {
+      _error = "time does not increase at data row " + std::to_string(row + 1);
+      return false;
+    }
+  }
+  if (out.timesMs[0] < 0.0) {
+    _error = "negative time at data row 1";
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,217 @@
+#include "CurveFitter.h"
+#include "TrackBuilder.h"
+#include <cmath>
+
+static constexpr uint32_t MAX_SEGMENT_MS = 0xFFFF;  // TrackKey::dtMs
+static constexpr int32_t MAX_SEGMENT_DVALUE = 0x7FFF; // TrackKey::dValue
+static constexpr Ease FIT_EASES[] = {Ease::Linear, Ease::Smooth, Ease::EaseIn, Ease::EaseOut};
+
+/**
+ * Description: Measure the worst error of one segment with one easing curve.
+ * Inputs:
+ * - a: first sample index.
+ * - b: last sample index.
+ * - ease: easing curve to test.
+ * - limit: stop early once the error exceeds this.
+ * Outputs: Returns the max error over samples a..b.
+ */
+float CurveFitter::segmentError(size_t a, size_t b, Ease ease, float limit) const {
+  TrackCursor cursor;
+  cursor.t0 = _t[a];
+  cursor.t1 = _t[b];
+  cursor.v0 = _k[a];
+  cursor.v1 = _k[b];
+  cursor.ease = (uint8_t)ease;
+  float worst = 0.0f;
+  for (size_t i = a; i <= b; i++) {
+    const float err = fabsf(Track::sample(cursor, (uint64_t)_t[i] * 1000u).pos - _v[i]);
+    if (err > worst) {
+      worst = err;
+      if (worst > limit) break;
+    }
+  }
+  return worst;
+}
+
+/**
+ * Description: Check whether some easing curve fits a segment.
+ * Inputs:
+ * - a: first sample index.
+ * - b: last sample index.
+ * - ease: receives the best fitting curve.
+ * Outputs: Returns true when the segment is encodable and within tolerance.
+ */
+bool CurveFitter::segmentFits(size_t a, size_t b, Ease& ease) const {
+  if (_t[b] - _t[a] > MAX_SEGMENT_MS || std::abs(_k[b] - _k[a]) > MAX_SEGMENT_DVALUE) {
+    return false;
+  }
+  float best = _options.tolerance;
+  bool found = false;
+  for (Ease candidate : FIT_EASES) {
+    const float err = segmentError(a, b, candidate, best);
+    if (err <= best) {
+      best = err;
+      ease = candidate;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**
+ * Description: Fit one channel.
+ * Inputs:
+ * - timesMs: sample times in milliseconds (increasing).
+ * - values: input values (scaled by FitOptions::scale).
+ * - count: number of samples.
+ * - out: receives keys, checkpoints and statistics.
+ * Outputs: Returns false if the channel cannot be encoded.
+ */
+bool CurveFitter::fit(const double* timesMs, const float* values, size_t count, FitResult& out) const {
+  out = FitResult{};
+
+  // Resample onto whole milliseconds (the key time base); frames that land
+  // on the same millisecond keep the first value.
+  _t.clear();
+  _v.clear();
+  _k.clear();
+  for (size_t i = 0; i < count; i++) {
+    const uint32_t t = (uint32_t)llround(timesMs[i]);
+    if (!_t.empty() && t <= _t.back()) continue;
+    const float v = values[i] * _options.scale;
+    _t.push_back(t);
+    _v.push_back(v);
+    _k.push_back((int32_t)lroundf(v));
+  }
+  const size_t n = _t.size();
+  out.samples = (uint32_t)n;
+  if (n == 0) {
+    return false;
+  }
+
+  // Greedy segmentation: gallop forward while a segment still fits, then
+  // bisect between the last fit and the first miss.
+  std::vector<uint32_t> keyAt;   // sample index of each key
+  std::vector<Ease> keyEase;
+  size_t a = 0;
+  while (a + 1 < n) {
+    Ease ease = Ease::Linear;
+    size_t good = a + 1;
+    Ease goodEase = Ease::Linear;
+    if (!segmentFits(a, good, goodEase)) {
+      goodEase = Ease::Linear; // adjacent samples: exact up to key rounding
+    }
+    size_t bad = n;
+    for (size_t step = 2;; step *= 2) {
+      const size_t cand = (a + step < n) ? a + step : n - 1;
+      if (cand <= good) break;
+      if (segmentFits(a, cand, ease)) {
+        good = cand;
+        goodEase = ease;
+        if (cand == n - 1) break;
+      } else {
+        bad = cand;
+        break;
+      }
+    }
+    while (bad < n && bad - good > 1) {
+      const size_t mid = good + (bad - good) / 2;
+      if (segmentFits(a, mid, ease)) {
+        good = mid;
+        goodEase = ease;
+      } else {
+        bad = mid;
+      }
+    }
+    keyAt.push_back((uint32_t)a);
+    keyEase.push_back(goodEase);
+    a = good;
+  }
+  keyAt.push_back((uint32_t)(n - 1));
+  keyEase.push_back(Ease::Step);
+
+  // Encode with the firmware's builder; segments were kept within the key
+  // delta ranges, so no keys are split.
+  out.keys.resize(keyAt.size());
+  out.checkpoints.resize(Track::checkpointsFor((uint32_t)keyAt.size()));
+  TrackBuilder builder;
+  builder.begin(out.keys.data(), (uint32_t)out.keys.size(),
+                out.checkpoints.data(), (uint32_t)out.checkpoints.size());
+  for (size_t i = 0; i < keyAt.size(); i++) {
+    if (!builder.append(_t[keyAt[i]], _k[keyAt[i]], keyEase[i])) {
+      return false;
+    }
+  }
+  Track track;
+  if (!builder.attach(track)) {
+    return false;
+  }
+  out.durationMs = track.durationMs();
+
+  // Fit error as played back.
+  TrackCursor cursor;
+  track.seek(cursor, _t[0]);
+  double sumSq = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    track.advance(cursor, _t[i]);
+    const float err = fabsf(Track::sample(cursor, (uint64_t)_t[i] * 1000u).pos - _v[i]);
+    if (err > out.maxError) out.maxError = err;
+    sumSq += (double)err * err;
+  }
+  out.rmsError = (float)sqrt(sumSq / (double)n);
+
+  checkKinematics(track, out);
+  out.ok = true;
+  return true;
+}
+
+/**
+ * Description: Scan the fitted track for velocity/acceleration limits.
+ * Inputs:
+ * - track: fitted track.
+ * - out: receives peaks and violation counts.
+ * Outputs: None.
+ */
+void CurveFitter::checkKinematics(const Track& track, FitResult& out) const {
+  if (track.keyCount() < 2) {
+    return;
+  }
+  // Velocity and acceleration from positions one control window apart, so
+  // corners between linear keys read as the acceleration a motor would need
+  // to follow them at that update rate.
+  const float window = (float)ACCEL_WINDOW_MS * 1e-3f;
+  TrackCursor cursor;
+  uint32_t t = _t[0];
+  track.seek(cursor, t);
+  float prevPos = Track::sample(cursor, (uint64_t)t * 1000u).pos;
+  float prevVel = 0.0f;
+  bool havePrevVel = false;
+  bool anyViolation = false;
+  for (t += ACCEL_WINDOW_MS; t <= out.durationMs; t += ACCEL_WINDOW_MS) {
+    track.advance(cursor, t);
+    const float pos = Track::sample(cursor, (uint64_t)t * 1000u).pos;
+    const float vel = (pos - prevPos) / window;
+    const float speed = fabsf(vel);
+    if (speed > out.peakVel) out.peakVel = speed;
+    bool violated = false;
+    if (_options.maxVel > 0.0f && speed > _options.maxVel) {
+      out.velViolations++;
+      violated = true;
+    }
+    if (havePrevVel) {
+      const float accel = fabsf(vel - prevVel) / window;
+      if (accel > out.peakAccel) out.peakAccel = accel;
+      if (_options.maxAccel > 0.0f && accel > _options.maxAccel) {
+        out.accelViolations++;
+        violated = true;
+      }
+    }
+    if (violated && !anyViolation) {
+      out.firstViolationMs = t;
+      anyViolation = true;
+    }
+    prevPos = pos;
+    prevVel = vel;
+    havePrevVel = true;
+  }
+}
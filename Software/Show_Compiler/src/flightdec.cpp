@@ -0,0 +1,178 @@
+// flightdec: decodes a controller flight recorder dump into CSV.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "FlightFormat.h"
+
+static const char BEGIN_TEXT[] = "FLIGHT BEGIN ";
+
+/**
+ * Description: Print command line usage.
+ * Inputs: None.
+ * Outputs: Writes usage text to stderr.
+ */
+static void printUsage() {
+  fprintf(stderr,
+          "usage: flightdec <capture> <output.csv>\n"
+          "  <capture>  raw serial capture containing a 'flight dump' (text around it is skipped)\n");
+}
+
+/**
+ * Description: Read a whole file.
+ * Inputs:
+ * - path: file path.
+ * - out: receives the bytes.
+ * Outputs: Returns false if the file cannot be read.
+ */
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  uint8_t buf[65536];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    out.insert(out.end(), buf, buf + n);
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * Description: Write the CSV header row.
+ * Inputs:
+ * - out: CSV file.
+ * Outputs: Column names for the frame fields and every channel.
+ */
+static void writeHeader(FILE* out) {
+  fprintf(out, "frame,trigger,time_us,show_ms,faults,buttons,pot_speed,pot_accel,jog,"
+               "playing,stopped,motors_on,approaching,recording,follow_level");
+  for (unsigned ch = 0; ch < FLIGHT_CHANNELS; ch++) {
+    fprintf(out, ",ch%u_target,ch%u_pos,ch%u_current_a", ch, ch, ch);
+  }
+  fprintf(out, "\n");
+}
+
+/**
+ * Description: Write one decoded frame as a CSV row.
+ * Inputs:
+ * - out: CSV file.
+ * - frame: frame number.
+ * - trigger: true for the frame where the fault bit rose.
+ * - v: FLIGHT_FIELD_COUNT values.
+ * Outputs: Appends the row.
+ */
+static void writeRow(FILE* out, uint32_t frame, bool trigger, const uint32_t* v) {
+  const uint32_t flags = v[(uint8_t)FlightField::Flags];
+  fprintf(out, "%u,%d,%u,%u,0x%08X,0x%02X,%u,%u,%d,%d,%d,%d,%d,%d,%u",
+          frame, trigger ? 1 : 0, v[(uint8_t)FlightField::TimeUs], v[(uint8_t)FlightField::ShowTimeMs],
+          v[(uint8_t)FlightField::Faults], v[(uint8_t)FlightField::Buttons],
+          v[(uint8_t)FlightField::PotSpeed], v[(uint8_t)FlightField::PotAccel],
+          (int32_t)v[(uint8_t)FlightField::JogPos],
+          (flags & FLIGHT_FLAG_PLAYING) ? 1 : 0, (flags & FLIGHT_FLAG_STOPPED) ? 1 : 0,
+          (flags & FLIGHT_FLAG_MOTORS_ON) ? 1 : 0, (flags & FLIGHT_FLAG_APPROACHING) ? 1 : 0,
+          (flags & FLIGHT_FLAG_RECORDING) ? 1 : 0, (flags >> FLIGHT_FOLLOW_SHIFT) & 3u);
+  for (unsigned ch = 0; ch < FLIGHT_CHANNELS; ch++) {
+    const uint32_t* c = &v[(uint8_t)FlightField::Channels + ch * FLIGHT_CHANNEL_FIELDS];
+    fprintf(out, ",%d,%d,%.2f", (int32_t)c[(uint8_t)FlightChannelField::Target],
+            (int32_t)c[(uint8_t)FlightChannelField::Position],
+            (int32_t)c[(uint8_t)FlightChannelField::CurrentCa] / 100.0);
+  }
+  fprintf(out, "\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printUsage();
+    return 1;
+  }
+
+  std::vector<uint8_t> capture;
+  if (!readFile(argv[1], capture)) {
+    fprintf(stderr, "error: cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  // Find the BEGIN line; the binary part starts after its newline.
+  const std::string text(capture.begin(), capture.end());
+  const size_t begin = text.find(BEGIN_TEXT);
+  const size_t eol = (begin == std::string::npos) ? std::string::npos : text.find('\n', begin);
+  if (eol == std::string::npos) {
+    fprintf(stderr, "error: no 'FLIGHT BEGIN' line in %s\n", argv[1]);
+    return 1;
+  }
+  const size_t binaryBytes = strtoul(text.c_str() + begin + strlen(BEGIN_TEXT), nullptr, 10);
+  const uint8_t* p = capture.data() + eol + 1;
+  const uint8_t* end = p + binaryBytes;
+  if (binaryBytes < sizeof(FlightDumpHeader) || end > capture.data() + capture.size()) {
+    fprintf(stderr, "error: dump truncated (%zu bytes announced)\n", binaryBytes);
+    return 1;
+  }
+
+  FlightDumpHeader header;
+  memcpy(&header, p, sizeof(header));
+  p += sizeof(header);
+  if (header.magic != FLIGHT_MAGIC || header.version != FLIGHT_FORMAT_VERSION ||
+      header.fieldCount != FLIGHT_FIELD_COUNT) {
+    fprintf(stderr, "error: unsupported dump (magic 0x%08X, version %u, %u fields)\n",
+            header.magic, header.version, header.fieldCount);
+    return 1;
+  }
+  const uint32_t checksum = flightFnv1a(2166136261u, p, (size_t)(end - p));
+  if (checksum != header.checksum) {
+    fprintf(stderr, "warning: checksum mismatch (dump 0x%08X, computed 0x%08X)\n", header.checksum, checksum);
+  }
+
+  FILE* out = fopen(argv[2], "w");
+  if (!out) {
+    fprintf(stderr, "error: cannot write %s\n", argv[2]);
+    return 1;
+  }
+  writeHeader(out);
+
+  uint32_t frames = 0;
+  uint32_t values[FLIGHT_FIELD_COUNT];
+  for (uint32_t b = 0; b < header.blockCount; b++) {
+    FlightBlockHeader block;
+    if ((size_t)(end - p) < sizeof(block)) {
+      fprintf(stderr, "error: block %u header truncated\n", b);
+      break;
+    }
+    memcpy(&block, p, sizeof(block));
+    p += sizeof(block);
+    const uint8_t* payloadEnd = p + block.payloadBytes;
+    if (payloadEnd > end) {
+      fprintf(stderr, "error: block %u payload truncated\n", b);
+      break;
+    }
+
+    // Each block starts from absolute values.
+    memset(values, 0, sizeof(values));
+    for (uint32_t f = 0; f < block.frameCount; f++) {
+      for (uint8_t i = 0; i < FLIGHT_FIELD_COUNT; i++) {
+        int32_t delta = 0;
+        if (!flightGetDelta(p, payloadEnd, delta)) {
+          fprintf(stderr, "error: block %u frame %u is corrupt\n", b, f);
+          fclose(out);
+          return 1;
+        }
+        values[i] += (uint32_t)delta;
+      }
+      const uint32_t frame = block.firstFrame + f;
+      writeRow(out, frame, frame == header.triggerFrame, values);
+      frames++;
+    }
+    p = payloadEnd;
+  }
+  fclose(out);
+
+  printf("%u frames, %u blocks, %u us period", frames, header.blockCount, header.periodUs);
+  if (header.triggerFrame != FLIGHT_NO_TRIGGER) {
+    printf(", trigger at frame %u (faults 0x%08X)", header.triggerFrame, header.triggerFaults);
+  }
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,317 @@
+// showc: compiles dense animation exports (CSV) into controller show images.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "CsvReader.h"
+#include "CurveFitter.h"
+#include "Show.h"
+#include "ShowWriter.h"
+
+struct Options {
+  const char* input = nullptr;
+  const char* output = nullptr;
+  const char* eventsPath = nullptr;
+  double fps = 0.0;
+  unsigned threads = 0;
+  bool strict = false;
+  FitOptions fit;
+};
+
+/**
+ * Description: Print command line usage.
+ * Inputs: None.
+ * Outputs: Writes usage text to stderr.
+ */
+static void printUsage() {
+  fprintf(stderr,
+          "usage: showc [options] <input.csv> <output.acs>\n"
+          "  --fps N          first column is a frame number at N fps (default: seconds)\n"
+          "  --scale K        multiply input values by K to get channel units (default 1)\n"
+          "  --tol U          max fit error in channel units (default 1)\n"
+          "  --max-vel V      velocity limit in units/s (default: not checked)\n"
+          "  --max-accel A    acceleration limit in units/s^2 (default: not checked)\n"
+          "  --events FILE    discrete events CSV: timeMs,type,target,value\n"
+          "  --threads N      worker threads (default: all cores)\n"
+          "  --strict         fail when a channel exceeds the limits\n"
+          "Shows with more than %u channels are split into <output>.0.acs, .1.acs, ...\n",
+          (unsigned)SHOW_MAX_CHANNELS);
+}
+
+/**
+ * Description: Parse command line arguments.
+ * Inputs:
+ * - argc: argument count.
+ * - argv: argument values.
+ * - opts: receives the options.
+ * Outputs: Returns false on a usage error.
+ */
+static bool parseArgs(int argc, char** argv, Options& opts) {
+  std::vector<const char*> positional;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+    if (strcmp(arg, "--fps") == 0 && hasValue) {
+      opts.fps = atof(argv[++i]);
+    } else if (strcmp(arg, "--scale") == 0 && hasValue) {
+      opts.fit.scale = (float)atof(argv[++i]);
+    } else if (strcmp(arg, "--tol") == 0 && hasValue) {
+      opts.fit.tolerance = (float)atof(argv[++i]);
+    } else if (strcmp(arg, "--max-vel") == 0 && hasValue) {
+      opts.fit.maxVel = (float)atof(argv[++i]);
+    } else if (strcmp(arg, "--max-accel") == 0 && hasValue) {
+      opts.fit.maxAccel = (float)atof(argv[++i]);
+    } else if (strcmp(arg, "--events") == 0 && hasValue) {
+      opts.eventsPath = argv[++i];
+    } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+      opts.threads = (unsigned)atoi(argv[++i]);
+    } else if (strcmp(arg, "--strict") == 0) {
+      opts.strict = true;
+    } else if (arg[0] == '-' && arg[1] == '-') {
+      return false;
+    } else {
+      positional.push_back(arg);
+    }
+  }
+  if (positional.size() != 2) {
+    return false;
+  }
+  opts.input = positional[0];
+  opts.output = positional[1];
+  if (opts.threads == 0) {
+    opts.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (opts.fit.tolerance < 0.5f) {
+    // Keys hold whole units, so rounding alone can be off by half a unit.
+    fprintf(stderr, "note: tolerance raised to 0.5 (key resolution)\n");
+    opts.fit.tolerance = 0.5f;
+  }
+  return true;
+}
+
+/**
+ * Description: Read a discrete events CSV (timeMs,type,target,value).
+ * Inputs:
+ * - path: file to read.
+ * - events: receives the events sorted by time.
+ * Outputs: Returns false on a read or parse error (message printed).
+ */
+static bool readEvents(const char* path, std::vector<ShowEvent>& events) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    fprintf(stderr, "error: cannot open %s\n", path);
+    return false;
+  }
+  char line[256];
+  unsigned lineNo = 0;
+  while (fgets(line, sizeof(line), file)) {
+    lineNo++;
+    char type[32] = {};
+    char value[32] = {};
+    unsigned long timeMs = 0;
+    unsigned target = 0;
+    if (sscanf(line, " %lu , %31[^,] , %u , %31[^,\r\n]", &timeMs, type, &target, value) != 4) {
+      if (lineNo == 1 || line[strspn(line, " \t\r\n")] == '\0') continue; // header or blank
+      fprintf(stderr, "error: %s:%u: expected timeMs,type,target,value\n", path, lineNo);
+      fclose(file);
+      return false;
+    }
+    ShowEvent ev = {};
+    ev.timeMs = (uint32_t)timeMs;
+    ev.target = (uint8_t)target;
+    if (strcmp(type, "output") == 0) {
+      ev.type = (uint8_t)ShowEventType::Output;
+    } else if (strcmp(type, "audio") == 0) {
+      ev.type = (uint8_t)ShowEventType::Audio;
+    } else if (strcmp(type, "mark") == 0) {
+      ev.type = (uint8_t)ShowEventType::Mark;
+    } else {
+      fprintf(stderr, "error: %s:%u: unknown event type '%s'\n", path, lineNo, type);
+      fclose(file);
+      return false;
+    }
+    if (strcmp(value, "pause") == 0) {
+      ev.value = (uint16_t)ShowMarkAction::Pause;
+    } else if (strcmp(value, "note") == 0) {
+      ev.value = (uint16_t)ShowMarkAction::Note;
+    } else {
+      ev.value = (uint16_t)strtoul(value, nullptr, 10);
+    }
+    events.push_back(ev);
+  }
+  fclose(file);
+  std::stable_sort(events.begin(), events.end(),
+                   [](const ShowEvent& a, const ShowEvent& b) { return a.timeMs < b.timeMs; });
+  return true;
+}
+
+/**
+ * Description: Write one show image and load it back with the firmware loader.
+ * Inputs:
+ * - path: output file.
+ * - results: fitted channels for this image.
+ * - durationMs: show length.
+ * - events: events to include.
+ * Outputs: Returns false on a write or verification failure (message printed).
+ */
+static bool writeShow(const std::string& path, const std::vector<const FitResult*>& results,
+                      uint32_t durationMs, const std::vector<ShowEvent>& events) {
+  std::vector<ShowWriterTrack> tracks(results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    tracks[i].keys = results[i]->keys.data();
+    tracks[i].keyCount = (uint32_t)results[i]->keys.size();
+    tracks[i].checkpoints = results[i]->checkpoints.data();
+    tracks[i].checkpointCount = (uint32_t)results[i]->checkpoints.size();
+  }
+  const uint8_t channelCount = (uint8_t)tracks.size();
+  const uint32_t eventCount = (uint32_t)events.size();
+  const size_t size = ShowWriter::imageSize(tracks.data(), channelCount, eventCount);
+  std::vector<uint32_t> image((size + 3) / 4); // 4-byte aligned for Show::load()
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(image.data());
+  if (ShowWriter::write(bytes, size, tracks.data(), channelCount, durationMs,
+                        events.empty() ? nullptr : events.data(), eventCount) != size) {
+    fprintf(stderr, "error: cannot encode %s\n", path.c_str());
+    return false;
+  }
+
+  Show check;
+  if (!check.load(bytes, size) || check.channelCount() != channelCount) {
+    fprintf(stderr, "error: %s does not load back\n", path.c_str());
+    return false;
+  }
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file || fwrite(bytes, 1, size, file) != size) {
+    fprintf(stderr, "error: cannot write %s\n", path.c_str());
+    if (file) fclose(file);
+    return false;
+  }
+  fclose(file);
+  printf("wrote %s: %u channels, %u events, %zu bytes\n", path.c_str(), channelCount, eventCount, size);
+  return true;
+}
+
+/**
+ * Description: Seconds elapsed since a start point.
+ * Inputs:
+ * - start: start time.
+ * Outputs: Returns elapsed seconds.
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    printUsage();
+    return 1;
+  }
+
+  const auto tStart = std::chrono::steady_clock::now();
+  MotionTable table;
+  CsvReader reader;
+  if (!reader.read(opts.input, opts.fps, opts.threads, table)) {
+    fprintf(stderr, "error: %s: %s\n", opts.input, reader.error().c_str());
+    return 1;
+  }
+  const double parseS = secondsSince(tStart);
+  const size_t channelCount = table.channels.size();
+  const size_t rows = table.timesMs.size();
+
+  std::vector<ShowEvent> events;
+  if (opts.eventsPath && !readEvents(opts.eventsPath, events)) {
+    return 1;
+  }
+
+  // Fit channels in parallel; each worker owns a fitter and pulls the next channel.
+  const auto tFit = std::chrono::steady_clock::now();
+  std::vector<FitResult> results(channelCount);
+  std::atomic<size_t> nextChannel{0};
+  std::vector<std::thread> workers;
+  const unsigned workerCount = (unsigned)std::min<size_t>(opts.threads, channelCount);
+  for (unsigned w = 0; w < workerCount; w++) {
+    workers.emplace_back([&]() {
+      CurveFitter fitter(opts.fit);
+      for (size_t ch = nextChannel++; ch < channelCount; ch = nextChannel++) {
+        fitter.fit(table.timesMs.data(), table.channels[ch].data(), rows, results[ch]);
+      }
+    });
+  }
+  for (std::thread& t : workers) t.join();
+  const double fitS = secondsSince(tFit);
+
+  // Per-channel report.
+  printf("%-4s %-16s %9s %8s %8s %8s %8s %10s %12s %s\n",
+         "ch", "name", "samples", "keys", "ratio", "maxErr", "rmsErr", "peakVel", "peakAccel", "limits");
+  uint64_t totalSamples = 0;
+  uint64_t totalKeys = 0;
+  float worstError = 0.0f;
+  bool failed = false;
+  bool violated = false;
+  uint32_t durationMs = 0;
+  for (size_t ch = 0; ch < channelCount; ch++) {
+    const FitResult& r = results[ch];
+    if (!r.ok) {
+      printf("%-4zu %-16s FAILED (cannot encode)\n", ch, table.names[ch].c_str());
+      failed = true;
+      continue;
+    }
+    char limits[64] = "ok";
+    if (r.velViolations || r.accelViolations) {
+      snprintf(limits, sizeof(limits), "vel x%u accel x%u from %.3f s",
+               r.velViolations, r.accelViolations, r.firstViolationMs / 1000.0);
+      violated = true;
+    }
+    printf("%-4zu %-16s %9u %8zu %7.1f:1 %8.3f %8.3f %10.1f %12.1f %s\n",
+           ch, table.names[ch].c_str(), r.samples, r.keys.size(),
+           (double)r.samples / (double)r.keys.size(), r.maxError, r.rmsError,
+           r.peakVel, r.peakAccel, limits);
+    totalSamples += r.samples;
+    totalKeys += r.keys.size();
+    worstError = std::max(worstError, r.maxError);
+    durationMs = std::max(durationMs, r.durationMs);
+  }
+  if (failed) {
+    return 1;
+  }
+  printf("total: %llu samples -> %llu keys (%.1f:1), max error %.3f, %.1f s of show\n",
+         (unsigned long long)totalSamples, (unsigned long long)totalKeys,
+         totalKeys ? (double)totalSamples / (double)totalKeys : 0.0, worstError, durationMs / 1000.0);
+  if (violated && opts.strict) {
+    fprintf(stderr, "error: kinematic limits exceeded (--strict)\n");
+    return 2;
+  }
+  if (!events.empty() && events.back().timeMs > durationMs) {
+    durationMs = events.back().timeMs;
+  }
+
+  // Write one image per SHOW_MAX_CHANNELS channels; events go with the first.
+  const auto tWrite = std::chrono::steady_clock::now();
+  const size_t imageCount = (channelCount + SHOW_MAX_CHANNELS - 1) / SHOW_MAX_CHANNELS;
+  for (size_t img = 0; img < imageCount; img++) {
+    std::vector<const FitResult*> group;
+    for (size_t ch = img * SHOW_MAX_CHANNELS; ch < channelCount && group.size() < SHOW_MAX_CHANNELS; ch++) {
+      group.push_back(&results[ch]);
+    }
+    std::string path = opts.output;
+    if (imageCount > 1) {
+      const size_t dot = path.rfind('.');
+      const std::string suffix = "." + std::to_string(img);
+      path = (dot == std::string::npos) ? path + suffix : path.substr(0, dot) + suffix + path.substr(dot);
+    }
+    if (!writeShow(path, group, durationMs, (img == 0) ? events : std::vector<ShowEvent>{})) {
+      return 1;
+    }
+  }
+
+  printf("time: parse %.2f s, fit %.2f s (%u threads), write %.2f s, total %.2f s\n",
+         parseS, fitS, workerCount, secondsSince(tWrite), secondsSince(tStart));
+  return 0;
+}